@@ -710,9 +710,11 @@ _adg_do_edit(DemoPart *part)
 
     _adg_part_lock(part);
 
-    adg_model_reset(ADG_MODEL(part->body));
-    adg_model_reset(ADG_MODEL(part->hole));
-    adg_model_reset(ADG_MODEL(part->axis));
+    /* Incremental update: only the entities depending on something
+     * that actually changed are invalidated */
+    adg_path_begin_update(part->body);
+    adg_path_begin_update(part->hole);
+    adg_path_begin_update(part->axis);
     adg_model_reset(ADG_MODEL(part->edges));
 
     _adg_part_define_title_block(part);
@@ -720,9 +722,9 @@ _adg_do_edit(DemoPart *part)
     _adg_part_define_hole(part);
     _adg_part_define_axis(part);
 
-    adg_model_changed(ADG_MODEL(part->body));
-    adg_model_changed(ADG_MODEL(part->hole));
-    adg_model_changed(ADG_MODEL(part->axis));
+    g_slist_free(adg_path_end_update(part->body));
+    g_slist_free(adg_path_end_update(part->hole));
+    g_slist_free(adg_path_end_update(part->axis));
     adg_model_changed(ADG_MODEL(part->edges));
 
     gtk_widget_queue_draw(GTK_WIDGET(part->area));
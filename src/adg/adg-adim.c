@@ -748,6 +748,17 @@ adg_adim_has_extension2(AdgADim *adim)
 }
 
 
+void
+_adg_adim_get_lines(AdgADim *adim, AdgTrail **trail,
+                    AdgMarker **marker1, AdgMarker **marker2)
+{
+    AdgADimPrivate *data = adg_adim_get_instance_private(adim);
+
+    *trail = data->trail;
+    *marker1 = data->marker1;
+    *marker2 = data->marker2;
+}
+
 static void
 _adg_global_changed(AdgEntity *entity)
 {
@@ -758,10 +769,10 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    if (data->marker1 != NULL)
+    if (data->marker1 != NULL && ! _adg_entity_lazy_matrices())
         adg_entity_global_changed((AdgEntity *) data->marker1);
 
-    if (data->marker2 != NULL)
+    if (data->marker2 != NULL && ! _adg_entity_lazy_matrices())
         adg_entity_global_changed((AdgEntity *) data->marker2);
 }
 
@@ -960,11 +971,10 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 
     cairo_transform(cr, adg_entity_get_global_matrix(entity));
     dress = adg_dim_style_get_line_dress(dim_style);
-    adg_entity_apply_dress(entity, dress, cr);
 
+    /* The local matrix has already been applied to the trail */
     cairo_path = adg_trail_get_cairo_path(data->trail);
-    cairo_append_path(cr, cairo_path);
-    cairo_stroke(cr);
+    adg_entity_stroke_path(entity, dress, cairo_path, NULL, cr);
 }
 
 static gchar *
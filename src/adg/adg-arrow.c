@@ -73,6 +73,12 @@ static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
 static AdgModel *       _adg_create_model       (AdgMarker      *marker);
+static void             _adg_model_finalized    (gpointer        key,
+                                                 GObject        *model);
+
+
+/* Arrow models shared among all the arrows with the same angle */
+static GHashTable *_adg_models = NULL;
 
 
 static void
@@ -138,6 +144,8 @@ _adg_set_property(GObject *object, guint prop_id,
     switch (prop_id) {
     case PROP_ANGLE:
         data->angle = cpml_angle(g_value_get_double(value));
+        /* The model depends on the angle: drop the old one */
+        adg_marker_set_model((AdgMarker *) object, NULL);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -274,9 +282,22 @@ _adg_create_model(AdgMarker *marker)
 {
     AdgArrowPrivate *data;
     AdgPath *path;
+    gdouble *key;
     CpmlPair p1, p2;
 
     data = adg_arrow_get_instance_private((AdgArrow *) marker);
+
+    /* The model does not depend on the marker size (that is applied
+     * by the local matrix), so it can be shared among all the arrows
+     * with the same angle: the cache holds only weak references */
+    if (_adg_models == NULL)
+        _adg_models = g_hash_table_new_full(g_double_hash, g_double_equal,
+                                            g_free, NULL);
+
+    path = g_hash_table_lookup(_adg_models, &data->angle);
+    if (path != NULL)
+        return g_object_ref(path);
+
     path = adg_path_new();
     cpml_vector_from_angle(&p1, data->angle / 2);
     p2.x = p1.x;
@@ -287,5 +308,16 @@ _adg_create_model(AdgMarker *marker)
     adg_path_line_to(path, &p2);
     adg_path_close(path);
 
+    key = g_new(gdouble, 1);
+    *key = data->angle;
+    g_hash_table_insert(_adg_models, key, path);
+    g_object_weak_ref((GObject *) path, _adg_model_finalized, key);
+
     return (AdgModel *) path;
 }
+
+static void
+_adg_model_finalized(gpointer key, GObject *model)
+{
+    g_hash_table_remove(_adg_models, key);
+}
@@ -58,6 +58,14 @@
  * simply ignoredby the arrange phase. They are still used by
  * adg_canvas_autoscale() though, if called.
  *
+ * When #AdgCanvas:cache-dir is set, adg_canvas_export() keeps a copy
+ * of every exported file in that directory, keyed by the content hash
+ * of the drawing (see adg_entity_dup_hash()), by the export format and
+ * by the global switches affecting the rendering.
+ * Exporting again a drawing that did not change is then a plain file
+ * copy: the rendering is skipped altogether. Drawings that cannot be
+ * hashed are always rendered and never cached.
+ *
  * Since: 1.0
  **/
 
@@ -91,6 +99,8 @@
 
 
 #include "adg-internal.h"
+#include <gio/gio.h>
+#include <glib/gstdio.h>
 
 #include "adg-container.h"
 #include "adg-table.h"
@@ -125,6 +135,7 @@ enum {
     PROP_SIZE,
     PROP_FACTOR,
     PROP_SCALES,
+    PROP_ANALYTIC_AUTOSCALE,
     PROP_BACKGROUND_DRESS,
     PROP_FRAME_DRESS,
     PROP_TITLE_BLOCK,
@@ -136,7 +147,8 @@ enum {
     PROP_TOP_PADDING,
     PROP_RIGHT_PADDING,
     PROP_BOTTOM_PADDING,
-    PROP_LEFT_PADDING
+    PROP_LEFT_PADDING,
+    PROP_CACHE_DIR
 };
 
 
@@ -157,6 +169,27 @@ static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
 static void             _adg_apply_paddings     (AdgCanvas      *canvas,
                                                  CpmlExtents    *extents);
+static gboolean         _adg_arrange_scale      (AdgCanvas      *canvas,
+                                                 const gchar    *scale,
+                                                 CpmlExtents    *extents);
+static gboolean         _adg_extents_fit        (AdgCanvas      *canvas,
+                                                 const CpmlExtents *extents);
+static void             _adg_center_drawing     (AdgCanvas      *canvas,
+                                                 const CpmlExtents *extents);
+static gdouble          _adg_predict_factor     (gdouble         f1,
+                                                 gdouble         s1,
+                                                 gdouble         f2,
+                                                 gdouble         s2,
+                                                 gdouble         size);
+static gboolean         _adg_autoscale_analytic (AdgCanvas      *canvas);
+static gchar *          _adg_cache_file         (AdgCanvas      *canvas,
+                                                 cairo_surface_type_t type);
+static gboolean         _adg_copy_file          (const gchar    *src,
+                                                 const gchar    *dst,
+                                                 GError        **gerror);
+static void             _adg_cache_store        (const gchar    *cache_dir,
+                                                 const gchar    *file,
+                                                 const gchar    *cached);
 static void             _adg_update_margin      (AdgCanvas      *canvas,
                                                  gdouble        *margin,
                                                  gdouble        *side,
@@ -202,6 +235,7 @@ adg_canvas_class_init(AdgCanvasClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->batchable = FALSE;
 
     param = g_param_spec_boxed("size",
                                P_("Canvas Size"),
@@ -224,6 +258,13 @@ adg_canvas_class_init(AdgCanvasClass *klass)
                                G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_SCALES, param);
 
+    param = g_param_spec_boolean("analytic-autoscale",
+                                 P_("Analytic Autoscale Flag"),
+                                 P_("If enabled, adg_canvas_autoscale() predicts the fitting scale from a few arrange passes instead of trying every scale in sequence"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_ANALYTIC_AUTOSCALE, param);
+
     param = adg_param_spec_dress("background-dress",
                                  P_("Background Dress"),
                                  P_("The color dress to use for the canvas background"),
@@ -307,6 +348,13 @@ adg_canvas_class_init(AdgCanvasClass *klass)
                                 -G_MAXDOUBLE, G_MAXDOUBLE, 15,
                                 G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_LEFT_PADDING, param);
+
+    param = g_param_spec_string("cache-dir",
+                                P_("Cache Directory"),
+                                P_("Where adg_canvas_export() stores the exported files, so unchanged drawings are copied from there instead of being rendered again"),
+                                NULL,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_CACHE_DIR, param);
 }
 
 static void
@@ -322,6 +370,7 @@ adg_canvas_init(AdgCanvas *canvas)
     data->size.y = 0;
     data->factor = 1;
     data->scales = g_strdupv((gchar **) scales);
+    data->analytic_autoscale = FALSE;
     data->background_dress = ADG_DRESS_COLOR_BACKGROUND;
     data->frame_dress = ADG_DRESS_LINE_FRAME;
     data->title_block = NULL;
@@ -334,6 +383,7 @@ adg_canvas_init(AdgCanvas *canvas)
     data->right_padding = 15;
     data->bottom_padding = 15;
     data->left_padding = 15;
+    data->cache_dir = NULL;
 }
 
 static void
@@ -352,6 +402,11 @@ _adg_dispose(GObject *object)
         data->scales = NULL;
     }
 
+    if (data->cache_dir != NULL) {
+        g_free(data->cache_dir);
+        data->cache_dir = NULL;
+    }
+
     if (_ADG_OLD_OBJECT_CLASS->dispose)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
@@ -373,6 +428,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_SCALES:
         g_value_set_boxed(value, data->scales);
         break;
+    case PROP_ANALYTIC_AUTOSCALE:
+        g_value_set_boolean(value, data->analytic_autoscale);
+        break;
     case PROP_BACKGROUND_DRESS:
         g_value_set_enum(value, data->background_dress);
         break;
@@ -409,6 +467,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_LEFT_PADDING:
         g_value_set_double(value, data->left_padding);
         break;
+    case PROP_CACHE_DIR:
+        g_value_set_string(value, data->cache_dir);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -437,6 +498,9 @@ _adg_set_property(GObject *object, guint prop_id,
         g_strfreev(data->scales);
         data->scales = g_value_dup_boxed(value);
         break;
+    case PROP_ANALYTIC_AUTOSCALE:
+        data->analytic_autoscale = g_value_get_boolean(value);
+        break;
     case PROP_BACKGROUND_DRESS:
         data->background_dress = g_value_get_enum(value);
         break;
@@ -485,6 +549,10 @@ _adg_set_property(GObject *object, guint prop_id,
     case PROP_LEFT_PADDING:
         data->left_padding = g_value_get_double(value);
         break;
+    case PROP_CACHE_DIR:
+        g_free(data->cache_dir);
+        data->cache_dir = g_value_dup_string(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -742,6 +810,11 @@ adg_canvas_get_scales(AdgCanvas *canvas)
  * scale of the title block is changed accordingly and the drawing
  * is centered inside the paper.
  *
+ * If #AdgCanvas:analytic-autoscale is enabled and the scales are
+ * sorted from the biggest to the smallest one, the fitting scale is
+ * instead searched by arranging the drawing only a few times: check
+ * adg_canvas_switch_analytic_autoscale() for details.
+ *
  * The paddings are taken into account while computing the drawing
  * extents.
  *
@@ -752,67 +825,89 @@ adg_canvas_autoscale(AdgCanvas *canvas)
 {
     AdgCanvasPrivate *data;
     gchar **p_scale;
-    AdgEntity *entity;
-    cairo_matrix_t map;
     CpmlExtents extents;
-    AdgTitleBlock *title_block;
-    CpmlPair delta;
 
     g_return_if_fail(ADG_IS_CANVAS(canvas));
     g_return_if_fail(_ADG_OLD_ENTITY_CLASS->arrange != NULL);
 
     data = adg_canvas_get_instance_private(canvas);
-    entity = (AdgEntity *) canvas;
-    title_block = data->title_block;
 
     /* Manually calling the arrange() method instead of emitting the "arrange"
      * signal does not invalidate the global matrix: let's do it right now */
-    adg_entity_global_changed(entity);
+    adg_entity_global_changed((AdgEntity *) canvas);
+
+    if (data->analytic_autoscale && _adg_autoscale_analytic(canvas))
+        return;
 
     for (p_scale = data->scales; p_scale != NULL && *p_scale != NULL; ++p_scale) {
         const gchar *scale = *p_scale;
-        gdouble factor = adg_scale_factor(scale);
-        if (factor <= 0)
+        if (adg_scale_factor(scale) <= 0)
             continue;
 
-        cairo_matrix_init_scale(&map, factor, factor);
-        adg_entity_set_local_map(entity, &map);
-        adg_entity_local_changed(entity);
-
-        /* Arrange the entities inside the canvas, but not the canvas itself,
-         * just to get the bounding box of the drawing without the paper */
-        _ADG_OLD_ENTITY_CLASS->arrange(entity);
-        cpml_extents_copy(&extents, adg_entity_get_extents(entity));
-
         /* Just in case @canvas is empty */
-        if (! extents.is_defined)
+        if (! _adg_arrange_scale(canvas, scale, &extents))
             return;
 
-        _adg_apply_paddings(canvas, &extents);
-
-        if (title_block != NULL)
-            adg_title_block_set_scale(title_block, scale);
-
         /* Bail out if paper size is not specified or invalid */
         if (data->size.x <= 0 || data->size.y <= 0)
             break;
 
         /* If the drawing extents are fully contained inside the paper size,
          * center the drawing in the paper and bail out */
-        delta.x = data->size.x - extents.size.x;
-        delta.y = data->size.y - extents.size.y;
-        if (delta.x >= 0 && delta.y >= 0) {
-            cairo_matrix_t transform;
-            cairo_matrix_init_translate(&transform,
-                                        delta.x / 2 - extents.org.x,
-                                        delta.y / 2 - extents.org.y);
-            adg_entity_transform_local_map(entity, &transform,
-                                           ADG_TRANSFORM_AFTER);
+        if (_adg_extents_fit(canvas, &extents)) {
+            _adg_center_drawing(canvas, &extents);
             break;
         }
     }
 }
 
+/**
+ * adg_canvas_switch_analytic_autoscale:
+ * @canvas:    an #AdgCanvas
+ * @new_state: the new flag status
+ *
+ * Sets a new status on the #AdgCanvas:analytic-autoscale property.
+ *
+ * When enabled, adg_canvas_autoscale() does not arrange the drawing
+ * once per scale. It splits the drawing extents in a part that
+ * depends on the scale (the geometry) and a part that does not
+ * (texts, markers and dimension offsets) by arranging the biggest and
+ * the smallest scales, predicts the fitting scale from them and
+ * refines the prediction with a binary search. This requires the
+ * scales to be sorted from the biggest to the smallest factor: if
+ * they are not, the sequential method is used.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_switch_analytic_autoscale(AdgCanvas *canvas, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_object_set(canvas, "analytic-autoscale", new_state, NULL);
+}
+
+/**
+ * adg_canvas_has_analytic_autoscale:
+ * @canvas: an #AdgCanvas
+ *
+ * Gets the current status of the #AdgCanvas:analytic-autoscale
+ * property.
+ *
+ * Returns: the current status of the analytic autoscale flag.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_has_analytic_autoscale(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+
+    data = adg_canvas_get_instance_private(canvas);
+    return data->analytic_autoscale;
+}
+
 /**
  * adg_canvas_set_background_dress:
  * @canvas: an #AdgCanvas
@@ -1434,6 +1529,54 @@ adg_canvas_get_paddings(AdgCanvas *canvas,
     }
 }
 
+/**
+ * adg_canvas_set_cache_dir:
+ * @canvas:    an #AdgCanvas
+ * @cache_dir: (allow-none): the export cache directory
+ *
+ * Sets the directory where adg_canvas_export() keeps a copy of the
+ * exported files. Every file is named after an hash of the drawing
+ * content, of the export format, of the ADG and cairo versions and of
+ * the adg_switch_extents() and adg_switch_batching() states:
+ * when a matching file is already present, it is copied to the
+ * destination and the rendering is skipped.
+ *
+ * The directory is created on the first export, if needed. Stale
+ * files are never removed, so the directory can be cleared at any
+ * time. Set @cache_dir to <constant>NULL</constant> (the default)
+ * to disable the cache.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_set_cache_dir(AdgCanvas *canvas, const gchar *cache_dir)
+{
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_object_set(canvas, "cache-dir", cache_dir, NULL);
+}
+
+/**
+ * adg_canvas_get_cache_dir:
+ * @canvas: an #AdgCanvas
+ *
+ * Gets the export cache directory of @canvas, as set by
+ * adg_canvas_set_cache_dir().
+ *
+ * Returns: (transfer none): the cache directory or <constant>NULL</constant> if the cache is disabled.
+ *
+ * Since: 1.0
+ **/
+const gchar *
+adg_canvas_get_cache_dir(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), NULL);
+
+    data = adg_canvas_get_instance_private(canvas);
+    return data->cache_dir;
+}
+
 
 static void
 _adg_global_changed(AdgEntity *entity)
@@ -1443,7 +1586,7 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    if (data->title_block)
+    if (data->title_block && ! _adg_entity_lazy_matrices())
         adg_entity_global_changed((AdgEntity *) data->title_block);
 }
 
@@ -1467,7 +1610,8 @@ _adg_local_changed(AdgEntity *entity)
                 adg_title_block_set_scale(title_block, "---");
         }
 
-        adg_entity_local_changed((AdgEntity *) title_block);
+        if (! _adg_entity_lazy_matrices())
+            adg_entity_local_changed((AdgEntity *) title_block);
     }
 }
 
@@ -1606,6 +1750,169 @@ _adg_apply_paddings(AdgCanvas *canvas, CpmlExtents *extents)
     extents->size.y += data->top_padding + data->bottom_padding;
 }
 
+static gboolean
+_adg_arrange_scale(AdgCanvas *canvas, const gchar *scale, CpmlExtents *extents)
+{
+    AdgCanvasPrivate *data = adg_canvas_get_instance_private(canvas);
+    AdgEntity *entity = (AdgEntity *) canvas;
+    gdouble factor = adg_scale_factor(scale);
+    cairo_matrix_t map;
+
+    cairo_matrix_init_scale(&map, factor, factor);
+    adg_entity_set_local_map(entity, &map);
+    adg_entity_local_changed(entity);
+
+    /* Arrange the entities inside the canvas, but not the canvas itself,
+     * just to get the bounding box of the drawing without the paper */
+    _ADG_OLD_ENTITY_CLASS->arrange(entity);
+    cpml_extents_copy(extents, adg_entity_get_extents(entity));
+
+    if (! extents->is_defined)
+        return FALSE;
+
+    _adg_apply_paddings(canvas, extents);
+
+    if (data->title_block != NULL)
+        adg_title_block_set_scale(data->title_block, scale);
+
+    return TRUE;
+}
+
+static gboolean
+_adg_extents_fit(AdgCanvas *canvas, const CpmlExtents *extents)
+{
+    AdgCanvasPrivate *data = adg_canvas_get_instance_private(canvas);
+
+    return extents->size.x <= data->size.x && extents->size.y <= data->size.y;
+}
+
+static void
+_adg_center_drawing(AdgCanvas *canvas, const CpmlExtents *extents)
+{
+    AdgCanvasPrivate *data = adg_canvas_get_instance_private(canvas);
+    cairo_matrix_t transform;
+
+    cairo_matrix_init_translate(&transform,
+                                (data->size.x - extents->size.x) / 2 - extents->org.x,
+                                (data->size.y - extents->size.y) / 2 - extents->org.y);
+    adg_entity_transform_local_map((AdgEntity *) canvas, &transform,
+                                   ADG_TRANSFORM_AFTER);
+}
+
+static gdouble
+_adg_predict_factor(gdouble f1, gdouble s1, gdouble f2, gdouble s2,
+                    gdouble size)
+{
+    /* The extents are modeled as s = a * f + b, where a * f is the
+     * scale dependent part and b the scale independent one */
+    if (s1 <= size || s1 == s2)
+        return f1;
+
+    return f1 + (size - s1) * (f2 - f1) / (s2 - s1);
+}
+
+static gboolean
+_adg_autoscale_analytic(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data = adg_canvas_get_instance_private(canvas);
+    gchar **p_scale;
+    const gchar **scales;
+    gdouble *factors;
+    CpmlExtents extents, lo_extents, hi_extents;
+    gint n, lo, hi, guess, arranged;
+    gboolean bisect;
+
+    if (data->scales == NULL || data->size.x <= 0 || data->size.y <= 0)
+        return FALSE;
+
+    n = g_strv_length(data->scales);
+    scales = g_new(const gchar *, n);
+    factors = g_new(gdouble, n);
+
+    /* Collect the valid scales, checking they are sorted */
+    n = 0;
+    for (p_scale = data->scales; *p_scale != NULL; ++p_scale) {
+        gdouble factor = adg_scale_factor(*p_scale);
+        if (factor <= 0)
+            continue;
+        if (n > 0 && factor >= factors[n - 1]) {
+            n = 0;
+            break;
+        }
+        scales[n] = *p_scale;
+        factors[n] = factor;
+        ++n;
+    }
+
+    if (n < 3) {
+        g_free(scales);
+        g_free(factors);
+        return FALSE;
+    }
+
+    /* The biggest scale has the precedence: if it fits or the canvas
+     * is empty there is nothing else to do */
+    lo = 0;
+    hi = n - 1;
+    if (! _adg_arrange_scale(canvas, scales[lo], &lo_extents)) {
+        arranged = -1;
+    } else if (_adg_extents_fit(canvas, &lo_extents)) {
+        _adg_center_drawing(canvas, &lo_extents);
+        arranged = -1;
+    } else {
+        /* Even the smallest scale does not fit: leave it applied,
+         * as the sequential method would do */
+        _adg_arrange_scale(canvas, scales[hi], &hi_extents);
+        arranged = _adg_extents_fit(canvas, &hi_extents) ? hi : -1;
+    }
+
+    /* Invariant: scales[lo] does not fit while scales[hi] does.
+     * Alternate the linear prediction with a plain bisection, so
+     * the number of arrange passes is logarithmic in the worst case */
+    bisect = FALSE;
+    while (arranged >= 0 && hi - lo > 1) {
+        if (bisect) {
+            guess = (lo + hi) / 2;
+        } else {
+            gdouble fx, fy, factor;
+
+            fx = _adg_predict_factor(factors[lo], lo_extents.size.x,
+                                     factors[hi], hi_extents.size.x,
+                                     data->size.x);
+            fy = _adg_predict_factor(factors[lo], lo_extents.size.y,
+                                     factors[hi], hi_extents.size.y,
+                                     data->size.y);
+            factor = MIN(fx, fy);
+
+            for (guess = lo + 1; guess < hi - 1; ++guess)
+                if (factors[guess] <= factor)
+                    break;
+        }
+        bisect = ! bisect;
+
+        _adg_arrange_scale(canvas, scales[guess], &extents);
+        arranged = guess;
+        if (_adg_extents_fit(canvas, &extents)) {
+            hi = guess;
+            cpml_extents_copy(&hi_extents, &extents);
+        } else {
+            lo = guess;
+            cpml_extents_copy(&lo_extents, &extents);
+        }
+    }
+
+    if (arranged >= 0) {
+        /* Leave the drawing arranged with the fitting scale */
+        if (arranged != hi)
+            _adg_arrange_scale(canvas, scales[hi], &hi_extents);
+        _adg_center_drawing(canvas, &hi_extents);
+    }
+
+    g_free(scales);
+    g_free(factors);
+    return TRUE;
+}
+
 
 /**
  * adg_canvas_export:
@@ -1619,6 +1926,12 @@ _adg_apply_paddings(AdgCanvas *canvas, CpmlExtents *extents)
  * in the @type format. Any error will be reported in @gerror,
  * if not <constant>NULL</constant>.
  *
+ * If #AdgCanvas:cache-dir is set and the same drawing has already
+ * been exported in the same format, the cached file is copied to
+ * @file without rendering anything. Failures while storing a new
+ * file in the cache are reported as warnings but do not make the
+ * export fail.
+ *
  * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
  *
  * Since: 1.0
@@ -1627,20 +1940,33 @@ gboolean
 adg_canvas_export(AdgCanvas *canvas, cairo_surface_type_t type,
                   const gchar *file, GError **gerror)
 {
+    AdgCanvasPrivate *data;
     AdgEntity *entity;
     const CpmlExtents *extents;
     gdouble top, bottom, left, right, width, height, factor;
     cairo_surface_t *surface;
     cairo_t *cr;
     cairo_status_t status;
+    gchar *cached;
+    gboolean result;
 
     g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
     g_return_val_if_fail(file != NULL, FALSE);
     g_return_val_if_fail(gerror == NULL || *gerror == NULL, FALSE);
 
+    data = adg_canvas_get_instance_private(canvas);
     entity = (AdgEntity *) canvas;
 
     adg_entity_arrange(entity);
+
+    /* An unchanged drawing is simply copied from the cache */
+    cached = data->cache_dir != NULL ? _adg_cache_file(canvas, type) : NULL;
+    if (cached != NULL && g_file_test(cached, G_FILE_TEST_IS_REGULAR)) {
+        result = _adg_copy_file(cached, file, gerror);
+        g_free(cached);
+        return result;
+    }
+
     extents = adg_entity_get_extents(entity);
 
     factor = adg_canvas_get_factor(canvas);
@@ -1681,6 +2007,7 @@ adg_canvas_export(AdgCanvas *canvas, cairo_surface_type_t type,
         g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_SURFACE,
                     "unable to handle surface type '%d'",
                     type);
+        g_free(cached);
         return FALSE;
     }
 
@@ -1704,12 +2031,130 @@ adg_canvas_export(AdgCanvas *canvas, cairo_surface_type_t type,
         g_set_error(gerror, ADG_CANVAS_ERROR, ADG_CANVAS_ERROR_CAIRO,
                     "cairo reported '%s'",
                     cairo_status_to_string(status));
+        g_free(cached);
         return FALSE;
     }
 
+    if (cached != NULL) {
+        _adg_cache_store(data->cache_dir, file, cached);
+        g_free(cached);
+    }
+
     return TRUE;
 }
 
+static gchar *
+_adg_cache_file(AdgCanvas *canvas, cairo_surface_type_t type)
+{
+    AdgCanvasPrivate *data = adg_canvas_get_instance_private(canvas);
+    const gchar *extension;
+    GChecksum *checksum;
+    gchar *hash, *switches, *name, *cached;
+
+    switch (type) {
+#ifdef CAIRO_HAS_PNG_FUNCTIONS
+    case CAIRO_SURFACE_TYPE_IMAGE:
+        extension = "png";
+        break;
+#endif
+#ifdef CAIRO_HAS_PDF_SURFACE
+    case CAIRO_SURFACE_TYPE_PDF:
+        extension = "pdf";
+        break;
+#endif
+#ifdef CAIRO_HAS_PS_SURFACE
+    case CAIRO_SURFACE_TYPE_PS:
+        extension = "ps";
+        break;
+#endif
+#ifdef CAIRO_HAS_SVG_SURFACE
+    case CAIRO_SURFACE_TYPE_SVG:
+        extension = "svg";
+        break;
+#endif
+    default:
+        return NULL;
+    }
+
+    /* The same drawing could be rendered differently by other
+     * versions of ADG or cairo or with other global render switches.
+     * The level of detail is not included: it is bound to the cairo
+     * context and never enabled on the exports */
+    hash = adg_entity_dup_hash((AdgEntity *) canvas);
+    if (hash == NULL)
+        return NULL;
+
+    switches = g_strdup_printf("\n%u\n", _adg_entity_render_switches());
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, (const guchar *) hash, -1);
+    g_checksum_update(checksum, (const guchar *) "\n" PACKAGE_VERSION "\n", -1);
+    g_checksum_update(checksum, (const guchar *) cairo_version_string(), -1);
+    g_checksum_update(checksum, (const guchar *) switches, -1);
+    g_checksum_update(checksum, (const guchar *) extension, -1);
+
+    name = g_strdup_printf("%s.%s", g_checksum_get_string(checksum), extension);
+    cached = g_build_filename(data->cache_dir, name, NULL);
+
+    g_free(name);
+    g_checksum_free(checksum);
+    g_free(switches);
+    g_free(hash);
+
+    return cached;
+}
+
+static gboolean
+_adg_copy_file(const gchar *src, const gchar *dst, GError **gerror)
+{
+    GFile *src_file, *dst_file;
+    gboolean result;
+
+    src_file = g_file_new_for_path(src);
+    dst_file = g_file_new_for_path(dst);
+    result = g_file_copy(src_file, dst_file, G_FILE_COPY_OVERWRITE,
+                         NULL, NULL, NULL, gerror);
+    g_object_unref(src_file);
+    g_object_unref(dst_file);
+
+    return result;
+}
+
+static void
+_adg_cache_store(const gchar *cache_dir, const gchar *file, const gchar *cached)
+{
+    gchar *tmp;
+    gint fd;
+    GError *error;
+
+    if (g_mkdir_with_parents(cache_dir, 0755) != 0) {
+        g_warning(_("%s: unable to create the export cache '%s'"),
+                  G_STRLOC, cache_dir);
+        return;
+    }
+
+    /* Write a temporary file and rename it, so a concurrent
+     * export never sees a partially written cache entry */
+    tmp = g_strconcat(cached, ".XXXXXX", NULL);
+    fd = g_mkstemp(tmp);
+    if (fd == -1) {
+        g_warning(_("%s: unable to write in the export cache '%s'"),
+                  G_STRLOC, cache_dir);
+        g_free(tmp);
+        return;
+    }
+    g_close(fd, NULL);
+
+    error = NULL;
+    if (! _adg_copy_file(file, tmp, &error) || g_rename(tmp, cached) != 0) {
+        g_warning(_("%s: unable to store '%s' in the export cache"),
+                  G_STRLOC, file);
+        g_clear_error(&error);
+        g_unlink(tmp);
+    }
+
+    g_free(tmp);
+}
+
 
 #if GTK3_ENABLED || GTK2_ENABLED
 #include <gtk/gtk.h>
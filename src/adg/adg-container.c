@@ -126,6 +126,8 @@ adg_container_class_init(AdgContainerClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->batchable = TRUE;
+    entity_class->lod_policy = ADG_LOD_POLICY_NONE;
 
     klass->children = _adg_children;
     klass->add = _adg_add;
@@ -465,7 +467,9 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_PARENT_ENTITY_CLASS->global_changed)
         _ADG_PARENT_ENTITY_CLASS->global_changed(entity);
 
-    adg_container_propagate_by_name((AdgContainer *) entity, "global-changed");
+    /* In lazy mode every child will check its own matrix when arranged */
+    if (! _adg_entity_lazy_matrices())
+        adg_container_propagate_by_name((AdgContainer *) entity, "global-changed");
 }
 
 static void
@@ -474,7 +478,8 @@ _adg_local_changed(AdgEntity *entity)
     if (_ADG_PARENT_ENTITY_CLASS->local_changed)
         _ADG_PARENT_ENTITY_CLASS->local_changed(entity);
 
-    adg_container_propagate_by_name((AdgContainer *) entity, "local-changed");
+    if (! _adg_entity_lazy_matrices())
+        adg_container_propagate_by_name((AdgContainer *) entity, "local-changed");
 }
 
 static void
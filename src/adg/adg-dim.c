@@ -157,6 +157,7 @@ adg_dim_class_init(AdgDimClass *klass)
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
+    entity_class->batchable = TRUE;
 
     klass->compute_geometry = _adg_compute_geometry;
     klass->quote_angle = _adg_quote_angle;
@@ -1435,7 +1436,7 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    if (data->quote.entity)
+    if (data->quote.entity && ! _adg_entity_lazy_matrices())
         adg_entity_global_changed((AdgEntity *) data->quote.entity);
 }
 
@@ -1447,7 +1448,7 @@ _adg_local_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->local_changed)
         _ADG_OLD_ENTITY_CLASS->local_changed(entity);
 
-    if (data->quote.entity)
+    if (data->quote.entity && ! _adg_entity_lazy_matrices())
         adg_entity_local_changed((AdgEntity *) data->quote.entity);
 }
 
@@ -349,6 +349,8 @@ adg_dress_set_fallback(AdgDress dress, AdgStyle *fallback)
 
     if (data->fallback != NULL)
         g_object_ref(data->fallback);
+
+    _adg_entity_styles_changed();
 }
 
 /**
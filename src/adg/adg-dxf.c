@@ -0,0 +1,975 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-dxf
+ * @Section_Id:dxf
+ * @title: DXF export
+ * @short_description: Export of drawings in the DXF format
+ *
+ * Exporting a drawing through a cairo surface flattens it into a
+ * bunch of strokes, losing what makes it a technical drawing. The
+ * DXF exporter instead walks the arranged entity tree and writes
+ * the entities directly, so the following information is kept:
+ * <itemizedlist>
+ * <listitem>every #AdgStroke is written primitive by primitive: lines
+ *           become LINE entities, arcs become ARC entities and Bézier
+ *           curves become cubic SPLINE entities;</listitem>
+ * <listitem>an #AdgTrail stroked by more than one entity is written
+ *           only once as a BLOCK and every stroke becomes an INSERT
+ *           of that block;</listitem>
+ * <listitem>#AdgLDim, #AdgADim and #AdgRDim entities become linear,
+ *           angular and radial DIMENSION entities, with their
+ *           reference points, their quote text and their measure
+ *           in model space.</listitem>
+ * </itemizedlist>
+ *
+ * The coordinates are the ones of the rendered drawing, that is the
+ * model space transformed by the local and global matrices, with the
+ * y axis flipped to follow the DXF convention. Any other entity type
+ * (e.g. texts, hatches and tables) is silently skipped.
+ *
+ * The file is written sequentially while walking the tree, so the
+ * memory required does not depend on the size of the paths. The only
+ * data kept for the whole export is the set of trails, needed to
+ * know in advance which of them must be written as a block.
+ *
+ * The output follows the AutoCAD 2000 (AC1015) format in its
+ * minimal form: every symbol table and the root dictionary of the
+ * OBJECTS section are written, but only with the default records
+ * (the layer "0", the "Continuous" line type and the "Standard" text
+ * and dimension styles). Every dimension refers to its own anonymous
+ * block, left empty, so the reading application is expected to
+ * regenerate the dimension graphics.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-container.h"
+#include "adg-alignment.h"
+#include "adg-point.h"
+#include "adg-marker.h"
+#include "adg-style.h"
+#include "adg-dress.h"
+#include "adg-dim-style.h"
+#include "adg-stroke.h"
+#include "adg-hatch.h"
+#include "adg-dim.h"
+#include "adg-ldim.h"
+#include "adg-adim.h"
+#include "adg-rdim.h"
+
+#include "adg-dxf.h"
+
+
+#define _ADG_DXF_EPSILON        1e-9
+
+typedef struct {
+    FILE           *file;
+    guint           handle;
+    GHashTable     *trails;
+    GHashTable     *blocks;
+    guint           n_dims;
+    guint           dim;
+} _AdgDxf;
+
+
+static void             _adg_count_entities     (_AdgDxf        *dxf,
+                                                 AdgEntity      *entity);
+static void             _adg_write_tables       (_AdgDxf        *dxf);
+static void             _adg_write_objects      (_AdgDxf        *dxf);
+static guint            _adg_begin_table        (_AdgDxf        *dxf,
+                                                 const gchar    *name,
+                                                 gint            n_records);
+static void             _adg_begin_record       (_AdgDxf        *dxf,
+                                                 const gchar    *type,
+                                                 const gchar    *subclass,
+                                                 guint           owner);
+static void             _adg_write_line_type    (_AdgDxf        *dxf,
+                                                 guint           owner,
+                                                 const gchar    *name,
+                                                 const gchar    *description);
+static void             _adg_write_block_record (_AdgDxf        *dxf,
+                                                 guint           owner,
+                                                 const gchar    *name);
+static void             _adg_write_blocks       (_AdgDxf        *dxf);
+static void             _adg_write_block        (_AdgDxf        *dxf,
+                                                 const gchar    *name,
+                                                 gint            flags,
+                                                 AdgTrail       *trail);
+static void             _adg_write_entity       (_AdgDxf        *dxf,
+                                                 AdgEntity      *entity);
+static void             _adg_write_stroke       (_AdgDxf        *dxf,
+                                                 AdgStroke      *stroke);
+static gboolean         _adg_write_insert       (_AdgDxf        *dxf,
+                                                 guint           block,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_write_trail        (_AdgDxf        *dxf,
+                                                 AdgTrail       *trail,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_write_line         (_AdgDxf        *dxf,
+                                                 const CpmlPrimitive *primitive,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_write_arc          (_AdgDxf        *dxf,
+                                                 const CpmlPrimitive *primitive,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_write_spline       (_AdgDxf        *dxf,
+                                                 const CpmlPair *org,
+                                                 const cairo_path_data_t *data,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_write_ldim         (_AdgDxf        *dxf,
+                                                 AdgLDim        *ldim);
+static void             _adg_write_adim         (_AdgDxf        *dxf,
+                                                 AdgADim        *adim);
+static void             _adg_write_rdim         (_AdgDxf        *dxf,
+                                                 AdgRDim        *rdim);
+static void             _adg_write_dim_header   (_AdgDxf        *dxf,
+                                                 AdgDim         *dim,
+                                                 gint            type,
+                                                 const CpmlPair *def,
+                                                 const CpmlPair *text,
+                                                 gdouble         measure);
+static gboolean         _adg_get_pair           (AdgPoint       *point,
+                                                 CpmlPair       *pair);
+static void             _adg_get_matrix         (AdgEntity      *entity,
+                                                 cairo_matrix_t *matrix);
+static gboolean         _adg_is_similarity      (const cairo_matrix_t *matrix);
+static void             _adg_put_entity         (_AdgDxf        *dxf,
+                                                 const gchar    *type,
+                                                 const gchar    *subclass);
+static guint            _adg_put_handle         (_AdgDxf        *dxf);
+static void             _adg_put_hex            (_AdgDxf        *dxf,
+                                                 gint            code,
+                                                 guint           value);
+static void             _adg_put_string         (_AdgDxf        *dxf,
+                                                 gint            code,
+                                                 const gchar    *string);
+static void             _adg_put_int            (_AdgDxf        *dxf,
+                                                 gint            code,
+                                                 gint            value);
+static void             _adg_put_double         (_AdgDxf        *dxf,
+                                                 gint            code,
+                                                 gdouble         value);
+static void             _adg_put_angle          (_AdgDxf        *dxf,
+                                                 gint            code,
+                                                 gdouble         angle);
+static void             _adg_put_pair           (_AdgDxf        *dxf,
+                                                 gint            code,
+                                                 const CpmlPair *pair,
+                                                 const cairo_matrix_t *matrix);
+
+/* Maps the ADG y axis, pointing down, to the DXF one */
+static const cairo_matrix_t _adg_flip = { 1, 0, 0, -1, 0, 0 };
+
+
+/**
+ * adg_dxf_export:
+ * @entity: the root #AdgEntity to export
+ * @file: the name of the file to write
+ * @error: (allow-none): return location for a #GError or <constant>NULL</constant>
+ *
+ * Arranges @entity and writes it, together with its children, in
+ * @file using the DXF format. Check the section description for
+ * details on which entities are exported. Any I/O error is reported
+ * in @error, if not <constant>NULL</constant>, in the
+ * #G_FILE_ERROR domain.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_dxf_export(AdgEntity *entity, const gchar *file, GError **error)
+{
+    _AdgDxf dxf;
+    GHashTableIter iter;
+    gpointer trail, count;
+    glong seed;
+    gboolean result;
+    gint code;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    dxf.file = g_fopen(file, "wb");
+    if (dxf.file == NULL) {
+        code = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(code),
+                    "unable to open '%s': %s", file, g_strerror(code));
+        return FALSE;
+    }
+
+    adg_entity_arrange(entity);
+
+    /* Handles 1 to 0xFF are left to the reading application */
+    dxf.handle = 0xFF;
+    dxf.trails = g_hash_table_new(NULL, NULL);
+    dxf.blocks = g_hash_table_new(NULL, NULL);
+    dxf.n_dims = 0;
+    dxf.dim = 0;
+
+    /* Only the trails stroked more than once become blocks */
+    _adg_count_entities(&dxf, entity);
+    g_hash_table_iter_init(&iter, dxf.trails);
+    while (g_hash_table_iter_next(&iter, &trail, &count))
+        if (GPOINTER_TO_UINT(count) > 1)
+            g_hash_table_insert(dxf.blocks, trail,
+                                GUINT_TO_POINTER(g_hash_table_size(dxf.blocks) + 1));
+
+    _adg_put_string(&dxf, 0, "SECTION");
+    _adg_put_string(&dxf, 2, "HEADER");
+    _adg_put_string(&dxf, 9, "$ACADVER");
+    _adg_put_string(&dxf, 1, "AC1015");
+    _adg_put_string(&dxf, 9, "$HANDSEED");
+
+    /* The seed is known only at the end: reserve room for it */
+    fputs("  5\n", dxf.file);
+    seed = ftell(dxf.file);
+    fputs("00000000\n", dxf.file);
+
+    _adg_put_string(&dxf, 0, "ENDSEC");
+
+    _adg_write_tables(&dxf);
+    _adg_write_blocks(&dxf);
+
+    _adg_put_string(&dxf, 0, "SECTION");
+    _adg_put_string(&dxf, 2, "ENTITIES");
+    _adg_write_entity(&dxf, entity);
+    _adg_put_string(&dxf, 0, "ENDSEC");
+
+    _adg_write_objects(&dxf);
+    _adg_put_string(&dxf, 0, "EOF");
+
+    if (seed >= 0 && fseek(dxf.file, seed, SEEK_SET) == 0)
+        fprintf(dxf.file, "%08X", dxf.handle + 1);
+
+    result = ! ferror(dxf.file) && seed >= 0;
+    code = errno;
+    if (fclose(dxf.file) != 0 && result) {
+        code = errno;
+        result = FALSE;
+    }
+
+    if (! result)
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(code),
+                    "unable to write '%s': %s", file, g_strerror(code));
+
+    g_hash_table_destroy(dxf.trails);
+    g_hash_table_destroy(dxf.blocks);
+
+    return result;
+}
+
+
+static void
+_adg_count_entities(_AdgDxf *dxf, AdgEntity *entity)
+{
+    if (ADG_IS_CONTAINER(entity)) {
+        GSList *children, *child;
+
+        children = adg_container_children((AdgContainer *) entity);
+        for (child = children; child != NULL; child = child->next)
+            _adg_count_entities(dxf, child->data);
+        g_slist_free(children);
+    } else if (ADG_IS_LDIM(entity) || ADG_IS_ADIM(entity) ||
+               ADG_IS_RDIM(entity)) {
+        ++dxf->n_dims;
+    } else if (ADG_IS_STROKE(entity) && ! ADG_IS_HATCH(entity)) {
+        AdgTrail *trail = adg_stroke_get_trail((AdgStroke *) entity);
+        guint count;
+
+        if (trail != NULL) {
+            count = GPOINTER_TO_UINT(g_hash_table_lookup(dxf->trails, trail));
+            g_hash_table_insert(dxf->trails, trail, GUINT_TO_POINTER(count + 1));
+        }
+    }
+}
+
+static void
+_adg_write_tables(_AdgDxf *dxf)
+{
+    GHashTableIter iter;
+    gpointer block;
+    gchar *name;
+    guint table, n;
+
+    _adg_put_string(dxf, 0, "SECTION");
+    _adg_put_string(dxf, 2, "TABLES");
+
+    _adg_begin_table(dxf, "VPORT", 0);
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    table = _adg_begin_table(dxf, "LTYPE", 3);
+    _adg_write_line_type(dxf, table, "ByBlock", "");
+    _adg_write_line_type(dxf, table, "ByLayer", "");
+    _adg_write_line_type(dxf, table, "Continuous", "Solid line");
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    table = _adg_begin_table(dxf, "LAYER", 1);
+    _adg_begin_record(dxf, "LAYER", "AcDbLayerTableRecord", table);
+    _adg_put_string(dxf, 2, "0");
+    _adg_put_int(dxf, 70, 0);
+    _adg_put_int(dxf, 62, 7);
+    _adg_put_string(dxf, 6, "Continuous");
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    table = _adg_begin_table(dxf, "STYLE", 1);
+    _adg_begin_record(dxf, "STYLE", "AcDbTextStyleTableRecord", table);
+    _adg_put_string(dxf, 2, "Standard");
+    _adg_put_int(dxf, 70, 0);
+    _adg_put_double(dxf, 40, 0);
+    _adg_put_double(dxf, 41, 1);
+    _adg_put_double(dxf, 50, 0);
+    _adg_put_int(dxf, 71, 0);
+    _adg_put_double(dxf, 42, 2.5);
+    _adg_put_string(dxf, 3, "txt");
+    _adg_put_string(dxf, 4, "");
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    _adg_begin_table(dxf, "VIEW", 0);
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    _adg_begin_table(dxf, "UCS", 0);
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    table = _adg_begin_table(dxf, "APPID", 1);
+    _adg_begin_record(dxf, "APPID", "AcDbRegAppTableRecord", table);
+    _adg_put_string(dxf, 2, "ACAD");
+    _adg_put_int(dxf, 70, 0);
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    /* The dimension style records use 105 instead of 5 for the handle */
+    table = _adg_begin_table(dxf, "DIMSTYLE", 1);
+    _adg_put_string(dxf, 100, "AcDbDimStyleTable");
+    _adg_put_int(dxf, 71, 0);
+    _adg_put_string(dxf, 0, "DIMSTYLE");
+    _adg_put_hex(dxf, 105, ++dxf->handle);
+    _adg_put_hex(dxf, 330, table);
+    _adg_put_string(dxf, 100, "AcDbSymbolTableRecord");
+    _adg_put_string(dxf, 100, "AcDbDimStyleTableRecord");
+    _adg_put_string(dxf, 2, "Standard");
+    _adg_put_int(dxf, 70, 0);
+    _adg_put_string(dxf, 0, "ENDTAB");
+
+    table = _adg_begin_table(dxf, "BLOCK_RECORD",
+                             g_hash_table_size(dxf->blocks) + dxf->n_dims + 2);
+    _adg_write_block_record(dxf, table, "*Model_Space");
+    _adg_write_block_record(dxf, table, "*Paper_Space");
+
+    g_hash_table_iter_init(&iter, dxf->blocks);
+    while (g_hash_table_iter_next(&iter, NULL, &block)) {
+        name = g_strdup_printf("ADG_TRAIL_%u", GPOINTER_TO_UINT(block));
+        _adg_write_block_record(dxf, table, name);
+        g_free(name);
+    }
+
+    for (n = 1; n <= dxf->n_dims; ++n) {
+        name = g_strdup_printf("*D%u", n);
+        _adg_write_block_record(dxf, table, name);
+        g_free(name);
+    }
+
+    _adg_put_string(dxf, 0, "ENDTAB");
+    _adg_put_string(dxf, 0, "ENDSEC");
+}
+
+static void
+_adg_write_objects(_AdgDxf *dxf)
+{
+    guint root;
+
+    _adg_put_string(dxf, 0, "SECTION");
+    _adg_put_string(dxf, 2, "OBJECTS");
+
+    /* The root dictionary, with the only mandatory entry */
+    _adg_put_string(dxf, 0, "DICTIONARY");
+    root = _adg_put_handle(dxf);
+    _adg_put_hex(dxf, 330, 0);
+    _adg_put_string(dxf, 100, "AcDbDictionary");
+    _adg_put_int(dxf, 281, 1);
+    _adg_put_string(dxf, 3, "ACAD_GROUP");
+    _adg_put_hex(dxf, 350, root + 1);
+
+    _adg_put_string(dxf, 0, "DICTIONARY");
+    _adg_put_handle(dxf);
+    _adg_put_hex(dxf, 330, root);
+    _adg_put_string(dxf, 100, "AcDbDictionary");
+    _adg_put_int(dxf, 281, 1);
+
+    _adg_put_string(dxf, 0, "ENDSEC");
+}
+
+static guint
+_adg_begin_table(_AdgDxf *dxf, const gchar *name, gint n_records)
+{
+    guint table;
+
+    _adg_put_string(dxf, 0, "TABLE");
+    _adg_put_string(dxf, 2, name);
+    table = _adg_put_handle(dxf);
+    _adg_put_hex(dxf, 330, 0);
+    _adg_put_string(dxf, 100, "AcDbSymbolTable");
+    _adg_put_int(dxf, 70, n_records);
+
+    return table;
+}
+
+static void
+_adg_begin_record(_AdgDxf *dxf, const gchar *type,
+                  const gchar *subclass, guint owner)
+{
+    _adg_put_string(dxf, 0, type);
+    _adg_put_handle(dxf);
+    _adg_put_hex(dxf, 330, owner);
+    _adg_put_string(dxf, 100, "AcDbSymbolTableRecord");
+    _adg_put_string(dxf, 100, subclass);
+}
+
+static void
+_adg_write_line_type(_AdgDxf *dxf, guint owner,
+                     const gchar *name, const gchar *description)
+{
+    _adg_begin_record(dxf, "LTYPE", "AcDbLinetypeTableRecord", owner);
+    _adg_put_string(dxf, 2, name);
+    _adg_put_int(dxf, 70, 0);
+    _adg_put_string(dxf, 3, description);
+    _adg_put_int(dxf, 72, 65);
+    _adg_put_int(dxf, 73, 0);
+    _adg_put_double(dxf, 40, 0);
+}
+
+static void
+_adg_write_block_record(_AdgDxf *dxf, guint owner, const gchar *name)
+{
+    _adg_begin_record(dxf, "BLOCK_RECORD", "AcDbBlockTableRecord", owner);
+    _adg_put_string(dxf, 2, name);
+}
+
+static void
+_adg_write_blocks(_AdgDxf *dxf)
+{
+    GHashTableIter iter;
+    gpointer trail, block;
+    gchar *name;
+    guint n;
+
+    _adg_put_string(dxf, 0, "SECTION");
+    _adg_put_string(dxf, 2, "BLOCKS");
+
+    _adg_write_block(dxf, "*Model_Space", 0, NULL);
+    _adg_write_block(dxf, "*Paper_Space", 0, NULL);
+
+    g_hash_table_iter_init(&iter, dxf->blocks);
+    while (g_hash_table_iter_next(&iter, &trail, &block)) {
+        name = g_strdup_printf("ADG_TRAIL_%u", GPOINTER_TO_UINT(block));
+        _adg_write_block(dxf, name, 0, trail);
+        g_free(name);
+    }
+
+    /* The anonymous blocks of the dimensions (flag 1) */
+    for (n = 1; n <= dxf->n_dims; ++n) {
+        name = g_strdup_printf("*D%u", n);
+        _adg_write_block(dxf, name, 1, NULL);
+        g_free(name);
+    }
+
+    _adg_put_string(dxf, 0, "ENDSEC");
+}
+
+static void
+_adg_write_block(_AdgDxf *dxf, const gchar *name, gint flags, AdgTrail *trail)
+{
+    const CpmlPair origin = { 0, 0 };
+
+    _adg_put_entity(dxf, "BLOCK", "AcDbBlockBegin");
+    _adg_put_string(dxf, 2, name);
+    _adg_put_int(dxf, 70, flags);
+    _adg_put_pair(dxf, 10, &origin, NULL);
+    _adg_put_string(dxf, 3, name);
+    _adg_put_string(dxf, 1, "");
+
+    /* The y axis is flipped here, so the insertions
+     * can reuse the matrices of the strokes */
+    if (trail != NULL)
+        _adg_write_trail(dxf, trail, &_adg_flip);
+
+    _adg_put_entity(dxf, "ENDBLK", "AcDbBlockEnd");
+}
+
+static void
+_adg_write_entity(_AdgDxf *dxf, AdgEntity *entity)
+{
+    if (ADG_IS_CONTAINER(entity)) {
+        GSList *children, *child;
+
+        /* The children list is built by prepending */
+        children = adg_container_children((AdgContainer *) entity);
+        children = g_slist_reverse(children);
+        for (child = children; child != NULL; child = child->next)
+            _adg_write_entity(dxf, child->data);
+        g_slist_free(children);
+    } else if (ADG_IS_HATCH(entity)) {
+        /* Fillings have no counterpart in the exported entities */
+    } else if (ADG_IS_STROKE(entity)) {
+        _adg_write_stroke(dxf, (AdgStroke *) entity);
+    } else if (ADG_IS_LDIM(entity)) {
+        _adg_write_ldim(dxf, (AdgLDim *) entity);
+    } else if (ADG_IS_ADIM(entity)) {
+        _adg_write_adim(dxf, (AdgADim *) entity);
+    } else if (ADG_IS_RDIM(entity)) {
+        _adg_write_rdim(dxf, (AdgRDim *) entity);
+    }
+}
+
+static void
+_adg_write_stroke(_AdgDxf *dxf, AdgStroke *stroke)
+{
+    AdgTrail *trail;
+    cairo_matrix_t matrix, insert;
+    guint block;
+
+    trail = adg_stroke_get_trail(stroke);
+    if (trail == NULL)
+        return;
+
+    _adg_get_matrix((AdgEntity *) stroke, &matrix);
+
+    block = GPOINTER_TO_UINT(g_hash_table_lookup(dxf->blocks, trail));
+    if (block > 0) {
+        /* The block is already flipped, so flip it back first */
+        cairo_matrix_multiply(&insert, &_adg_flip, &matrix);
+        if (_adg_write_insert(dxf, block, &insert))
+            return;
+    }
+
+    _adg_write_trail(dxf, trail, &matrix);
+}
+
+static gboolean
+_adg_write_insert(_AdgDxf *dxf, guint block, const cairo_matrix_t *matrix)
+{
+    CpmlPair pair;
+    gdouble x_scale, y_scale;
+    gchar *name;
+
+    /* An INSERT can only rotate and scale along the block axes */
+    x_scale = hypot(matrix->xx, matrix->yx);
+    y_scale = hypot(matrix->xy, matrix->yy);
+    if (x_scale == 0 || y_scale == 0 ||
+        fabs(matrix->xx * matrix->xy + matrix->yx * matrix->yy) >
+        _ADG_DXF_EPSILON * x_scale * y_scale)
+        return FALSE;
+
+    /* The sign of the determinant gives the mirroring */
+    y_scale = (matrix->xx * matrix->yy - matrix->xy * matrix->yx) / x_scale;
+    pair.x = matrix->x0;
+    pair.y = matrix->y0;
+    name = g_strdup_printf("ADG_TRAIL_%u", block);
+
+    _adg_put_entity(dxf, "INSERT", "AcDbBlockReference");
+    _adg_put_string(dxf, 2, name);
+    _adg_put_pair(dxf, 10, &pair, NULL);
+    _adg_put_double(dxf, 41, x_scale);
+    _adg_put_double(dxf, 42, y_scale);
+    _adg_put_double(dxf, 43, 1);
+    _adg_put_angle(dxf, 50, atan2(matrix->yx, matrix->xx));
+
+    g_free(name);
+    return TRUE;
+}
+
+static void
+_adg_write_trail(_AdgDxf *dxf, AdgTrail *trail, const cairo_matrix_t *matrix)
+{
+    cairo_path_t *cairo_path;
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlPair org;
+
+    cairo_path = adg_trail_cairo_path(trail);
+    if (cairo_path == NULL || ! cpml_segment_from_cairo(&segment, cairo_path))
+        return;
+
+    do {
+        cpml_primitive_from_segment(&primitive, &segment);
+        do {
+            switch (primitive.data->header.type) {
+            case CPML_LINE:
+            case CPML_CLOSE:
+                _adg_write_line(dxf, &primitive, matrix);
+                break;
+            case CPML_ARC:
+                _adg_write_arc(dxf, &primitive, matrix);
+                break;
+            case CPML_CURVE:
+                cpml_primitive_put_point(&primitive, 0, &org);
+                _adg_write_spline(dxf, &org, primitive.data, matrix);
+                break;
+            default:
+                break;
+            }
+        } while (cpml_primitive_next(&primitive));
+    } while (cpml_segment_next(&segment));
+}
+
+static void
+_adg_write_line(_AdgDxf *dxf, const CpmlPrimitive *primitive,
+                const cairo_matrix_t *matrix)
+{
+    CpmlPair from, to;
+
+    cpml_primitive_put_point(primitive, 0, &from);
+    cpml_primitive_put_point(primitive, -1, &to);
+
+    _adg_put_entity(dxf, "LINE", "AcDbLine");
+    _adg_put_pair(dxf, 10, &from, matrix);
+    _adg_put_pair(dxf, 11, &to, matrix);
+}
+
+static void
+_adg_write_arc(_AdgDxf *dxf, const CpmlPrimitive *primitive,
+               const cairo_matrix_t *matrix)
+{
+    cairo_path_data_t data[16];
+    CpmlPrimitive arc;
+    CpmlSegment segment;
+    CpmlPair org, center;
+    gdouble r, start, end;
+    gint n;
+
+    if (! _adg_is_similarity(matrix)) {
+        /* The arc becomes an ellipse: approximate it with Bézier curves
+         * in model space, so they can be transformed as they are */
+        segment.path = NULL;
+        segment.data = data;
+        segment.num_data = 0;
+        cpml_arc_to_curves(primitive, &segment, 4);
+
+        if (segment.num_data == 0) {
+            _adg_write_line(dxf, primitive, matrix);
+            return;
+        }
+
+        cpml_primitive_put_point(primitive, 0, &org);
+        for (n = 0; n < segment.num_data; n += 4) {
+            _adg_write_spline(dxf, &org, &data[n], matrix);
+            cpml_pair_from_cairo(&org, &data[n + 3]);
+        }
+        return;
+    }
+
+    /* Transform the three points of the arc and rebuild it, so any
+     * mirroring in matrix is properly taken into account */
+    for (n = 0; n < 3; ++n) {
+        cpml_primitive_put_point(primitive, n, &org);
+        cpml_pair_transform(&org, matrix);
+        cpml_pair_to_cairo(&org, &data[n == 0 ? 0 : n + 1]);
+    }
+    data[1].header.type = CPML_ARC;
+    data[1].header.length = 3;
+
+    arc.segment = NULL;
+    arc.org = &data[0];
+    arc.data = &data[1];
+
+    if (! cpml_arc_info(&arc, &center, &r, &start, &end)) {
+        _adg_write_line(dxf, primitive, matrix);
+        return;
+    }
+
+    /* In DXF the arcs are always counterclockwise, that is with
+     * increasing angles in a y axis pointing up */
+    _adg_put_entity(dxf, "ARC", "AcDbCircle");
+    _adg_put_pair(dxf, 10, &center, NULL);
+    _adg_put_double(dxf, 40, r);
+    _adg_put_string(dxf, 100, "AcDbArc");
+    _adg_put_angle(dxf, 50, MIN(start, end));
+    _adg_put_angle(dxf, 51, MAX(start, end));
+}
+
+static void
+_adg_write_spline(_AdgDxf *dxf, const CpmlPair *org,
+                  const cairo_path_data_t *data, const cairo_matrix_t *matrix)
+{
+    CpmlPair pair;
+    gint n;
+
+    _adg_put_entity(dxf, "SPLINE", "AcDbSpline");
+    _adg_put_int(dxf, 70, 8);
+    _adg_put_int(dxf, 71, 3);
+    _adg_put_int(dxf, 72, 8);
+    _adg_put_int(dxf, 73, 4);
+    _adg_put_int(dxf, 74, 0);
+
+    /* A single Bézier curve is a clamped B-spline of degree 3 */
+    for (n = 0; n < 8; ++n)
+        _adg_put_double(dxf, 40, n < 4 ? 0 : 1);
+
+    _adg_put_pair(dxf, 10, org, matrix);
+    for (n = 1; n <= 3; ++n) {
+        cpml_pair_from_cairo(&pair, &data[n]);
+        _adg_put_pair(dxf, 10, &pair, matrix);
+    }
+}
+
+static void
+_adg_write_ldim(_AdgDxf *dxf, AdgLDim *ldim)
+{
+    AdgDim *dim;
+    cairo_matrix_t matrix;
+    CpmlPair ref1, ref2, pos, base1, base2, middle;
+    CpmlVector extension, baseline;
+    gdouble k, distance;
+
+    dim = (AdgDim *) ldim;
+    if (! _adg_get_pair(adg_dim_get_ref1(dim), &ref1) ||
+        ! _adg_get_pair(adg_dim_get_ref2(dim), &ref2) ||
+        ! _adg_get_pair(adg_dim_get_pos(dim), &pos))
+        return;
+
+    /* Project the reference points on the baseline passing
+     * through pos, as done by AdgLDim itself */
+    cpml_vector_from_angle(&extension, adg_ldim_get_direction(ldim));
+    k = (pos.x - ref1.x) * extension.x + (pos.y - ref1.y) * extension.y;
+    base1.x = ref1.x + k * extension.x;
+    base1.y = ref1.y + k * extension.y;
+    k = (pos.x - ref2.x) * extension.x + (pos.y - ref2.y) * extension.y;
+    base2.x = ref2.x + k * extension.x;
+    base2.y = ref2.y + k * extension.y;
+    middle.x = (base1.x + base2.x) / 2;
+    middle.y = (base1.y + base2.y) / 2;
+    distance = cpml_pair_distance(&base1, &base2);
+
+    _adg_get_matrix((AdgEntity *) dim, &matrix);
+    cpml_pair_copy(&baseline, &extension);
+    cpml_vector_normal(&baseline);
+    cpml_vector_transform(&baseline, &matrix);
+
+    cpml_pair_transform(&base2, &matrix);
+    cpml_pair_transform(&middle, &matrix);
+    _adg_write_dim_header(dxf, dim, 0, &base2, &middle, distance);
+    _adg_put_string(dxf, 100, "AcDbAlignedDimension");
+    _adg_put_pair(dxf, 13, &ref1, &matrix);
+    _adg_put_pair(dxf, 14, &ref2, &matrix);
+    _adg_put_angle(dxf, 50, cpml_vector_angle(&baseline));
+    _adg_put_string(dxf, 100, "AcDbRotatedDimension");
+}
+
+static void
+_adg_write_adim(_AdgDxf *dxf, AdgADim *adim)
+{
+    AdgDim *dim;
+    cairo_matrix_t matrix;
+    CpmlPair org1, ref1, org2, ref2, pos;
+    CpmlVector vector;
+    gdouble angle;
+
+    dim = (AdgDim *) adim;
+    if (! _adg_get_pair(adg_adim_get_org1(adim), &org1) ||
+        ! _adg_get_pair(adg_dim_get_ref1(dim), &ref1) ||
+        ! _adg_get_pair(adg_adim_get_org2(adim), &org2) ||
+        ! _adg_get_pair(adg_dim_get_ref2(dim), &ref2) ||
+        ! _adg_get_pair(adg_dim_get_pos(dim), &pos))
+        return;
+
+    /* The measure is in degrees, as in the quote of AdgADim */
+    vector.x = ref2.x - org2.x;
+    vector.y = ref2.y - org2.y;
+    angle = cpml_vector_angle(&vector);
+    vector.x = ref1.x - org1.x;
+    vector.y = ref1.y - org1.y;
+    angle -= cpml_vector_angle(&vector);
+    if (angle < 0)
+        angle += G_PI * 2;
+
+    _adg_get_matrix((AdgEntity *) dim, &matrix);
+    cpml_pair_transform(&ref2, &matrix);
+    cpml_pair_transform(&pos, &matrix);
+    _adg_write_dim_header(dxf, dim, 2, &ref2, &pos, angle * 180 / G_PI);
+    _adg_put_string(dxf, 100, "AcDb2LineAngularDimension");
+    _adg_put_pair(dxf, 13, &org1, &matrix);
+    _adg_put_pair(dxf, 14, &ref1, &matrix);
+    _adg_put_pair(dxf, 15, &org2, &matrix);
+    _adg_put_pair(dxf, 16, &pos, NULL);
+}
+
+static void
+_adg_write_rdim(_AdgDxf *dxf, AdgRDim *rdim)
+{
+    AdgDim *dim;
+    cairo_matrix_t matrix;
+    CpmlPair center, point, pos;
+    gdouble radius;
+
+    dim = (AdgDim *) rdim;
+    if (! _adg_get_pair(adg_dim_get_ref1(dim), &center) ||
+        ! _adg_get_pair(adg_dim_get_ref2(dim), &point) ||
+        ! _adg_get_pair(adg_dim_get_pos(dim), &pos))
+        return;
+
+    radius = cpml_pair_distance(&center, &point);
+
+    _adg_get_matrix((AdgEntity *) dim, &matrix);
+    cpml_pair_transform(&center, &matrix);
+    cpml_pair_transform(&pos, &matrix);
+    _adg_write_dim_header(dxf, dim, 4, &center, &pos, radius);
+    _adg_put_string(dxf, 100, "AcDbRadialDimension");
+    _adg_put_pair(dxf, 15, &point, &matrix);
+    _adg_put_double(dxf, 40, 0);
+}
+
+static void
+_adg_write_dim_header(_AdgDxf *dxf, AdgDim *dim, gint type,
+                      const CpmlPair *def, const CpmlPair *text,
+                      gdouble measure)
+{
+    gchar *quote, *block;
+
+    quote = adg_dim_get_text(dim, measure);
+    block = g_strdup_printf("*D%u", ++dxf->dim);
+
+    /* 32 marks the block as referenced by this dimension only */
+    _adg_put_entity(dxf, "DIMENSION", "AcDbDimension");
+    _adg_put_string(dxf, 2, block);
+    _adg_put_pair(dxf, 10, def, NULL);
+    _adg_put_pair(dxf, 11, text, NULL);
+    _adg_put_int(dxf, 70, type | 32);
+    _adg_put_string(dxf, 1, quote != NULL ? quote : "");
+    _adg_put_double(dxf, 42, measure);
+    _adg_put_string(dxf, 3, "Standard");
+
+    g_free(block);
+    g_free(quote);
+}
+
+static gboolean
+_adg_get_pair(AdgPoint *point, CpmlPair *pair)
+{
+    if (point == NULL || ! adg_point_update(point))
+        return FALSE;
+
+    /* The pair is the first field of an AdgPoint */
+    cpml_pair_copy(pair, (CpmlPair *) point);
+    return TRUE;
+}
+
+static void
+_adg_get_matrix(AdgEntity *entity, cairo_matrix_t *matrix)
+{
+    cairo_matrix_multiply(matrix, adg_entity_get_local_matrix(entity),
+                          adg_entity_get_global_matrix(entity));
+    cairo_matrix_multiply(matrix, matrix, &_adg_flip);
+}
+
+static gboolean
+_adg_is_similarity(const cairo_matrix_t *matrix)
+{
+    gdouble x_length, y_length;
+
+    x_length = matrix->xx * matrix->xx + matrix->yx * matrix->yx;
+    y_length = matrix->xy * matrix->xy + matrix->yy * matrix->yy;
+
+    return fabs(x_length - y_length) <= _ADG_DXF_EPSILON * x_length &&
+           fabs(matrix->xx * matrix->xy + matrix->yx * matrix->yy) <=
+           _ADG_DXF_EPSILON * x_length;
+}
+
+static void
+_adg_put_entity(_AdgDxf *dxf, const gchar *type, const gchar *subclass)
+{
+    _adg_put_string(dxf, 0, type);
+    _adg_put_handle(dxf);
+    _adg_put_string(dxf, 100, "AcDbEntity");
+    _adg_put_string(dxf, 8, "0");
+    _adg_put_string(dxf, 100, subclass);
+}
+
+static guint
+_adg_put_handle(_AdgDxf *dxf)
+{
+    ++dxf->handle;
+    _adg_put_hex(dxf, 5, dxf->handle);
+
+    return dxf->handle;
+}
+
+static void
+_adg_put_hex(_AdgDxf *dxf, gint code, guint value)
+{
+    fprintf(dxf->file, "%3d\n%X\n", code, value);
+}
+
+static void
+_adg_put_string(_AdgDxf *dxf, gint code, const gchar *string)
+{
+    fprintf(dxf->file, "%3d\n%s\n", code, string);
+}
+
+static void
+_adg_put_int(_AdgDxf *dxf, gint code, gint value)
+{
+    fprintf(dxf->file, "%3d\n%6d\n", code, value);
+}
+
+static void
+_adg_put_double(_AdgDxf *dxf, gint code, gdouble value)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* Do not depend on the decimal separator of the locale */
+    g_ascii_formatd(buffer, sizeof(buffer), "%.12g", value);
+    _adg_put_string(dxf, code, buffer);
+}
+
+static void
+_adg_put_angle(_AdgDxf *dxf, gint code, gdouble angle)
+{
+    gdouble degrees = fmod(angle * 180 / G_PI, 360);
+
+    if (degrees < 0)
+        degrees += 360;
+
+    _adg_put_double(dxf, code, degrees);
+}
+
+static void
+_adg_put_pair(_AdgDxf *dxf, gint code, const CpmlPair *pair,
+              const cairo_matrix_t *matrix)
+{
+    CpmlPair transformed;
+
+    cpml_pair_copy(&transformed, pair);
+    if (matrix != NULL)
+        cpml_pair_transform(&transformed, matrix);
+
+    _adg_put_double(dxf, code, transformed.x);
+    _adg_put_double(dxf, code + 10, transformed.y);
+    _adg_put_double(dxf, code + 20, 0);
+}
@@ -452,7 +452,10 @@ _adg_get_cairo_path(AdgTrail *trail)
         vertices = _adg_optimize_vertices(vertices);
         data->cairo.array = _adg_path_build(vertices);
 
-        g_slist_foreach(vertices, (GFunc) g_free, NULL);
+        /* Release the vertices in reverse order, so the scratch
+         * memory can be rewound */
+        vertices = g_slist_reverse(vertices);
+        g_slist_foreach(vertices, (GFunc) cpml_scratch_free, NULL);
         g_slist_free(vertices);
 
         /* Reapply the inverse of the previous transformation to
@@ -510,7 +513,7 @@ _adg_get_vertices(GSList *vertices, CpmlSegment *segment, gdouble threshold)
 {
     CpmlPrimitive primitive;
     CpmlVector old, new;
-    CpmlPair pair;
+    CpmlPair *vertex;
 
     cpml_primitive_from_segment(&primitive, segment);
     /* The first vector starts undefined, so it will always be
@@ -528,8 +531,9 @@ _adg_get_vertices(GSList *vertices, CpmlSegment *segment, gdouble threshold)
          * the edge detection */
         if (new.x == 0 ||
             cpml_pair_squared_distance(&old, &new) > threshold) {
-            cpml_primitive_put_pair_at(&primitive, 0, &pair);
-            vertices = g_slist_append(vertices, cpml_pair_dup(&pair));
+            vertex = cpml_scratch_alloc(sizeof(CpmlPair));
+            cpml_primitive_put_pair_at(&primitive, 0, vertex);
+            vertices = g_slist_append(vertices, vertex);
         }
 
         cpml_primitive_put_vector_at(&primitive, 1, &old);
@@ -562,11 +566,11 @@ _adg_optimize_vertices(GSList *vertices)
 
         if (old_pair->y < pair->y) {
             /* Preserve the old vertex and remove the current one */
-            g_free(pair);
+            cpml_scratch_free(pair);
             vertices = g_slist_delete_link(vertices, vertex);
         } else {
             /* Preserve the current vertex and remove the old one */
-            g_free(old_pair);
+            cpml_scratch_free(old_pair);
             vertices = g_slist_delete_link(vertices, old_vertex);
             old_vertex = vertex;
         }
@@ -34,17 +34,31 @@ struct _AdgEntityPrivate {
     AdgMix               local_mix;
     GHashTable          *hash_styles;
 
+    struct {
+        guint            generation;
+        GHashTable      *resolved;
+        GList           *children;
+        GList           *link;
+    }                    styles;
+
     struct {
         gboolean         is_defined;
+        guint            generation;
         cairo_matrix_t   matrix;
     }                    global;
 
     struct {
         gboolean         is_defined;
+        guint            generation;
         cairo_matrix_t   matrix;
     }                    local;
 
     CpmlExtents          extents;
+
+    struct {
+        gboolean         is_defined;
+        guint8           digest[32];
+    }                    content;
 };
 
 G_END_DECLS
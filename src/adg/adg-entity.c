@@ -58,11 +58,22 @@
  * @invalidate:     invalidating callback, used to clear the internal cache
  * @arrange:        prepare the layout and fill the extents struct
  * @render:         rendering callback, it must be implemented by every entity
+ * @lod_dress:      the dress used to render the dot or the placeholder
+ *                  of the level of detail
+ * @batchable:      whether the entity draws only through
+ *                  adg_entity_stroke_path() and adg_entity_render(),
+ *                  so its strokes can be batched with the others
+ * @lod_policy:     how the entity is rendered when the level of detail
+ *                  is enabled
  *
  * Any entity (if not abstract) must implement at least the @render method.
  * The other signal handlers can be overriden to provide custom behaviors
  * and usually must chain up the original handler.
  *
+ * @batchable is inherited by the derived classes: a subclass drawing
+ * directly on the cairo context must reset it to %FALSE. The same
+ * applies to @lod_policy, that defaults to %ADG_LOD_POLICY_SKIP.
+ *
  * Since: 1.0
  **/
 
@@ -90,11 +101,14 @@
 #include <adg-canvas.h>
 #include "adg-dress.h"
 #include "adg-style.h"
+#include "adg-line-style.h"
 #include "adg-model.h"
+#include "adg-trail.h"
 #include "adg-point.h"
 #include "adg-cairo-fallback.h"
 
 #include "adg-entity-private.h"
+#include "adg-profile-private.h"
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_entity_parent_class)
@@ -122,8 +136,38 @@ enum {
     LAST_SIGNAL
 };
 
+/* How an entity is rendered when the level of detail is enabled */
+typedef enum {
+    _ADG_LOD_FULL,
+    _ADG_LOD_SKIP,
+    _ADG_LOD_PLACEHOLDER,
+    _ADG_LOD_DOT
+} _AdgLod;
+
+/* Strokes sharing the same style and user space, deferred
+ * in a batch to be rendered with a single cairo_stroke().
+ * The color style is resolved per entity by the line style,
+ * so it is part of the group key too */
+typedef struct {
+    AdgStyle           *style;
+    AdgStyle           *color_style;
+    cairo_matrix_t      matrix;
+    CpmlExtents         extents;
+    gboolean            is_bounded;
+    GArray             *items;
+} _AdgBatchGroup;
+
+typedef struct {
+    AdgEntity          *entity;
+    const cairo_path_t *path;
+    cairo_path_t       *owned_path;
+    cairo_matrix_t      matrix;
+} _AdgBatchItem;
+
 
 static void             _adg_dispose            (GObject         *object);
+static void             _adg_notify             (GObject         *object,
+                                                 GParamSpec      *pspec);
 static void             _adg_get_property       (GObject         *object,
                                                  guint            prop_id,
                                                  GValue          *value,
@@ -133,16 +177,55 @@ static void             _adg_set_property       (GObject         *object,
                                                  const GValue    *value,
                                                  GParamSpec      *pspec);
 static void             _adg_destroy            (AdgEntity       *entity);
+static void             _adg_overrides_changed  (AdgEntity       *entity);
 static void             _adg_set_parent         (AdgEntity       *entity,
                                                  AdgEntity       *parent);
 static void             _adg_global_changed     (AdgEntity       *entity);
 static void             _adg_local_changed      (AdgEntity       *entity);
+static void             _adg_global_compose     (AdgEntity       *entity,
+                                                 cairo_matrix_t  *matrix);
+static void             _adg_local_compose      (AdgEntity       *entity,
+                                                 cairo_matrix_t  *matrix);
+static void             _adg_global_update      (AdgEntity       *entity);
+static void             _adg_local_update       (AdgEntity       *entity);
 static void             _adg_real_invalidate    (AdgEntity       *entity);
 static void             _adg_real_arrange       (AdgEntity       *entity);
 static void             _adg_real_render        (AdgEntity       *entity,
                                                  cairo_t         *cr);
+static _AdgLod          _adg_lod_level          (AdgEntity       *entity,
+                                                 cairo_t         *cr,
+                                                 gdouble          threshold,
+                                                 CpmlExtents     *device);
+static void             _adg_lod_render         (AdgEntity       *entity,
+                                                 _AdgLod          lod,
+                                                 const CpmlExtents *device,
+                                                 cairo_t         *cr);
+static void             _adg_stroke_path        (AdgEntity       *entity,
+                                                 AdgDress         dress,
+                                                 const cairo_path_t *path,
+                                                 const cairo_matrix_t *matrix,
+                                                 cairo_path_t    *owned_path,
+                                                 cairo_t         *cr);
+static gboolean         _adg_is_batchable       (AdgEntity       *entity);
+static void             _adg_batch_add          (GArray          *batch,
+                                                 AdgEntity       *entity,
+                                                 AdgStyle        *style,
+                                                 const cairo_path_t *path,
+                                                 const cairo_matrix_t *matrix,
+                                                 cairo_path_t    *owned_path,
+                                                 cairo_t         *cr);
+static void             _adg_batch_flush        (GArray          *batch,
+                                                 cairo_t         *cr);
+static gboolean         _adg_extents_overlap    (const CpmlExtents *extents1,
+                                                 const CpmlExtents *extents2);
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
 static gboolean         _adg_show_extents = FALSE;
+static guint            _adg_style_generation = 1;
+static gboolean         _adg_lazy_matrices = FALSE;
+static guint            _adg_matrix_generation = 1;
+static gboolean         _adg_batching = FALSE;
+static cairo_user_data_key_t _adg_batch_key;
+static cairo_user_data_key_t _adg_lod_key;
 
 
 static void
@@ -158,6 +241,7 @@ adg_entity_class_init(AdgEntityClass *klass)
     gobject_class->dispose = _adg_dispose;
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
+    gobject_class->notify = _adg_notify;
 
     klass->destroy = _adg_destroy;
     klass->parent_set = NULL;
@@ -166,6 +250,11 @@ adg_entity_class_init(AdgEntityClass *klass)
     klass->invalidate = NULL;
     klass->arrange= NULL;
     klass->render = NULL;
+    klass->lod_dress = NULL;
+    klass->batchable = FALSE;
+    klass->lod_policy = ADG_LOD_POLICY_SKIP;
+
+    _adg_profile_init();
 
     param = g_param_spec_boolean("floating",
                                  P_("Floating Entity"),
@@ -354,11 +443,16 @@ adg_entity_init(AdgEntity *entity)
     cairo_matrix_init_identity(&data->local_map);
     data->local_mix = ADG_MIX_ANCESTORS;
     data->hash_styles = NULL;
+    data->styles.generation = 0;
+    data->styles.resolved = NULL;
+    data->styles.children = NULL;
+    data->styles.link = NULL;
     data->global.is_defined = FALSE;
     adg_matrix_copy(&data->global.matrix, adg_matrix_null());
     data->local.is_defined = FALSE;
     adg_matrix_copy(&data->local.matrix, adg_matrix_null());
     data->extents.is_defined = FALSE;
+    data->content.is_defined = FALSE;
 }
 
 static void
@@ -366,14 +460,30 @@ _adg_dispose(GObject *object)
 {
     AdgEntity *entity = (AdgEntity *) object;
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    AdgEntityPrivate *child_data;
+    GList *node;
 
     /* This call will emit a "notify" signal for parent.
      * Consequentially, the references to the old parent is dropped. */
     adg_entity_set_parent(entity, NULL);
 
+    /* Children still bound to this entity must not refer to its list */
+    for (node = data->styles.children; node != NULL; node = node->next) {
+        child_data = adg_entity_get_instance_private(node->data);
+        child_data->styles.link = NULL;
+    }
+    g_list_free(data->styles.children);
+    data->styles.children = NULL;
+
     if (data->hash_styles != NULL) {
         g_hash_table_destroy(data->hash_styles);
         data->hash_styles = NULL;
+        _adg_overrides_changed(entity);
+    }
+
+    if (data->styles.resolved != NULL) {
+        g_hash_table_destroy(data->styles.resolved);
+        data->styles.resolved = NULL;
     }
 
     if (_ADG_OLD_OBJECT_CLASS->dispose)
@@ -426,14 +536,17 @@ _adg_set_property(GObject *object, guint prop_id,
     case PROP_GLOBAL_MAP:
         adg_matrix_copy(&data->global_map, g_value_get_boxed(value));
         data->global.is_defined = FALSE;
+        ++_adg_matrix_generation;
         break;
     case PROP_LOCAL_MAP:
         adg_matrix_copy(&data->local_map, g_value_get_boxed(value));
         data->local.is_defined = FALSE;
+        ++_adg_matrix_generation;
         break;
     case PROP_LOCAL_MIX:
         data->local_mix = g_value_get_enum(value);
         data->local.is_defined = FALSE;
+        ++_adg_matrix_generation;
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -441,6 +554,15 @@ _adg_set_property(GObject *object, guint prop_id,
     }
 }
 
+static void
+_adg_notify(GObject *object, GParamSpec *pspec)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private((AdgEntity *) object);
+
+    /* Any property could be part of the content hash */
+    data->content.is_defined = FALSE;
+}
+
 
 /**
  * adg_switch_extents:
@@ -458,6 +580,140 @@ adg_switch_extents(gboolean state)
     _adg_show_extents = state;
 }
 
+/**
+ * adg_switch_lazy_matrices:
+ * @state: new lazy matrices state
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * lazy computation of the global and local matrices.
+ *
+ * By default, changing a map emits the #AdgEntity::global-changed or
+ * #AdgEntity::local-changed signal on the whole hierarchy below the
+ * modified entity during the next arrange() phase. In lazy mode
+ * changing a map is a constant time operation: the matrices are
+ * composed on demand by adg_entity_get_global_matrix() and
+ * adg_entity_get_local_matrix() and the signals are emitted, in the
+ * arrange() phase, only on the entities whose matrices have really
+ * changed.
+ *
+ * This should be set before building the drawing: switching mode
+ * on an already arranged hierarchy is not supported.
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_lazy_matrices(gboolean state)
+{
+    _adg_lazy_matrices = state;
+    ++_adg_matrix_generation;
+}
+
+gboolean
+_adg_entity_lazy_matrices(void)
+{
+    return _adg_lazy_matrices;
+}
+
+guint
+_adg_entity_render_switches(void)
+{
+    return (_adg_show_extents ? 1 : 0) | (_adg_batching ? 2 : 0);
+}
+
+/**
+ * adg_switch_batching:
+ * @state: new batching state
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * batching of the strokes in the rendering phase.
+ *
+ * When enabled, the strokes requested with adg_entity_stroke_path()
+ * are not rendered immediately but collected and grouped by style:
+ * every group is then rendered with a single style application and
+ * a single cairo_stroke() call. A stroke can be moved before other
+ * pending strokes only if it does not overlap them, so the z-order
+ * is preserved. Any entity drawing directly on the cairo context
+ * flushes the pending strokes before rendering.
+ *
+ * This reduces the cairo state changes and the size of the vector
+ * output (e.g. PDF and SVG) when many entities share the same style.
+ * The only visible difference can be on translucent strokes, where
+ * the overlapping parts of the same group are painted only once.
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_batching(gboolean state)
+{
+    _adg_batching = state;
+}
+
+/**
+ * adg_set_lod_threshold:
+ * @cr: a cairo context
+ * @threshold: the new threshold, in device units
+ *
+ * Sets the level of detail threshold used when rendering on @cr.
+ * A @threshold of 0 (the default) disables the level of detail.
+ * The threshold is bound to @cr, so other renderings (e.g. the
+ * exports performed by adg_canvas_export()) keep the full detail.
+ *
+ * The size of every entity is computed by transforming its extents
+ * with the matrix of the cairo context and compared with @threshold
+ * as specified by the #AdgLodPolicy of its class. With the policies
+ * of the ADG classes, when this size is below @threshold the texts
+ * are rendered as a translucent placeholder box while the markers
+ * and the hatches are skipped. Texts thinner than one device unit
+ * are skipped too and strokes smaller than one device unit are
+ * collapsed into a single dot.
+ *
+ * This is mainly useful on overviews of dense drawings, where most
+ * of these details are not perceivable anyway: zooming in restores
+ * the full detail. #AdgGtkArea sets its #AdgGtkArea:lod-threshold
+ * on the contexts it renders on.
+ *
+ * Since: 1.0
+ **/
+void
+adg_set_lod_threshold(cairo_t *cr, gdouble threshold)
+{
+    gdouble *p_threshold;
+
+    g_return_if_fail(cr != NULL);
+    g_return_if_fail(threshold >= 0);
+
+    if (threshold == 0) {
+        cairo_set_user_data(cr, &_adg_lod_key, NULL, NULL);
+        return;
+    }
+
+    p_threshold = g_new(gdouble, 1);
+    *p_threshold = threshold;
+    cairo_set_user_data(cr, &_adg_lod_key, p_threshold, g_free);
+}
+
+/**
+ * adg_get_lod_threshold:
+ * @cr: a cairo context
+ *
+ * Gets the level of detail threshold set on @cr by
+ * adg_set_lod_threshold().
+ *
+ * Returns: the current threshold, in device units, or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+gdouble
+adg_get_lod_threshold(cairo_t *cr)
+{
+    gdouble *p_threshold;
+
+    g_return_val_if_fail(cr != NULL, 0);
+
+    p_threshold = cairo_get_user_data(cr, &_adg_lod_key);
+    return p_threshold == NULL ? 0 : *p_threshold;
+}
+
 /**
  * adg_entity_destroy:
  * @entity: an #AdgEntity
@@ -690,7 +946,9 @@ adg_entity_get_global_map(AdgEntity *entity)
  *
  * The global matrix is computed in the arrange() phase by
  * combining all the global maps of the @entity hierarchy using
- * the %ADG_MIX_ANCESTORS method.
+ * the %ADG_MIX_ANCESTORS method. When adg_switch_lazy_matrices()
+ * is enabled, it is composed on demand whenever a map in the
+ * hierarchy has been changed.
  *
  * Returns: the global matrix or <constant>NULL</constant> on errors.
  *
@@ -704,6 +962,9 @@ adg_entity_get_global_matrix(AdgEntity *entity)
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
     data = adg_entity_get_instance_private(entity);
+    if (_adg_lazy_matrices)
+        _adg_global_update(entity);
+
     return &data->global.matrix;
 }
 
@@ -794,6 +1055,8 @@ adg_entity_get_local_map(AdgEntity *entity)
  * The local matrix is computed in the arrange() phase by
  * combining all the local maps of the @entity hierarchy using
  * the method specified by the #AdgEntity:local-mix property.
+ * When adg_switch_lazy_matrices() is enabled, it is composed on
+ * demand whenever a map in the hierarchy has been changed.
  *
  * Returns: the local matrix or <constant>NULL</constant> on errors.
  *
@@ -807,6 +1070,9 @@ adg_entity_get_local_matrix(AdgEntity *entity)
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
     data = adg_entity_get_instance_private(entity);
+    if (_adg_lazy_matrices)
+        _adg_local_update(entity);
+
     return &data->local.matrix;
 }
 
@@ -958,6 +1224,7 @@ adg_entity_set_style(AdgEntity *entity, AdgDress dress, AdgStyle *style)
 
     if (style == NULL) {
         g_hash_table_remove(data->hash_styles, p_dress);
+        _adg_overrides_changed(entity);
         return;
     }
 
@@ -973,6 +1240,7 @@ adg_entity_set_style(AdgEntity *entity, AdgDress dress, AdgStyle *style)
 
     g_object_ref(style);
     g_hash_table_replace(data->hash_styles, p_dress, style);
+    _adg_overrides_changed(entity);
 }
 
 /**
@@ -1023,6 +1291,13 @@ adg_entity_get_style(AdgEntity *entity, AdgDress dress)
  * <listitem>returns the main style with adg_dress_get_fallback().</listitem>
  * </orderedlist>
  *
+ * The result is cached by @entity, so the above checks are
+ * performed only once per dress. The cache is cleared whenever
+ * a style of @entity or of one of its ancestors is overriden,
+ * whenever any of them changes its parent and whenever a
+ * fallback style is modified. Changes outside the chain of
+ * ancestors of @entity do not clear its cache.
+ *
  * The returned object is owned by @entity and should not be
  * freed or modified.
  *
@@ -1033,21 +1308,40 @@ adg_entity_get_style(AdgEntity *entity, AdgDress dress)
 AdgStyle *
 adg_entity_style(AdgEntity *entity, AdgDress dress)
 {
+    AdgEntityPrivate *data;
+    gpointer p_dress, cached;
     AdgStyle *style;
 
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
+    data = adg_entity_get_instance_private(entity);
+    p_dress = GINT_TO_POINTER(dress);
+
+    if (data->styles.generation != _adg_style_generation) {
+        /* Something changed since the last resolution */
+        if (data->styles.resolved != NULL)
+            g_hash_table_remove_all(data->styles.resolved);
+        data->styles.generation = _adg_style_generation;
+    } else if (data->styles.resolved != NULL &&
+               g_hash_table_lookup_extended(data->styles.resolved, p_dress,
+                                            NULL, &cached)) {
+        return cached;
+    }
+
     style = adg_entity_get_style(entity, dress);
 
     if (style == NULL) {
-        AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
-
         if (data->parent != NULL)
             style = adg_entity_style(data->parent, dress);
         else
             style = adg_dress_get_fallback(dress);
     }
 
+    if (data->styles.resolved == NULL)
+        data->styles.resolved = g_hash_table_new(NULL, NULL);
+
+    g_hash_table_insert(data->styles.resolved, p_dress, style);
+
     return style;
 }
 
@@ -1076,6 +1370,72 @@ adg_entity_apply_dress(AdgEntity *entity, AdgDress dress, cairo_t *cr)
         adg_style_apply(style, entity, cr);
 }
 
+/**
+ * adg_entity_stroke_path:
+ * @entity: an #AdgEntity
+ * @dress: the dress style to apply
+ * @path: the #cairo_path_t to stroke
+ * @matrix: (allow-none): the transformation to apply to @path
+ * @cr: a #cairo_t drawing context
+ *
+ * <note><para>
+ * This function is only useful in entity implementations.
+ * </para></note>
+ *
+ * Strokes @path with the @dress style. @path is transformed by @matrix,
+ * if not %NULL, while the style is applied in the current user space
+ * of @cr. The stroking entities usually pass their local matrix, so
+ * the line width is not affected by the local map.
+ *
+ * When batching is enabled with adg_switch_batching() and a rendering
+ * is in progress, the stroke is deferred so it can be merged with the
+ * other strokes using the same line style and resolving the same color
+ * style. In this case @path must be kept valid until the end of the
+ * rendering. Strokes with a style that is not an #AdgLineStyle are
+ * never deferred: the pending strokes are rendered first, to keep
+ * the drawing order. For the same reason the pending strokes are
+ * rendered before any entity whose class does not set
+ * #AdgEntityClass.batchable.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_stroke_path(AdgEntity *entity, AdgDress dress,
+                       const cairo_path_t *path,
+                       const cairo_matrix_t *matrix, cairo_t *cr)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+    g_return_if_fail(path != NULL);
+    g_return_if_fail(cr != NULL);
+
+    _adg_stroke_path(entity, dress, path, matrix, NULL, cr);
+}
+
+void
+_adg_entity_stroke_owned_path(AdgEntity *entity, AdgDress dress,
+                              cairo_path_t *path, cairo_t *cr)
+{
+    _adg_stroke_path(entity, dress, path, NULL, path, cr);
+}
+
+void
+_adg_entity_flush_strokes(cairo_t *cr)
+{
+    GArray *batch;
+    cairo_path_t *path;
+
+    batch = cairo_get_user_data(cr, &_adg_batch_key);
+    if (batch == NULL || batch->len == 0)
+        return;
+
+    /* Stroking the batch would consume the current path too */
+    path = cairo_copy_path(cr);
+    cairo_new_path(cr);
+    _adg_batch_flush(batch, cr);
+    cairo_append_path(cr, path);
+    cairo_path_destroy(path);
+}
+
 /**
  * adg_entity_global_changed:
  * @entity: an #AdgEntity
@@ -1137,6 +1497,9 @@ adg_entity_invalidate(AdgEntity *entity)
  * if any. The arrange call is implicitely called by the
  * #AdgEntity::render signal but not by adg_entity_get_extents().
  *
+ * The temporary memory used while arranging is given back to the
+ * scratch memory (see cpml_scratch_reset()) before returning.
+ *
  * Since: 1.0
  **/
 void
@@ -1145,6 +1508,10 @@ adg_entity_arrange(AdgEntity *entity)
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
     g_signal_emit(entity, _adg_signals[ARRANGE], 0);
+
+    /* Safe also in nested calls: nothing is reclaimed while
+     * the outer calls still hold some scratch chunk */
+    cpml_scratch_reset();
 }
 
 /**
@@ -1163,6 +1530,55 @@ adg_entity_render(AdgEntity *entity, cairo_t *cr)
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
     g_signal_emit(entity, _adg_signals[RENDER], 0, cr);
+    cpml_scratch_reset();
+}
+
+/**
+ * adg_entity_dup_hash:
+ * @entity: an #AdgEntity
+ *
+ * Computes a SHA-256 hash of what @entity (and its children, if any)
+ * will render: the path data and the named pairs of the referenced
+ * models, the resolved styles, the texts, the matrices, the extents
+ * and any other property of the entities. Two drawings with the same
+ * hash render the same output, so the hash can be used to detect
+ * unchanged drawings without rendering them.
+ *
+ * The hash is meaningful only on an arranged entity. It is computed
+ * incrementally: the digest of the own content of every entity is
+ * cached and cleared when the entity is invalidated or any of its
+ * properties changes, so only the invalidated entities are hashed
+ * again. The styles are not cached, as they can be changed without
+ * invalidating the entities using them.
+ *
+ * The hash is stable across different runs of the same program, but
+ * it is not guaranteed to be stable across different versions of ADG.
+ *
+ * Some content cannot be hashed without rendering it, e.g. a fill
+ * style using a pattern on a surface other than an image surface.
+ * In that case no hash is returned, so the drawing is never
+ * confused with a different one.
+ *
+ * Returns: (transfer full) (nullable): a newly allocated string with the hexadecimal hash or <constant>NULL</constant> if @entity cannot be hashed: free with g_free() when no longer needed.
+ *
+ * Since: 1.0
+ **/
+gchar *
+adg_entity_dup_hash(AdgEntity *entity)
+{
+    GChecksum *checksum;
+    gchar *hash;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    if (_adg_hash_entity(entity, checksum))
+        hash = g_strdup(g_checksum_get_string(checksum));
+    else
+        hash = NULL;
+    g_checksum_free(checksum);
+
+    return hash;
 }
 
 /**
@@ -1218,6 +1634,12 @@ adg_entity_point(AdgEntity *entity, AdgPoint *old_point, const AdgPoint *new_poi
                 adg_model_remove_dependency(old_model, entity);
         }
 
+        /* Track the named pairs used by @entity */
+        if (new_model != NULL)
+            _adg_model_bind_pair(new_model, adg_point_get_name(new_point), entity);
+        if (old_model != NULL)
+            _adg_model_unbind_pair(old_model, adg_point_get_name(old_point), entity);
+
         if (new_point != NULL)
             point = adg_point_dup(new_point);
         if (old_point != NULL)
@@ -1228,6 +1650,53 @@ adg_entity_point(AdgEntity *entity, AdgPoint *old_point, const AdgPoint *new_poi
 }
 
 
+void
+_adg_entity_styles_changed(void)
+{
+    ++_adg_style_generation;
+
+    /* Skip the value reserved to stale entities on wrap around */
+    if (_adg_style_generation == 0)
+        ++_adg_style_generation;
+}
+
+gboolean
+_adg_entity_hash_content(AdgEntity *entity, GChecksum *checksum)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    GChecksum *content;
+    gboolean is_hashable;
+    gsize len;
+
+    if (! data->content.is_defined) {
+        content = g_checksum_new(G_CHECKSUM_SHA256);
+        is_hashable = _adg_hash_content(entity, content);
+        len = sizeof(data->content.digest);
+        g_checksum_get_digest(content, data->content.digest, &len);
+        g_checksum_free(content);
+
+        /* The content of an entity not yet arranged is
+         * incomplete, so it cannot be cached */
+        data->content.is_defined = is_hashable && data->extents.is_defined;
+    } else {
+        is_hashable = TRUE;
+    }
+
+    g_checksum_update(checksum, data->content.digest,
+                      sizeof(data->content.digest));
+
+    return is_hashable;
+}
+
+void
+_adg_entity_foreach_style(AdgEntity *entity, GHFunc callback, gpointer user_data)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+
+    if (data->hash_styles != NULL)
+        g_hash_table_foreach(data->hash_styles, callback, user_data);
+}
+
 static void
 _adg_destroy(AdgEntity *entity)
 {
@@ -1242,20 +1711,80 @@ _adg_set_parent(AdgEntity *entity, AdgEntity *parent)
 {
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
     AdgEntity *old_parent = data->parent;
+    AdgEntityPrivate *parent_data;
+
+    /* Keep track of the children, so a change in the styles can
+     * be propagated down without knowing the entity types */
+    if (data->styles.link != NULL) {
+        parent_data = adg_entity_get_instance_private(old_parent);
+        parent_data->styles.children =
+            g_list_delete_link(parent_data->styles.children,
+                               data->styles.link);
+        data->styles.link = NULL;
+    }
+
+    if (parent != NULL) {
+        parent_data = adg_entity_get_instance_private(parent);
+        parent_data->styles.children =
+            g_list_prepend(parent_data->styles.children, entity);
+        data->styles.link = parent_data->styles.children;
+    }
 
     data->parent = parent;
     data->global.is_defined = FALSE;
     data->local.is_defined = FALSE;
+    ++_adg_matrix_generation;
+    _adg_overrides_changed(entity);
 
     g_signal_emit(entity, _adg_signals[PARENT_SET], 0, old_parent);
 }
 
+/* Marks the styles resolved by @entity and by its descendants as
+ * stale, so adg_entity_style() needs to check only its own entity.
+ * Generation 0 is never issued by _adg_entity_styles_changed() */
+static void
+_adg_overrides_changed(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    GList *node;
+
+    data->styles.generation = 0;
+
+    for (node = data->styles.children; node != NULL; node = node->next)
+        _adg_overrides_changed(node->data);
+}
+
 static void
 _adg_global_changed(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+
+    if (_adg_lazy_matrices) {
+        _adg_global_update(entity);
+        data->global.is_defined = TRUE;
+    } else {
+        _adg_global_compose(entity, &data->global.matrix);
+    }
+}
+
+static void
+_adg_local_changed(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+
+    if (_adg_lazy_matrices) {
+        _adg_local_update(entity);
+        data->local.is_defined = TRUE;
+    } else {
+        _adg_local_compose(entity, &data->local.matrix);
+    }
+}
+
+static void
+_adg_global_compose(AdgEntity *entity, cairo_matrix_t *matrix)
 {
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
     const cairo_matrix_t *map = &data->global_map;
-    cairo_matrix_t *matrix = &data->global.matrix;
 
     if (data->parent) {
         adg_matrix_copy(matrix, adg_entity_get_global_matrix(data->parent));
@@ -1266,11 +1795,10 @@ _adg_global_changed(AdgEntity *entity)
 }
 
 static void
-_adg_local_changed(AdgEntity *entity)
+_adg_local_compose(AdgEntity *entity, cairo_matrix_t *matrix)
 {
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
     const cairo_matrix_t *map = &data->local_map;
-    cairo_matrix_t *matrix = &data->local.matrix;
 
     switch (data->local_mix) {
     case ADG_MIX_DISABLED:
@@ -1323,6 +1851,45 @@ _adg_local_changed(AdgEntity *entity)
     }
 }
 
+static void
+_adg_global_update(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    cairo_matrix_t matrix;
+
+    if (data->global.generation == _adg_matrix_generation)
+        return;
+
+    data->global.generation = _adg_matrix_generation;
+    _adg_global_compose(entity, &matrix);
+
+    /* Flag the matrix as changed, so the next arrange() will emit
+     * the "global-changed" signal on this entity only */
+    if (! adg_matrix_equal(&matrix, &data->global.matrix)) {
+        adg_matrix_copy(&data->global.matrix, &matrix);
+        data->global.is_defined = FALSE;
+    }
+}
+
+static void
+_adg_local_update(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    cairo_matrix_t matrix;
+
+    if (data->local.generation == _adg_matrix_generation)
+        return;
+
+    data->local.generation = _adg_matrix_generation;
+    adg_matrix_copy(&matrix, &data->local.matrix);
+    _adg_local_compose(entity, &matrix);
+
+    if (! adg_matrix_equal(&matrix, &data->local.matrix)) {
+        adg_matrix_copy(&data->local.matrix, &matrix);
+        data->local.is_defined = FALSE;
+    }
+}
+
 static void
 _adg_real_invalidate(AdgEntity *entity)
 {
@@ -1335,6 +1902,7 @@ _adg_real_invalidate(AdgEntity *entity)
         klass->invalidate(entity);
 
     data->extents.is_defined = FALSE;
+    data->content.is_defined = FALSE;
 }
 
 static void
@@ -1342,6 +1910,15 @@ _adg_real_arrange(AdgEntity *entity)
 {
     AdgEntityClass *klass = ADG_ENTITY_GET_CLASS(entity);
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    gboolean is_cached = data->extents.is_defined;
+    gint64 start = _adg_profile_begin();
+
+    /* In lazy mode, bring the matrices up to date: this clears the
+     * is_defined flags only if they have effectively been changed */
+    if (_adg_lazy_matrices) {
+        _adg_global_update(entity);
+        _adg_local_update(entity);
+    }
 
     /* Update the global matrix, if required */
     if (!data->global.is_defined) {
@@ -1360,16 +1937,22 @@ _adg_real_arrange(AdgEntity *entity)
         g_warning(_("%s: 'arrange' method not implemented for type '%s'"),
                   G_STRLOC, g_type_name(G_OBJECT_TYPE(entity)));
         data->extents.is_defined = FALSE;
-        return;
+    } else {
+        klass->arrange(entity);
     }
 
-    klass->arrange(entity);
+    if (start != 0)
+        _adg_profile_end(entity, ADG_PROFILE_ARRANGE, start, is_cached);
 }
 
 static void
 _adg_real_render(AdgEntity *entity, cairo_t *cr)
 {
     AdgEntityClass *klass = ADG_ENTITY_GET_CLASS(entity);
+    gint64 start;
+    GArray *batch;
+    gboolean is_batch_owner;
+    gdouble *p_threshold;
 
     /* The render method must be defined */
     if (klass->render == NULL) {
@@ -1381,15 +1964,60 @@ _adg_real_render(AdgEntity *entity, cairo_t *cr)
     /* Before the rendering, the entity should be arranged */
     g_signal_emit(entity, _adg_signals[ARRANGE], 0);
 
+    p_threshold = cairo_get_user_data(cr, &_adg_lod_key);
+    if (p_threshold != NULL) {
+        CpmlExtents device;
+        _AdgLod lod = _adg_lod_level(entity, cr, *p_threshold, &device);
+
+        if (lod != _ADG_LOD_FULL) {
+            if (lod != _ADG_LOD_SKIP) {
+                batch = cairo_get_user_data(cr, &_adg_batch_key);
+                if (batch != NULL)
+                    _adg_batch_flush(batch, cr);
+                _adg_lod_render(entity, lod, &device, cr);
+            }
+            return;
+        }
+    }
+
+    /* The outermost rendering owns the batch of strokes, if any */
+    batch = cairo_get_user_data(cr, &_adg_batch_key);
+    is_batch_owner = _adg_batching && batch == NULL;
+
+    if (is_batch_owner) {
+        batch = g_array_new(FALSE, FALSE, sizeof(_AdgBatchGroup));
+        cairo_set_user_data(cr, &_adg_batch_key, batch, NULL);
+    } else if (batch != NULL && ! _adg_is_batchable(entity)) {
+        /* Entities drawing directly must be rendered above the
+         * pending strokes */
+        _adg_batch_flush(batch, cr);
+    }
+
+    start = _adg_profile_begin();
+
     cairo_save(cr);
     klass->render(entity, cr);
+
+    if (is_batch_owner) {
+        _adg_batch_flush(batch, cr);
+        cairo_set_user_data(cr, &_adg_batch_key, NULL, NULL);
+        g_array_free(batch, TRUE);
+        batch = NULL;
+    }
+
     cairo_restore(cr);
 
+    if (start != 0)
+        _adg_profile_end(entity, ADG_PROFILE_RENDER, start, FALSE);
+
     if (_adg_show_extents) {
         AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
         CpmlExtents *extents = &data->extents;
 
         if (extents->is_defined) {
+            if (batch != NULL)
+                _adg_batch_flush(batch, cr);
+
             cairo_save(cr);
             cairo_set_source_rgba(cr, 0.15, 0.15, 0.15, 0.15);
             cairo_rectangle(cr, extents->org.x, extents->org.y,
@@ -1399,3 +2027,222 @@ _adg_real_render(AdgEntity *entity, cairo_t *cr)
         }
     }
 }
+
+static _AdgLod
+_adg_lod_level(AdgEntity *entity, cairo_t *cr,
+               gdouble threshold, CpmlExtents *device)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    AdgLodPolicy policy = ADG_ENTITY_GET_CLASS(entity)->lod_policy;
+    cairo_matrix_t ctm;
+    gdouble min_size, max_size;
+
+    if (! data->extents.is_defined || policy == ADG_LOD_POLICY_NONE)
+        return _ADG_LOD_FULL;
+
+    cpml_extents_copy(device, &data->extents);
+    cairo_get_matrix(cr, &ctm);
+    cpml_extents_transform(device, &ctm);
+
+    min_size = MIN(device->size.x, device->size.y);
+    max_size = MAX(device->size.x, device->size.y);
+
+    switch (policy) {
+    case ADG_LOD_POLICY_PLACEHOLDER:
+        /* A text becomes unreadable well before disappearing,
+         * so its height is what matters */
+        if (min_size < 1)
+            return _ADG_LOD_SKIP;
+        return min_size < threshold ? _ADG_LOD_PLACEHOLDER : _ADG_LOD_FULL;
+    case ADG_LOD_POLICY_DETAIL:
+        return max_size < threshold ? _ADG_LOD_SKIP : _ADG_LOD_FULL;
+    case ADG_LOD_POLICY_DOT:
+        return max_size < 1 ? _ADG_LOD_DOT : _ADG_LOD_FULL;
+    default:
+        return max_size < 1 ? _ADG_LOD_SKIP : _ADG_LOD_FULL;
+    }
+}
+
+static void
+_adg_lod_render(AdgEntity *entity, _AdgLod lod,
+                const CpmlExtents *device, cairo_t *cr)
+{
+    AdgEntityClass *klass = ADG_ENTITY_GET_CLASS(entity);
+
+    cairo_save(cr);
+
+    if (klass->lod_dress != NULL)
+        adg_entity_apply_dress(entity, klass->lod_dress(entity), cr);
+
+    cairo_identity_matrix(cr);
+
+    if (lod == _ADG_LOD_PLACEHOLDER) {
+        cairo_rectangle(cr, device->org.x, device->org.y,
+                        device->size.x, device->size.y);
+        cairo_clip(cr);
+        cairo_paint_with_alpha(cr, 0.3);
+    } else {
+        /* The dot is one device unit wide and centered on the stroke */
+        cairo_rectangle(cr,
+                        device->org.x + (device->size.x - 1) / 2,
+                        device->org.y + (device->size.y - 1) / 2,
+                        1, 1);
+        cairo_fill(cr);
+    }
+
+    cairo_restore(cr);
+}
+
+static void
+_adg_stroke_path(AdgEntity *entity, AdgDress dress, const cairo_path_t *path,
+                 const cairo_matrix_t *matrix, cairo_path_t *owned_path,
+                 cairo_t *cr)
+{
+    GArray *batch;
+    AdgStyle *style;
+
+    batch = cairo_get_user_data(cr, &_adg_batch_key);
+
+    if (batch != NULL) {
+        style = adg_entity_style(entity, dress);
+
+        /* Only the dresses resolved by a line style are known */
+        if (style == NULL || ADG_IS_LINE_STYLE(style)) {
+            _adg_batch_add(batch, entity, style, path, matrix, owned_path, cr);
+            return;
+        }
+
+        _adg_batch_flush(batch, cr);
+    }
+
+    cairo_save(cr);
+    if (matrix != NULL)
+        cairo_transform(cr, matrix);
+    cairo_append_path(cr, path);
+    cairo_restore(cr);
+
+    adg_entity_apply_dress(entity, dress, cr);
+    cairo_stroke(cr);
+
+    if (owned_path != NULL)
+        cairo_path_destroy(owned_path);
+}
+
+static gboolean
+_adg_is_batchable(AdgEntity *entity)
+{
+    return ADG_ENTITY_GET_CLASS(entity)->batchable;
+}
+
+static void
+_adg_batch_add(GArray *batch, AdgEntity *entity, AdgStyle *style,
+               const cairo_path_t *path, const cairo_matrix_t *matrix,
+               cairo_path_t *owned_path, cairo_t *cr)
+{
+    const CpmlExtents *extents;
+    _AdgBatchGroup *group, new_group;
+    _AdgBatchItem item;
+    AdgStyle *color_style;
+    cairo_matrix_t ctm;
+    guint n;
+
+    cairo_get_matrix(cr, &ctm);
+    extents = adg_entity_get_extents(entity);
+    color_style = style == NULL ? NULL :
+        adg_entity_style(entity,
+                         adg_line_style_get_color_dress((AdgLineStyle *) style));
+
+    /* Look backward for a group compatible with this stroke: it can be
+     * joined only if the stroke does not overlap any later group */
+    group = NULL;
+    for (n = batch->len; n > 0; --n) {
+        _AdgBatchGroup *candidate = &g_array_index(batch, _AdgBatchGroup, n - 1);
+
+        if (candidate->style == style &&
+            candidate->color_style == color_style &&
+            adg_matrix_equal(&candidate->matrix, &ctm)) {
+            group = candidate;
+            break;
+        }
+
+        if (! candidate->is_bounded ||
+            _adg_extents_overlap(&candidate->extents, extents))
+            break;
+    }
+
+    if (group == NULL) {
+        new_group.style = style;
+        new_group.color_style = color_style;
+        new_group.matrix = ctm;
+        new_group.extents.is_defined = FALSE;
+        new_group.is_bounded = TRUE;
+        new_group.items = g_array_new(FALSE, FALSE, sizeof(_AdgBatchItem));
+        g_array_append_val(batch, new_group);
+        group = &g_array_index(batch, _AdgBatchGroup, batch->len - 1);
+    }
+
+    item.entity = g_object_ref(entity);
+    item.path = path;
+    item.owned_path = owned_path;
+    if (matrix != NULL)
+        cairo_matrix_multiply(&item.matrix, matrix, &group->matrix);
+    else
+        item.matrix = group->matrix;
+    g_array_append_val(group->items, item);
+
+    if (extents->is_defined)
+        cpml_extents_add(&group->extents, extents);
+    else
+        group->is_bounded = FALSE;
+}
+
+static void
+_adg_batch_flush(GArray *batch, cairo_t *cr)
+{
+    _AdgBatchGroup *group;
+    _AdgBatchItem *item;
+    guint n, i;
+
+    for (n = 0; n < batch->len; ++n) {
+        group = &g_array_index(batch, _AdgBatchGroup, n);
+
+        cairo_save(cr);
+
+        for (i = 0; i < group->items->len; ++i) {
+            item = &g_array_index(group->items, _AdgBatchItem, i);
+            cairo_set_matrix(cr, &item->matrix);
+            cairo_append_path(cr, item->path);
+        }
+
+        cairo_set_matrix(cr, &group->matrix);
+        item = &g_array_index(group->items, _AdgBatchItem, 0);
+        if (group->style != NULL)
+            adg_style_apply(group->style, item->entity, cr);
+        cairo_stroke(cr);
+
+        cairo_restore(cr);
+
+        for (i = 0; i < group->items->len; ++i) {
+            item = &g_array_index(group->items, _AdgBatchItem, i);
+            if (item->owned_path != NULL)
+                cairo_path_destroy(item->owned_path);
+            g_object_unref(item->entity);
+        }
+        g_array_free(group->items, TRUE);
+    }
+
+    g_array_set_size(batch, 0);
+}
+
+static gboolean
+_adg_extents_overlap(const CpmlExtents *extents1, const CpmlExtents *extents2)
+{
+    /* Undefined extents could be anywhere */
+    if (! extents1->is_defined || ! extents2->is_defined)
+        return TRUE;
+
+    return extents1->org.x <= extents2->org.x + extents2->size.x &&
+           extents2->org.x <= extents1->org.x + extents1->size.x &&
+           extents1->org.y <= extents2->org.y + extents2->size.y &&
+           extents2->org.y <= extents1->org.y + extents1->size.y;
+}
@@ -60,10 +60,22 @@ struct _AdgEntityClass {
     void                (*arrange)              (AdgEntity       *entity);
     void                (*render)               (AdgEntity       *entity,
                                                  cairo_t         *cr);
+
+    /* Virtual table */
+    AdgDress            (*lod_dress)            (AdgEntity       *entity);
+
+    /* Class data */
+    gboolean            batchable;
+    AdgLodPolicy        lod_policy;
 };
 
 
 void            adg_switch_extents              (gboolean         state);
+void            adg_switch_lazy_matrices        (gboolean         state);
+void            adg_switch_batching             (gboolean         state);
+void            adg_set_lod_threshold           (cairo_t         *cr,
+                                                 gdouble          threshold);
+gdouble         adg_get_lod_threshold           (cairo_t         *cr);
 
 GType           adg_entity_get_type             (void);
 void            adg_entity_destroy              (AdgEntity       *entity);
@@ -109,12 +121,18 @@ AdgStyle *      adg_entity_style                (AdgEntity       *entity,
 void            adg_entity_apply_dress          (AdgEntity       *entity,
                                                  AdgDress         dress,
                                                  cairo_t         *cr);
+void            adg_entity_stroke_path          (AdgEntity       *entity,
+                                                 AdgDress         dress,
+                                                 const cairo_path_t *path,
+                                                 const cairo_matrix_t *matrix,
+                                                 cairo_t         *cr);
 void            adg_entity_global_changed       (AdgEntity       *entity);
 void            adg_entity_local_changed        (AdgEntity       *entity);
 void            adg_entity_invalidate           (AdgEntity       *entity);
 void            adg_entity_arrange              (AdgEntity       *entity);
 void            adg_entity_render               (AdgEntity       *entity,
                                                  cairo_t         *cr);
+gchar *         adg_entity_dup_hash             (AdgEntity       *entity);
 AdgPoint *      adg_entity_point                (AdgEntity       *entity,
                                                  AdgPoint        *point,
                                                  const AdgPoint  *new_point);
@@ -117,3 +117,40 @@
  *
  * Since: 1.0
  **/
+
+/**
+ * AdgSnap:
+ * @ADG_SNAP_NONE:     no snapping
+ * @ADG_SNAP_ENDPOINT: snap to the start and end points of the primitives
+ * @ADG_SNAP_MIDPOINT: snap to the middle point of the primitives
+ * @ADG_SNAP_CENTER:   snap to the center of the circular arcs
+ * @ADG_SNAP_NEAREST:  snap to the nearest point laying on the primitives
+ *
+ * Flags specifying which points are considered by adg_trail_snap().
+ * The special points (%ADG_SNAP_ENDPOINT, %ADG_SNAP_MIDPOINT and
+ * %ADG_SNAP_CENTER) have precedence over %ADG_SNAP_NEAREST, that is
+ * the nearest point is returned only when no special point has
+ * been found.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgLodPolicy:
+ * @ADG_LOD_POLICY_NONE:        always rendered with full detail, e.g.
+ *                              containers leaving the decision to their
+ *                              children
+ * @ADG_LOD_POLICY_SKIP:        skipped when smaller than one device unit
+ * @ADG_LOD_POLICY_DOT:         collapsed into a single dot when smaller
+ *                              than one device unit
+ * @ADG_LOD_POLICY_DETAIL:      skipped when smaller than the threshold
+ * @ADG_LOD_POLICY_PLACEHOLDER: replaced by a translucent box when thinner
+ *                              than the threshold and skipped when thinner
+ *                              than one device unit
+ *
+ * How the entities of a class are rendered when the level of detail is
+ * enabled with adg_set_lod_threshold(). Every entity class declares its
+ * own policy in #AdgEntityClass.
+ *
+ * Since: 1.0
+ **/
@@ -96,6 +96,22 @@ typedef enum {
     ADG_DRESS_TABLE
 } AdgDress;
 
+typedef enum {
+    ADG_SNAP_NONE       = 0,
+    ADG_SNAP_ENDPOINT   = 1 << 0,
+    ADG_SNAP_MIDPOINT   = 1 << 1,
+    ADG_SNAP_CENTER     = 1 << 2,
+    ADG_SNAP_NEAREST    = 1 << 3
+} AdgSnap;
+
+typedef enum {
+    ADG_LOD_POLICY_NONE,
+    ADG_LOD_POLICY_SKIP,
+    ADG_LOD_POLICY_DOT,
+    ADG_LOD_POLICY_DETAIL,
+    ADG_LOD_POLICY_PLACEHOLDER
+} AdgLodPolicy;
+
 G_END_DECLS
 
 
@@ -41,6 +41,8 @@
  * @set_extents: virtual method that specifies where a specific fill style
  *               must be applied. It is called by #AdgHatch in the rendering
  *               phase passing with its boundary box as argument.
+ * @fill:        virtual method that fills the current path of a cairo
+ *               context with this fill style.
  *
  * The default <function>set_extents</function> implementation simply sets
  * the extents owned by the fill style instance to the one provided, so the
@@ -48,6 +50,11 @@
  * this behavior, for example to keep the greatest boundary box instead of
  * the last one.
  *
+ * The default <function>fill</function> implementation applies the style
+ * and calls cairo_fill(). A derived class can override it to render the
+ * filling in a different way, e.g. by stroking vector lines clipped to
+ * the current path.
+ *
  * Since: 1.0
  **/
 
@@ -82,6 +89,9 @@ static void             _adg_apply              (AdgStyle       *style,
                                                  cairo_t        *cr);
 static void             _adg_set_extents        (AdgFillStyle   *fill_style,
                                                  const CpmlExtents *extents);
+static void             _adg_fill               (AdgFillStyle   *fill_style,
+                                                 AdgEntity      *entity,
+                                                 cairo_t        *cr);
 
 
 static void
@@ -101,6 +111,7 @@ adg_fill_style_class_init(AdgFillStyleClass *klass)
     style_class->apply = _adg_apply;
 
     klass->set_extents = _adg_set_extents;
+    klass->fill = _adg_fill;
 
     param = g_param_spec_boxed("pattern",
                                P_("Pattern"),
@@ -270,6 +281,31 @@ adg_fill_style_get_extents(AdgFillStyle *fill_style)
     return &data->extents;
 }
 
+/**
+ * adg_fill_style_fill:
+ * @fill_style: an #AdgFillStyle
+ * @entity: the caller #AdgEntity
+ * @cr: the cairo context with the path to fill
+ *
+ * Fills the current path of @cr with @fill_style. The path is
+ * consumed, as it happens with cairo_fill().
+ *
+ * Since: 1.0
+ **/
+void
+adg_fill_style_fill(AdgFillStyle *fill_style, AdgEntity *entity, cairo_t *cr)
+{
+    AdgFillStyleClass *klass;
+
+    g_return_if_fail(ADG_IS_FILL_STYLE(fill_style));
+    g_return_if_fail(cr != NULL);
+
+    klass = ADG_FILL_STYLE_GET_CLASS(fill_style);
+
+    if (klass->fill)
+        klass->fill(fill_style, entity, cr);
+}
+
 
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
@@ -288,3 +324,12 @@ _adg_set_extents(AdgFillStyle *fill_style, const CpmlExtents *extents)
     AdgFillStylePrivate *data = adg_fill_style_get_instance_private(fill_style);
     cpml_extents_copy(&data->extents, extents);
 }
+
+static void
+_adg_fill(AdgFillStyle *fill_style, AdgEntity *entity, cairo_t *cr)
+{
+    /* The fill must be rendered above the pending strokes */
+    _adg_entity_flush_strokes(cr);
+    adg_style_apply((AdgStyle *) fill_style, entity, cr);
+    cairo_fill(cr);
+}
@@ -53,6 +53,9 @@ struct _AdgFillStyleClass {
     /* Virtual table */
     void                (*set_extents)          (AdgFillStyle   *fill_style,
                                                  const CpmlExtents *extents);
+    void                (*fill)                 (AdgFillStyle   *fill_style,
+                                                 AdgEntity      *entity,
+                                                 cairo_t        *cr);
 };
 
 
@@ -63,6 +66,9 @@ cairo_pattern_t *  adg_fill_style_get_pattern   (AdgFillStyle       *fill_style)
 void               adg_fill_style_set_extents   (AdgFillStyle       *fill_style,
                                                  const CpmlExtents  *extents);
 const CpmlExtents *adg_fill_style_get_extents   (AdgFillStyle       *fill_style);
+void               adg_fill_style_fill          (AdgFillStyle       *fill_style,
+                                                 AdgEntity          *entity,
+                                                 cairo_t            *cr);
 
 G_END_DECLS
 
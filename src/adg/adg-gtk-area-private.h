@@ -31,10 +31,30 @@ struct _AdgGtkAreaPrivate {
     gdouble          factor;
     gboolean         autozoom;
     cairo_matrix_t   render_map;
+    AdgSnap          snap;
+    gdouble          snap_radius;
+    gboolean         tile_cache;
+    gboolean         async_render;
+    gdouble          lod_threshold;
 
     gboolean         initialized;
     CpmlExtents      extents;
     gdouble          x_event, y_event;
+
+    GQueue          *tile_levels;
+    guint            n_tiles;
+    CpmlExtents      tile_sheet;
+    GHashTable      *dirty;
+    gulong           hooks[4];
+
+    guint            generation;
+    cairo_surface_t *frame;
+    cairo_matrix_t   frame_map;
+    guint            frame_generation;
+    GCancellable    *job_cancellable;
+    cairo_matrix_t   job_map;
+    guint            job_generation;
+    gint             job_width, job_height;
 };
 
 G_END_DECLS
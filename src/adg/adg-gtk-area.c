@@ -47,6 +47,41 @@
  * without affecting the other layers. Local transformations,
  * instead, are directly applied to the local matrix of the canvas.
  *
+ * When the #AdgGtkArea:snap property is not %ADG_SNAP_NONE, any pointer
+ * motion looks for the nearest point of the #AdgStroke entities of the
+ * canvas not farther than #AdgGtkArea:snap-radius pixels and emits
+ * the #AdgGtkArea::snapped signal. The lookup is performed with
+ * adg_trail_snap(), so it does not need to scan every primitive.
+ *
+ * When #AdgGtkArea:tile-cache is enabled, the canvas is not rendered
+ * on every expose. It is instead split in square tiles, rendered on
+ * demand on image surfaces and kept in a cache keyed on the scale of
+ * the render map and on the tile coordinates. Panning only composes
+ * the cached tiles, rendering the newly exposed ones in a single pass
+ * over the area they cover, and zooming back to one of the last used
+ * scales reuses its tiles. A tile is dropped
+ * whenever an entity of the canvas overlapping it is invalidated or
+ * its global or local matrix changes. Changes not notified through
+ * these signals (e.g. a different style) must be explicitly reported
+ * with adg_gtk_area_invalidate_tiles().
+ *
+ * When #AdgGtkArea:async-render is enabled, the expose handler never
+ * waits for the rasterization. The canvas is arranged and its drawing
+ * operations are recorded on the main thread (entities are not thread
+ * safe), then a worker thread rasterizes the recording on an image
+ * surface. Until the new frame is ready, the last one is shown,
+ * transformed to follow the current render map. A render made
+ * obsolete by a newer render map, size or change in the canvas is
+ * cancelled. The asynchronous rendering takes precedence over the
+ * tile cache and requires cairo 1.10 or later: with older versions
+ * the canvas is always rendered synchronously.
+ *
+ * #AdgGtkArea:lod-threshold enables the level of detail on the
+ * contexts used to render the canvas (see
+ * adg_set_lod_threshold()), so zoomed out views of dense drawings
+ * are faster to render without affecting other renderings, such as
+ * the exports of the same canvas.
+ *
  * Since: 1.0
  **/
 
@@ -65,6 +100,7 @@
  * @canvas_changed:  signals that a new #AdgCanvas is bound to this widget.
  * @extents_changed: signals that the extents on the underling #AdgCanvas
  *                   has been changed.
+ * @snapped:         signals the result of a snap lookup on pointer motion.
  *
  * The default @canvas_changed resets the internal initialization flag, so at
  * the first call to the <function>size_allocate</function> method the zoom
@@ -74,17 +110,24 @@
  * a hook for derived class for refreshing GUI elements (such as scrollbars)
  * whenever the boundary box changes.
  *
+ * The default @snapped signal does not do anything: it is intended as a
+ * hook for providing a visual feedback of the snapped point.
+ *
  * Since: 1.0
  **/
 
 
 #include "adg-internal.h"
 #include <gtk/gtk.h>
+#include <math.h>
 
 #include "adg-container.h"
 #include "adg-table.h"
 #include "adg-title-block.h"
 #include <adg-canvas.h>
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-stroke.h"
 #include "adg-gtk-utils.h"
 #include "adg-cairo-fallback.h"
 
@@ -94,6 +137,30 @@
 #define _ADG_OLD_OBJECT_CLASS   ((GObjectClass *) adg_gtk_area_parent_class)
 #define _ADG_OLD_WIDGET_CLASS   ((GtkWidgetClass *) adg_gtk_area_parent_class)
 
+/* Side of a tile, in pixels */
+#define _ADG_TILE_SIZE          256
+
+/* Tiles kept in cache before dropping the least recently used scales */
+#define _ADG_MAX_TILES          256
+
+/* Scales (zoom levels) kept in cache */
+#define _ADG_MAX_TILE_LEVELS    4
+
+/* Extra space around the extents of an entity, to catch line widths */
+#define _ADG_TILE_PADDING       8
+
+#define _ADG_TILE_KEY(i, j)     (((gint64) (i) << 32) | (guint32) (j))
+
+/* Rows rasterized by a render thread between two cancellation checks */
+#define _ADG_RENDER_BAND        128
+
+/* Every band replays the recording: above this recording time (in
+ * microseconds) the frame is rasterized in a single replay instead */
+#define _ADG_RENDER_BAND_LIMIT  2000
+
+/* Recording surfaces are required by the asynchronous rendering */
+#define _ADG_ASYNC_RENDER       (CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 10, 0))
+
 
 G_DEFINE_TYPE_WITH_PRIVATE(AdgGtkArea, adg_gtk_area, GTK_TYPE_DRAWING_AREA)
 
@@ -102,18 +169,61 @@ enum {
     PROP_CANVAS,
     PROP_FACTOR,
     PROP_AUTOZOOM,
-    PROP_RENDER_MAP
+    PROP_RENDER_MAP,
+    PROP_SNAP,
+    PROP_SNAP_RADIUS,
+    PROP_TILE_CACHE,
+    PROP_ASYNC_RENDER,
+    PROP_LOD_THRESHOLD
 };
 
 enum {
     CANVAS_CHANGED,
     EXTENTS_CHANGED,
+    SNAPPED,
     LAST_SIGNAL
 };
 
+typedef struct {
+    const cairo_matrix_t *render_map;
+    CpmlPair    pair;
+    AdgSnap     snap;
+    gdouble     radius;
+    CpmlExtents bounds;
+    gdouble     distance;
+    AdgSnap     result;
+    CpmlPair    dest;
+} _AdgSnapData;
+
+typedef struct {
+    cairo_matrix_t  scale;
+    GHashTable     *tiles;
+} _AdgTileLevel;
+
+typedef struct {
+    gint        i1, j1;
+    gint        i2, j2;
+} _AdgTileRange;
+
+typedef struct {
+    cairo_surface_t *recording;
+    gint             width, height;
+    cairo_matrix_t   map;
+    guint            generation;
+    gboolean         banded;
+} _AdgRenderJob;
+
 
 static guint    _adg_signals[LAST_SIGNAL] = { 0 };
 
+/* Entity signals that could invalidate the rendered content */
+static const gchar *_adg_hooked_signals[] = {
+    "invalidate",
+    "global-changed",
+    "local-changed",
+    "parent-set"
+};
+
 
 static const CpmlExtents *
 _adg_get_extents(AdgGtkArea *area)
@@ -146,6 +256,624 @@ _adg_get_extents(AdgGtkArea *area)
     return &data->extents;
 }
 
+static void
+_adg_tile_level_free(AdgGtkArea *area, _AdgTileLevel *level)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+
+    data->n_tiles -= g_hash_table_size(level->tiles);
+    g_hash_table_destroy(level->tiles);
+    g_free(level);
+}
+
+static void
+_adg_tile_range(const CpmlExtents *extents, _AdgTileRange *range)
+{
+    range->i1 = floor(extents->org.x / _ADG_TILE_SIZE);
+    range->j1 = floor(extents->org.y / _ADG_TILE_SIZE);
+    range->i2 = ceil((extents->org.x + extents->size.x) / _ADG_TILE_SIZE) - 1;
+    range->j2 = ceil((extents->org.y + extents->size.y) / _ADG_TILE_SIZE) - 1;
+}
+
+static gboolean
+_adg_tile_inside(gpointer key, gpointer value, gpointer user_data)
+{
+    const _AdgTileRange *range = user_data;
+    gint64 tile = *(gint64 *) key;
+    gint i = (gint32) (tile >> 32);
+    gint j = (gint32) (tile & 0xffffffff);
+
+    return i >= range->i1 && i <= range->i2 && j >= range->j1 && j <= range->j2;
+}
+
+static gboolean
+_adg_tile_outside(gpointer key, gpointer value, gpointer user_data)
+{
+    return ! _adg_tile_inside(key, value, user_data);
+}
+
+static void
+_adg_invalidate_tiles(AdgGtkArea *area, const CpmlExtents *extents)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    _AdgTileLevel *level;
+    CpmlExtents tile_extents;
+    _AdgTileRange range;
+    GList *node;
+
+    if (data->tile_levels == NULL)
+        return;
+
+    if (extents == NULL) {
+        while ((level = g_queue_pop_head(data->tile_levels)) != NULL)
+            _adg_tile_level_free(area, level);
+        data->tile_sheet.is_defined = FALSE;
+        return;
+    }
+
+    for (node = data->tile_levels->head; node != NULL; node = node->next) {
+        level = node->data;
+        tile_extents = *extents;
+        cpml_extents_transform(&tile_extents, &level->scale);
+        tile_extents.org.x -= _ADG_TILE_PADDING;
+        tile_extents.org.y -= _ADG_TILE_PADDING;
+        tile_extents.size.x += _ADG_TILE_PADDING * 2;
+        tile_extents.size.y += _ADG_TILE_PADDING * 2;
+        _adg_tile_range(&tile_extents, &range);
+        data->n_tiles -= g_hash_table_foreach_remove(level->tiles,
+                                                     _adg_tile_inside, &range);
+    }
+}
+
+static gboolean
+_adg_is_shown(AdgCanvas *canvas, AdgEntity *entity)
+{
+    while (entity != NULL && entity != (AdgEntity *) canvas)
+        entity = adg_entity_get_parent(entity);
+
+    return entity != NULL;
+}
+
+static gboolean
+_adg_entity_hook(GSignalInvocationHint *ihint, guint n_param_values,
+               const GValue *param_values, gpointer user_data)
+{
+    AdgGtkArea *area = (AdgGtkArea *) user_data;
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    AdgEntity *entity, *old_parent;
+    const CpmlExtents *extents;
+    gboolean is_shown;
+
+    entity = g_value_get_object(&param_values[0]);
+    is_shown = _adg_is_shown(data->canvas, entity);
+
+    /* For AdgEntity::parent-set, check also the old parent */
+    old_parent = n_param_values > 1 ? g_value_get_object(&param_values[1]) : NULL;
+
+    if (! is_shown && ! _adg_is_shown(data->canvas, old_parent))
+        return TRUE;
+
+    /* Any change makes the last asynchronous frame obsolete */
+    ++data->generation;
+
+    /* Tiles not yet rendered are not affected by changes */
+    if (data->n_tiles == 0)
+        return TRUE;
+
+    if (entity == (AdgEntity *) data->canvas) {
+        _adg_invalidate_tiles(area, NULL);
+        return TRUE;
+    }
+
+    /* Extents are cleared by the default handler of
+     * AdgEntity::invalidate, called after this hook */
+    extents = adg_entity_get_extents(entity);
+    if (extents->is_defined)
+        _adg_invalidate_tiles(area, extents);
+
+    /* The new extents will be known only after the next arrange */
+    if (is_shown)
+        g_hash_table_add(data->dirty, g_object_ref(entity));
+
+    return TRUE;
+}
+
+static void
+_adg_update_hooks(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    gboolean is_needed, is_installed;
+    gpointer entity_class;
+    guint n, signal_id;
+
+    is_needed = data->tile_cache || data->async_render;
+    is_installed = data->hooks[0] != 0;
+    if (is_needed == is_installed)
+        return;
+
+    /* Signals are registered by the class initialization */
+    entity_class = g_type_class_ref(ADG_TYPE_ENTITY);
+
+    for (n = 0; n < G_N_ELEMENTS(_adg_hooked_signals); ++n) {
+        signal_id = g_signal_lookup(_adg_hooked_signals[n], ADG_TYPE_ENTITY);
+        if (is_needed) {
+            data->hooks[n] = g_signal_add_emission_hook(signal_id, 0,
+                                                        _adg_entity_hook,
+                                                        area, NULL);
+        } else {
+            g_signal_remove_emission_hook(signal_id, data->hooks[n]);
+            data->hooks[n] = 0;
+        }
+    }
+
+    g_type_class_unref(entity_class);
+}
+
+static void
+_adg_switch_tile_cache(AdgGtkArea *area, gboolean state)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+
+    if (state == data->tile_cache)
+        return;
+
+    if (state) {
+        data->tile_levels = g_queue_new();
+        data->dirty = g_hash_table_new_full(NULL, NULL, g_object_unref, NULL);
+    } else {
+        _adg_invalidate_tiles(area, NULL);
+        g_queue_free(data->tile_levels);
+        data->tile_levels = NULL;
+        g_hash_table_destroy(data->dirty);
+        data->dirty = NULL;
+    }
+
+    data->tile_cache = state;
+    _adg_update_hooks(area);
+}
+
+static void
+_adg_flush_dirty(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    GHashTableIter iter;
+    gpointer entity;
+    const CpmlExtents *extents;
+
+    g_hash_table_iter_init(&iter, data->dirty);
+    while (g_hash_table_iter_next(&iter, &entity, NULL)) {
+        if (_adg_is_shown(data->canvas, entity)) {
+            extents = adg_entity_get_extents(entity);
+            if (extents->is_defined)
+                _adg_invalidate_tiles(area, extents);
+        }
+    }
+
+    g_hash_table_remove_all(data->dirty);
+}
+
+static _AdgTileLevel *
+_adg_get_tile_level(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    const cairo_matrix_t *map = &data->render_map;
+    _AdgTileLevel *level;
+    GList *node;
+
+    for (node = data->tile_levels->head; node != NULL; node = node->next) {
+        level = node->data;
+        if (level->scale.xx == map->xx && level->scale.yx == map->yx &&
+            level->scale.xy == map->xy && level->scale.yy == map->yy) {
+            /* Keep the most recently used scale in front */
+            g_queue_unlink(data->tile_levels, node);
+            g_queue_push_head_link(data->tile_levels, node);
+            return level;
+        }
+    }
+
+    level = g_new(_AdgTileLevel, 1);
+    cairo_matrix_init(&level->scale, map->xx, map->yx, map->xy, map->yy, 0, 0);
+    level->tiles = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free,
+                                         (GDestroyNotify) cairo_surface_destroy);
+    g_queue_push_head(data->tile_levels, level);
+
+    if (g_queue_get_length(data->tile_levels) > _ADG_MAX_TILE_LEVELS)
+        _adg_tile_level_free(area, g_queue_pop_tail(data->tile_levels));
+
+    return level;
+}
+
+/* Renders all the tiles in range not yet cached with a single pass on
+ * a surface covering them, that is then split: rendering every tile
+ * on its own would walk the whole entity tree once per tile */
+static void
+_adg_fill_tiles(AdgGtkArea *area, _AdgTileLevel *level,
+                const _AdgTileRange *range)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    _AdgTileRange missing;
+    cairo_surface_t *surface, *tile;
+    cairo_t *cr;
+    gint64 key, *p_key;
+    gint i, j;
+
+    missing.i1 = range->i2 + 1;
+    missing.j1 = range->j2 + 1;
+    missing.i2 = range->i1 - 1;
+    missing.j2 = range->j1 - 1;
+
+    for (j = range->j1; j <= range->j2; ++j) {
+        for (i = range->i1; i <= range->i2; ++i) {
+            key = _ADG_TILE_KEY(i, j);
+            if (g_hash_table_lookup(level->tiles, &key) == NULL) {
+                missing.i1 = MIN(missing.i1, i);
+                missing.j1 = MIN(missing.j1, j);
+                missing.i2 = MAX(missing.i2, i);
+                missing.j2 = MAX(missing.j2, j);
+            }
+        }
+    }
+
+    if (missing.i1 > missing.i2)
+        return;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         (missing.i2 - missing.i1 + 1) * _ADG_TILE_SIZE,
+                                         (missing.j2 - missing.j1 + 1) * _ADG_TILE_SIZE);
+    cr = cairo_create(surface);
+    adg_set_lod_threshold(cr, data->lod_threshold);
+    cairo_translate(cr, -missing.i1 * _ADG_TILE_SIZE, -missing.j1 * _ADG_TILE_SIZE);
+    cairo_transform(cr, &level->scale);
+    adg_entity_render((AdgEntity *) data->canvas, cr);
+    cairo_destroy(cr);
+
+    for (j = missing.j1; j <= missing.j2; ++j) {
+        for (i = missing.i1; i <= missing.i2; ++i) {
+            key = _ADG_TILE_KEY(i, j);
+            if (g_hash_table_lookup(level->tiles, &key) != NULL)
+                continue;
+
+            tile = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                              _ADG_TILE_SIZE, _ADG_TILE_SIZE);
+            cr = cairo_create(tile);
+            cairo_set_source_surface(cr, surface,
+                                     -(i - missing.i1) * _ADG_TILE_SIZE,
+                                     -(j - missing.j1) * _ADG_TILE_SIZE);
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+            cairo_paint(cr);
+            cairo_destroy(cr);
+
+            p_key = g_new(gint64, 1);
+            *p_key = key;
+            g_hash_table_insert(level->tiles, p_key, tile);
+            ++data->n_tiles;
+        }
+    }
+
+    cairo_surface_destroy(surface);
+}
+
+static void
+_adg_render_tiles(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    AdgEntity *entity = (AdgEntity *) data->canvas;
+    const CpmlExtents *extents;
+    CpmlExtents sheet, visible;
+    _AdgTileLevel *level;
+    _AdgTileRange range;
+    gdouble x1, y1, x2, y2, tx, ty;
+    gint64 key;
+    gint i, j;
+
+    adg_entity_arrange(entity);
+    _adg_flush_dirty(area);
+
+    extents = adg_entity_get_extents(entity);
+    if (!extents->is_defined)
+        return;
+
+    /* A different sheet changes the background of every tile */
+    sheet = *extents;
+    adg_canvas_apply_margins(data->canvas, &sheet);
+    if (!cpml_extents_equal(&sheet, &data->tile_sheet)) {
+        _adg_invalidate_tiles(area, NULL);
+        data->tile_sheet = sheet;
+    }
+
+    level = _adg_get_tile_level(area);
+    cpml_extents_transform(&sheet, &level->scale);
+
+    /* Tiles are placed on whole pixels, so they are copied 1:1 */
+    tx = round(data->render_map.x0);
+    ty = round(data->render_map.y0);
+
+    /* Render only the tiles both exposed and inside the sheet */
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    x1 = MAX(x1 - tx, sheet.org.x - _ADG_TILE_PADDING);
+    y1 = MAX(y1 - ty, sheet.org.y - _ADG_TILE_PADDING);
+    x2 = MIN(x2 - tx, sheet.org.x + sheet.size.x + _ADG_TILE_PADDING);
+    y2 = MIN(y2 - ty, sheet.org.y + sheet.size.y + _ADG_TILE_PADDING);
+    if (x1 >= x2 || y1 >= y2)
+        return;
+
+    visible.is_defined = TRUE;
+    visible.org.x = x1;
+    visible.org.y = y1;
+    visible.size.x = x2 - x1;
+    visible.size.y = y2 - y1;
+    _adg_tile_range(&visible, &range);
+
+    _adg_fill_tiles(area, level, &range);
+    cairo_save(cr);
+
+    for (j = range.j1; j <= range.j2; ++j) {
+        for (i = range.i1; i <= range.i2; ++i) {
+            key = _ADG_TILE_KEY(i, j);
+            x1 = tx + i * _ADG_TILE_SIZE;
+            y1 = ty + j * _ADG_TILE_SIZE;
+            cairo_set_source_surface(cr, g_hash_table_lookup(level->tiles, &key),
+                                     x1, y1);
+            cairo_rectangle(cr, x1, y1, _ADG_TILE_SIZE, _ADG_TILE_SIZE);
+            cairo_fill(cr);
+        }
+    }
+
+    cairo_restore(cr);
+
+    /* Drop the least recently used scales first and, if still
+     * needed, the tiles of the current scale not exposed */
+    while (data->n_tiles > _ADG_MAX_TILES &&
+           g_queue_peek_tail(data->tile_levels) != level)
+        _adg_tile_level_free(area, g_queue_pop_tail(data->tile_levels));
+
+    if (data->n_tiles > _ADG_MAX_TILES)
+        data->n_tiles -= g_hash_table_foreach_remove(level->tiles,
+                                                     _adg_tile_outside, &range);
+}
+
+static void
+_adg_cancel_render(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+
+    if (data->job_cancellable != NULL) {
+        g_cancellable_cancel(data->job_cancellable);
+        g_object_unref(data->job_cancellable);
+        data->job_cancellable = NULL;
+    }
+}
+
+static void
+_adg_switch_async_render(AdgGtkArea *area, gboolean state)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+
+    if (state == data->async_render)
+        return;
+
+    if (! state) {
+        _adg_cancel_render(area);
+        if (data->frame != NULL) {
+            cairo_surface_destroy(data->frame);
+            data->frame = NULL;
+        }
+    }
+
+    data->async_render = state;
+    _adg_update_hooks(area);
+}
+
+static void
+_adg_set_lod_threshold(AdgGtkArea *area, gdouble threshold)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+
+    if (threshold == data->lod_threshold)
+        return;
+
+    data->lod_threshold = threshold;
+
+    /* The cached tiles and the last frame have the old detail */
+    _adg_invalidate_tiles(area, NULL);
+    ++data->generation;
+    gtk_widget_queue_draw((GtkWidget *) area);
+}
+
+#if _ADG_ASYNC_RENDER
+
+static void
+_adg_render_job_free(gpointer user_data)
+{
+    _AdgRenderJob *job = user_data;
+
+    cairo_surface_destroy(job->recording);
+    g_free(job);
+}
+
+static void
+_adg_render_thread(GTask *task, gpointer source_object,
+                   gpointer task_data, GCancellable *cancellable)
+{
+    _AdgRenderJob *job = task_data;
+    cairo_surface_t *frame;
+    cairo_t *cr;
+    gint y;
+
+    frame = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                       job->width, job->height);
+    cr = cairo_create(frame);
+    cairo_set_source_surface(cr, job->recording, 0, 0);
+
+    if (! job->banded) {
+        if (! g_cancellable_is_cancelled(cancellable))
+            cairo_paint(cr);
+    } else {
+        /* Rasterize in bands, so stale renders are abandoned early */
+        for (y = 0; y < job->height; y += _ADG_RENDER_BAND) {
+            if (g_cancellable_is_cancelled(cancellable))
+                break;
+            cairo_rectangle(cr, 0, y, job->width, _ADG_RENDER_BAND);
+            cairo_fill(cr);
+        }
+    }
+
+    cairo_destroy(cr);
+
+    if (g_task_return_error_if_cancelled(task))
+        cairo_surface_destroy(frame);
+    else
+        g_task_return_pointer(task, frame,
+                              (GDestroyNotify) cairo_surface_destroy);
+}
+
+static void
+_adg_render_done(GObject *source_object, GAsyncResult *result,
+                 gpointer user_data)
+{
+    AdgGtkArea *area = (AdgGtkArea *) source_object;
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    _AdgRenderJob *job = g_task_get_task_data((GTask *) result);
+    cairo_surface_t *frame;
+
+    /* NULL when cancelled, that is a newer render has been started
+     * or the asynchronous rendering has been disabled */
+    frame = g_task_propagate_pointer((GTask *) result, NULL);
+    if (frame == NULL)
+        return;
+
+    if (data->frame != NULL)
+        cairo_surface_destroy(data->frame);
+
+    data->frame = frame;
+    adg_matrix_copy(&data->frame_map, &job->map);
+    data->frame_generation = job->generation;
+
+    g_object_unref(data->job_cancellable);
+    data->job_cancellable = NULL;
+
+    gtk_widget_queue_draw((GtkWidget *) area);
+}
+
+static void
+_adg_start_render(AdgGtkArea *area, gint width, gint height)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    cairo_rectangle_t bounds;
+    _AdgRenderJob *job;
+    cairo_t *cr;
+    gint64 elapsed;
+    GTask *task;
+
+    _adg_cancel_render(area);
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.width = width;
+    bounds.height = height;
+
+    job = g_new(_AdgRenderJob, 1);
+    job->recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA,
+                                                    &bounds);
+    job->width = width;
+    job->height = height;
+
+    /* Entities are not thread safe: the canvas is arranged and its
+     * drawing operations recorded here, leaving to the worker thread
+     * only the rasterization */
+    elapsed = g_get_monotonic_time();
+    cr = cairo_create(job->recording);
+    adg_set_lod_threshold(cr, data->lod_threshold);
+    cairo_transform(cr, &data->render_map);
+    adg_entity_render((AdgEntity *) data->canvas, cr);
+    cairo_destroy(cr);
+    elapsed = g_get_monotonic_time() - elapsed;
+
+    /* The recording time is a cheap estimate of the replay cost:
+     * banding is worth its repeated replays only on light drawings */
+    job->banded = elapsed < _ADG_RENDER_BAND_LIMIT;
+
+    adg_matrix_copy(&job->map, &data->render_map);
+    job->generation = data->generation;
+
+    adg_matrix_copy(&data->job_map, &job->map);
+    data->job_generation = job->generation;
+    data->job_width = width;
+    data->job_height = height;
+    data->job_cancellable = g_cancellable_new();
+
+    task = g_task_new(area, data->job_cancellable, _adg_render_done, NULL);
+    g_task_set_task_data(task, job, _adg_render_job_free);
+    g_task_run_in_thread(task, _adg_render_thread);
+    g_object_unref(task);
+}
+
+static void
+_adg_render_async(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+    GtkAllocation allocation;
+    cairo_matrix_t map;
+    gboolean is_current;
+
+    gtk_widget_get_allocation((GtkWidget *) area, &allocation);
+    if (allocation.width <= 0 || allocation.height <= 0)
+        return;
+
+    is_current = data->frame != NULL &&
+        data->frame_generation == data->generation &&
+        cairo_image_surface_get_width(data->frame) == allocation.width &&
+        cairo_image_surface_get_height(data->frame) == allocation.height &&
+        adg_matrix_equal(&data->frame_map, &data->render_map);
+
+    /* Start a new render, unless the one in flight is already fine */
+    if (! is_current &&
+        (data->job_cancellable == NULL ||
+         data->job_generation != data->generation ||
+         data->job_width != allocation.width ||
+         data->job_height != allocation.height ||
+         ! adg_matrix_equal(&data->job_map, &data->render_map)))
+        _adg_start_render(area, allocation.width, allocation.height);
+
+    if (data->frame == NULL)
+        return;
+
+    /* Present the last frame, adapted to the current render map */
+    adg_matrix_copy(&map, &data->frame_map);
+    if (cairo_matrix_invert(&map) != CAIRO_STATUS_SUCCESS)
+        return;
+
+    cairo_save(cr);
+    cairo_transform(cr, &data->render_map);
+    cairo_transform(cr, &map);
+    cairo_set_source_surface(cr, data->frame, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+#endif
+
+static void
+_adg_render(AdgGtkArea *area, cairo_t *cr)
+{
+    AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private(area);
+
+#if _ADG_ASYNC_RENDER
+    if (data->async_render) {
+        _adg_render_async(area, cr);
+        return;
+    }
+#endif
+
+    if (data->tile_cache) {
+        _adg_render_tiles(area, cr);
+    } else {
+        adg_set_lod_threshold(cr, data->lod_threshold);
+        cairo_transform(cr, &data->render_map);
+        adg_entity_render((AdgEntity *) data->canvas, cr);
+    }
+}
+
 
 static void
 _adg_get_property(GObject *object, guint prop_id,
@@ -166,6 +894,21 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_RENDER_MAP:
         g_value_set_boxed(value, &data->render_map);
         break;
+    case PROP_SNAP:
+        g_value_set_flags(value, data->snap);
+        break;
+    case PROP_SNAP_RADIUS:
+        g_value_set_double(value, data->snap_radius);
+        break;
+    case PROP_TILE_CACHE:
+        g_value_set_boolean(value, data->tile_cache);
+        break;
+    case PROP_ASYNC_RENDER:
+        g_value_set_boolean(value, data->async_render);
+        break;
+    case PROP_LOD_THRESHOLD:
+        g_value_set_double(value, data->lod_threshold);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -189,6 +932,7 @@ _adg_set_property(GObject *object, guint prop_id,
             if (old_canvas != NULL)
                 g_object_unref(old_canvas);
             data->canvas = new_canvas;
+            _adg_invalidate_tiles((AdgGtkArea *) object, NULL);
             g_signal_emit(object, _adg_signals[CANVAS_CHANGED], 0, old_canvas);
         }
         break;
@@ -201,6 +945,24 @@ _adg_set_property(GObject *object, guint prop_id,
     case PROP_RENDER_MAP:
         adg_matrix_copy(&data->render_map, g_value_get_boxed(value));
         break;
+    case PROP_SNAP:
+        data->snap = g_value_get_flags(value);
+        break;
+    case PROP_SNAP_RADIUS:
+        data->snap_radius = g_value_get_double(value);
+        break;
+    case PROP_TILE_CACHE:
+        _adg_switch_tile_cache((AdgGtkArea *) object,
+                               g_value_get_boolean(value));
+        break;
+    case PROP_ASYNC_RENDER:
+        _adg_switch_async_render((AdgGtkArea *) object,
+                                 g_value_get_boolean(value));
+        break;
+    case PROP_LOD_THRESHOLD:
+        _adg_set_lod_threshold((AdgGtkArea *) object,
+                               g_value_get_double(value));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -213,6 +975,9 @@ _adg_dispose(GObject *object)
 {
     AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private((AdgGtkArea *) object);
 
+    _adg_switch_tile_cache((AdgGtkArea *) object, FALSE);
+    _adg_switch_async_render((AdgGtkArea *) object, FALSE);
+
     if (data->canvas) {
         g_object_unref(data->canvas);
         data->canvas = NULL;
@@ -412,12 +1177,136 @@ _adg_motion_notify_event(GtkWidget *widget, GdkEventMotion *event)
         return TRUE;
     }
 
+    if (!translating) {
+        AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private((AdgGtkArea *) widget);
+
+        if (data->snap != ADG_SNAP_NONE) {
+            CpmlPair pair;
+            AdgSnap snap = adg_gtk_area_snap((AdgGtkArea *) widget,
+                                             event->x, event->y, &pair);
+            g_signal_emit(widget, _adg_signals[SNAPPED], 0, snap,
+                          snap != ADG_SNAP_NONE ? &pair : NULL);
+        }
+    }
+
     if (_ADG_OLD_WIDGET_CLASS->motion_notify_event == NULL)
         return FALSE;
 
     return _ADG_OLD_WIDGET_CLASS->motion_notify_event(widget, event);
 }
 
+static gboolean
+_adg_snap_bounds(const cairo_matrix_t *render_map, gdouble x, gdouble y,
+                 gdouble radius, CpmlExtents *bounds)
+{
+    cairo_matrix_t inverted;
+    CpmlPair corner;
+    gint n;
+
+    adg_matrix_copy(&inverted, render_map);
+    if (cairo_matrix_invert(&inverted) != CAIRO_STATUS_SUCCESS)
+        return FALSE;
+
+    bounds->is_defined = 0;
+    for (n = 0; n < 4; ++n) {
+        corner.x = n & 1 ? x + radius : x - radius;
+        corner.y = n & 2 ? y + radius : y - radius;
+        cairo_matrix_transform_point(&inverted, &corner.x, &corner.y);
+        cpml_extents_pair_add(bounds, &corner);
+    }
+
+    return TRUE;
+}
+
+static gboolean
+_adg_snap_is_near(const CpmlExtents *extents, const CpmlExtents *bounds)
+{
+    return extents->org.x <= bounds->org.x + bounds->size.x &&
+           extents->org.y <= bounds->org.y + bounds->size.y &&
+           extents->org.x + extents->size.x >= bounds->org.x &&
+           extents->org.y + extents->size.y >= bounds->org.y;
+}
+
+static void
+_adg_snap_stroke(AdgStroke *stroke, _AdgSnapData *snap_data)
+{
+    AdgEntity *entity;
+    AdgTrail *trail;
+    cairo_matrix_t map, inverted;
+    CpmlPair pair, dest;
+    CpmlVector vx, vy;
+    gdouble radius, distance;
+    AdgSnap snap;
+
+    entity = (AdgEntity *) stroke;
+    trail = adg_stroke_get_trail(stroke);
+    if (trail == NULL)
+        return;
+
+    /* Map from trail space to widget space, as done by the rendering */
+    adg_matrix_copy(&map, adg_entity_get_local_matrix(entity));
+    adg_matrix_transform(&map, adg_entity_get_global_matrix(entity),
+                         ADG_TRANSFORM_AFTER);
+    adg_matrix_transform(&map, snap_data->render_map, ADG_TRANSFORM_AFTER);
+
+    adg_matrix_copy(&inverted, &map);
+    if (cairo_matrix_invert(&inverted) != CAIRO_STATUS_SUCCESS)
+        return;
+
+    cpml_pair_copy(&pair, &snap_data->pair);
+    cairo_matrix_transform_point(&inverted, &pair.x, &pair.y);
+
+    /* The radius in trail space: the distance in widget
+     * space is checked anyway once the point is found */
+    vx.x = vy.y = snap_data->radius;
+    vx.y = vy.x = 0;
+    cairo_matrix_transform_distance(&inverted, &vx.x, &vx.y);
+    cairo_matrix_transform_distance(&inverted, &vy.x, &vy.y);
+    radius = MAX(hypot(vx.x, vx.y), hypot(vy.x, vy.y));
+
+    snap = adg_trail_snap(trail, snap_data->snap, &pair, radius, &dest);
+    if (snap == ADG_SNAP_NONE)
+        return;
+
+    cairo_matrix_transform_point(&map, &dest.x, &dest.y);
+    distance = cpml_pair_squared_distance(&dest, &snap_data->pair);
+    if (distance > snap_data->radius * snap_data->radius)
+        return;
+
+    /* Special points win over the nearest point, whatever the distance */
+    if (snap_data->result != ADG_SNAP_NONE) {
+        gboolean is_nearest = snap == ADG_SNAP_NEAREST;
+        gboolean was_nearest = snap_data->result == ADG_SNAP_NEAREST;
+
+        if (is_nearest && !was_nearest)
+            return;
+        if (is_nearest == was_nearest && distance >= snap_data->distance)
+            return;
+    }
+
+    snap_data->distance = distance;
+    snap_data->result = snap;
+    cpml_pair_copy(&snap_data->dest, &dest);
+}
+
+static void
+_adg_snap_entity(AdgEntity *entity, _AdgSnapData *snap_data)
+{
+    const CpmlExtents *extents = adg_entity_get_extents(entity);
+
+    /* Skip the entities (and so whole containers) far from the
+     * pointer: this costs much less than a trail query */
+    if (extents->is_defined && ! _adg_snap_is_near(extents, &snap_data->bounds))
+        return;
+
+    if (ADG_IS_CONTAINER(entity)) {
+        adg_container_foreach((AdgContainer *) entity,
+                              G_CALLBACK(_adg_snap_entity), snap_data);
+    } else if (ADG_IS_STROKE(entity)) {
+        _adg_snap_stroke((AdgStroke *) entity, snap_data);
+    }
+}
+
 static void
 _adg_canvas_changed(AdgGtkArea *area, AdgCanvas *old_canvas)
 {
@@ -447,8 +1336,7 @@ _adg_expose_event(GtkWidget *widget, GdkEventExpose *event)
 
     if (canvas != NULL && event->window != NULL) {
         cairo_t *cr = gdk_cairo_create(event->window);
-        cairo_transform(cr, &data->render_map);
-        adg_entity_render((AdgEntity *) canvas, cr);
+        _adg_render((AdgGtkArea *) widget, cr);
         cairo_destroy(cr);
     }
 
@@ -532,10 +1420,8 @@ _adg_draw(GtkWidget *widget, cairo_t *cr)
     AdgGtkAreaPrivate *data = adg_gtk_area_get_instance_private((AdgGtkArea *) widget);
     AdgCanvas *canvas = data->canvas;
 
-    if (canvas != NULL) {
-        cairo_transform(cr, &data->render_map);
-        adg_entity_render((AdgEntity *) canvas, cr);
-    }
+    if (canvas != NULL)
+        _adg_render((AdgGtkArea *) widget, cr);
 
     return FALSE;
 }
@@ -604,6 +1490,41 @@ adg_gtk_area_class_init(AdgGtkAreaClass *klass)
                                G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_RENDER_MAP, param);
 
+    param = g_param_spec_flags("snap",
+                               P_("Snap"),
+                               P_("The kind of points to snap to while moving the pointer: ADG_SNAP_NONE disables snapping"),
+                               ADG_TYPE_SNAP, ADG_SNAP_NONE,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_SNAP, param);
+
+    param = g_param_spec_double("snap-radius",
+                                P_("Snap Radius"),
+                                P_("The max distance (in pixels) between the pointer and the snapped point"),
+                                0., G_MAXDOUBLE, 8.,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_SNAP_RADIUS, param);
+
+    param = g_param_spec_boolean("tile-cache",
+                                 P_("Tile Cache"),
+                                 P_("When enabled, the canvas is rendered in tiles cached among the exposes, so panning and zooming do not render everything again"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_TILE_CACHE, param);
+
+    param = g_param_spec_boolean("async-render",
+                                 P_("Asynchronous Rendering"),
+                                 P_("When enabled, the canvas is rasterized by a worker thread while the last rendered frame is shown"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_ASYNC_RENDER, param);
+
+    param = g_param_spec_double("lod-threshold",
+                                P_("Level of Detail Threshold"),
+                                P_("The size (in pixels) below which the entities of the canvas are rendered with less detail: 0 disables the level of detail"),
+                                0., G_MAXDOUBLE, 0.,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_LOD_THRESHOLD, param);
+
     /**
      * AdgGtkArea::canvas-changed:
      * @area: an #AdgGtkArea
@@ -646,6 +1567,26 @@ adg_gtk_area_class_init(AdgGtkAreaClass *klass)
                      NULL, NULL,
                      g_cclosure_marshal_VOID__POINTER,
                      G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+    /**
+     * AdgGtkArea::snapped:
+     * @area: an #AdgGtkArea
+     * @snap: the kind of the snapped point
+     * @pair: the snapped point, in widget space
+     *
+     * Emitted on pointer motion when the #AdgGtkArea:snap property
+     * is not %ADG_SNAP_NONE. If no point has been found, @snap is
+     * %ADG_SNAP_NONE and @pair is <constant>NULL</constant>.
+     *
+     * Since: 1.0
+     **/
+    _adg_signals[SNAPPED] =
+        g_signal_new("snapped", ADG_GTK_TYPE_AREA,
+                     G_SIGNAL_RUN_LAST|G_SIGNAL_NO_RECURSE,
+                     G_STRUCT_OFFSET(AdgGtkAreaClass, snapped),
+                     NULL, NULL,
+                     adg_marshal_VOID__FLAGS_POINTER,
+                     G_TYPE_NONE, 2, ADG_TYPE_SNAP, G_TYPE_POINTER);
 }
 
 static void
@@ -656,14 +1597,27 @@ adg_gtk_area_init(AdgGtkArea *area)
     data->factor = 1.05;
     data->autozoom = FALSE;
     cairo_matrix_init_identity(&data->render_map);
+    data->snap = ADG_SNAP_NONE;
+    data->snap_radius = 8.;
+    data->tile_cache = FALSE;
+    data->async_render = FALSE;
+    data->lod_threshold = 0.;
     data->initialized = FALSE;
     data->x_event = 0;
     data->y_event = 0;
-
-    /* Enable GDK events to catch wheel rotation and drag */
+    data->tile_levels = NULL;
+    data->n_tiles = 0;
+    data->tile_sheet.is_defined = FALSE;
+    data->dirty = NULL;
+    data->generation = 0;
+    data->frame = NULL;
+    data->job_cancellable = NULL;
+
+    /* Enable GDK events to catch wheel rotation, drag and snapping */
     gtk_widget_add_events((GtkWidget *) area,
                           GDK_BUTTON_PRESS_MASK |
                           GDK_BUTTON2_MOTION_MASK |
+                          GDK_POINTER_MOTION_MASK |
                           GDK_SCROLL_MASK);
 }
 
@@ -1044,3 +1998,302 @@ adg_gtk_area_extents_changed(AdgGtkArea *area, const CpmlExtents *old_extents)
 
     g_signal_emit(area, _adg_signals[EXTENTS_CHANGED], 0, old_extents);
 }
+
+/**
+ * adg_gtk_area_set_snap:
+ * @area: an #AdgGtkArea
+ * @snap: the kind of points to snap to
+ *
+ * Sets the #AdgGtkArea:snap property of @area to @snap. Use
+ * %ADG_SNAP_NONE to disable the snapping on pointer motion.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_set_snap(AdgGtkArea *area, AdgSnap snap)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "snap", snap, NULL);
+}
+
+/**
+ * adg_gtk_area_get_snap:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the kind of points @area is snapping to.
+ *
+ * Returns: the current #AdgGtkArea:snap value or %ADG_SNAP_NONE on errors.
+ *
+ * Since: 1.0
+ **/
+AdgSnap
+adg_gtk_area_get_snap(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), ADG_SNAP_NONE);
+
+    data = adg_gtk_area_get_instance_private(area);
+    return data->snap;
+}
+
+/**
+ * adg_gtk_area_set_snap_radius:
+ * @area: an #AdgGtkArea
+ * @radius: the new radius, in pixels
+ *
+ * Sets the #AdgGtkArea:snap-radius property of @area to @radius,
+ * that is the max distance between the pointer and a snapped point.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_set_snap_radius(AdgGtkArea *area, gdouble radius)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "snap-radius", radius, NULL);
+}
+
+/**
+ * adg_gtk_area_get_snap_radius:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the snap radius of @area.
+ *
+ * Returns: the current radius (in pixels) or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+gdouble
+adg_gtk_area_get_snap_radius(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), 0.);
+
+    data = adg_gtk_area_get_instance_private(area);
+    return data->snap_radius;
+}
+
+/**
+ * adg_gtk_area_snap:
+ * @area: an #AdgGtkArea
+ * @x: the x coordinate, in widget space
+ * @y: the y coordinate, in widget space
+ * @dest: (out) (allow-none): where to store the snapped point
+ *
+ * Looks for the point of the #AdgStroke entities of the canvas of
+ * @area nearest to (@x, @y), according to the #AdgGtkArea:snap and
+ * #AdgGtkArea:snap-radius properties. Special points have precedence
+ * over the nearest point, as explained in #AdgSnap.
+ *
+ * Every trail is queried with adg_trail_snap() in its own space, so
+ * only the strokes must be traversed. The entities whose extents are
+ * farther than the snap radius from the pointer are skipped, together
+ * with all their children, before any trail is queried. When a point is found and @dest
+ * is not <constant>NULL</constant>, its coordinates (in widget space)
+ * are stored in @dest.
+ *
+ * Returns: the kind of the snapped point or %ADG_SNAP_NONE if nothing has been found.
+ *
+ * Since: 1.0
+ **/
+AdgSnap
+adg_gtk_area_snap(AdgGtkArea *area, gdouble x, gdouble y, CpmlPair *dest)
+{
+    AdgGtkAreaPrivate *data;
+    _AdgSnapData snap_data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), ADG_SNAP_NONE);
+
+    data = adg_gtk_area_get_instance_private(area);
+    if (data->canvas == NULL || data->snap == ADG_SNAP_NONE)
+        return ADG_SNAP_NONE;
+
+    snap_data.render_map = &data->render_map;
+    snap_data.pair.x = x;
+    snap_data.pair.y = y;
+    snap_data.snap = data->snap;
+    snap_data.radius = data->snap_radius;
+    snap_data.distance = 0;
+    snap_data.result = ADG_SNAP_NONE;
+
+    /* The square around the pointer, in the global space of the
+     * entity extents (that is before applying the render map) */
+    if (! _adg_snap_bounds(&data->render_map, x, y, data->snap_radius,
+                           &snap_data.bounds))
+        return ADG_SNAP_NONE;
+
+    _adg_snap_entity((AdgEntity *) data->canvas, &snap_data);
+
+    if (snap_data.result != ADG_SNAP_NONE && dest != NULL)
+        cpml_pair_copy(dest, &snap_data.dest);
+
+    return snap_data.result;
+}
+
+/**
+ * adg_gtk_area_switch_tile_cache:
+ * @area: an #AdgGtkArea
+ * @state: the new tile cache state
+ *
+ * Sets the #AdgGtkArea:tile-cache property of @area to @state.
+ * Disabling the tile cache releases all the cached tiles.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_switch_tile_cache(AdgGtkArea *area, gboolean state)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "tile-cache", state, NULL);
+}
+
+/**
+ * adg_gtk_area_has_tile_cache:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the current state of the #AdgGtkArea:tile-cache property on
+ * the @area object.
+ *
+ * Returns: the current tile cache state
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_gtk_area_has_tile_cache(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), FALSE);
+
+    data = adg_gtk_area_get_instance_private(area);
+    return data->tile_cache;
+}
+
+/**
+ * adg_gtk_area_invalidate_tiles:
+ * @area: an #AdgGtkArea
+ * @extents: (allow-none): the region to invalidate
+ *
+ * Drops the cached tiles of @area overlapping @extents, so they
+ * will be rendered again on the next expose. @extents is expressed
+ * in the same space of adg_entity_get_extents(), that is before
+ * applying the render map. If @extents is <constant>NULL</constant>,
+ * the whole cache is dropped.
+ *
+ * The tiles are automatically invalidated when an entity of the
+ * canvas is invalidated or when its matrices change: this function
+ * is needed only for changes not notified in this way.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_invalidate_tiles(AdgGtkArea *area, const CpmlExtents *extents)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+
+    if (extents == NULL || extents->is_defined)
+        _adg_invalidate_tiles(area, extents);
+}
+
+/**
+ * adg_gtk_area_switch_async_render:
+ * @area: an #AdgGtkArea
+ * @state: the new asynchronous rendering state
+ *
+ * Sets the #AdgGtkArea:async-render property of @area to @state.
+ * Disabling the asynchronous rendering cancels the render in flight,
+ * if any, and releases the last rendered frame.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_switch_async_render(AdgGtkArea *area, gboolean state)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "async-render", state, NULL);
+}
+
+/**
+ * adg_gtk_area_has_async_render:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the current state of the #AdgGtkArea:async-render property
+ * on the @area object.
+ *
+ * Returns: the current asynchronous rendering state
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_gtk_area_has_async_render(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), FALSE);
+
+    data = adg_gtk_area_get_instance_private(area);
+    return data->async_render;
+}
+
+/**
+ * adg_gtk_area_is_rendering:
+ * @area: an #AdgGtkArea
+ *
+ * Checks if a worker thread is rendering a new frame of @area. This
+ * can happen only when #AdgGtkArea:async-render is enabled and can
+ * be used, for example, to show a busy indicator.
+ *
+ * Returns: <constant>TRUE</constant> if a render is in flight, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_gtk_area_is_rendering(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), FALSE);
+
+    data = adg_gtk_area_get_instance_private(area);
+    return data->job_cancellable != NULL;
+}
+
+/**
+ * adg_gtk_area_set_lod_threshold:
+ * @area: an #AdgGtkArea
+ * @threshold: the new threshold, in pixels
+ *
+ * Sets the #AdgGtkArea:lod-threshold property of @area to @threshold.
+ * A @threshold of 0 disables the level of detail.
+ *
+ * Since: 1.0
+ **/
+void
+adg_gtk_area_set_lod_threshold(AdgGtkArea *area, gdouble threshold)
+{
+    g_return_if_fail(ADG_GTK_IS_AREA(area));
+    g_object_set(area, "lod-threshold", threshold, NULL);
+}
+
+/**
+ * adg_gtk_area_get_lod_threshold:
+ * @area: an #AdgGtkArea
+ *
+ * Gets the level of detail threshold of @area.
+ *
+ * Returns: the current threshold (in pixels) or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+gdouble
+adg_gtk_area_get_lod_threshold(AdgGtkArea *area)
+{
+    AdgGtkAreaPrivate *data;
+
+    g_return_val_if_fail(ADG_GTK_IS_AREA(area), 0.);
+
+    data = adg_gtk_area_get_instance_private(area);
+    return data->lod_threshold;
+}
@@ -55,6 +55,9 @@ struct _AdgGtkAreaClass {
     void                (*extents_changed)      (AdgGtkArea     *area,
                                                  const CpmlExtents
                                                                 *old_extents);
+    void                (*snapped)              (AdgGtkArea     *area,
+                                                 AdgSnap         snap,
+                                                 const CpmlPair *pair);
 };
 
 
@@ -88,6 +91,28 @@ const cairo_matrix_t*
 void            adg_gtk_area_extents_changed    (AdgGtkArea      *area,
                                                  const CpmlExtents
                                                                  *old_extents);
+void            adg_gtk_area_set_snap           (AdgGtkArea      *area,
+                                                 AdgSnap          snap);
+AdgSnap         adg_gtk_area_get_snap           (AdgGtkArea      *area);
+void            adg_gtk_area_set_snap_radius    (AdgGtkArea      *area,
+                                                 gdouble          radius);
+gdouble         adg_gtk_area_get_snap_radius    (AdgGtkArea      *area);
+AdgSnap         adg_gtk_area_snap               (AdgGtkArea      *area,
+                                                 gdouble          x,
+                                                 gdouble          y,
+                                                 CpmlPair        *dest);
+void            adg_gtk_area_switch_tile_cache  (AdgGtkArea      *area,
+                                                 gboolean         state);
+gboolean        adg_gtk_area_has_tile_cache     (AdgGtkArea      *area);
+void            adg_gtk_area_invalidate_tiles   (AdgGtkArea      *area,
+                                                 const CpmlExtents *extents);
+void            adg_gtk_area_switch_async_render(AdgGtkArea      *area,
+                                                 gboolean         state);
+gboolean        adg_gtk_area_has_async_render   (AdgGtkArea      *area);
+gboolean        adg_gtk_area_is_rendering       (AdgGtkArea      *area);
+void            adg_gtk_area_set_lod_threshold  (AdgGtkArea      *area,
+                                                 gdouble          threshold);
+gdouble         adg_gtk_area_get_lod_threshold  (AdgGtkArea      *area);
 
 G_END_DECLS
 
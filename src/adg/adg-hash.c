@@ -0,0 +1,639 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/*
+ * Content hashing of entity trees, used by adg_entity_dup_hash().
+ *
+ * The hash of an entity is split in two parts. The own content is
+ * what depends only on the entity: its properties (texts, numbers,
+ * points...) and the path data and named pairs of the models it
+ * refers to. This part is cached by AdgEntity and it is hashed by
+ * _adg_hash_content(). Everything else (matrices, extents, resolved
+ * styles and children) is cheap to collect or cannot be tracked by
+ * the entity itself, so it is hashed again by _adg_hash_entity()
+ * on every call.
+ *
+ * The properties are walked generically, so custom entities are
+ * hashed without any additional code. Properties are sorted by name
+ * and the dresses are hashed by name, so the result does not depend
+ * on the registration order of types and dresses. Values that cannot
+ * be hashed by content, such as opaque boxed types or patterns on
+ * non-image surfaces, make every hash function return FALSE.
+ */
+
+
+#include "adg-internal.h"
+#include <string.h>
+
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-point.h"
+#include "adg-container.h"
+#include "adg-alignment.h"
+#include "adg-marker.h"
+#include "adg-style.h"
+#include "adg-fill-style.h"
+#include "adg-ruled-fill.h"
+#include "adg-dress.h"
+#include "adg-param-dress.h"
+#include "adg-dash.h"
+#include "adg-dim.h"
+#include "adg-ldim.h"
+#include "adg-adim.h"
+#include "adg-rdim.h"
+#include "adg-table.h"
+#include "adg-table-row.h"
+#include "adg-table-cell.h"
+#include "adg-title-block.h"
+#include <adg-canvas.h>
+#include "adg-cairo-fallback.h"
+
+
+/* Nested dresses deeper than this are not followed: it protects
+ * against styles referring, directly or not, to themselves */
+#define _ADG_MAX_STYLE_DEPTH    4
+
+
+typedef struct {
+    GChecksum      *checksum;
+    gboolean        is_hashable;
+} _AdgHashCells;
+
+
+static GParamSpec **    _adg_sorted_properties  (GObject        *object,
+                                                 guint          *n_properties);
+static gint             _adg_compare_properties (gconstpointer   a,
+                                                 gconstpointer   b);
+static gint             _adg_compare_names      (gconstpointer   a,
+                                                 gconstpointer   b);
+static gboolean         _adg_is_hashable        (GParamSpec     *pspec);
+static gboolean         _adg_is_content         (GParamSpec     *pspec);
+static gboolean         _adg_hash_value         (const GValue   *value,
+                                                 GChecksum      *checksum);
+static gboolean         _adg_hash_pattern       (GChecksum      *checksum,
+                                                 cairo_pattern_t *pattern);
+static gboolean         _adg_hash_image         (GChecksum      *checksum,
+                                                 cairo_pattern_t *pattern);
+static void             _adg_hash_model         (AdgModel       *model,
+                                                 GChecksum      *checksum);
+static void             _adg_collect_name       (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 CpmlPair       *pair,
+                                                 GPtrArray      *names);
+static gboolean         _adg_hash_style         (AdgStyle       *style,
+                                                 AdgEntity      *entity,
+                                                 gint            depth,
+                                                 GChecksum      *checksum);
+static gboolean         _adg_hash_dress         (AdgDress        dress,
+                                                 AdgEntity      *entity,
+                                                 gint            depth,
+                                                 GChecksum      *checksum);
+static void             _adg_hash_cell          (AdgTableCell   *table_cell,
+                                                 _AdgHashCells  *cells);
+static gboolean         _adg_dim_parts          (AdgEntity      *entity,
+                                                 AdgTrail      **trail,
+                                                 AdgMarker     **marker1,
+                                                 AdgMarker     **marker2);
+static void             _adg_hash_string        (GChecksum      *checksum,
+                                                 const gchar    *string);
+static void             _adg_hash_doubles       (GChecksum      *checksum,
+                                                 const gdouble  *doubles,
+                                                 gsize           n_doubles);
+static void             _adg_hash_pair          (GChecksum      *checksum,
+                                                 const CpmlPair *pair);
+static void             _adg_hash_matrix        (GChecksum      *checksum,
+                                                 const cairo_matrix_t *matrix);
+
+
+gboolean
+_adg_hash_entity(AdgEntity *entity, GChecksum *checksum)
+{
+    const CpmlExtents *extents;
+    GParamSpec **properties;
+    guint n, n_properties;
+    AdgTrail *trail;
+    AdgMarker *marker1, *marker2;
+    gboolean is_hashable;
+
+    _adg_hash_string(checksum, G_OBJECT_TYPE_NAME(entity));
+    _adg_hash_matrix(checksum, adg_entity_get_global_matrix(entity));
+    _adg_hash_matrix(checksum, adg_entity_get_local_matrix(entity));
+
+    extents = adg_entity_get_extents(entity);
+    if (extents->is_defined) {
+        _adg_hash_pair(checksum, &extents->org);
+        _adg_hash_pair(checksum, &extents->size);
+    }
+
+    is_hashable = _adg_entity_hash_content(entity, checksum);
+
+    /* Dresses and entities referenced by the properties */
+    properties = _adg_sorted_properties((GObject *) entity, &n_properties);
+    for (n = 0; n < n_properties; ++n) {
+        GParamSpec *pspec = properties[n];
+        GValue value = G_VALUE_INIT;
+
+        if (! _adg_is_hashable(pspec) || _adg_is_content(pspec))
+            continue;
+
+        g_value_init(&value, pspec->value_type);
+        g_object_get_property((GObject *) entity, pspec->name, &value);
+        _adg_hash_string(checksum, pspec->name);
+
+        if (ADG_IS_PARAM_DRESS(pspec)) {
+            is_hashable &= _adg_hash_dress(g_value_get_enum(&value),
+                                           entity, 0, checksum);
+        } else if (g_value_get_object(&value) != NULL) {
+            is_hashable &= _adg_hash_entity(g_value_get_object(&value),
+                                            checksum);
+        }
+
+        g_value_unset(&value);
+    }
+    g_free(properties);
+
+    /* Children not exposed as properties */
+    if (ADG_IS_CONTAINER(entity)) {
+        GSList *children, *child;
+
+        children = adg_container_children((AdgContainer *) entity);
+        for (child = children; child != NULL; child = child->next)
+            is_hashable &= _adg_hash_entity(child->data, checksum);
+        g_slist_free(children);
+    }
+
+    if (ADG_IS_TABLE(entity)) {
+        _AdgHashCells cells;
+
+        cells.checksum = checksum;
+        cells.is_hashable = TRUE;
+        adg_table_foreach_cell((AdgTable *) entity,
+                               G_CALLBACK(_adg_hash_cell), &cells);
+        is_hashable &= cells.is_hashable;
+    }
+
+    if (ADG_IS_DIM(entity)) {
+        AdgAlignment *quote = adg_dim_get_quote((AdgDim *) entity);
+        if (quote != NULL)
+            is_hashable &= _adg_hash_entity((AdgEntity *) quote, checksum);
+    }
+
+    if (_adg_dim_parts(entity, &trail, &marker1, &marker2)) {
+        if (marker1 != NULL)
+            is_hashable &= _adg_hash_entity((AdgEntity *) marker1, checksum);
+        if (marker2 != NULL)
+            is_hashable &= _adg_hash_entity((AdgEntity *) marker2, checksum);
+    }
+
+    return is_hashable;
+}
+
+gboolean
+_adg_hash_content(AdgEntity *entity, GChecksum *checksum)
+{
+    GParamSpec **properties;
+    guint n, n_properties;
+    AdgTrail *trail;
+    AdgMarker *marker1, *marker2;
+    gboolean is_hashable;
+
+    is_hashable = TRUE;
+
+    properties = _adg_sorted_properties((GObject *) entity, &n_properties);
+    for (n = 0; n < n_properties; ++n) {
+        GParamSpec *pspec = properties[n];
+        GValue value = G_VALUE_INIT;
+
+        if (! _adg_is_hashable(pspec) || ! _adg_is_content(pspec))
+            continue;
+
+        g_value_init(&value, pspec->value_type);
+        g_object_get_property((GObject *) entity, pspec->name, &value);
+        _adg_hash_string(checksum, pspec->name);
+        is_hashable &= _adg_hash_value(&value, checksum);
+        g_value_unset(&value);
+    }
+    g_free(properties);
+
+    /* The dimension lines are built while arranging */
+    if (_adg_dim_parts(entity, &trail, &marker1, &marker2) && trail != NULL)
+        _adg_hash_model((AdgModel *) trail, checksum);
+
+    return is_hashable;
+}
+
+
+static GParamSpec **
+_adg_sorted_properties(GObject *object, guint *n_properties)
+{
+    GParamSpec **properties;
+
+    properties = g_object_class_list_properties(G_OBJECT_GET_CLASS(object),
+                                                n_properties);
+    qsort(properties, *n_properties, sizeof(GParamSpec *),
+          _adg_compare_properties);
+
+    return properties;
+}
+
+static gint
+_adg_compare_properties(gconstpointer a, gconstpointer b)
+{
+    const GParamSpec *pspec1 = *(const GParamSpec **) a;
+    const GParamSpec *pspec2 = *(const GParamSpec **) b;
+
+    return strcmp(pspec1->name, pspec2->name);
+}
+
+static gint
+_adg_compare_names(gconstpointer a, gconstpointer b)
+{
+    return strcmp(*(const gchar **) a, *(const gchar **) b);
+}
+
+static gboolean
+_adg_is_hashable(GParamSpec *pspec)
+{
+    /* The AdgEntity properties are either hashed explicitely
+     * (the maps, through the matrices) or must not be followed
+     * (the parent). The cache directory does not change the
+     * drawing, so it must not change the hash either */
+    if (pspec->owner_type == ADG_TYPE_CANVAS &&
+        strcmp(pspec->name, "cache-dir") == 0)
+        return FALSE;
+
+    return pspec->owner_type != ADG_TYPE_ENTITY &&
+           (pspec->flags & G_PARAM_READABLE) != 0;
+}
+
+/* Checks if the value of @pspec is part of the own content of the
+ * entity, i.e. it can be cached until the entity changes: resolved
+ * styles and referenced entities can change without notice */
+static gboolean
+_adg_is_content(GParamSpec *pspec)
+{
+    return ! ADG_IS_PARAM_DRESS(pspec) &&
+           ! g_type_is_a(pspec->value_type, ADG_TYPE_ENTITY);
+}
+
+/* Returns FALSE if @value cannot be hashed by content */
+static gboolean
+_adg_hash_value(const GValue *value, GChecksum *checksum)
+{
+    GType type = G_VALUE_TYPE(value);
+    gdouble number;
+
+    if (G_VALUE_HOLDS_DOUBLE(value)) {
+        number = g_value_get_double(value);
+        _adg_hash_doubles(checksum, &number, 1);
+    } else if (G_VALUE_HOLDS_FLOAT(value)) {
+        number = g_value_get_float(value);
+        _adg_hash_doubles(checksum, &number, 1);
+    } else if (G_VALUE_HOLDS_STRING(value)) {
+        _adg_hash_string(checksum, g_value_get_string(value));
+    } else if (G_VALUE_HOLDS_OBJECT(value)) {
+        GObject *object = g_value_get_object(value);
+
+        if (ADG_IS_MODEL(object))
+            _adg_hash_model((AdgModel *) object, checksum);
+        else if (object != NULL)
+            _adg_hash_string(checksum, G_OBJECT_TYPE_NAME(object));
+    } else if (G_VALUE_HOLDS_BOXED(value)) {
+        gpointer boxed = g_value_get_boxed(value);
+
+        if (boxed == NULL) {
+            _adg_hash_string(checksum, NULL);
+        } else if (type == CPML_TYPE_PAIR) {
+            _adg_hash_pair(checksum, boxed);
+        } else if (type == ADG_TYPE_POINT) {
+            _adg_hash_pair(checksum, adg_point_get_pair(boxed));
+        } else if (type == ADG_TYPE_DASH) {
+            _adg_hash_doubles(checksum, adg_dash_get_dashes(boxed),
+                              adg_dash_get_num_dashes(boxed));
+            number = adg_dash_get_offset(boxed);
+            _adg_hash_doubles(checksum, &number, 1);
+        } else if (type == G_TYPE_STRV) {
+            gchar **strings;
+
+            for (strings = boxed; *strings != NULL; ++strings)
+                _adg_hash_string(checksum, *strings);
+        } else if (type == CAIRO_GOBJECT_TYPE_MATRIX) {
+            _adg_hash_matrix(checksum, boxed);
+        } else if (type == CAIRO_GOBJECT_TYPE_PATTERN) {
+            return _adg_hash_pattern(checksum, boxed);
+        } else {
+            /* Unknown boxed types are opaque */
+            return FALSE;
+        }
+    } else if (G_VALUE_HOLDS_POINTER(value)) {
+        /* Addresses change on every run: skip them */
+    } else {
+        /* Integers, booleans, enums and flags have a stable
+         * and lossless textual representation */
+        gchar *contents = g_strdup_value_contents(value);
+        _adg_hash_string(checksum, contents);
+        g_free(contents);
+    }
+
+    return TRUE;
+}
+
+/* Solid colors, gradients and image surfaces are hashed by content.
+ * Any other surface cannot be read back without rendering it, so the
+ * pattern is reported as not hashable */
+static gboolean
+_adg_hash_pattern(GChecksum *checksum, cairo_pattern_t *pattern)
+{
+    cairo_pattern_type_t type;
+    cairo_matrix_t matrix;
+    gdouble values[6];
+    gint n, n_stops;
+    gchar *settings;
+
+    type = cairo_pattern_get_type(pattern);
+    cairo_pattern_get_matrix(pattern, &matrix);
+    settings = g_strdup_printf("%d %d %d", type,
+                               cairo_pattern_get_extend(pattern),
+                               cairo_pattern_get_filter(pattern));
+    _adg_hash_string(checksum, settings);
+    _adg_hash_matrix(checksum, &matrix);
+    g_free(settings);
+
+    switch (type) {
+    case CAIRO_PATTERN_TYPE_SOLID:
+        cairo_pattern_get_rgba(pattern, &values[0], &values[1],
+                               &values[2], &values[3]);
+        _adg_hash_doubles(checksum, values, 4);
+        return TRUE;
+    case CAIRO_PATTERN_TYPE_LINEAR:
+        cairo_pattern_get_linear_points(pattern, &values[0], &values[1],
+                                        &values[2], &values[3]);
+        _adg_hash_doubles(checksum, values, 4);
+        break;
+    case CAIRO_PATTERN_TYPE_RADIAL:
+        cairo_pattern_get_radial_circles(pattern, &values[0], &values[1],
+                                         &values[2], &values[3],
+                                         &values[4], &values[5]);
+        _adg_hash_doubles(checksum, values, 6);
+        break;
+    case CAIRO_PATTERN_TYPE_SURFACE:
+        return _adg_hash_image(checksum, pattern);
+    default:
+        return FALSE;
+    }
+
+    /* Gradient color stops */
+    cairo_pattern_get_color_stop_count(pattern, &n_stops);
+    for (n = 0; n < n_stops; ++n) {
+        cairo_pattern_get_color_stop_rgba(pattern, n, &values[0],
+                                          &values[1], &values[2],
+                                          &values[3], &values[4]);
+        _adg_hash_doubles(checksum, values, 5);
+    }
+
+    return TRUE;
+}
+
+static gboolean
+_adg_hash_image(GChecksum *checksum, cairo_pattern_t *pattern)
+{
+    cairo_surface_t *surface;
+    cairo_format_t format;
+    const guchar *row;
+    gint n, width, height, stride;
+    gsize row_size;
+    gchar *settings;
+
+    cairo_pattern_get_surface(pattern, &surface);
+    if (cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE)
+        return FALSE;
+
+    cairo_surface_flush(surface);
+    format = cairo_image_surface_get_format(surface);
+    width = cairo_image_surface_get_width(surface);
+    height = cairo_image_surface_get_height(surface);
+    stride = cairo_image_surface_get_stride(surface);
+    row = cairo_image_surface_get_data(surface);
+
+    /* Only the pixels are hashed: the padding at the end
+     * of every row is not initialized */
+    switch (format) {
+    case CAIRO_FORMAT_ARGB32:
+    case CAIRO_FORMAT_RGB24:
+        row_size = width * 4;
+        break;
+    case CAIRO_FORMAT_A8:
+        row_size = width;
+        break;
+    case CAIRO_FORMAT_A1:
+        row_size = (width + 7) / 8;
+        break;
+    default:
+        return FALSE;
+    }
+
+    if (row == NULL)
+        return FALSE;
+
+    settings = g_strdup_printf("%d %d %d", format, width, height);
+    _adg_hash_string(checksum, settings);
+    g_free(settings);
+
+    for (n = 0; n < height; ++n, row += stride)
+        g_checksum_update(checksum, row, row_size);
+
+    return TRUE;
+}
+
+static void
+_adg_hash_model(AdgModel *model, GChecksum *checksum)
+{
+    GPtrArray *names;
+    guint n;
+
+    _adg_hash_string(checksum, G_OBJECT_TYPE_NAME(model));
+
+    if (ADG_IS_TRAIL(model)) {
+        const cairo_path_t *cairo_path;
+
+        cairo_path = adg_trail_get_cairo_path((AdgTrail *) model);
+        if (cairo_path != NULL)
+            g_checksum_update(checksum, (const guchar *) cairo_path->data,
+                              sizeof(cairo_path_data_t) * cairo_path->num_data);
+    }
+
+    /* The named pairs are stored in an hash table: sort them by name */
+    names = g_ptr_array_new();
+    adg_model_foreach_named_pair(model,
+                                 (AdgNamedPairFunc) _adg_collect_name, names);
+    g_ptr_array_sort(names, (GCompareFunc) _adg_compare_names);
+
+    for (n = 0; n < names->len; ++n) {
+        const gchar *name = g_ptr_array_index(names, n);
+
+        _adg_hash_string(checksum, name);
+        _adg_hash_pair(checksum, adg_model_get_named_pair(model, name));
+    }
+
+    g_ptr_array_free(names, TRUE);
+}
+
+static void
+_adg_collect_name(AdgModel *model, const gchar *name,
+                  CpmlPair *pair, GPtrArray *names)
+{
+    g_ptr_array_add(names, (gpointer) name);
+}
+
+static gboolean
+_adg_hash_style(AdgStyle *style, AdgEntity *entity,
+                gint depth, GChecksum *checksum)
+{
+    GParamSpec **properties;
+    guint n, n_properties;
+    gboolean is_hashable;
+
+    is_hashable = TRUE;
+
+    _adg_hash_string(checksum, G_OBJECT_TYPE_NAME(style));
+
+    properties = _adg_sorted_properties((GObject *) style, &n_properties);
+    for (n = 0; n < n_properties; ++n) {
+        GParamSpec *pspec = properties[n];
+        GValue value = G_VALUE_INIT;
+
+        if ((pspec->flags & G_PARAM_READABLE) == 0)
+            continue;
+
+        /* The pattern of a ruled fill is generated while rendering
+         * from the other properties: hashing it would only change
+         * the hash after the first rendering */
+        if (ADG_IS_RULED_FILL(style) &&
+            pspec->owner_type == ADG_TYPE_FILL_STYLE &&
+            strcmp(pspec->name, "pattern") == 0)
+            continue;
+
+        g_value_init(&value, pspec->value_type);
+        g_object_get_property((GObject *) style, pspec->name, &value);
+        _adg_hash_string(checksum, pspec->name);
+
+        /* Nested dresses are resolved in the context of the entity */
+        if (ADG_IS_PARAM_DRESS(pspec))
+            is_hashable &= _adg_hash_dress(g_value_get_enum(&value), entity,
+                                           depth + 1, checksum);
+        else
+            is_hashable &= _adg_hash_value(&value, checksum);
+
+        g_value_unset(&value);
+    }
+    g_free(properties);
+
+    return is_hashable;
+}
+
+static gboolean
+_adg_hash_dress(AdgDress dress, AdgEntity *entity,
+                gint depth, GChecksum *checksum)
+{
+    AdgStyle *style;
+
+    _adg_hash_string(checksum, adg_dress_get_name(dress));
+
+    if (depth > _ADG_MAX_STYLE_DEPTH)
+        return TRUE;
+
+    style = adg_entity_style(entity, dress);
+    if (style == NULL)
+        return TRUE;
+
+    return _adg_hash_style(style, entity, depth, checksum);
+}
+
+static void
+_adg_hash_cell(AdgTableCell *table_cell, _AdgHashCells *cells)
+{
+    GChecksum *checksum = cells->checksum;
+    AdgEntity *title, *value;
+    gdouble width;
+
+    width = adg_table_cell_get_width(table_cell);
+    _adg_hash_doubles(checksum, &width, 1);
+    _adg_hash_string(checksum, adg_table_cell_has_frame(table_cell) ? "F" : "");
+
+    title = adg_table_cell_title(table_cell);
+    if (title != NULL)
+        cells->is_hashable &= _adg_hash_entity(title, checksum);
+
+    value = adg_table_cell_value(table_cell);
+    if (value != NULL)
+        cells->is_hashable &= _adg_hash_entity(value, checksum);
+}
+
+static gboolean
+_adg_dim_parts(AdgEntity *entity, AdgTrail **trail,
+               AdgMarker **marker1, AdgMarker **marker2)
+{
+    if (ADG_IS_LDIM(entity))
+        _adg_ldim_get_lines((AdgLDim *) entity, trail, marker1, marker2);
+    else if (ADG_IS_ADIM(entity))
+        _adg_adim_get_lines((AdgADim *) entity, trail, marker1, marker2);
+    else if (ADG_IS_RDIM(entity))
+        _adg_rdim_get_lines((AdgRDim *) entity, trail, marker1, marker2);
+    else
+        return FALSE;
+
+    return TRUE;
+}
+
+/* Strings are hashed with their terminating zero, so adjacent
+ * strings cannot be confused; NULL is hashed as a lone 0xFF */
+static void
+_adg_hash_string(GChecksum *checksum, const gchar *string)
+{
+    static const guchar null_string = 0xFF;
+
+    if (string == NULL)
+        g_checksum_update(checksum, &null_string, 1);
+    else
+        g_checksum_update(checksum, (const guchar *) string, strlen(string) + 1);
+}
+
+static void
+_adg_hash_doubles(GChecksum *checksum, const gdouble *doubles, gsize n_doubles)
+{
+    if (n_doubles > 0)
+        g_checksum_update(checksum, (const guchar *) doubles,
+                          sizeof(gdouble) * n_doubles);
+}
+
+static void
+_adg_hash_pair(GChecksum *checksum, const CpmlPair *pair)
+{
+    if (pair == NULL)
+        _adg_hash_string(checksum, NULL);
+    else
+        _adg_hash_doubles(checksum, &pair->x, 2);
+}
+
+static void
+_adg_hash_matrix(GChecksum *checksum, const cairo_matrix_t *matrix)
+{
+    _adg_hash_doubles(checksum, &matrix->xx, 6);
+}
@@ -85,6 +85,7 @@ adg_hatch_class_init(AdgHatchClass *klass)
     gobject_class->set_property = _adg_set_property;
 
     entity_class->render = _adg_render;
+    entity_class->lod_policy = ADG_LOD_POLICY_DETAIL;
 
     param = adg_param_spec_dress("fill-dress",
                                  P_("Fill Dress"),
@@ -218,7 +219,6 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
         cairo_append_path(cr, cairo_path);
         cairo_restore(cr);
 
-        adg_style_apply((AdgStyle *) fill_style, entity, cr);
-        cairo_fill(cr);
+        adg_fill_style_fill(fill_style, entity, cr);
     }
 }
@@ -0,0 +1,357 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-instance
+ * @short_description: A placement of a shared entity
+ *
+ * The #AdgInstance entity renders another entity, the source,
+ * at a different placement. Many instances can share the same
+ * source: this is the ADG equivalent of a DXF block insert and
+ * it is especially useful for repeated features, e.g. the holes
+ * of a bolt pattern or the same symbol placed in different spots.
+ *
+ * The source is arranged once in its own global space, regardless
+ * of the number of instances referring to it. Every instance then
+ * applies its own global matrix on top of that result: the extents
+ * of an instance are the source extents transformed by the global
+ * matrix of the instance and, when the recording surface is
+ * available in cairo, the rendering is a replay of the output
+ * of the source recorded the first time it is needed.
+ *
+ * The recorded output is cleared whenever the source is
+ * invalidated, so any change to the source (or to the models it
+ * depends on) is automatically reflected by all its instances.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgInstance:
+ *
+ * All fields are private and should not be used directly.
+ * Use its public methods instead.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+
+#include "adg-instance.h"
+#include "adg-instance-private.h"
+
+#define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_instance_parent_class)
+#define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_instance_parent_class)
+
+
+G_DEFINE_TYPE_WITH_PRIVATE(AdgInstance, adg_instance, ADG_TYPE_ENTITY)
+
+enum {
+    PROP_0,
+    PROP_SOURCE
+};
+
+
+static void             _adg_dispose            (GObject        *object);
+static void             _adg_get_property       (GObject        *object,
+                                                 guint           param_id,
+                                                 GValue         *value,
+                                                 GParamSpec     *pspec);
+static void             _adg_set_property       (GObject        *object,
+                                                 guint           param_id,
+                                                 const GValue   *value,
+                                                 GParamSpec     *pspec);
+static void             _adg_global_changed     (AdgEntity      *entity);
+static void             _adg_arrange            (AdgEntity      *entity);
+static void             _adg_render             (AdgEntity      *entity,
+                                                 cairo_t        *cr);
+static void             _adg_source_invalidated (AdgEntity      *source,
+                                                 AdgInstance    *instance);
+#ifdef CAIRO_HAS_RECORDING_SURFACE
+static GQuark           _adg_record_quark       (void);
+static cairo_surface_t *_adg_record             (AdgEntity      *source);
+#endif
+
+
+static void
+adg_instance_class_init(AdgInstanceClass *klass)
+{
+    GObjectClass *gobject_class;
+    AdgEntityClass *entity_class;
+    GParamSpec *param;
+
+    gobject_class = (GObjectClass *) klass;
+    entity_class = (AdgEntityClass *) klass;
+
+    gobject_class->dispose = _adg_dispose;
+    gobject_class->get_property = _adg_get_property;
+    gobject_class->set_property = _adg_set_property;
+
+    entity_class->global_changed = _adg_global_changed;
+    entity_class->arrange = _adg_arrange;
+    entity_class->render = _adg_render;
+
+    param = g_param_spec_object("source",
+                                P_("Source"),
+                                P_("The entity to be placed by this instance"),
+                                ADG_TYPE_ENTITY,
+                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+    g_object_class_install_property(gobject_class, PROP_SOURCE, param);
+}
+
+static void
+adg_instance_init(AdgInstance *instance)
+{
+    AdgInstancePrivate *data = adg_instance_get_instance_private(instance);
+    data->source = NULL;
+    data->invalidate_handler = 0;
+}
+
+static void
+_adg_dispose(GObject *object)
+{
+    AdgInstance *instance = (AdgInstance *) object;
+
+    adg_instance_set_source(instance, NULL);
+
+    if (_ADG_OLD_OBJECT_CLASS->dispose)
+        _ADG_OLD_OBJECT_CLASS->dispose(object);
+}
+
+static void
+_adg_get_property(GObject *object, guint prop_id,
+                  GValue *value, GParamSpec *pspec)
+{
+    AdgInstancePrivate *data = adg_instance_get_instance_private((AdgInstance *) object);
+
+    switch (prop_id) {
+    case PROP_SOURCE:
+        g_value_set_object(value, data->source);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+_adg_set_property(GObject *object, guint prop_id,
+                  const GValue *value, GParamSpec *pspec)
+{
+    AdgInstancePrivate *data = adg_instance_get_instance_private((AdgInstance *) object);
+    AdgEntity *old_source;
+
+    switch (prop_id) {
+    case PROP_SOURCE:
+        old_source = data->source;
+        data->source = g_value_get_object(value);
+
+        if (data->source != old_source) {
+            if (old_source != NULL) {
+                g_signal_handler_disconnect(old_source,
+                                            data->invalidate_handler);
+                data->invalidate_handler = 0;
+                g_object_unref(old_source);
+            }
+            if (data->source != NULL) {
+                g_object_ref_sink(data->source);
+                data->invalidate_handler =
+                    g_signal_connect(data->source, "invalidate",
+                                     G_CALLBACK(_adg_source_invalidated),
+                                     object);
+            }
+            adg_entity_invalidate((AdgEntity *) object);
+        }
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+
+/**
+ * adg_instance_new:
+ * @source: (allow-none): the #AdgEntity to be placed
+ *
+ * Creates a new instance entity placing @source. @source can be
+ * <constant>NULL</constant>, in which case an empty instance is
+ * created. The source is not reparented, so the same entity can
+ * be used by any number of instances.
+ *
+ * Returns: the newly created instance entity
+ *
+ * Since: 1.0
+ **/
+AdgInstance *
+adg_instance_new(AdgEntity *source)
+{
+    return g_object_new(ADG_TYPE_INSTANCE, "source", source, NULL);
+}
+
+/**
+ * adg_instance_set_source:
+ * @instance:                             an #AdgInstance
+ * @source: (allow-none) (transfer none): the new #AdgEntity to place
+ *
+ * Sets @source as the new entity placed by @instance. @instance
+ * keeps a reference to @source until another source is set or
+ * @instance is destroyed. If @source is floating, its floating
+ * reference is sunk by @instance.
+ *
+ * Since: 1.0
+ **/
+void
+adg_instance_set_source(AdgInstance *instance, AdgEntity *source)
+{
+    g_return_if_fail(ADG_IS_INSTANCE(instance));
+    g_object_set(instance, "source", source, NULL);
+}
+
+/**
+ * adg_instance_get_source:
+ * @instance: an #AdgInstance
+ *
+ * Gets the entity placed by @instance. The returned entity is
+ * shared between all the instances referring to it and should
+ * not be freed.
+ *
+ * Returns: (transfer none): the requested #AdgEntity or <constant>NULL</constant> on no source or errors.
+ *
+ * Since: 1.0
+ **/
+AdgEntity *
+adg_instance_get_source(AdgInstance *instance)
+{
+    AdgInstancePrivate *data;
+
+    g_return_val_if_fail(ADG_IS_INSTANCE(instance), NULL);
+
+    data = adg_instance_get_instance_private(instance);
+    return data->source;
+}
+
+
+static void
+_adg_global_changed(AdgEntity *entity)
+{
+    if (_ADG_OLD_ENTITY_CLASS->global_changed)
+        _ADG_OLD_ENTITY_CLASS->global_changed(entity);
+
+    adg_entity_invalidate(entity);
+}
+
+static void
+_adg_arrange(AdgEntity *entity)
+{
+    AdgInstancePrivate *data;
+    const CpmlExtents *source_extents;
+    CpmlExtents extents;
+
+    /* Check for cached result */
+    if (adg_entity_get_extents(entity)->is_defined)
+        return;
+
+    data = adg_instance_get_instance_private((AdgInstance *) entity);
+    if (data->source == NULL)
+        return;
+
+    /* The source is arranged only once: the other instances
+     * sharing it will find its extents already defined */
+    source_extents = adg_entity_get_extents(data->source);
+    if (! source_extents->is_defined) {
+        adg_entity_arrange(data->source);
+        source_extents = adg_entity_get_extents(data->source);
+        if (! source_extents->is_defined)
+            return;
+    }
+
+    cpml_extents_copy(&extents, source_extents);
+    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+    adg_entity_set_extents(entity, &extents);
+}
+
+static void
+_adg_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgInstancePrivate *data = adg_instance_get_instance_private((AdgInstance *) entity);
+
+    if (data->source == NULL)
+        return;
+
+    cairo_transform(cr, adg_entity_get_global_matrix(entity));
+
+#ifdef CAIRO_HAS_RECORDING_SURFACE
+    cairo_set_source_surface(cr, _adg_record(data->source), 0, 0);
+    cairo_paint(cr);
+#else
+    adg_entity_render(data->source, cr);
+#endif
+}
+
+static void
+_adg_source_invalidated(AdgEntity *source, AdgInstance *instance)
+{
+#ifdef CAIRO_HAS_RECORDING_SURFACE
+    /* Drop the recorded output: it will be regenerated on demand */
+    g_object_set_qdata((GObject *) source, _adg_record_quark(), NULL);
+#endif
+    adg_entity_invalidate((AdgEntity *) instance);
+}
+
+#ifdef CAIRO_HAS_RECORDING_SURFACE
+
+static GQuark
+_adg_record_quark(void)
+{
+    static GQuark quark;
+
+    if G_UNLIKELY (quark == 0)
+        quark = g_quark_from_static_string("adg-instance-record");
+
+    return quark;
+}
+
+static cairo_surface_t *
+_adg_record(AdgEntity *source)
+{
+    GObject *object = (GObject *) source;
+    GQuark quark = _adg_record_quark();
+    cairo_surface_t *record = g_object_get_qdata(object, quark);
+
+    if (record == NULL) {
+        cairo_t *cr;
+
+        /* The recording is owned by the source, so it is shared
+         * between all the instances and destroyed with it */
+        record = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+        cr = cairo_create(record);
+        adg_entity_render(source, cr);
+        cairo_destroy(cr);
+
+        g_object_set_qdata_full(object, quark, record,
+                                (GDestroyNotify) cairo_surface_destroy);
+    }
+
+    return record;
+}
+
+#endif
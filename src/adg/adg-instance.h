@@ -0,0 +1,64 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_INSTANCE_H__
+#define __ADG_INSTANCE_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_TYPE_INSTANCE             (adg_instance_get_type())
+#define ADG_INSTANCE(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), ADG_TYPE_INSTANCE, AdgInstance))
+#define ADG_INSTANCE_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), ADG_TYPE_INSTANCE, AdgInstanceClass))
+#define ADG_IS_INSTANCE(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), ADG_TYPE_INSTANCE))
+#define ADG_IS_INSTANCE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), ADG_TYPE_INSTANCE))
+#define ADG_INSTANCE_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), ADG_TYPE_INSTANCE, AdgInstanceClass))
+
+typedef struct _AdgInstance        AdgInstance;
+typedef struct _AdgInstanceClass   AdgInstanceClass;
+
+struct _AdgInstance {
+    /*< private >*/
+    AdgEntity           parent;
+};
+
+struct _AdgInstanceClass {
+    /*< private >*/
+    AdgEntityClass      parent_class;
+};
+
+
+GType           adg_instance_get_type           (void);
+
+AdgInstance *   adg_instance_new                (AdgEntity      *source);
+
+void            adg_instance_set_source         (AdgInstance    *instance,
+                                                 AdgEntity      *source);
+AdgEntity *     adg_instance_get_source         (AdgInstance    *instance);
+
+G_END_DECLS
+
+
+#endif /* __ADG_INSTANCE_H__ */
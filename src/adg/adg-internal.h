@@ -92,5 +92,109 @@ const gchar *           _adg_dpgettext  (const gchar *domain,
                                          const gchar *msgctxtid,
                                          gsize        msgidoffset) G_GNUC_FORMAT(2);
 
+/* Defined in adg-entity.c: must be called whenever a fallback style
+ * changes, to clear the styles resolved by every entity */
+void                    _adg_entity_styles_changed
+                                        (void);
+
+/* Defined in adg-entity.c: append to @checksum the digest of the own
+ * content of @entity, computed by _adg_hash_content() and cached
+ * until @entity is invalidated or one of its properties changes.
+ * Returns FALSE if the content cannot be hashed */
+gboolean                _adg_entity_hash_content
+                                        (AdgEntity      *entity,
+                                         GChecksum      *checksum);
+
+/* Defined in adg-entity.c: call @callback on every style overriden
+ * with adg_entity_set_style(), passing the dress (packed with
+ * GINT_TO_POINTER()) as key and the #AdgStyle as value */
+void                    _adg_entity_foreach_style
+                                        (AdgEntity      *entity,
+                                         GHFunc          callback,
+                                         gpointer        user_data);
+
+/* Defined in adg-hash.c: append to @checksum the hash of @entity and
+ * its children (_adg_hash_entity()) or only of its own content, that
+ * is the part that does not depend on styles and children
+ * (_adg_hash_content()). Both return FALSE if something (e.g. a
+ * pattern on a non-image surface) cannot be hashed by content */
+gboolean                _adg_hash_entity
+                                        (AdgEntity      *entity,
+                                         GChecksum      *checksum);
+gboolean                _adg_hash_content
+                                        (AdgEntity      *entity,
+                                         GChecksum      *checksum);
+
+/* Defined in adg-entity.c: when TRUE, the "global-changed" and
+ * "local-changed" signals must not be propagated to the children */
+gboolean                _adg_entity_lazy_matrices
+                                        (void);
+
+/* Defined in adg-entity.c: a bitmask of the global switches changing
+ * the rendered output, i.e. adg_switch_extents() (bit 0) and
+ * adg_switch_batching() (bit 1) */
+guint                   _adg_entity_render_switches
+                                        (void);
+
+/* Defined in adg-entity.c: adg_entity_stroke_path() on a @path in the
+ * current user space of @cr that is owned, and eventually destroyed,
+ * by the entity batch */
+void                    _adg_entity_stroke_owned_path
+                                        (AdgEntity      *entity,
+                                         AdgDress        dress,
+                                         cairo_path_t   *path,
+                                         cairo_t        *cr);
+
+/* Defined in adg-entity.c: render the strokes deferred by the batch,
+ * if any, before drawing directly on @cr. The current path of @cr
+ * is preserved */
+void                    _adg_entity_flush_strokes
+                                        (cairo_t        *cr);
+
+/* The internal API below refers to these types without
+ * including their headers, so they must be declared here */
+struct _AdgModel;
+struct _AdgTrail;
+struct _AdgMarker;
+struct _AdgLDim;
+struct _AdgADim;
+struct _AdgRDim;
+
+/* Defined in adg-model.c: track the named pairs an entity is bound to
+ * through its points, so an update can invalidate only the entities
+ * bound to the named pairs that have been actually moved */
+void                    _adg_model_bind_pair
+                                        (struct _AdgModel *model,
+                                         const gchar      *name,
+                                         AdgEntity        *entity);
+void                    _adg_model_unbind_pair
+                                        (struct _AdgModel *model,
+                                         const gchar      *name,
+                                         AdgEntity        *entity);
+void                    _adg_model_begin_update
+                                        (struct _AdgModel *model);
+GSList *                _adg_model_end_update
+                                        (struct _AdgModel *model,
+                                         gboolean          data_changed);
+
+/* Defined in adg-ldim.c, adg-adim.c and adg-rdim.c: get the trail
+ * of the dimension lines and the markers (any of them can be NULL),
+ * so the exporters can write a dimension piece by piece */
+void                    _adg_ldim_get_lines
+                                        (struct _AdgLDim    *ldim,
+                                         struct _AdgTrail  **trail,
+                                         struct _AdgMarker **marker1,
+                                         struct _AdgMarker **marker2);
+void                    _adg_adim_get_lines
+                                        (struct _AdgADim    *adim,
+                                         struct _AdgTrail  **trail,
+                                         struct _AdgMarker **marker1,
+                                         struct _AdgMarker **marker2);
+void                    _adg_rdim_get_lines
+                                        (struct _AdgRDim    *rdim,
+                                         struct _AdgTrail  **trail,
+                                         struct _AdgMarker **marker1,
+                                         struct _AdgMarker **marker2);
+
 
 #endif /* __ADG_INTERNAL_H__ */
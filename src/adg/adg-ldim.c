@@ -494,6 +494,17 @@ adg_ldim_has_extension2(AdgLDim *ldim)
 }
 
 
+void
+_adg_ldim_get_lines(AdgLDim *ldim, AdgTrail **trail,
+                    AdgMarker **marker1, AdgMarker **marker2)
+{
+    AdgLDimPrivate *data = adg_ldim_get_instance_private(ldim);
+
+    *trail = data->trail;
+    *marker1 = data->marker1;
+    *marker2 = data->marker2;
+}
+
 static void
 _adg_global_changed(AdgEntity *entity)
 {
@@ -504,10 +515,10 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    if (data->marker1)
+    if (data->marker1 && ! _adg_entity_lazy_matrices())
         adg_entity_global_changed((AdgEntity *) data->marker1);
 
-    if (data->marker2)
+    if (data->marker2 && ! _adg_entity_lazy_matrices())
         adg_entity_global_changed((AdgEntity *) data->marker2);
 }
 
@@ -696,11 +707,10 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 
     cairo_transform(cr, adg_entity_get_global_matrix(entity));
     dress = adg_dim_style_get_line_dress(dim_style);
-    adg_entity_apply_dress(entity, dress, cr);
 
+    /* The local matrix has already been applied to the trail */
     cairo_path = adg_trail_get_cairo_path(data->trail);
-    cairo_append_path(cr, cairo_path);
-    cairo_stroke(cr);
+    adg_entity_stroke_path(entity, dress, cairo_path, NULL, cr);
 }
 
 static gchar *
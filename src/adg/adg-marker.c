@@ -62,7 +62,9 @@
  * The @create_model method must be implemented by any #AdgMarker derived
  * classes. The derived classes are expected to apply a single model
  * (the one returned by this method) to every path endings by using
- * different transformations.
+ * different transformations. The method must return a new reference:
+ * it can be a newly created model or an additional reference to an
+ * immutable model shared among different markers.
  *
  * Since: 1.0
  **/
@@ -127,6 +129,7 @@ adg_marker_class_init(AdgMarkerClass *klass)
 
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
+    entity_class->lod_policy = ADG_LOD_POLICY_DETAIL;
 
     klass->create_model = _adg_create_model;
 
@@ -636,8 +639,15 @@ adg_marker_model(AdgMarker *marker)
         /* Model not found: regenerate it */
         AdgMarkerClass *marker_class = ADG_MARKER_GET_CLASS(marker);
 
-        if (marker_class->create_model)
-            adg_marker_set_model(marker, marker_class->create_model(marker));
+        if (marker_class->create_model) {
+            AdgModel *model = marker_class->create_model(marker);
+
+            /* create_model() returns a new reference */
+            if (model != NULL) {
+                adg_marker_set_model(marker, model);
+                g_object_unref(model);
+            }
+        }
     }
 
     return data->model;
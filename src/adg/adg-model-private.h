@@ -25,17 +25,23 @@
 G_BEGIN_DECLS
 
 typedef struct _AdgModelPrivate  AdgModelPrivate;
-typedef struct _AdgWrapperHelper AdgWrapperHelper;
+typedef struct _AdgNamedPairSlot AdgNamedPairSlot;
 
 struct _AdgModelPrivate {
     GSList     *dependencies;
-    GHashTable *named_pairs;
+    GHashTable *bindings;
+    GHashTable *slot_ids;
+    GPtrArray  *slots;
+    guint       slot_generation;
+    gboolean    is_ending_update;
 };
 
-struct _AdgWrapperHelper {
-    AdgNamedPairFunc callback;
-    AdgModel        *model;
-    gpointer         user_data;
+struct _AdgNamedPairSlot {
+    const gchar *name;
+    gboolean     is_defined;
+    gboolean     is_updated;
+    gboolean     is_moved;
+    CpmlPair     pair;
 };
 
 G_END_DECLS
@@ -154,9 +154,10 @@ static void             _adg_set_named_pair     (AdgModel       *model,
                                                  const gchar    *name,
                                                  const CpmlPair *pair);
 static void             _adg_changed            (AdgModel       *model);
-static void             _adg_named_pair_wrapper (gpointer        key,
-                                                 gpointer        value,
-                                                 gpointer        user_data);
+static AdgNamedPairSlot *_adg_slot             (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 gboolean        create);
+static void             _adg_free_names         (gpointer        names);
 static void             _adg_invalidate_wrapper (AdgModel       *model,
                                                  AdgEntity      *entity,
                                                  gpointer        user_data);
@@ -329,6 +330,11 @@ adg_model_init(AdgModel *model)
 {
     AdgModelPrivate *data = adg_model_get_instance_private(model);
     data->dependencies = NULL;
+    data->bindings = NULL;
+    data->slot_ids = NULL;
+    data->slots = NULL;
+    data->slot_generation = 1;
+    data->is_ending_update = FALSE;
 }
 
 static void
@@ -349,6 +355,11 @@ _adg_dispose(GObject *object)
             adg_model_remove_dependency(model, entity);
         }
 
+        if (data->bindings != NULL) {
+            g_hash_table_destroy(data->bindings);
+            data->bindings = NULL;
+        }
+
         g_signal_emit(model, _adg_signals[RESET], 0);
     }
 
@@ -578,21 +589,119 @@ adg_model_foreach_named_pair(AdgModel *model, AdgNamedPairFunc callback,
                              gpointer user_data)
 {
     AdgModelPrivate *data;
-    AdgWrapperHelper helper;
+    AdgNamedPairSlot *slot;
+    guint n;
 
     g_return_if_fail(ADG_IS_MODEL(model));
     g_return_if_fail(callback != NULL);
 
     data = adg_model_get_instance_private(model);
 
-    if (data->named_pairs == NULL)
+    if (data->slots == NULL)
         return;
 
-    helper.callback = callback;
-    helper.model = model;
-    helper.user_data = user_data;
+    for (n = 0; n < data->slots->len; ++n) {
+        slot = g_ptr_array_index(data->slots, n);
+        if (slot->is_defined)
+            callback(model, slot->name, &slot->pair, user_data);
+    }
+}
+
+/**
+ * adg_model_get_named_pair_slot:
+ * @model: an #AdgModel
+ * @name: the name of a named pair
+ *
+ * Gets the slot of the @name named pair. Any named pair has its own
+ * slot inside @model, reserved when the pair is first defined, so the
+ * returned value can be stored and used later with
+ * adg_model_get_slot_pair() to access the named pair without looking
+ * up @name again. The slot is kept when the named pair is removed, so
+ * it stays valid if the pair is defined again.
+ *
+ * The slots are valid until the generation returned by
+ * adg_model_get_slot_generation() changes.
+ *
+ * If the #AdgModelClass:named_pair virtual method is overriden the
+ * slots cannot be used and 0 is returned: in this case, fallback to
+ * adg_model_get_named_pair().
+ *
+ * Returns: the requested slot or 0 if @name has never been defined or on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_model_get_named_pair_slot(AdgModel *model, const gchar *name)
+{
+    AdgModelPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), 0);
+    g_return_val_if_fail(name != NULL, 0);
+
+    if (ADG_MODEL_GET_CLASS(model)->named_pair != _adg_named_pair)
+        return 0;
 
-    g_hash_table_foreach(data->named_pairs, _adg_named_pair_wrapper, &helper);
+    data = adg_model_get_instance_private(model);
+
+    /* Looking up a name never reserves a slot, otherwise any
+     * misspelled name would be kept until the model is reset */
+    if (data->slot_ids == NULL)
+        return 0;
+
+    return GPOINTER_TO_UINT(g_hash_table_lookup(data->slot_ids, name));
+}
+
+/**
+ * adg_model_get_slot_pair:
+ * @model: an #AdgModel
+ * @slot: a slot returned by adg_model_get_named_pair_slot()
+ *
+ * Gets the named pair stored in @slot. This is a constant time
+ * operation. The returned pair is owned by @model and must not be
+ * modified or freed.
+ *
+ * Returns: the requested #CpmlPair or <constant>NULL</constant> if the named pair is not defined.
+ *
+ * Since: 1.0
+ **/
+const CpmlPair *
+adg_model_get_slot_pair(AdgModel *model, guint slot)
+{
+    AdgModelPrivate *data;
+    AdgNamedPairSlot *named_pair_slot;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), NULL);
+
+    data = adg_model_get_instance_private(model);
+    if (data->slots == NULL || slot == 0 || slot > data->slots->len)
+        return NULL;
+
+    named_pair_slot = g_ptr_array_index(data->slots, slot - 1);
+    return named_pair_slot->is_defined ? &named_pair_slot->pair : NULL;
+}
+
+/**
+ * adg_model_get_slot_generation:
+ * @model: an #AdgModel
+ *
+ * Gets the current slot generation of @model. The generation
+ * changes whenever the slots are released, e.g. when @model is
+ * reset, so any slot obtained with a different generation must
+ * be requested again with adg_model_get_named_pair_slot().
+ *
+ * Returns: the slot generation or 0 on errors.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_model_get_slot_generation(AdgModel *model)
+{
+    AdgModelPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), 0);
+
+    data = adg_model_get_instance_private(model);
+    return data->slot_generation;
 }
 
 /**
@@ -652,6 +761,133 @@ adg_model_changed(AdgModel *model)
 }
 
 
+void
+_adg_model_bind_pair(AdgModel *model, const gchar *name, AdgEntity *entity)
+{
+    AdgModelPrivate *data = adg_model_get_instance_private(model);
+    GSList *names;
+
+    if (data->bindings == NULL)
+        data->bindings = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                               NULL, _adg_free_names);
+
+    names = g_hash_table_lookup(data->bindings, entity);
+    g_hash_table_steal(data->bindings, entity);
+    g_hash_table_insert(data->bindings, entity,
+                        g_slist_prepend(names, g_strdup(name)));
+}
+
+void
+_adg_model_unbind_pair(AdgModel *model, const gchar *name, AdgEntity *entity)
+{
+    AdgModelPrivate *data = adg_model_get_instance_private(model);
+    GSList *names, *node;
+
+    /* The bindings are dropped when the model is disposed */
+    if (data->bindings == NULL)
+        return;
+
+    names = g_hash_table_lookup(data->bindings, entity);
+    node = g_slist_find_custom(names, name, (GCompareFunc) g_strcmp0);
+    if (node == NULL)
+        return;
+
+    g_hash_table_steal(data->bindings, entity);
+    g_free(node->data);
+    names = g_slist_delete_link(names, node);
+
+    if (names != NULL)
+        g_hash_table_insert(data->bindings, entity, names);
+}
+
+void
+_adg_model_begin_update(AdgModel *model)
+{
+    AdgModelPrivate *data = adg_model_get_instance_private(model);
+    AdgNamedPairSlot *slot;
+    guint n;
+
+    if (data->slots != NULL) {
+        for (n = 0; n < data->slots->len; ++n) {
+            slot = g_ptr_array_index(data->slots, n);
+            slot->is_updated = FALSE;
+            slot->is_moved = FALSE;
+        }
+    }
+
+    adg_model_clear(model);
+}
+
+GSList *
+_adg_model_end_update(AdgModel *model, gboolean data_changed)
+{
+    AdgModelPrivate *data = adg_model_get_instance_private(model);
+    AdgNamedPairSlot *slot;
+    GHashTable *counts;
+    GHashTableIter iter;
+    gpointer entity, count;
+    GSList *moved, *node;
+    gboolean is_affected;
+    guint n;
+
+    moved = NULL;
+
+    if (data->slots != NULL) {
+        for (n = 0; n < data->slots->len; ++n) {
+            slot = g_ptr_array_index(data->slots, n);
+
+            /* Named pairs not redefined during the update are removed */
+            if (slot->is_defined && ! slot->is_updated) {
+                slot->is_defined = FALSE;
+                slot->is_moved = TRUE;
+            }
+
+            if (slot->is_moved)
+                moved = g_slist_prepend(moved, (gpointer) slot->name);
+        }
+    }
+
+    /* Count how many times any entity depends on @model */
+    counts = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (node = data->dependencies; node != NULL; node = node->next) {
+        count = g_hash_table_lookup(counts, node->data);
+        g_hash_table_insert(counts, node->data,
+                            GUINT_TO_POINTER(GPOINTER_TO_UINT(count) + 1));
+    }
+
+    g_hash_table_iter_init(&iter, counts);
+    while (g_hash_table_iter_next(&iter, &entity, &count)) {
+        node = data->bindings != NULL ?
+            g_hash_table_lookup(data->bindings, entity) : NULL;
+
+        /* Any dependency not coming from a bound point (e.g. a stroke
+         * of this model) depends on the model data */
+        is_affected = data_changed &&
+            g_slist_length(node) < GPOINTER_TO_UINT(count);
+
+        for (; node != NULL && ! is_affected; node = node->next) {
+            slot = _adg_slot(model, node->data, FALSE);
+            is_affected = slot != NULL && slot->is_moved;
+        }
+
+        if (is_affected)
+            adg_entity_invalidate((AdgEntity *) entity);
+    }
+
+    g_hash_table_destroy(counts);
+
+    /* The dependencies have already been invalidated selectively:
+     * the flag prevents the default handler from invalidating them all */
+    if (data_changed || moved != NULL) {
+        data->is_ending_update = TRUE;
+        adg_model_changed(model);
+        data->is_ending_update = FALSE;
+    }
+
+    return g_slist_reverse(moved);
+}
+
+
 static void
 _adg_add_dependency(AdgModel *model, AdgEntity *entity)
 {
@@ -695,69 +931,109 @@ _adg_reset(AdgModel *model)
 
     adg_model_clear(model);
 
-    if (data->named_pairs) {
-        g_hash_table_destroy(data->named_pairs);
-        data->named_pairs = NULL;
+    if (data->slots) {
+        g_ptr_array_free(data->slots, TRUE);
+        g_hash_table_destroy(data->slot_ids);
+        data->slots = NULL;
+        data->slot_ids = NULL;
+        ++data->slot_generation;
     }
 }
 
 static void
 _adg_set_named_pair(AdgModel *model, const gchar *name, const CpmlPair *pair)
 {
-    AdgModelPrivate *data = adg_model_get_instance_private(model);
-    GHashTable **hash = &data->named_pairs;
-    gchar *key;
-    CpmlPair *value;
+    AdgNamedPairSlot *slot;
 
     if (pair == NULL) {
-        /* Delete mode: raise a warning if @name is not found */
-        if (*hash == NULL || !g_hash_table_remove(*hash, name))
+        /* Delete mode: raise a warning if @name is not found.
+         * The slot is kept, so the existing handles stay valid */
+        slot = _adg_slot(model, name, FALSE);
+        if (slot == NULL || ! slot->is_defined) {
             g_warning(_("%s: attempting to remove nonexistent '%s' named pair"),
                       G_STRLOC, name);
+        } else {
+            slot->is_defined = FALSE;
+            slot->is_moved = TRUE;
+        }
 
         return;
     }
 
     /* Insert or update mode */
-    key = g_strdup(name);
-    value = cpml_pair_dup(pair);
-
-    if (*hash == NULL)
-        *hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    slot = _adg_slot(model, name, TRUE);
+    if (! slot->is_defined || ! cpml_pair_equal(&slot->pair, pair))
+        slot->is_moved = TRUE;
 
-    g_hash_table_insert(*hash, key, value);
+    cpml_pair_copy(&slot->pair, pair);
+    slot->is_defined = TRUE;
+    slot->is_updated = TRUE;
 }
 
 static const CpmlPair *
 _adg_named_pair(AdgModel *model, const gchar *name)
+{
+    AdgNamedPairSlot *slot = _adg_slot(model, name, FALSE);
+
+    if (slot == NULL || ! slot->is_defined)
+        return NULL;
+
+    return &slot->pair;
+}
+
+static AdgNamedPairSlot *
+_adg_slot(AdgModel *model, const gchar *name, gboolean create)
 {
     AdgModelPrivate *data = adg_model_get_instance_private(model);
+    AdgNamedPairSlot *slot;
+    gchar *key;
+    guint id;
+
+    if (data->slots == NULL) {
+        if (! create)
+            return NULL;
 
-    if (data->named_pairs == NULL)
+        data->slots = g_ptr_array_new_with_free_func(g_free);
+        data->slot_ids = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                               g_free, NULL);
+    }
+
+    /* Slot ids are 1-based, so 0 can be used as invalid id */
+    id = GPOINTER_TO_UINT(g_hash_table_lookup(data->slot_ids, name));
+    if (id > 0)
+        return g_ptr_array_index(data->slots, id - 1);
+
+    if (! create)
         return NULL;
 
-    return g_hash_table_lookup(data->named_pairs, name);
+    key = g_strdup(name);
+    slot = g_new0(AdgNamedPairSlot, 1);
+    slot->name = key;
+    slot->is_defined = FALSE;
+    g_ptr_array_add(data->slots, slot);
+    g_hash_table_insert(data->slot_ids, key, GUINT_TO_POINTER(data->slots->len));
+
+    return slot;
 }
 
 static void
 _adg_changed(AdgModel *model)
 {
+    AdgModelPrivate *data = adg_model_get_instance_private(model);
+
+    /* At the end of an update the dependencies affected by the
+     * update have already been invalidated */
+    if (data->is_ending_update)
+        return;
+
     /* Invalidate all the entities dependent on this model */
     adg_model_foreach_dependency(model, _adg_invalidate_wrapper, NULL);
 }
 
 static void
-_adg_named_pair_wrapper(gpointer key, gpointer value, gpointer user_data)
+_adg_free_names(gpointer names)
 {
-    const gchar *name;
-    CpmlPair *pair;
-    AdgWrapperHelper *helper;
-
-    name = key;
-    pair = value;
-    helper = user_data;
-
-    helper->callback(helper->model, name, pair, helper->user_data);
+    g_slist_free_full(names, g_free);
 }
 
 static void
@@ -98,6 +98,11 @@ const CpmlPair *adg_model_get_named_pair        (AdgModel         *model,
 void            adg_model_foreach_named_pair    (AdgModel         *model,
                                                  AdgNamedPairFunc  callback,
                                                  gpointer          user_data);
+guint           adg_model_get_named_pair_slot   (AdgModel         *model,
+                                                 const gchar      *name);
+const CpmlPair *adg_model_get_slot_pair         (AdgModel         *model,
+                                                 guint             slot);
+guint           adg_model_get_slot_generation   (AdgModel         *model);
 void            adg_model_clear                 (AdgModel         *model);
 void            adg_model_reset                 (AdgModel         *model);
 void            adg_model_changed               (AdgModel         *model);
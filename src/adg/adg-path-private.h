@@ -61,11 +61,15 @@ struct _AdgPathPrivate {
     struct {
         cairo_path_t     path;
         GArray          *array;
+        GArray          *backup;
     }                    cairo;
 
+    gboolean             is_updating;
+
     CpmlPrimitive        last;
     CpmlPrimitive        over;
     AdgOperation         operation;
+    gdouble              arc_tolerance;
 };
 
 G_END_DECLS
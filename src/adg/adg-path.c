@@ -68,6 +68,8 @@
 #include "adg-path.h"
 #include "adg-path-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_path_parent_class)
 #define _ADG_OLD_MODEL_CLASS   ((AdgModelClass *) adg_path_parent_class)
@@ -79,8 +81,21 @@
 
 G_DEFINE_TYPE_WITH_PRIVATE(AdgPath, adg_path, ADG_TYPE_TRAIL)
 
+enum {
+    PROP_0,
+    PROP_ARC_TOLERANCE
+};
+
 
 static void             _adg_finalize           (GObject        *object);
+static void             _adg_get_property       (GObject        *object,
+                                                 guint           prop_id,
+                                                 GValue         *value,
+                                                 GParamSpec     *pspec);
+static void             _adg_set_property       (GObject        *object,
+                                                 guint           prop_id,
+                                                 const GValue   *value,
+                                                 GParamSpec     *pspec);
 static void             _adg_clear              (AdgModel       *model);
 static void             _adg_clear_parent       (AdgModel       *model);
 static void             _adg_changed            (AdgModel       *model);
@@ -130,17 +145,27 @@ adg_path_class_init(AdgPathClass *klass)
     GObjectClass *gobject_class;
     AdgModelClass *model_class;
     AdgTrailClass *trail_class;
+    GParamSpec *param;
 
     gobject_class = (GObjectClass *) klass;
     model_class = (AdgModelClass *) klass;
     trail_class = (AdgTrailClass *) klass;
 
     gobject_class->finalize = _adg_finalize;
+    gobject_class->get_property = _adg_get_property;
+    gobject_class->set_property = _adg_set_property;
 
     model_class->clear = _adg_clear;
     model_class->changed = _adg_changed;
 
     trail_class->get_cairo_path = _adg_get_cairo_path;
+
+    param = g_param_spec_double("arc-tolerance",
+                                P_("Arc Tolerance"),
+                                P_("Max distance allowed when converting a curve to a circular arc: check adg_path_set_arc_tolerance() for details"),
+                                0, G_MAXDOUBLE, 0,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_ARC_TOLERANCE, param);
 }
 
 static void
@@ -154,6 +179,8 @@ adg_path_init(AdgPath *path)
     data->cairo.path.data = NULL;
     data->cairo.path.num_data = 0;
     data->cairo.array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    data->cairo.backup = NULL;
+    data->is_updating = FALSE;
     data->last.segment = NULL;
     data->last.org = NULL;
     data->last.data = NULL;
@@ -161,6 +188,7 @@ adg_path_init(AdgPath *path)
     data->over.org = NULL;
     data->over.data = NULL;
     data->operation.action = ADG_ACTION_NONE;
+    data->arc_tolerance = 0;
 }
 
 static void
@@ -170,12 +198,46 @@ _adg_finalize(GObject *object)
     AdgPathPrivate *data = adg_path_get_instance_private(path);
 
     g_array_free(data->cairo.array, TRUE);
+    if (data->cairo.backup != NULL)
+        g_array_free(data->cairo.backup, TRUE);
     _adg_clear_operation(path);
 
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
 }
 
+static void
+_adg_get_property(GObject *object, guint prop_id,
+                  GValue *value, GParamSpec *pspec)
+{
+    AdgPathPrivate *data = adg_path_get_instance_private((AdgPath *) object);
+
+    switch (prop_id) {
+    case PROP_ARC_TOLERANCE:
+        g_value_set_double(value, data->arc_tolerance);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+_adg_set_property(GObject *object, guint prop_id,
+                  const GValue *value, GParamSpec *pspec)
+{
+    AdgPathPrivate *data = adg_path_get_instance_private((AdgPath *) object);
+
+    switch (prop_id) {
+    case PROP_ARC_TOLERANCE:
+        data->arc_tolerance = g_value_get_double(value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
 
 /**
  * adg_path_new:
@@ -193,6 +255,56 @@ adg_path_new(void)
     return g_object_new(ADG_TYPE_PATH, NULL);
 }
 
+/**
+ * adg_path_set_arc_tolerance:
+ * @path: an #AdgPath
+ * @tolerance: the new tolerance
+ *
+ * Sets the #AdgPath:arc-tolerance property of @path to @tolerance.
+ *
+ * When @tolerance is greater than 0, any curve appended to @path
+ * close enough to a circular arc (that is, no point of the curve is
+ * farther than @tolerance from the arc) is stored as a %CPML_ARC
+ * primitive. Arcs can be offseted and intersected in an exact way,
+ * so this improves the precision of the following operations, e.g.
+ * when importing external outlines. Check cpml_curve_to_arc() for
+ * further details.
+ *
+ * The default value of 0 disables the conversion. Changing this
+ * property does not affect the primitives already in @path.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_set_arc_tolerance(AdgPath *path, gdouble tolerance)
+{
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_object_set(path, "arc-tolerance", tolerance, NULL);
+}
+
+/**
+ * adg_path_get_arc_tolerance:
+ * @path: an #AdgPath
+ *
+ * Gets the #AdgPath:arc-tolerance property value of @path.
+ * Refer to adg_path_set_arc_tolerance() for details of what
+ * this parameter is used for.
+ *
+ * Returns: the arc tolerance or 0 on errors
+ *
+ * Since: 1.0
+ **/
+gdouble
+adg_path_get_arc_tolerance(AdgPath *path)
+{
+    AdgPathPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), 0);
+
+    data = adg_path_get_instance_private(path);
+    return data->arc_tolerance;
+}
+
 /**
  * adg_path_get_current_point:
  * @path: an #AdgPath
@@ -477,11 +589,11 @@ adg_path_append_primitive(AdgPath *path, const CpmlPrimitive *primitive)
 
     /* The primitive data could be modified by pending operations:
      * work on a copy */
-    primitive_dup = cpml_primitive_deep_dup(primitive);
+    primitive_dup = cpml_scratch_primitive_dup(primitive);
 
     _adg_append_primitive(path, primitive_dup);
 
-    g_free(primitive_dup);
+    cpml_scratch_free(primitive_dup);
 }
 
 /**
@@ -1060,7 +1172,7 @@ adg_path_reflect(AdgPath *path, const CpmlVector *vector)
         if (segment.num_data == 0 || segment.num_data == 0)
             continue;
 
-        dup_segment = cpml_segment_deep_dup(&segment);
+        dup_segment = cpml_scratch_segment_dup(&segment);
         if (dup_segment == NULL)
             return;
 
@@ -1070,7 +1182,7 @@ adg_path_reflect(AdgPath *path, const CpmlVector *vector)
 
         adg_path_append_segment(path, dup_segment);
 
-        g_free(dup_segment);
+        cpml_scratch_free(dup_segment);
     }
 
     _adg_dup_reverse_named_pairs(model, &matrix);
@@ -1098,6 +1210,108 @@ adg_path_reflect_explicit(AdgPath *path, gdouble x, gdouble y)
     adg_path_reflect(path, &vector);
 }
 
+/**
+ * adg_path_begin_update:
+ * @path: an #AdgPath
+ *
+ * Starts an incremental update of @path. The primitives are cleared
+ * (similarly to adg_model_clear()) but the named pairs are retained,
+ * so the #AdgPoint bound to them are still valid. The path must then
+ * be redefined from scratch and the update terminated with
+ * adg_path_end_update().
+ *
+ * This is lighter than adg_model_reset() followed by
+ * adg_model_changed(), as only the entities really affected by the
+ * update are invalidated. When @path is rebuilt with the same
+ * sequence of operations, the primitives are stored in place and
+ * retain the same position inside the path data.
+ *
+ * <informalexample><programlisting language="C">
+ * adg_path_begin_update(path);
+ * // Redefinition of the primitives and of the named pairs
+ * ...
+ * g_slist_free(adg_path_end_update(path));
+ * </programlisting></informalexample>
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_begin_update(AdgPath *path)
+{
+    AdgPathPrivate *data;
+    GArray *array;
+
+    g_return_if_fail(ADG_IS_PATH(path));
+
+    data = adg_path_get_instance_private(path);
+    array = data->cairo.array;
+
+    /* Keep a copy of the old data, to be compared on update end */
+    if (data->cairo.backup == NULL)
+        data->cairo.backup = g_array_sized_new(FALSE, FALSE,
+                                               sizeof(cairo_path_data_t),
+                                               array->len);
+
+    g_array_set_size(data->cairo.backup, 0);
+    g_array_append_vals(data->cairo.backup, array->data, array->len);
+
+    data->is_updating = TRUE;
+    _adg_model_begin_update((AdgModel *) path);
+}
+
+/**
+ * adg_path_end_update:
+ * @path: an #AdgPath
+ *
+ * Terminates an update started by adg_path_begin_update(). The named
+ * pairs not redefined during the update are removed. The dependent
+ * entities are then invalidated, but only when needed: the entities
+ * bound to @path only by their #AdgPoint (e.g. dimensions) are
+ * invalidated only if any of their named pairs moved, while any other
+ * dependency (e.g. the strokes of @path) is invalidated only if the
+ * path data actually changed.
+ *
+ * If the path data changed or any named pair has been added, moved or
+ * removed, #AdgModel::changed is emitted once at the end, so any other
+ * listener is notified of the update. The default handler does not
+ * invalidate the dependent entities again in this case.
+ *
+ * Calling this function without a previous adg_path_begin_update()
+ * is an error: a warning is raised and nothing is done.
+ *
+ * Returns: (transfer container) (element-type utf8): the names of the named pairs added, moved or removed by the update. The names are owned by @path: free only the list with g_slist_free().
+ *
+ * Since: 1.0
+ **/
+GSList *
+adg_path_end_update(AdgPath *path)
+{
+    AdgPathPrivate *data;
+    GArray *array, *backup;
+    gboolean data_changed;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), NULL);
+
+    data = adg_path_get_instance_private(path);
+    array = data->cairo.array;
+    backup = data->cairo.backup;
+
+    if (! data->is_updating) {
+        g_warning(_("%s: no update in progress (adg_path_begin_update() not called)"),
+                  G_STRLOC);
+        return NULL;
+    }
+
+    data->is_updating = FALSE;
+    data_changed = array->len != backup->len ||
+        memcmp(array->data, backup->data,
+               array->len * sizeof(cairo_path_data_t)) != 0;
+
+    g_array_set_size(backup, 0);
+
+    return _adg_model_end_update((AdgModel *) path, data_changed);
+}
+
 
 static void
 _adg_clear(AdgModel *model)
@@ -1236,6 +1450,22 @@ _adg_append_primitive(AdgPath *path, CpmlPrimitive *current)
     path_data = (cairo_path_data_t *) new_data +
                 (data->cairo.array)->len - length;
 
+    if (type == CPML_CURVE && length == 4 &&
+        data->arc_tolerance > 0 && data->cp_is_valid) {
+        CpmlPrimitive curve;
+
+        curve.segment = NULL;
+        curve.org = path_data - 1;
+        curve.data = path_data;
+
+        if (cpml_curve_to_arc(&curve, data->arc_tolerance)) {
+            /* The arc is the last primitive: drop the embedded data */
+            path_data->header.length = 3;
+            g_array_set_size(data->cairo.array, (data->cairo.array)->len - 1);
+            type = CPML_ARC;
+        }
+    }
+
     if (type == CPML_MOVE) {
         /* Remap last and over, but do not change their content */
         _adg_primitive_remap(&data->last, new_data, &data->last, old_data);
@@ -1457,8 +1687,8 @@ _adg_do_fillet(AdgPath *path, CpmlPrimitive *current)
 {
     AdgPathPrivate *data = adg_path_get_instance_private(path);
     CpmlPrimitive *last = &data->last;
-    CpmlPrimitive *current_dup = cpml_primitive_deep_dup(current);
-    CpmlPrimitive *last_dup = cpml_primitive_deep_dup(last);
+    CpmlPrimitive *current_dup = cpml_scratch_primitive_dup(current);
+    CpmlPrimitive *last_dup = cpml_scratch_primitive_dup(last);
     gdouble radius = data->operation.data.fillet.radius;
     gdouble offset = _adg_is_convex(last_dup, current_dup) ? -radius : radius;
     gdouble pos;
@@ -1471,8 +1701,8 @@ _adg_do_fillet(AdgPath *path, CpmlPrimitive *current)
     if (cpml_primitive_put_intersections(current_dup, last_dup, 1, &center) == 0) {
         g_warning(_("%s: fillet with radius of %lf is not applicable here"),
                   G_STRLOC, radius);
-        g_free(current_dup);
-        g_free(last_dup);
+        cpml_scratch_free(last_dup);
+        cpml_scratch_free(current_dup);
         return;
     }
 
@@ -1500,8 +1730,8 @@ _adg_do_fillet(AdgPath *path, CpmlPrimitive *current)
     p[2].x = center.x - vector.x;
     p[2].y = center.y - vector.y;
 
-    g_free(current_dup);
-    g_free(last_dup);
+    cpml_scratch_free(last_dup);
+    cpml_scratch_free(current_dup);
 
     /* Change the end point of the last primitive */
     cpml_primitive_set_point(last, -1, &p[0]);
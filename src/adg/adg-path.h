@@ -52,6 +52,9 @@ struct _AdgPathClass {
 
 GType           adg_path_get_type               (void);
 AdgPath *       adg_path_new                    (void);
+void            adg_path_set_arc_tolerance      (AdgPath        *path,
+                                                 gdouble         tolerance);
+gdouble         adg_path_get_arc_tolerance      (AdgPath        *path);
 
 const CpmlPair *adg_path_get_current_point      (AdgPath        *path);
 gboolean        adg_path_has_current_point      (AdgPath        *path);
@@ -133,6 +136,8 @@ void            adg_path_reflect                (AdgPath        *path,
 void            adg_path_reflect_explicit       (AdgPath        *path,
                                                  gdouble         x,
                                                  gdouble         y);
+void            adg_path_begin_update           (AdgPath        *path);
+GSList *        adg_path_end_update             (AdgPath        *path);
 
 G_END_DECLS
 
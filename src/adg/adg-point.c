@@ -56,6 +56,8 @@ struct _AdgPoint {
     AdgModel    *model;
     gchar       *name;
     gboolean     up_to_date;
+    guint        slot;
+    guint        generation;
 };
 
 
@@ -242,10 +244,11 @@ adg_point_set_pair_from_model(AdgPoint *point,
         g_free(point->name);
     }
 
-    /* Set the new named pair */
+    /* Set the new named pair: the slot is bound on the first update */
     point->up_to_date = FALSE;
     point->model = model;
     point->name = g_strdup(name);
+    point->slot = 0;
 }
 
 /**
@@ -293,6 +296,7 @@ adg_point_unset(AdgPoint *point)
     point->up_to_date = FALSE;
     point->model = NULL;
     point->name = NULL;
+    point->slot = 0;
 }
 
 /**
@@ -303,6 +307,11 @@ adg_point_unset(AdgPoint *point)
  * implementation is protected against multiple calls so it
  * can be called more times without harms.
  *
+ * A point bound to a named pair caches the slot of the pair in
+ * the model (see adg_model_get_named_pair_slot()), so the name
+ * is looked up only until the pair is defined or after the model
+ * is reset.
+ *
  * Returns: <constant>TRUE</constant> if @point has been updated or <constant>FALSE</constant> on errors, i.e. when it is bound to a non-existent named pair.
  *
  * Since: 1.0
@@ -327,7 +336,18 @@ adg_point_update(AdgPoint *point)
         return FALSE;
     }
 
-    pair = adg_model_get_named_pair(model, point->name);
+    /* Bind the slot, if not yet done or no more valid */
+    if (point->slot == 0 ||
+        point->generation != adg_model_get_slot_generation(model)) {
+        point->slot = adg_model_get_named_pair_slot(model, point->name);
+        point->generation = adg_model_get_slot_generation(model);
+    }
+
+    if (point->slot > 0)
+        pair = adg_model_get_slot_pair(model, point->slot);
+    else
+        pair = adg_model_get_named_pair(model, point->name);
+
     if (pair == NULL)
         return FALSE;
 
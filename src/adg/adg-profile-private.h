@@ -0,0 +1,64 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __ADG_PROFILE_PRIVATE_H__
+#define __ADG_PROFILE_PRIVATE_H__
+
+
+G_BEGIN_DECLS
+
+typedef enum {
+    ADG_PROFILE_ARRANGE,
+    ADG_PROFILE_RENDER,
+    ADG_PROFILE_N_PHASES
+} AdgProfilePhase;
+
+typedef struct _AdgProfileStats AdgProfileStats;
+typedef struct _AdgProfileEvent AdgProfileEvent;
+
+struct _AdgProfileStats {
+    const gchar *name;
+    guint        id;
+    guint        n_calls[ADG_PROFILE_N_PHASES];
+    guint        n_hits[ADG_PROFILE_N_PHASES];
+    gint64       total[ADG_PROFILE_N_PHASES];
+    gint64       self[ADG_PROFILE_N_PHASES];
+};
+
+struct _AdgProfileEvent {
+    const gchar     *name;
+    guint            id;
+    AdgProfilePhase  phase;
+    gint64           start;
+    gint64           duration;
+};
+
+
+void            _adg_profile_init               (void);
+gint64          _adg_profile_begin              (void);
+void            _adg_profile_end                (AdgEntity      *entity,
+                                                 AdgProfilePhase phase,
+                                                 gint64          start,
+                                                 gboolean        is_cached);
+
+G_END_DECLS
+
+
+#endif /* __ADG_PROFILE_PRIVATE_H__ */
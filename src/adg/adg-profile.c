@@ -0,0 +1,453 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-profile
+ * @Section_Id:profile
+ * @title: Profiling
+ * @short_description: Arrange and render instrumentation
+ *
+ * Every arrange and render request of any entity passes through
+ * the #AdgEntity base class. When profiling is enabled, the time
+ * spent by every such call is recorded and aggregated by entity
+ * type and by entity, so it is possible to know which kind of
+ * entities (e.g. dimensions, hatches, text) are responsible of a
+ * slow drawing without using an external profiler.
+ *
+ * For every type the summary reports the number of calls, the
+ * percentage of arrange calls resolved by a cached result (that is
+ * when the extents were already defined before arranging), the
+ * inclusive time and the self time, i.e. the inclusive time minus
+ * the time spent by the children.
+ *
+ * Profiling can be enabled programmatically with adg_switch_profile()
+ * or by setting the <envar>ADG_PROFILE</envar> environment variable
+ * before the first entity is created. In the latter case the summary
+ * is printed on stderr at program exit and, if the variable is not
+ * empty, its value is used as the file name where to write the trace
+ * of every call in the Chrome trace event format, to be loaded by
+ * chrome://tracing or any compatible viewer.
+ *
+ * Entities are identified by a serial number assigned the first
+ * time they are profiled, so the statistics of an entity are never
+ * merged with the ones of a later entity allocated at the same
+ * address. The statistics grow with the number of profiled entities
+ * while the trace keeps only the latest calls (see
+ * #ADG_PROFILE_MAX_EVENTS): use adg_profile_reset() to free them.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <stdlib.h>
+
+#include "adg-profile.h"
+#include "adg-profile-private.h"
+
+
+/**
+ * ADG_PROFILE_MAX_EVENTS:
+ *
+ * Maximum number of calls kept for the trace written by
+ * adg_profile_write_trace(). When the limit is reached, the
+ * oldest calls are overwritten.
+ *
+ * Since: 1.0
+ **/
+
+
+static void             _adg_profile_atexit     (void);
+static guint            _adg_profile_id         (AdgEntity      *entity);
+static AdgProfileStats *_adg_profile_stats      (GHashTable     *table,
+                                                 gpointer        key,
+                                                 const gchar    *name,
+                                                 guint           id);
+static gint             _adg_compare_self       (gconstpointer   a,
+                                                 gconstpointer   b);
+static gint64           _adg_self               (const AdgProfileStats *stats);
+
+
+static const gchar *    _adg_phases[ADG_PROFILE_N_PHASES] = {
+    "arrange",
+    "render"
+};
+static gboolean         _adg_profiling = FALSE;
+static gchar *          _adg_trace_file = NULL;
+static GHashTable *     _adg_type_stats = NULL;
+static GHashTable *     _adg_entity_stats = NULL;
+static GArray *         _adg_events = NULL;
+static guint            _adg_events_head = 0;
+static guint            _adg_last_id = 0;
+static GArray *         _adg_stack = NULL;
+
+
+/**
+ * adg_switch_profile:
+ * @state: new profiling state
+ *
+ * Starts (if @state is <constant>TRUE</constant>) or stops the
+ * recording of the arrange and render calls. Stopping does not
+ * clear the data already recorded: use adg_profile_reset() for
+ * that purpose.
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_profile(gboolean state)
+{
+    _adg_profiling = state;
+}
+
+/**
+ * adg_profile_is_enabled:
+ *
+ * Checks if the arrange and render calls are being recorded.
+ *
+ * Returns: <constant>TRUE</constant> if profiling is enabled, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_profile_is_enabled(void)
+{
+    return _adg_profiling;
+}
+
+/**
+ * adg_profile_reset:
+ *
+ * Clears all the data recorded so far.
+ *
+ * Since: 1.0
+ **/
+void
+adg_profile_reset(void)
+{
+    if (_adg_type_stats != NULL) {
+        g_hash_table_destroy(_adg_type_stats);
+        _adg_type_stats = NULL;
+    }
+
+    if (_adg_entity_stats != NULL) {
+        g_hash_table_destroy(_adg_entity_stats);
+        _adg_entity_stats = NULL;
+    }
+
+    if (_adg_events != NULL) {
+        g_array_free(_adg_events, TRUE);
+        _adg_events = NULL;
+        _adg_events_head = 0;
+    }
+
+    if (_adg_stack != NULL)
+        g_array_set_size(_adg_stack, 0);
+}
+
+/**
+ * adg_profile_get_summary:
+ *
+ * Builds a human readable table with the recorded data aggregated
+ * by entity type, sorted by descending self time, followed by the
+ * list of the ten entities with the highest self time.
+ *
+ * Returns: (transfer full): a newly allocated string to be freed with g_free() when no longer needed.
+ *
+ * Since: 1.0
+ **/
+gchar *
+adg_profile_get_summary(void)
+{
+    GString *summary;
+    GList *list, *node;
+    AdgProfileStats *stats;
+    AdgProfilePhase phase;
+    gint n;
+
+    summary = g_string_new(NULL);
+    g_string_append_printf(summary, "%-24s %-8s %8s %8s %12s %12s\n",
+                           "Type", "Phase", "Calls", "Cached",
+                           "Total (ms)", "Self (ms)");
+
+    list = _adg_type_stats != NULL ? g_hash_table_get_values(_adg_type_stats) : NULL;
+    list = g_list_sort(list, _adg_compare_self);
+
+    for (node = list; node != NULL; node = node->next) {
+        stats = node->data;
+        for (phase = 0; phase < ADG_PROFILE_N_PHASES; ++phase) {
+            if (stats->n_calls[phase] == 0)
+                continue;
+            g_string_append_printf(summary, "%-24s %-8s %8u %7.1f%% %12.3f %12.3f\n",
+                                   stats->name, _adg_phases[phase],
+                                   stats->n_calls[phase],
+                                   100. * stats->n_hits[phase] / stats->n_calls[phase],
+                                   stats->total[phase] / 1000.,
+                                   stats->self[phase] / 1000.);
+        }
+    }
+
+    g_list_free(list);
+
+    g_string_append_printf(summary, "\n%-24s %-18s %12s\n",
+                           "Entity", "Id", "Self (ms)");
+
+    list = _adg_entity_stats != NULL ? g_hash_table_get_values(_adg_entity_stats) : NULL;
+    list = g_list_sort(list, _adg_compare_self);
+
+    for (node = list, n = 0; node != NULL && n < 10; node = node->next, ++n) {
+        stats = node->data;
+        g_string_append_printf(summary, "%-24s %-18u %12.3f\n",
+                               stats->name, stats->id,
+                               _adg_self(stats) / 1000.);
+    }
+
+    g_list_free(list);
+
+    return g_string_free(summary, FALSE);
+}
+
+/**
+ * adg_profile_write_trace:
+ * @file: the name of the file to write
+ * @error: (allow-none): return location for a #GError or <constant>NULL</constant>
+ *
+ * Writes every recorded arrange and render call to @file, using
+ * the JSON object format of the Chrome trace event specification.
+ * Every event is named after the type of the entity and has the
+ * serial number of the entity in its arguments, so the calls of a
+ * specific entity can be tracked. Only the latest
+ * #ADG_PROFILE_MAX_EVENTS calls are written.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_profile_write_trace(const gchar *file, GError **error)
+{
+    GString *trace;
+    AdgProfileEvent *event;
+    gint64 origin;
+    guint n, len;
+    gboolean result;
+
+    g_return_val_if_fail(file != NULL, FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    trace = g_string_new("{\"traceEvents\":[");
+    origin = 0;
+    len = _adg_events != NULL ? _adg_events->len : 0;
+
+    for (n = 0; n < len; ++n) {
+        event = &g_array_index(_adg_events, AdgProfileEvent, n);
+        if (n == 0 || event->start < origin)
+            origin = event->start;
+    }
+
+    /* Once full, the oldest event is the one at the head of the ring */
+    for (n = 0; n < len; ++n) {
+        event = &g_array_index(_adg_events, AdgProfileEvent,
+                               (_adg_events_head + n) % len);
+        g_string_append_printf(trace, "%s\n{\"name\":\"%s\",\"cat\":\"%s\","
+                               "\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT ","
+                               "\"dur\":%" G_GINT64_FORMAT ",\"pid\":1,\"tid\":1,"
+                               "\"args\":{\"entity\":%u}}",
+                               n > 0 ? "," : "",
+                               event->name, _adg_phases[event->phase],
+                               event->start - origin, event->duration,
+                               event->id);
+    }
+
+    g_string_append(trace, "\n]}\n");
+    result = g_file_set_contents(file, trace->str, trace->len, error);
+    g_string_free(trace, TRUE);
+
+    return result;
+}
+
+
+void
+_adg_profile_init(void)
+{
+    const gchar *env = g_getenv("ADG_PROFILE");
+
+    if (env == NULL || _adg_profiling)
+        return;
+
+    _adg_profiling = TRUE;
+    if (env[0] != '\0')
+        _adg_trace_file = g_strdup(env);
+
+    atexit(_adg_profile_atexit);
+}
+
+gint64
+_adg_profile_begin(void)
+{
+    gint64 child_time = 0;
+
+    if (! _adg_profiling)
+        return 0;
+
+    if (_adg_stack == NULL)
+        _adg_stack = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+    /* Every nested call accumulates its time in the parent slot,
+     * so the self time can be computed when the parent ends */
+    g_array_append_val(_adg_stack, child_time);
+
+    return g_get_monotonic_time();
+}
+
+void
+_adg_profile_end(AdgEntity *entity, AdgProfilePhase phase,
+                 gint64 start, gboolean is_cached)
+{
+    AdgProfileStats *stats[2];
+    AdgProfileEvent event;
+    GType type;
+    guint id;
+    gint64 total, child_time;
+    gint n;
+
+    total = g_get_monotonic_time() - start;
+    child_time = 0;
+
+    if (_adg_stack != NULL && _adg_stack->len > 0) {
+        child_time = g_array_index(_adg_stack, gint64, _adg_stack->len - 1);
+        g_array_set_size(_adg_stack, _adg_stack->len - 1);
+        if (_adg_stack->len > 0)
+            g_array_index(_adg_stack, gint64, _adg_stack->len - 1) += total;
+    }
+
+    if (_adg_type_stats == NULL) {
+        _adg_type_stats = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+        _adg_entity_stats = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+        _adg_events = g_array_new(FALSE, FALSE, sizeof(AdgProfileEvent));
+    }
+
+    type = G_OBJECT_TYPE(entity);
+    id = _adg_profile_id(entity);
+    stats[0] = _adg_profile_stats(_adg_type_stats, GSIZE_TO_POINTER(type),
+                                  g_type_name(type), 0);
+    stats[1] = _adg_profile_stats(_adg_entity_stats, GUINT_TO_POINTER(id),
+                                  g_type_name(type), id);
+
+    for (n = 0; n < 2; ++n) {
+        ++stats[n]->n_calls[phase];
+        if (is_cached)
+            ++stats[n]->n_hits[phase];
+        stats[n]->total[phase] += total;
+        stats[n]->self[phase] += total - child_time;
+    }
+
+    event.name = stats[0]->name;
+    event.id = id;
+    event.phase = phase;
+    event.start = start;
+    event.duration = total;
+
+    if (_adg_events->len < ADG_PROFILE_MAX_EVENTS) {
+        g_array_append_val(_adg_events, event);
+    } else {
+        g_array_index(_adg_events, AdgProfileEvent, _adg_events_head) = event;
+        _adg_events_head = (_adg_events_head + 1) % ADG_PROFILE_MAX_EVENTS;
+    }
+}
+
+
+static void
+_adg_profile_atexit(void)
+{
+    gchar *summary = adg_profile_get_summary();
+
+    g_printerr("%s", summary);
+    g_free(summary);
+
+    if (_adg_trace_file != NULL) {
+        GError *error = NULL;
+
+        if (! adg_profile_write_trace(_adg_trace_file, &error)) {
+            g_printerr("%s\n", error->message);
+            g_error_free(error);
+        }
+
+        g_free(_adg_trace_file);
+        _adg_trace_file = NULL;
+    }
+}
+
+/* The id is stored in the entity itself, so it disappears together
+ * with the entity and cannot be inherited by a new entity allocated
+ * at the same address */
+static guint
+_adg_profile_id(AdgEntity *entity)
+{
+    static GQuark quark = 0;
+    guint id;
+
+    if (G_UNLIKELY(quark == 0))
+        quark = g_quark_from_static_string("adg-profile-id");
+
+    id = GPOINTER_TO_UINT(g_object_get_qdata((GObject *) entity, quark));
+    if (id == 0) {
+        id = ++_adg_last_id;
+        g_object_set_qdata((GObject *) entity, quark, GUINT_TO_POINTER(id));
+    }
+
+    return id;
+}
+
+static AdgProfileStats *
+_adg_profile_stats(GHashTable *table, gpointer key,
+                   const gchar *name, guint id)
+{
+    AdgProfileStats *stats = g_hash_table_lookup(table, key);
+
+    if (stats == NULL) {
+        stats = g_new0(AdgProfileStats, 1);
+        stats->name = name;
+        stats->id = id;
+        g_hash_table_insert(table, key, stats);
+    }
+
+    return stats;
+}
+
+static gint
+_adg_compare_self(gconstpointer a, gconstpointer b)
+{
+    gint64 self_a = _adg_self(a);
+    gint64 self_b = _adg_self(b);
+
+    return self_a < self_b ? 1 : self_a > self_b ? -1 : 0;
+}
+
+static gint64
+_adg_self(const AdgProfileStats *stats)
+{
+    gint64 self = 0;
+    AdgProfilePhase phase;
+
+    for (phase = 0; phase < ADG_PROFILE_N_PHASES; ++phase)
+        self += stats->self[phase];
+
+    return self;
+}
@@ -285,6 +285,17 @@ adg_rdim_new_full_from_model(AdgModel *model, const gchar *center,
 }
 
 
+void
+_adg_rdim_get_lines(AdgRDim *rdim, AdgTrail **trail,
+                    AdgMarker **marker1, AdgMarker **marker2)
+{
+    AdgRDimPrivate *data = adg_rdim_get_instance_private(rdim);
+
+    *trail = data->trail;
+    *marker1 = data->marker;
+    *marker2 = NULL;
+}
+
 static void
 _adg_global_changed(AdgEntity *entity)
 {
@@ -296,7 +307,7 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    if (data->marker != NULL)
+    if (data->marker != NULL && ! _adg_entity_lazy_matrices())
         adg_entity_global_changed((AdgEntity *) data->marker);
 }
 
@@ -473,11 +484,10 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 
     cairo_transform(cr, adg_entity_get_global_matrix(entity));
     dress = adg_dim_style_get_line_dress(dim_style);
-    adg_entity_apply_dress(entity, dress, cr);
 
+    /* The local matrix has already been applied to the trail */
     cairo_path = adg_trail_get_cairo_path(data->trail);
-    cairo_append_path(cr, cairo_path);
-    cairo_stroke(cr);
+    adg_entity_stroke_path(entity, dress, cairo_path, NULL, cr);
 }
 
 static gchar *
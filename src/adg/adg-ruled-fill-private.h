@@ -29,6 +29,7 @@ struct _AdgRuledFillPrivate {
     AdgDress     line_dress;
     gdouble      spacing;
     gdouble      angle;
+    gboolean     vector_lines;
 };
 
 G_END_DECLS
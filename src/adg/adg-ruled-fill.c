@@ -26,6 +26,13 @@
  * adg_ruled_fill_set_spacing() method. The angle of the lines should
  * be changed with adg_ruled_fill_set_angle().
  *
+ * By default the lines are drawn on an offscreen surface that is then
+ * used as a pattern for filling the region. When the
+ * #AdgRuledFill:vector-lines property is enabled, the lines are
+ * instead clipped analytically against the filled path and only the
+ * resulting segments are stroked: this produces much lighter output
+ * on vector targets such as PDF, PostScript and SVG.
+ *
  * Since: 1.0
  **/
 
@@ -61,9 +68,38 @@ enum {
     PROP_0,
     PROP_LINE_DRESS,
     PROP_SPACING,
-    PROP_ANGLE
+    PROP_ANGLE,
+    PROP_VECTOR_LINES
 };
 
+typedef void (*_AdgLineFunc)(const CpmlPair *p1, const CpmlPair *p2,
+                             gpointer user_data);
+
+/* An edge of the filled path, expressed in hatch space: the x
+ * coordinate is along the lines and y is across them */
+typedef struct {
+    gint        n_points;
+    CpmlPair    point[4];
+    gdouble     min;
+    gdouble     max;
+} _AdgEdge;
+
+/* A hatch line in hatch space, still to be clipped */
+typedef struct {
+    gdouble     y;
+    gdouble     x1;
+    gdouble     x2;
+} _AdgLine;
+
+typedef struct {
+    cairo_t    *cr;
+    GArray     *edges;
+    GArray     *lines;
+    GArray     *crossings;
+    CpmlVector  direction;
+    CpmlPair    org;
+} _AdgClip;
+
 
 static void             _adg_get_property       (GObject        *object,
                                                  guint           prop_id,
@@ -78,12 +114,40 @@ static void             _adg_apply              (AdgStyle       *style,
                                                  cairo_t        *cr);
 static void             _adg_set_extents        (AdgFillStyle   *fill_style,
                                                  const CpmlExtents *extents);
+static void             _adg_fill               (AdgFillStyle   *fill_style,
+                                                 AdgEntity      *entity,
+                                                 cairo_t        *cr);
 static cairo_pattern_t *_adg_create_pattern     (AdgRuledFill   *ruled_fill,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
 static void             _adg_draw_lines         (const CpmlPair *spacing,
                                                  const CpmlPair *size,
-                                                 cairo_t        *cr);
+                                                 _AdgLineFunc    func,
+                                                 gpointer        user_data);
+static void             _adg_line_to_cairo      (const CpmlPair *p1,
+                                                 const CpmlPair *p2,
+                                                 gpointer        user_data);
+static void             _adg_collect_line       (const CpmlPair *p1,
+                                                 const CpmlPair *p2,
+                                                 gpointer        user_data);
+static void             _adg_clip_lines         (_AdgClip       *clip);
+static GArray *         _adg_collect_edges      (const cairo_path_t *path,
+                                                 const CpmlVector *direction);
+static void             _adg_append_edge        (GArray         *edges,
+                                                 const CpmlPair *points,
+                                                 gint            n_points,
+                                                 const CpmlVector *direction);
+static void             _adg_edge_crossings     (const _AdgEdge *edge,
+                                                 gdouble         y,
+                                                 GArray         *crossings);
+static gdouble          _adg_bezier             (const gdouble  *value,
+                                                 gdouble         t);
+static gint             _adg_compare_doubles    (gconstpointer   a,
+                                                 gconstpointer   b);
+static gint             _adg_compare_edges      (gconstpointer   a,
+                                                 gconstpointer   b);
+static gint             _adg_compare_lines      (gconstpointer   a,
+                                                 gconstpointer   b);
 
 
 static void
@@ -104,6 +168,7 @@ adg_ruled_fill_class_init(AdgRuledFillClass *klass)
     style_class->apply = _adg_apply;
 
     fill_style_class->set_extents = _adg_set_extents;
+    fill_style_class->fill = _adg_fill;
 
     param = adg_param_spec_dress("line-dress",
                                  P_("Line Dress"),
@@ -125,6 +190,13 @@ adg_ruled_fill_class_init(AdgRuledFillClass *klass)
                                0, G_PI, G_PI_4,
                                G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_ANGLE, param);
+
+    param = g_param_spec_boolean("vector-lines",
+                                 P_("Vector Lines"),
+                                 P_("Whether the lines should be clipped to the filled path and stroked instead of being rendered with a surface pattern"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_VECTOR_LINES, param);
 }
 
 static void
@@ -134,6 +206,7 @@ adg_ruled_fill_init(AdgRuledFill *ruled_fill)
     data->line_dress = ADG_DRESS_LINE_FILL;
     data->angle = G_PI_4;
     data->spacing = 16;
+    data->vector_lines = FALSE;
 }
 
 static void
@@ -152,6 +225,9 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_ANGLE:
         g_value_set_double(value, data->angle);
         break;
+    case PROP_VECTOR_LINES:
+        g_value_set_boolean(value, data->vector_lines);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -176,6 +252,9 @@ _adg_set_property(GObject *object, guint prop_id,
         data->angle = g_value_get_double(value);
         adg_fill_style_set_pattern((AdgFillStyle *) object, NULL);
         break;
+    case PROP_VECTOR_LINES:
+        data->vector_lines = g_value_get_boolean(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -309,6 +388,45 @@ adg_ruled_fill_get_angle(AdgRuledFill *ruled_fill)
     return data->angle;
 }
 
+/**
+ * adg_ruled_fill_switch_vector_lines:
+ * @ruled_fill: an #AdgRuledFill
+ * @new_state: the new state of the vector lines
+ *
+ * Sets the #AdgRuledFill:vector-lines property: <constant>TRUE</constant>
+ * will intersect the lines with the filled path and stroke only the
+ * inner segments instead of filling the path with a surface pattern.
+ *
+ * Since: 1.0
+ **/
+void
+adg_ruled_fill_switch_vector_lines(AdgRuledFill *ruled_fill, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_RULED_FILL(ruled_fill));
+    g_object_set(ruled_fill, "vector-lines", new_state, NULL);
+}
+
+/**
+ * adg_ruled_fill_has_vector_lines:
+ * @ruled_fill: an #AdgRuledFill
+ *
+ * Returns the state of the #AdgRuledFill:vector-lines property.
+ *
+ * Returns: the current state.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_ruled_fill_has_vector_lines(AdgRuledFill *ruled_fill)
+{
+    AdgRuledFillPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_RULED_FILL(ruled_fill), FALSE);
+
+    data = adg_ruled_fill_get_instance_private(ruled_fill);
+    return data->vector_lines;
+}
+
 
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
@@ -357,6 +475,58 @@ _adg_set_extents(AdgFillStyle *fill_style, const CpmlExtents *extents)
         _ADG_OLD_FILL_STYLE_CLASS->set_extents(fill_style, &new);
 }
 
+static void
+_adg_fill(AdgFillStyle *fill_style, AdgEntity *entity, cairo_t *cr)
+{
+    AdgRuledFillPrivate *data;
+    const CpmlExtents *extents;
+    cairo_path_t *path, *lines;
+    CpmlPair spacing;
+    _AdgClip clip;
+
+    data = adg_ruled_fill_get_instance_private((AdgRuledFill *) fill_style);
+
+    if (! data->vector_lines) {
+        if (_ADG_OLD_FILL_STYLE_CLASS->fill)
+            _ADG_OLD_FILL_STYLE_CLASS->fill(fill_style, entity, cr);
+        return;
+    }
+
+    extents = adg_fill_style_get_extents(fill_style);
+    path = cairo_copy_path(cr);
+    cairo_new_path(cr);
+
+    if (extents->is_defined && path->status == CAIRO_STATUS_SUCCESS) {
+        spacing.x = cos(data->angle) * data->spacing;
+        spacing.y = sin(data->angle) * data->spacing;
+
+        /* _adg_draw_lines() goes from the x axis to the y axis */
+        clip.direction.x = -spacing.x;
+        clip.direction.y = spacing.y;
+        cpml_vector_set_length(&clip.direction, 1);
+
+        clip.cr = cr;
+        clip.org = extents->org;
+        clip.edges = _adg_collect_edges(path, &clip.direction);
+        clip.lines = g_array_new(FALSE, FALSE, sizeof(_AdgLine));
+        clip.crossings = g_array_new(FALSE, FALSE, sizeof(gdouble));
+
+        /* The hatch lines are stroked as any other line, so they can
+         * be batched with the strokes using the same line style */
+        _adg_draw_lines(&spacing, &extents->size, _adg_collect_line, &clip);
+        _adg_clip_lines(&clip);
+        lines = cairo_copy_path(cr);
+        cairo_new_path(cr);
+        _adg_entity_stroke_owned_path(entity, data->line_dress, lines, cr);
+
+        g_array_free(clip.crossings, TRUE);
+        g_array_free(clip.lines, TRUE);
+        g_array_free(clip.edges, TRUE);
+    }
+
+    cairo_path_destroy(path);
+}
+
 static cairo_pattern_t *
 _adg_create_pattern(AdgRuledFill *ruled_fill, AdgEntity *entity, cairo_t *cr)
 {
@@ -392,14 +562,16 @@ _adg_create_pattern(AdgRuledFill *ruled_fill, AdgEntity *entity, cairo_t *cr)
 
     context = cairo_create(surface);
     adg_style_apply(line_style, entity, context);
-    _adg_draw_lines(&spacing, &extents->size, context);
+    _adg_draw_lines(&spacing, &extents->size, _adg_line_to_cairo, context);
+    cairo_stroke(context);
     cairo_destroy(context);
 
     return pattern;
 }
 
 static void
-_adg_draw_lines(const CpmlPair *spacing, const CpmlPair *size, cairo_t *cr)
+_adg_draw_lines(const CpmlPair *spacing, const CpmlPair *size,
+                _AdgLineFunc func, gpointer user_data)
 {
     CpmlPair step, step1, step2;
     CpmlPair p1, p2;
@@ -437,8 +609,7 @@ _adg_draw_lines(const CpmlPair *spacing, const CpmlPair *size, cairo_t *cr)
                 step2.x = step.x;
                 step2.y = 0;
             }
-            cairo_move_to(cr, p1.x, p1.y);
-            cairo_line_to(cr, p2.x, p2.y);
+            func(&p1, &p2, user_data);
             p1.x += step1.x;
             p1.y += step1.y;
             p2.x += step2.x;
@@ -455,14 +626,329 @@ _adg_draw_lines(const CpmlPair *spacing, const CpmlPair *size, cairo_t *cr)
                 step2.x = step.x;
                 step2.y = 0;
             }
-            cairo_move_to(cr, p1.x, p1.y);
-            cairo_line_to(cr, p2.x, p2.y);
+            func(&p1, &p2, user_data);
             p1.x += step1.x;
             p1.y += step1.y;
             p2.x += step2.x;
             p2.y += step2.y;
         }
     }
+}
+
+static void
+_adg_line_to_cairo(const CpmlPair *p1, const CpmlPair *p2, gpointer user_data)
+{
+    cairo_t *cr = user_data;
+
+    cairo_move_to(cr, p1->x, p1->y);
+    cairo_line_to(cr, p2->x, p2->y);
+}
+
+static void
+_adg_collect_line(const CpmlPair *p1, const CpmlPair *p2, gpointer user_data)
+{
+    _AdgClip *clip;
+    const CpmlVector *d;
+    _AdgLine line;
+
+    clip = user_data;
+    d = &clip->direction;
+
+    /* Project the line in hatch space, where it is horizontal */
+    line.x1 = (p1->x + clip->org.x) * d->x + (p1->y + clip->org.y) * d->y;
+    line.x2 = (p2->x + clip->org.x) * d->x + (p2->y + clip->org.y) * d->y;
+    line.y = (p1->y + clip->org.y) * d->x - (p1->x + clip->org.x) * d->y;
+
+    if (line.x1 > line.x2) {
+        gdouble tmp = line.x1;
+        line.x1 = line.x2;
+        line.x2 = tmp;
+    }
+
+    g_array_append_val(clip->lines, line);
+}
+
+/* Sweeps the hatch lines, sorted across their direction, through the
+ * edges sorted by their lower bound: only the edges spanning the
+ * current line (the active ones) are checked for crossings */
+static void
+_adg_clip_lines(_AdgClip *clip)
+{
+    const CpmlVector *d;
+    const _AdgLine *line;
+    const _AdgEdge *edge;
+    const gdouble *crossing;
+    GPtrArray *active;
+    gdouble from, to;
+    guint n, next, i;
+
+    d = &clip->direction;
+    g_array_sort(clip->edges, _adg_compare_edges);
+    g_array_sort(clip->lines, _adg_compare_lines);
+    active = g_ptr_array_new();
+    next = 0;
+
+    for (n = 0; n < clip->lines->len; ++n) {
+        line = &g_array_index(clip->lines, _AdgLine, n);
+
+        while (next < clip->edges->len &&
+               g_array_index(clip->edges, _AdgEdge, next).min <= line->y) {
+            g_ptr_array_add(active, &g_array_index(clip->edges, _AdgEdge, next));
+            ++next;
+        }
+
+        /* The edges left behind by the sweep are dropped */
+        g_array_set_size(clip->crossings, 0);
+        i = 0;
+        while (i < active->len) {
+            edge = g_ptr_array_index(active, i);
+            if (edge->max < line->y) {
+                g_ptr_array_remove_index_fast(active, i);
+            } else {
+                _adg_edge_crossings(edge, line->y, clip->crossings);
+                ++i;
+            }
+        }
+
+        g_array_sort(clip->crossings, _adg_compare_doubles);
+        crossing = (const gdouble *) clip->crossings->data;
+
+        /* Even-odd rule: the line is inside between pairs of crossings */
+        for (i = 0; i + 1 < clip->crossings->len; i += 2) {
+            from = MAX(crossing[i], line->x1);
+            to = MIN(crossing[i + 1], line->x2);
+            if (from >= to)
+                continue;
+
+            cairo_move_to(clip->cr, from * d->x - line->y * d->y,
+                          from * d->y + line->y * d->x);
+            cairo_line_to(clip->cr, to * d->x - line->y * d->y,
+                          to * d->y + line->y * d->x);
+        }
+    }
 
-    cairo_stroke(cr);
+    g_ptr_array_free(active, TRUE);
+}
+
+static GArray *
+_adg_collect_edges(const cairo_path_t *path, const CpmlVector *direction)
+{
+    GArray *edges;
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlPair points[4];
+    gint n, n_points;
+    gboolean is_closed;
+
+    edges = g_array_new(FALSE, FALSE, sizeof(_AdgEdge));
+
+    if (! cpml_segment_from_cairo(&segment, (cairo_path_t *) path))
+        return edges;
+
+    do {
+        cpml_primitive_from_segment(&primitive, &segment);
+        is_closed = FALSE;
+
+        do {
+            n_points = cpml_primitive_get_n_points(&primitive);
+            for (n = 0; n < n_points; ++n)
+                cpml_primitive_put_point(&primitive, n, &points[n]);
+
+            switch (cpml_primitive_type(&primitive)) {
+            case CPML_CLOSE:
+                is_closed = TRUE;
+                /* Fall through */
+            case CPML_LINE:
+            case CPML_CURVE:
+                _adg_append_edge(edges, points, n_points, direction);
+                break;
+            case CPML_ARC: {
+                cairo_path_data_t data[16];
+                CpmlSegment curves;
+                CpmlPrimitive curve;
+
+                /* Use the same Bézier approximation used for rendering */
+                curves.data = data;
+                curves.num_data = G_N_ELEMENTS(data);
+                if (! cpml_arc_info(&primitive, NULL, NULL, NULL, NULL)) {
+                    points[1] = points[2];
+                    _adg_append_edge(edges, points, 2, direction);
+                    break;
+                }
+
+                cpml_arc_to_curves(&primitive, &curves, 4);
+                curve.org = primitive.org;
+                for (n = 0; n < 4; ++n) {
+                    curve.data = data + n * 4;
+                    cpml_pair_from_cairo(&points[0], curve.org);
+                    cpml_pair_from_cairo(&points[1], &curve.data[1]);
+                    cpml_pair_from_cairo(&points[2], &curve.data[2]);
+                    cpml_pair_from_cairo(&points[3], &curve.data[3]);
+                    _adg_append_edge(edges, points, 4, direction);
+                    curve.org = &curve.data[3];
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        } while (cpml_primitive_next(&primitive));
+
+        /* Open subpaths are implicitly closed by cairo_fill() */
+        if (! is_closed) {
+            cpml_primitive_put_point(&primitive, -1, &points[0]);
+            cpml_pair_from_cairo(&points[1], &segment.data[1]);
+            _adg_append_edge(edges, points, 2, direction);
+        }
+    } while (cpml_segment_next(&segment));
+
+    return edges;
+}
+
+static void
+_adg_append_edge(GArray *edges, const CpmlPair *points, gint n_points,
+                 const CpmlVector *direction)
+{
+    _AdgEdge edge;
+    CpmlPair *point;
+    gint n;
+
+    edge.n_points = n_points;
+
+    for (n = 0; n < n_points; ++n) {
+        point = &edge.point[n];
+        point->x = points[n].x * direction->x + points[n].y * direction->y;
+        point->y = points[n].y * direction->x - points[n].x * direction->y;
+
+        /* The control points enclose the whole curve */
+        if (n == 0 || point->y < edge.min)
+            edge.min = point->y;
+        if (n == 0 || point->y > edge.max)
+            edge.max = point->y;
+    }
+
+    /* Edges parallel to the lines never cross them */
+    if (edge.min < edge.max)
+        g_array_append_val(edges, edge);
+}
+
+static void
+_adg_edge_crossings(const _AdgEdge *edge, gdouble y, GArray *crossings)
+{
+    gdouble xs[4], ys[4], ts[4];
+    gdouble a, b, c, delta, t, t1, t2, y1, y2, x;
+    gint n, n_ts, iteration;
+
+    if (y < edge->min || y > edge->max)
+        return;
+
+    if (edge->n_points == 2) {
+        y1 = edge->point[0].y;
+        y2 = edge->point[1].y;
+
+        /* Half-open rule, so a vertex is not counted twice */
+        if ((y1 > y) != (y2 > y)) {
+            t = (y - y1) / (y2 - y1);
+            x = edge->point[0].x + (edge->point[1].x - edge->point[0].x) * t;
+            g_array_append_val(crossings, x);
+        }
+        return;
+    }
+
+    for (n = 0; n < 4; ++n) {
+        xs[n] = edge->point[n].x;
+        ys[n] = edge->point[n].y;
+    }
+
+    /* Split the curve in y-monotone pieces by using the roots of the
+     * derivative, that is a quadratic equation */
+    a = ys[3] - 3 * ys[2] + 3 * ys[1] - ys[0];
+    b = 2 * (ys[2] - 2 * ys[1] + ys[0]);
+    c = ys[1] - ys[0];
+
+    n_ts = 0;
+    ts[n_ts++] = 0;
+
+    if (fabs(a) < 1e-12) {
+        if (b != 0) {
+            t = -c / b;
+            if (t > 0 && t < 1)
+                ts[n_ts++] = t;
+        }
+    } else {
+        delta = b * b - 4 * a * c;
+        if (delta >= 0) {
+            delta = sqrt(delta);
+            t1 = (-b - delta) / (2 * a);
+            t2 = (-b + delta) / (2 * a);
+            if (t1 > t2) {
+                t = t1;
+                t1 = t2;
+                t2 = t;
+            }
+            if (t1 > 0 && t1 < 1)
+                ts[n_ts++] = t1;
+            if (t2 > 0 && t2 < 1 && t2 != t1)
+                ts[n_ts++] = t2;
+        }
+    }
+
+    ts[n_ts++] = 1;
+
+    for (n = 0; n + 1 < n_ts; ++n) {
+        t1 = ts[n];
+        t2 = ts[n + 1];
+        y1 = _adg_bezier(ys, t1);
+        y2 = _adg_bezier(ys, t2);
+
+        if ((y1 > y) == (y2 > y))
+            continue;
+
+        /* The piece is monotone: bisection always converges */
+        for (iteration = 0; iteration < 52; ++iteration) {
+            t = (t1 + t2) / 2;
+            if ((_adg_bezier(ys, t) > y) == (y1 > y))
+                t1 = t;
+            else
+                t2 = t;
+        }
+
+        x = _adg_bezier(xs, (t1 + t2) / 2);
+        g_array_append_val(crossings, x);
+    }
+}
+
+static gdouble
+_adg_bezier(const gdouble *value, gdouble t)
+{
+    gdouble mt = 1 - t;
+
+    return mt * mt * mt * value[0] + 3 * mt * mt * t * value[1] +
+        3 * mt * t * t * value[2] + t * t * t * value[3];
+}
+
+static gint
+_adg_compare_doubles(gconstpointer a, gconstpointer b)
+{
+    gdouble value1 = *(const gdouble *) a;
+    gdouble value2 = *(const gdouble *) b;
+
+    if (value1 < value2)
+        return -1;
+
+    return value1 > value2 ? 1 : 0;
+}
+
+static gint
+_adg_compare_edges(gconstpointer a, gconstpointer b)
+{
+    return _adg_compare_doubles(&((const _AdgEdge *) a)->min,
+                                &((const _AdgEdge *) b)->min);
+}
+
+static gint
+_adg_compare_lines(gconstpointer a, gconstpointer b)
+{
+    return _adg_compare_doubles(&((const _AdgLine *) a)->y,
+                                &((const _AdgLine *) b)->y);
 }
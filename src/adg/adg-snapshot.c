@@ -0,0 +1,1433 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-snapshot
+ * @Section_Id:snapshot
+ * @title: Snapshots
+ * @short_description: Binary save and load of drawings
+ *
+ * A snapshot is a compact binary image of an entity tree. Rebuilding
+ * a drawing through the #AdgPath API means replaying every primitive
+ * and recomputing every chamfer and fillet: a snapshot instead stores
+ * the resolved #cairo_path_data_t array of every model, arcs included
+ * as %CPML_ARC primitives, so loading it requires a single mapping of
+ * the file and a single copy per model.
+ *
+ * The following data is stored:
+ * <itemizedlist>
+ * <listitem>the path data and the named pairs of every #AdgModel
+ *           referenced by the entities, either directly (e.g. the
+ *           trail of an #AdgStroke) or through an #AdgPoint (e.g. the
+ *           reference points of an #AdgDim), shared among the
+ *           entities using the same model;</listitem>
+ * <listitem>the readable and writable properties of the #AdgContainer,
+ *           #AdgCanvas, #AdgAlignment, #AdgStroke, #AdgHatch, #AdgLDim,
+ *           #AdgADim, #AdgRDim, #AdgToyText, #AdgText, #AdgTitleBlock,
+ *           #AdgLogo, #AdgProjection and #AdgArrow entities, including
+ *           the entities they refer to (e.g. the title block of a
+ *           canvas);</listitem>
+ * <listitem>the styles overriden with adg_entity_set_style(), when
+ *           they are #AdgColorStyle, #AdgLineStyle, #AdgRuledFill,
+ *           #AdgFontStyle, #AdgPangoStyle, #AdgDimStyle (markers
+ *           included) or #AdgTableStyle instances;</listitem>
+ * <listitem>the children of the containers.</listitem>
+ * </itemizedlist>
+ *
+ * Models are reloaded as #AdgPath instances. Any other entity or
+ * style type (and any subclass of the above types) cannot be saved,
+ * in which case %ADG_SNAPSHOT_ERROR_UNSUPPORTED is returned. Dresses
+ * are saved by name, so they are valid as long as the same dresses
+ * are registered when loading.
+ *
+ * The format uses the native byte order and keeps every double
+ * aligned to 8 bytes, so the path data can be copied straight from
+ * the mapped file. Loading a snapshot written on a machine with a
+ * different byte order fails with %ADG_SNAPSHOT_ERROR_INVALID.
+ * The content is fully validated before being used: malformed path
+ * data, unknown types or properties and excessive nesting fail with
+ * %ADG_SNAPSHOT_ERROR_INVALID too.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * ADG_SNAPSHOT_ERROR:
+ *
+ * Error domain for snapshot processing. Errors in this domain will be from
+ * the #AdgSnapshotError enumeration. See #GError for information on error
+ * domains.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgSnapshotError:
+ * @ADG_SNAPSHOT_ERROR_UNSUPPORTED: The entity tree contains an entity that cannot be saved.
+ * @ADG_SNAPSHOT_ERROR_INVALID: The file is not a valid snapshot.
+ *
+ * Error codes returned by the snapshot functions.
+ *
+ * Since: 1.0
+ **/
+
+
+
+
+#include "adg-internal.h"
+#include <string.h>
+
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-path.h"
+#include "adg-point.h"
+#include "adg-dash.h"
+#include "adg-style.h"
+#include "adg-color-style.h"
+#include "adg-line-style.h"
+#include "adg-fill-style.h"
+#include "adg-ruled-fill.h"
+#include "adg-dim-style.h"
+#include "adg-table-style.h"
+#include "adg-dress.h"
+#include "adg-param-dress.h"
+#include "adg-container.h"
+#include "adg-alignment.h"
+#include "adg-stroke.h"
+#include "adg-hatch.h"
+#include "adg-marker.h"
+#include "adg-arrow.h"
+#include "adg-dim.h"
+#include "adg-ldim.h"
+#include "adg-adim.h"
+#include "adg-rdim.h"
+#include "adg-table.h"
+#include "adg-title-block.h"
+#include "adg-logo.h"
+#include "adg-projection.h"
+#include "adg-text-internal.h"
+#include <adg-canvas.h>
+#include "adg-cairo-fallback.h"
+
+#include "adg-snapshot.h"
+
+
+#define _ADG_SNAPSHOT_MAGIC     "ADGS"
+#define _ADG_SNAPSHOT_VERSION   2
+#define _ADG_SNAPSHOT_ORDER     0x01020304
+#define _ADG_NO_MODEL           G_MAXUINT32
+
+/* Nodes nested deeper than this are rejected on loading: it is far
+ * beyond any real drawing and it bounds the recursion on crafted files */
+#define _ADG_MAX_DEPTH          64
+
+typedef enum {
+    _ADG_VALUE_INVALID,
+    _ADG_VALUE_INTEGER,
+    _ADG_VALUE_DOUBLE,
+    _ADG_VALUE_STRING,
+    _ADG_VALUE_DRESS,
+    _ADG_VALUE_PAIR,
+    _ADG_VALUE_POINT,
+    _ADG_VALUE_MATRIX,
+    _ADG_VALUE_DASH,
+    _ADG_VALUE_STRV,
+    _ADG_VALUE_MODEL,
+    _ADG_VALUE_ENTITY
+} _AdgValueKind;
+
+typedef struct {
+    GByteArray     *nodes;
+    GHashTable     *model_ids;
+    GPtrArray      *models;
+    guint           n_nodes;
+    GError         *error;
+} _AdgWriter;
+
+typedef struct {
+    GByteArray     *buffer;
+    guint           offset;
+    guint32         n_pairs;
+} _AdgPairs;
+
+typedef struct {
+    const guint8   *data;
+    gsize           size;
+    gsize           pos;
+    gboolean        failed;
+} _AdgReader;
+
+
+static const GType *    _adg_entity_types       (void);
+static const GType *    _adg_style_types        (void);
+static gboolean         _adg_has_type           (const GType    *types,
+                                                 GType           type);
+static gboolean         _adg_is_stored          (GParamSpec     *pspec);
+static gboolean         _adg_is_template        (GParamSpec     *pspec);
+static _AdgValueKind    _adg_value_kind         (GParamSpec     *pspec);
+static gint64           _adg_value_get_integer  (const GValue   *value);
+static void             _adg_value_set_integer  (GValue         *value,
+                                                 gint64          integer);
+static gboolean         _adg_write_node         (_AdgWriter     *writer,
+                                                 AdgEntity      *entity);
+static gboolean         _adg_write_style        (_AdgWriter     *writer,
+                                                 AdgStyle       *style);
+static gboolean         _adg_write_properties   (_AdgWriter     *writer,
+                                                 GObject        *object);
+static gboolean         _adg_write_value        (_AdgWriter     *writer,
+                                                 _AdgValueKind   kind,
+                                                 const GValue   *value);
+static void             _adg_collect_style      (gpointer        key,
+                                                 gpointer        value,
+                                                 gpointer        user_data);
+static guint32          _adg_model_id           (_AdgWriter     *writer,
+                                                 AdgModel       *model);
+static void             _adg_write_model        (GByteArray     *buffer,
+                                                 AdgModel       *model);
+static void             _adg_write_named_pair   (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 CpmlPair       *pair,
+                                                 gpointer        user_data);
+static void             _adg_put_uint32         (GByteArray     *buffer,
+                                                 guint32         value);
+static void             _adg_put_int64          (GByteArray     *buffer,
+                                                 gint64          value);
+static void             _adg_put_double         (GByteArray     *buffer,
+                                                 gdouble         value);
+static void             _adg_put_string         (GByteArray     *buffer,
+                                                 const gchar    *string);
+static void             _adg_put_matrix         (GByteArray     *buffer,
+                                                 const cairo_matrix_t *matrix);
+static AdgEntity *      _adg_read_node          (_AdgReader     *reader,
+                                                 GPtrArray      *models,
+                                                 guint           depth);
+static void             _adg_read_style         (_AdgReader     *reader,
+                                                 GPtrArray      *models,
+                                                 AdgEntity      *entity,
+                                                 guint           depth);
+static void             _adg_read_properties    (_AdgReader     *reader,
+                                                 GPtrArray      *models,
+                                                 GObject        *object,
+                                                 guint           depth);
+static void             _adg_read_value         (_AdgReader     *reader,
+                                                 GPtrArray      *models,
+                                                 GObject        *object,
+                                                 GParamSpec     *pspec,
+                                                 guint           depth);
+static AdgPath *        _adg_read_model         (_AdgReader     *reader);
+static gboolean         _adg_check_path         (const cairo_path_data_t *data,
+                                                 guint32         n_data);
+static GType            _adg_get_type           (_AdgReader     *reader,
+                                                 const GType    *types);
+static const guint8 *   _adg_get_bytes          (_AdgReader     *reader,
+                                                 gsize           size);
+static guint32          _adg_get_uint32         (_AdgReader     *reader);
+static gint64           _adg_get_int64          (_AdgReader     *reader);
+static gdouble          _adg_get_double         (_AdgReader     *reader);
+static gchar *          _adg_get_string         (_AdgReader     *reader);
+static void             _adg_get_matrix         (_AdgReader     *reader,
+                                                 cairo_matrix_t *matrix);
+static guint32          _adg_get_count          (_AdgReader     *reader,
+                                                 gsize           min_size);
+
+
+/**
+ * adg_snapshot_error_quark:
+ *
+ * Registers an error quark specific for the snapshot functions.
+ *
+ * Returns: The error quark used for snapshot errors.
+ *
+ * Since: 1.0
+ **/
+GQuark
+adg_snapshot_error_quark(void)
+{
+  static GQuark q;
+
+  if G_UNLIKELY (q == 0)
+    q = g_quark_from_static_string("adg-snapshot-error-quark");
+
+  return q;
+}
+
+/**
+ * adg_snapshot_save:
+ * @entity: the root #AdgEntity to save
+ * @file: the name of the file to write
+ * @error: (allow-none): return location for a #GError or <constant>NULL</constant>
+ *
+ * Saves @entity, its children, the styles they override and the
+ * models they depend on in @file. The snapshot can be reloaded with
+ * adg_snapshot_load().
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_snapshot_save(AdgEntity *entity, const gchar *file, GError **error)
+{
+    _AdgWriter writer;
+    GByteArray *buffer;
+    gboolean result;
+    guint n;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
+    g_return_val_if_fail(file != NULL, FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    writer.nodes = g_byte_array_new();
+    writer.model_ids = g_hash_table_new(NULL, NULL);
+    writer.models = g_ptr_array_new();
+    writer.n_nodes = 0;
+    writer.error = NULL;
+
+    result = _adg_write_node(&writer, entity);
+
+    if (result) {
+        buffer = g_byte_array_new();
+        g_byte_array_append(buffer, (const guint8 *) _ADG_SNAPSHOT_MAGIC, 4);
+        _adg_put_uint32(buffer, _ADG_SNAPSHOT_VERSION);
+        _adg_put_uint32(buffer, _ADG_SNAPSHOT_ORDER);
+        _adg_put_uint32(buffer, writer.models->len);
+        _adg_put_uint32(buffer, writer.n_nodes);
+        _adg_put_uint32(buffer, 0);
+
+        for (n = 0; n < writer.models->len; ++n)
+            _adg_write_model(buffer, g_ptr_array_index(writer.models, n));
+
+        g_byte_array_append(buffer, writer.nodes->data, writer.nodes->len);
+        result = g_file_set_contents(file, (const gchar *) buffer->data,
+                                     buffer->len, error);
+        g_byte_array_free(buffer, TRUE);
+    } else {
+        g_propagate_error(error, writer.error);
+    }
+
+    g_byte_array_free(writer.nodes, TRUE);
+    g_hash_table_destroy(writer.model_ids);
+    g_ptr_array_free(writer.models, TRUE);
+
+    return result;
+}
+
+/**
+ * adg_snapshot_load:
+ * @file: the name of the file to read
+ * @error: (allow-none): return location for a #GError or <constant>NULL</constant>
+ *
+ * Loads a snapshot previously saved with adg_snapshot_save().
+ * The file is mapped in memory and the path data of every model
+ * is copied in a single step, without replaying the primitives.
+ *
+ * Returns: (transfer full): the root entity of the snapshot or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgEntity *
+adg_snapshot_load(const gchar *file, GError **error)
+{
+    GMappedFile *mapped;
+    _AdgReader reader;
+    GPtrArray *models;
+    AdgEntity *entity;
+    const guint8 *magic;
+    guint32 n_models, n_nodes;
+    guint n;
+
+    g_return_val_if_fail(file != NULL, NULL);
+    g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+    mapped = g_mapped_file_new(file, FALSE, error);
+    if (mapped == NULL)
+        return NULL;
+
+    reader.data = (const guint8 *) g_mapped_file_get_contents(mapped);
+    reader.size = g_mapped_file_get_length(mapped);
+    reader.pos = 0;
+    reader.failed = FALSE;
+
+    magic = _adg_get_bytes(&reader, 4);
+    if (magic == NULL || memcmp(magic, _ADG_SNAPSHOT_MAGIC, 4) != 0 ||
+        _adg_get_uint32(&reader) != _ADG_SNAPSHOT_VERSION ||
+        _adg_get_uint32(&reader) != _ADG_SNAPSHOT_ORDER) {
+        g_set_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID,
+                    "'%s' is not a compatible snapshot", file);
+        g_mapped_file_unref(mapped);
+        return NULL;
+    }
+
+    /* Every model takes at least 8 bytes */
+    n_models = _adg_get_count(&reader, 8);
+    n_nodes = _adg_get_uint32(&reader);
+    _adg_get_uint32(&reader);
+
+    models = g_ptr_array_new_with_free_func(g_object_unref);
+    for (n = 0; n < n_models && ! reader.failed; ++n)
+        g_ptr_array_add(models, _adg_read_model(&reader));
+
+    entity = reader.failed ? NULL : _adg_read_node(&reader, models, 0);
+
+    if (entity != NULL && reader.pos != reader.size) {
+        adg_entity_destroy(entity);
+        entity = NULL;
+    }
+
+    if (entity == NULL)
+        g_set_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID,
+                    "'%s' is a truncated or corrupted snapshot (%u nodes)",
+                    file, n_nodes);
+
+    g_ptr_array_free(models, TRUE);
+    g_mapped_file_unref(mapped);
+
+    return entity;
+}
+
+
+/* Only these exact types are saved: their state is fully described
+ * by their properties, their overriden styles and their children */
+static const GType *
+_adg_entity_types(void)
+{
+    static GType types[15];
+    static gsize initialized = 0;
+
+    if (g_once_init_enter(&initialized)) {
+        GType *type = types;
+
+        *type++ = ADG_TYPE_CONTAINER;
+        *type++ = ADG_TYPE_CANVAS;
+        *type++ = ADG_TYPE_ALIGNMENT;
+        *type++ = ADG_TYPE_STROKE;
+        *type++ = ADG_TYPE_HATCH;
+        *type++ = ADG_TYPE_LDIM;
+        *type++ = ADG_TYPE_ADIM;
+        *type++ = ADG_TYPE_RDIM;
+        *type++ = ADG_TYPE_TOY_TEXT;
+#ifdef PANGO_ENABLED
+        *type++ = ADG_TYPE_TEXT;
+#endif
+        *type++ = ADG_TYPE_TITLE_BLOCK;
+        *type++ = ADG_TYPE_LOGO;
+        *type++ = ADG_TYPE_PROJECTION;
+        *type++ = ADG_TYPE_ARROW;
+        *type = G_TYPE_INVALID;
+
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return types;
+}
+
+static const GType *
+_adg_style_types(void)
+{
+    static GType types[8];
+    static gsize initialized = 0;
+
+    if (g_once_init_enter(&initialized)) {
+        GType *type = types;
+
+        *type++ = ADG_TYPE_COLOR_STYLE;
+        *type++ = ADG_TYPE_LINE_STYLE;
+        *type++ = ADG_TYPE_RULED_FILL;
+        *type++ = ADG_TYPE_FONT_STYLE;
+#ifdef PANGO_ENABLED
+        *type++ = ADG_TYPE_PANGO_STYLE;
+#endif
+        *type++ = ADG_TYPE_DIM_STYLE;
+        *type++ = ADG_TYPE_TABLE_STYLE;
+        *type = G_TYPE_INVALID;
+
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return types;
+}
+
+static gboolean
+_adg_has_type(const GType *types, GType type)
+{
+    for (; *types != G_TYPE_INVALID; ++types)
+        if (*types == type)
+            return TRUE;
+
+    return FALSE;
+}
+
+static gboolean
+_adg_is_stored(GParamSpec *pspec)
+{
+    const gchar *name = pspec->name;
+    GType owner = pspec->owner_type;
+
+    if ((pspec->flags & G_PARAM_WRITABLE) == 0 ||
+        (pspec->flags & G_PARAM_CONSTRUCT_ONLY) != 0)
+        return FALSE;
+
+    /* The parent is set by the containers, the trail of the markers is
+     * set by the dimensions while arranging, the fill pattern is built
+     * by AdgRuledFill and the cache directory is not part of the drawing */
+    if ((owner == ADG_TYPE_ENTITY && strcmp(name, "parent") == 0) ||
+        (owner == ADG_TYPE_MARKER && (strcmp(name, "trail") == 0 ||
+                                      strcmp(name, "model") == 0)) ||
+        (owner == ADG_TYPE_FILL_STYLE && strcmp(name, "pattern") == 0) ||
+        (owner == ADG_TYPE_CANVAS && strcmp(name, "cache-dir") == 0))
+        return FALSE;
+
+    return (pspec->flags & G_PARAM_READABLE) != 0 || _adg_is_template(pspec);
+}
+
+/* The markers of AdgDimStyle are write-only: they are saved by
+ * rebuilding them from the template stored by the style */
+static gboolean
+_adg_is_template(GParamSpec *pspec)
+{
+    return pspec->owner_type == ADG_TYPE_DIM_STYLE &&
+           g_type_is_a(pspec->value_type, ADG_TYPE_MARKER);
+}
+
+static _AdgValueKind
+_adg_value_kind(GParamSpec *pspec)
+{
+    GParamSpec *target = g_param_spec_get_redirect_target(pspec);
+    GType type = pspec->value_type;
+
+    /* The interface properties (e.g. AdgTextual:font-dress)
+     * are overriden by the implementations */
+    if (target != NULL)
+        pspec = target;
+
+    if (ADG_IS_PARAM_DRESS(pspec))
+        return _ADG_VALUE_DRESS;
+
+    switch (G_TYPE_FUNDAMENTAL(type)) {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+        return _ADG_VALUE_INTEGER;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+        return _ADG_VALUE_DOUBLE;
+    case G_TYPE_STRING:
+        return _ADG_VALUE_STRING;
+    default:
+        break;
+    }
+
+    if (type == CPML_TYPE_PAIR)
+        return _ADG_VALUE_PAIR;
+    if (type == ADG_TYPE_POINT)
+        return _ADG_VALUE_POINT;
+    if (type == CAIRO_GOBJECT_TYPE_MATRIX)
+        return _ADG_VALUE_MATRIX;
+    if (type == ADG_TYPE_DASH)
+        return _ADG_VALUE_DASH;
+    if (type == G_TYPE_STRV)
+        return _ADG_VALUE_STRV;
+
+    /* Models are reloaded as AdgPath, so the property must accept it */
+    if (g_type_is_a(type, ADG_TYPE_MODEL) && g_type_is_a(ADG_TYPE_PATH, type))
+        return _ADG_VALUE_MODEL;
+    if (g_type_is_a(type, ADG_TYPE_ENTITY))
+        return _ADG_VALUE_ENTITY;
+
+    return _ADG_VALUE_INVALID;
+}
+
+static gint64
+_adg_value_get_integer(const GValue *value)
+{
+    switch (G_TYPE_FUNDAMENTAL(G_VALUE_TYPE(value))) {
+    case G_TYPE_BOOLEAN:
+        return g_value_get_boolean(value);
+    case G_TYPE_CHAR:
+        return g_value_get_schar(value);
+    case G_TYPE_UCHAR:
+        return g_value_get_uchar(value);
+    case G_TYPE_INT:
+        return g_value_get_int(value);
+    case G_TYPE_UINT:
+        return g_value_get_uint(value);
+    case G_TYPE_LONG:
+        return g_value_get_long(value);
+    case G_TYPE_ULONG:
+        return g_value_get_ulong(value);
+    case G_TYPE_INT64:
+        return g_value_get_int64(value);
+    case G_TYPE_UINT64:
+        return (gint64) g_value_get_uint64(value);
+    case G_TYPE_ENUM:
+        return g_value_get_enum(value);
+    case G_TYPE_FLAGS:
+        return g_value_get_flags(value);
+    default:
+        g_return_val_if_reached(0);
+    }
+}
+
+static void
+_adg_value_set_integer(GValue *value, gint64 integer)
+{
+    switch (G_TYPE_FUNDAMENTAL(G_VALUE_TYPE(value))) {
+    case G_TYPE_BOOLEAN:
+        g_value_set_boolean(value, integer != 0);
+        break;
+    case G_TYPE_CHAR:
+        g_value_set_schar(value, integer);
+        break;
+    case G_TYPE_UCHAR:
+        g_value_set_uchar(value, integer);
+        break;
+    case G_TYPE_INT:
+        g_value_set_int(value, integer);
+        break;
+    case G_TYPE_UINT:
+        g_value_set_uint(value, integer);
+        break;
+    case G_TYPE_LONG:
+        g_value_set_long(value, integer);
+        break;
+    case G_TYPE_ULONG:
+        g_value_set_ulong(value, integer);
+        break;
+    case G_TYPE_INT64:
+        g_value_set_int64(value, integer);
+        break;
+    case G_TYPE_UINT64:
+        g_value_set_uint64(value, (guint64) integer);
+        break;
+    case G_TYPE_ENUM:
+        g_value_set_enum(value, integer);
+        break;
+    case G_TYPE_FLAGS:
+        g_value_set_flags(value, integer);
+        break;
+    default:
+        g_return_if_reached();
+    }
+}
+
+static gboolean
+_adg_write_node(_AdgWriter *writer, AdgEntity *entity)
+{
+    GByteArray *buffer;
+    GType type;
+    GPtrArray *styles;
+    GSList *children, *child;
+    gboolean result;
+    guint n;
+
+    buffer = writer->nodes;
+    type = G_OBJECT_TYPE(entity);
+
+    if (! _adg_has_type(_adg_entity_types(), type)) {
+        g_set_error(&writer->error, ADG_SNAPSHOT_ERROR,
+                    ADG_SNAPSHOT_ERROR_UNSUPPORTED,
+                    "unable to save entities of type '%s'",
+                    g_type_name(type));
+        return FALSE;
+    }
+
+    /* Dresses and styles are stored in pairs */
+    styles = g_ptr_array_new();
+    _adg_entity_foreach_style(entity, _adg_collect_style, styles);
+
+    children = ADG_IS_CONTAINER(entity) ?
+        adg_container_children((AdgContainer *) entity) : NULL;
+
+    /* The children list is in reverse order of insertion */
+    children = g_slist_reverse(children);
+
+    _adg_put_string(buffer, G_OBJECT_TYPE_NAME(entity));
+    _adg_put_uint32(buffer, styles->len / 2);
+    _adg_put_uint32(buffer, g_slist_length(children));
+
+    ++writer->n_nodes;
+    result = _adg_write_properties(writer, (GObject *) entity);
+
+    for (n = 0; n < styles->len && result; n += 2) {
+        AdgDress dress = GPOINTER_TO_INT(g_ptr_array_index(styles, n));
+
+        _adg_put_string(buffer, adg_dress_get_name(dress));
+        result = _adg_write_style(writer, g_ptr_array_index(styles, n + 1));
+    }
+
+    for (child = children; child != NULL && result; child = child->next)
+        result = _adg_write_node(writer, child->data);
+
+    g_ptr_array_free(styles, TRUE);
+    g_slist_free(children);
+    return result;
+}
+
+static gboolean
+_adg_write_style(_AdgWriter *writer, AdgStyle *style)
+{
+    GType type = G_OBJECT_TYPE(style);
+
+    if (! _adg_has_type(_adg_style_types(), type)) {
+        g_set_error(&writer->error, ADG_SNAPSHOT_ERROR,
+                    ADG_SNAPSHOT_ERROR_UNSUPPORTED,
+                    "unable to save styles of type '%s'",
+                    g_type_name(type));
+        return FALSE;
+    }
+
+    _adg_put_string(writer->nodes, G_OBJECT_TYPE_NAME(style));
+    return _adg_write_properties(writer, (GObject *) style);
+}
+
+static gboolean
+_adg_write_properties(_AdgWriter *writer, GObject *object)
+{
+    GByteArray *buffer;
+    GParamSpec **properties;
+    guint n, n_properties, n_stored;
+    gboolean result;
+
+    buffer = writer->nodes;
+    properties = g_object_class_list_properties(G_OBJECT_GET_CLASS(object),
+                                                &n_properties);
+
+    /* Compact the stored properties at the start of the array */
+    n_stored = 0;
+    for (n = 0; n < n_properties; ++n)
+        if (_adg_is_stored(properties[n]))
+            properties[n_stored++] = properties[n];
+
+    _adg_put_uint32(buffer, n_stored);
+    _adg_put_uint32(buffer, 0);
+
+    result = TRUE;
+    for (n = 0; n < n_stored && result; ++n) {
+        GParamSpec *pspec = properties[n];
+        _AdgValueKind kind = _adg_value_kind(pspec);
+        GValue value = G_VALUE_INIT;
+
+        if (kind == _ADG_VALUE_INVALID) {
+            g_set_error(&writer->error, ADG_SNAPSHOT_ERROR,
+                        ADG_SNAPSHOT_ERROR_UNSUPPORTED,
+                        "unable to save the '%s' property of '%s'",
+                        pspec->name, G_OBJECT_TYPE_NAME(object));
+            result = FALSE;
+            break;
+        }
+
+        g_value_init(&value, pspec->value_type);
+
+        if (! _adg_is_template(pspec)) {
+            g_object_get_property(object, pspec->name, &value);
+        } else {
+            AdgDimStyle *dim_style = (AdgDimStyle *) object;
+            AdgMarker *marker = strcmp(pspec->name, "marker1") == 0 ?
+                adg_dim_style_marker1_new(dim_style) :
+                adg_dim_style_marker2_new(dim_style);
+
+            if (marker != NULL)
+                g_value_take_object(&value, g_object_ref_sink(marker));
+        }
+
+        _adg_put_string(buffer, pspec->name);
+        result = _adg_write_value(writer, kind, &value);
+        g_value_unset(&value);
+    }
+
+    g_free(properties);
+    return result;
+}
+
+static gboolean
+_adg_write_value(_AdgWriter *writer, _AdgValueKind kind, const GValue *value)
+{
+    GByteArray *buffer;
+    gconstpointer boxed;
+    const gchar *name;
+
+    buffer = writer->nodes;
+    boxed = G_VALUE_HOLDS_BOXED(value) ? g_value_get_boxed(value) :
+        G_VALUE_HOLDS_OBJECT(value) ? g_value_get_object(value) : value;
+    name = kind == _ADG_VALUE_DRESS ?
+        adg_dress_get_name(g_value_get_enum(value)) : NULL;
+
+    /* The second word tells if the value is set: unset values
+     * (NULL objects, strings and boxed or undefined dresses)
+     * have no payload */
+    _adg_put_uint32(buffer, kind);
+    if (boxed == NULL || (kind == _ADG_VALUE_STRING &&
+                          g_value_get_string(value) == NULL) ||
+        (kind == _ADG_VALUE_DRESS && name == NULL)) {
+        _adg_put_uint32(buffer, 0);
+        return TRUE;
+    }
+    _adg_put_uint32(buffer, 1);
+
+    switch (kind) {
+    case _ADG_VALUE_INTEGER:
+        _adg_put_int64(buffer, _adg_value_get_integer(value));
+        break;
+    case _ADG_VALUE_DOUBLE:
+        _adg_put_double(buffer, G_VALUE_HOLDS_FLOAT(value) ?
+                        g_value_get_float(value) : g_value_get_double(value));
+        break;
+    case _ADG_VALUE_STRING:
+        _adg_put_string(buffer, g_value_get_string(value));
+        break;
+    case _ADG_VALUE_DRESS:
+        _adg_put_string(buffer, name);
+        break;
+    case _ADG_VALUE_PAIR: {
+        const CpmlPair *pair = boxed;
+
+        _adg_put_double(buffer, pair->x);
+        _adg_put_double(buffer, pair->y);
+        break;
+    }
+    case _ADG_VALUE_POINT: {
+        AdgPoint *point = (AdgPoint *) boxed;
+        AdgModel *model = adg_point_get_model(point);
+        CpmlPair *pair = model == NULL ? adg_point_get_pair(point) : NULL;
+
+        /* Points bound to a model are saved by reference */
+        _adg_put_uint32(buffer, model != NULL ?
+                        _adg_model_id(writer, model) : _ADG_NO_MODEL);
+        _adg_put_uint32(buffer, 0);
+        _adg_put_string(buffer, adg_point_get_name(point));
+        _adg_put_double(buffer, pair != NULL ? pair->x : 0);
+        _adg_put_double(buffer, pair != NULL ? pair->y : 0);
+        g_free(pair);
+        break;
+    }
+    case _ADG_VALUE_MATRIX:
+        _adg_put_matrix(buffer, boxed);
+        break;
+    case _ADG_VALUE_DASH: {
+        const AdgDash *dash = boxed;
+        gint n_dashes = adg_dash_get_num_dashes(dash);
+
+        _adg_put_uint32(buffer, n_dashes);
+        _adg_put_uint32(buffer, 0);
+        if (n_dashes > 0)
+            g_byte_array_append(buffer,
+                                (const guint8 *) adg_dash_get_dashes(dash),
+                                sizeof(gdouble) * n_dashes);
+        _adg_put_double(buffer, adg_dash_get_offset(dash));
+        break;
+    }
+    case _ADG_VALUE_STRV: {
+        const gchar * const *strings = boxed;
+
+        _adg_put_uint32(buffer, g_strv_length((gchar **) strings));
+        _adg_put_uint32(buffer, 0);
+        for (; *strings != NULL; ++strings)
+            _adg_put_string(buffer, *strings);
+        break;
+    }
+    case _ADG_VALUE_MODEL:
+        _adg_put_uint32(buffer, _adg_model_id(writer, (AdgModel *) boxed));
+        _adg_put_uint32(buffer, 0);
+        break;
+    case _ADG_VALUE_ENTITY:
+        return _adg_write_node(writer, (AdgEntity *) boxed);
+    default:
+        g_return_val_if_reached(FALSE);
+    }
+
+    return TRUE;
+}
+
+static void
+_adg_collect_style(gpointer key, gpointer value, gpointer user_data)
+{
+    GPtrArray *styles = (GPtrArray *) user_data;
+
+    g_ptr_array_add(styles, key);
+    g_ptr_array_add(styles, value);
+}
+
+/* Models shared by more entities are saved only once */
+static guint32
+_adg_model_id(_AdgWriter *writer, AdgModel *model)
+{
+    gpointer id;
+    guint32 model_id;
+
+    if (g_hash_table_lookup_extended(writer->model_ids, model, NULL, &id))
+        return GPOINTER_TO_UINT(id);
+
+    model_id = writer->models->len;
+    g_hash_table_insert(writer->model_ids, model, GUINT_TO_POINTER(model_id));
+    g_ptr_array_add(writer->models, model);
+
+    return model_id;
+}
+
+static void
+_adg_write_model(GByteArray *buffer, AdgModel *model)
+{
+    const cairo_path_t *cairo_path;
+    _AdgPairs pairs;
+    guint32 n_data;
+
+    /* Models without path data keep only their named pairs. The
+     * unexpanded path is stored, so arcs are kept as CPML_ARC */
+    cairo_path = ADG_IS_TRAIL(model) ?
+        adg_trail_cairo_path((AdgTrail *) model) : NULL;
+    n_data = cairo_path != NULL ? cairo_path->num_data : 0;
+
+    _adg_put_uint32(buffer, n_data);
+
+    /* The number of named pairs is known only after scanning them */
+    pairs.buffer = buffer;
+    pairs.offset = buffer->len;
+    pairs.n_pairs = 0;
+    _adg_put_uint32(buffer, 0);
+
+    if (n_data > 0)
+        g_byte_array_append(buffer, (const guint8 *) cairo_path->data,
+                            sizeof(cairo_path_data_t) * n_data);
+
+    adg_model_foreach_named_pair(model, _adg_write_named_pair, &pairs);
+    memcpy(buffer->data + pairs.offset, &pairs.n_pairs, sizeof(guint32));
+}
+
+static void
+_adg_write_named_pair(AdgModel *model, const gchar *name,
+                      CpmlPair *pair, gpointer user_data)
+{
+    _AdgPairs *pairs = (_AdgPairs *) user_data;
+
+    _adg_put_string(pairs->buffer, name);
+    _adg_put_double(pairs->buffer, pair->x);
+    _adg_put_double(pairs->buffer, pair->y);
+    ++pairs->n_pairs;
+}
+
+static void
+_adg_put_uint32(GByteArray *buffer, guint32 value)
+{
+    g_byte_array_append(buffer, (const guint8 *) &value, sizeof(value));
+}
+
+static void
+_adg_put_int64(GByteArray *buffer, gint64 value)
+{
+    g_byte_array_append(buffer, (const guint8 *) &value, sizeof(value));
+}
+
+static void
+_adg_put_double(GByteArray *buffer, gdouble value)
+{
+    g_byte_array_append(buffer, (const guint8 *) &value, sizeof(value));
+}
+
+static void
+_adg_put_string(GByteArray *buffer, const gchar *string)
+{
+    static const guint8 padding[8] = { 0 };
+    guint32 len = string != NULL ? strlen(string) : 0;
+
+    /* Keep the following data aligned to 8 bytes */
+    _adg_put_uint32(buffer, len);
+    _adg_put_uint32(buffer, 0);
+    g_byte_array_append(buffer, (const guint8 *) string, len);
+    g_byte_array_append(buffer, padding, (8 - len % 8) % 8);
+}
+
+static void
+_adg_put_matrix(GByteArray *buffer, const cairo_matrix_t *matrix)
+{
+    _adg_put_double(buffer, matrix->xx);
+    _adg_put_double(buffer, matrix->yx);
+    _adg_put_double(buffer, matrix->xy);
+    _adg_put_double(buffer, matrix->yy);
+    _adg_put_double(buffer, matrix->x0);
+    _adg_put_double(buffer, matrix->y0);
+}
+
+static AdgEntity *
+_adg_read_node(_AdgReader *reader, GPtrArray *models, guint depth)
+{
+    GType type;
+    guint32 n_styles, n_children, n;
+    AdgEntity *entity, *child;
+
+    type = _adg_get_type(reader, _adg_entity_types());
+
+    /* Every style and every child takes at least 8 bytes */
+    n_styles = _adg_get_count(reader, 8);
+    n_children = _adg_get_count(reader, 8);
+
+    /* Only containers can have children */
+    if (depth > _ADG_MAX_DEPTH ||
+        (n_children > 0 && ! g_type_is_a(type, ADG_TYPE_CONTAINER)))
+        reader->failed = TRUE;
+
+    if (reader->failed)
+        return NULL;
+
+    entity = g_object_new(type, NULL);
+    _adg_read_properties(reader, models, (GObject *) entity, depth);
+
+    for (n = 0; n < n_styles && ! reader->failed; ++n)
+        _adg_read_style(reader, models, entity, depth);
+
+    for (n = 0; n < n_children && ! reader->failed; ++n) {
+        child = _adg_read_node(reader, models, depth + 1);
+        if (child != NULL)
+            adg_container_add((AdgContainer *) entity, child);
+    }
+
+    if (reader->failed) {
+        adg_entity_destroy(entity);
+        return NULL;
+    }
+
+    return entity;
+}
+
+static void
+_adg_read_style(_AdgReader *reader, GPtrArray *models,
+                AdgEntity *entity, guint depth)
+{
+    gchar *name;
+    AdgDress dress;
+    GType type;
+    AdgStyle *style;
+
+    name = _adg_get_string(reader);
+    dress = name != NULL ? adg_dress_from_name(name) : ADG_DRESS_UNDEFINED;
+    g_free(name);
+
+    type = _adg_get_type(reader, _adg_style_types());
+    if (reader->failed)
+        return;
+
+    style = g_object_new(type, NULL);
+    _adg_read_properties(reader, models, (GObject *) style, depth);
+
+    /* Overrides of dresses not registered in this process are dropped */
+    if (dress != ADG_DRESS_UNDEFINED && ! reader->failed) {
+        if (adg_dress_style_is_compatible(dress, style))
+            adg_entity_set_style(entity, dress, style);
+        else
+            reader->failed = TRUE;
+    }
+
+    g_object_unref(style);
+}
+
+static void
+_adg_read_properties(_AdgReader *reader, GPtrArray *models,
+                     GObject *object, guint depth)
+{
+    GObjectClass *object_class;
+    GParamSpec *pspec;
+    gchar *name;
+    guint32 n_properties, n;
+
+    object_class = G_OBJECT_GET_CLASS(object);
+
+    /* Every property takes at least 24 bytes */
+    n_properties = _adg_get_count(reader, 24);
+    _adg_get_uint32(reader);
+
+    for (n = 0; n < n_properties && ! reader->failed; ++n) {
+        name = _adg_get_string(reader);
+        pspec = name != NULL ? g_object_class_find_property(object_class, name) : NULL;
+        g_free(name);
+
+        if (pspec == NULL || ! _adg_is_stored(pspec))
+            reader->failed = TRUE;
+        else
+            _adg_read_value(reader, models, object, pspec, depth);
+    }
+}
+
+static void
+_adg_read_value(_AdgReader *reader, GPtrArray *models, GObject *object,
+                GParamSpec *pspec, guint depth)
+{
+    _AdgValueKind kind;
+    GValue value = G_VALUE_INIT;
+    AdgEntity *entity;
+    gboolean is_set;
+
+    kind = _adg_get_uint32(reader);
+    is_set = _adg_get_uint32(reader) != 0;
+
+    if (reader->failed || kind == _ADG_VALUE_INVALID ||
+        kind != _adg_value_kind(pspec)) {
+        reader->failed = TRUE;
+        return;
+    }
+
+    /* Undefined dresses keep the default value */
+    if (! is_set && kind == _ADG_VALUE_DRESS)
+        return;
+
+    g_value_init(&value, pspec->value_type);
+    entity = NULL;
+
+    if (is_set) {
+        switch (kind) {
+        case _ADG_VALUE_INTEGER:
+            _adg_value_set_integer(&value, _adg_get_int64(reader));
+            break;
+        case _ADG_VALUE_DOUBLE:
+            if (G_VALUE_HOLDS_FLOAT(&value))
+                g_value_set_float(&value, _adg_get_double(reader));
+            else
+                g_value_set_double(&value, _adg_get_double(reader));
+            break;
+        case _ADG_VALUE_STRING: {
+            gchar *string = _adg_get_string(reader);
+            g_value_take_string(&value, string != NULL ? string : g_strdup(""));
+            break;
+        }
+        case _ADG_VALUE_DRESS: {
+            gchar *name = _adg_get_string(reader);
+            AdgDress dress = name != NULL ?
+                adg_dress_from_name(name) : ADG_DRESS_UNDEFINED;
+
+            g_free(name);
+            if (dress == ADG_DRESS_UNDEFINED) {
+                /* Dresses not registered in this process are dropped */
+                g_value_unset(&value);
+                return;
+            }
+            g_value_set_enum(&value, dress);
+            break;
+        }
+        case _ADG_VALUE_PAIR: {
+            CpmlPair pair;
+
+            pair.x = _adg_get_double(reader);
+            pair.y = _adg_get_double(reader);
+            g_value_set_boxed(&value, &pair);
+            break;
+        }
+        case _ADG_VALUE_POINT: {
+            AdgPoint *point;
+            guint32 model;
+            gchar *name;
+            gdouble x, y;
+
+            model = _adg_get_uint32(reader);
+            _adg_get_uint32(reader);
+            name = _adg_get_string(reader);
+            x = _adg_get_double(reader);
+            y = _adg_get_double(reader);
+
+            point = adg_point_new();
+            if (model == _ADG_NO_MODEL)
+                adg_point_set_pair_explicit(point, x, y);
+            else if (model < models->len && name != NULL)
+                adg_point_set_pair_from_model(point,
+                                              g_ptr_array_index(models, model),
+                                              name);
+            else
+                reader->failed = TRUE;
+
+            g_value_take_boxed(&value, point);
+            g_free(name);
+            break;
+        }
+        case _ADG_VALUE_MATRIX: {
+            cairo_matrix_t matrix;
+
+            _adg_get_matrix(reader, &matrix);
+            g_value_set_boxed(&value, &matrix);
+            break;
+        }
+        case _ADG_VALUE_DASH: {
+            guint32 n_dashes = _adg_get_count(reader, sizeof(gdouble));
+            const guint8 *dashes;
+            AdgDash *dash;
+
+            _adg_get_uint32(reader);
+            dashes = _adg_get_bytes(reader, sizeof(gdouble) * n_dashes);
+            if (dashes == NULL)
+                break;
+
+            dash = adg_dash_new_with_dashes_array(n_dashes,
+                                                  (const gdouble *) dashes);
+            adg_dash_set_offset(dash, _adg_get_double(reader));
+            g_value_take_boxed(&value, dash);
+            break;
+        }
+        case _ADG_VALUE_STRV: {
+            guint32 n_strings, n;
+            gchar **strings;
+
+            /* Every string takes at least 8 bytes */
+            n_strings = _adg_get_count(reader, 8);
+            _adg_get_uint32(reader);
+            if (reader->failed)
+                break;
+
+            strings = g_new0(gchar *, n_strings + 1);
+            for (n = 0; n < n_strings; ++n) {
+                strings[n] = _adg_get_string(reader);
+                if (strings[n] == NULL)
+                    strings[n] = g_strdup("");
+            }
+            g_value_take_boxed(&value, strings);
+            break;
+        }
+        case _ADG_VALUE_MODEL: {
+            guint32 model = _adg_get_uint32(reader);
+
+            _adg_get_uint32(reader);
+            if (model < models->len)
+                g_value_set_object(&value, g_ptr_array_index(models, model));
+            else
+                reader->failed = TRUE;
+            break;
+        }
+        case _ADG_VALUE_ENTITY:
+            entity = _adg_read_node(reader, models, depth + 1);
+            if (entity != NULL &&
+                g_type_is_a(G_OBJECT_TYPE(entity), pspec->value_type))
+                g_value_set_object(&value, entity);
+            else
+                reader->failed = TRUE;
+            break;
+        default:
+            reader->failed = TRUE;
+            break;
+        }
+    }
+
+    /* Out of range values are a sign of corruption */
+    if (! reader->failed && g_param_value_validate(pspec, &value))
+        reader->failed = TRUE;
+
+    if (! reader->failed)
+        g_object_set_property(object, pspec->name, &value);
+
+    g_value_unset(&value);
+
+    /* Styles keep only a copy of the template markers, while the
+     * other entities own the entities they refer to */
+    if (entity != NULL && (reader->failed || ADG_IS_STYLE(object)))
+        adg_entity_destroy(entity);
+}
+
+static AdgPath *
+_adg_read_model(_AdgReader *reader)
+{
+    AdgPath *path;
+    guint32 n_data, n_pairs, n;
+    cairo_path_t cairo_path;
+    CpmlPair pair;
+    gchar *name;
+
+    path = adg_path_new();
+    n_data = _adg_get_count(reader, sizeof(cairo_path_data_t));
+    n_pairs = _adg_get_uint32(reader);
+
+    cairo_path.status = CAIRO_STATUS_SUCCESS;
+    cairo_path.num_data = n_data;
+    cairo_path.data = (cairo_path_data_t *)
+        _adg_get_bytes(reader, sizeof(cairo_path_data_t) * n_data);
+
+    if (cairo_path.data != NULL && ! _adg_check_path(cairo_path.data, n_data))
+        reader->failed = TRUE;
+
+    /* The whole data is appended at once: nothing is replayed */
+    if (! reader->failed && n_data > 0)
+        adg_path_append_cairo_path(path, &cairo_path);
+
+    for (n = 0; n < n_pairs && ! reader->failed; ++n) {
+        name = _adg_get_string(reader);
+        pair.x = _adg_get_double(reader);
+        pair.y = _adg_get_double(reader);
+        if (name != NULL && ! reader->failed)
+            adg_model_set_named_pair((AdgModel *) path, name, &pair);
+        g_free(name);
+    }
+
+    return path;
+}
+
+/* Walks the primitives the same way the CPML and cairo do, checking
+ * every header before it is trusted by adg_path_append_cairo_path() */
+static gboolean
+_adg_check_path(const cairo_path_data_t *data, guint32 n_data)
+{
+    guint32 n, length, n_points;
+
+    for (n = 0; n < n_data; n += length) {
+        length = data[n].header.length;
+
+        switch (data[n].header.type) {
+        case CPML_MOVE:
+        case CPML_LINE:
+            n_points = 2;
+            break;
+        case CPML_ARC:
+            n_points = 3;
+            break;
+        case CPML_CURVE:
+            n_points = 4;
+            break;
+        case CPML_CLOSE:
+            n_points = 1;
+            break;
+        default:
+            return FALSE;
+        }
+
+        if (length < n_points || length > n_data - n)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static GType
+_adg_get_type(_AdgReader *reader, const GType *types)
+{
+    gchar *name;
+    GType type;
+
+    name = _adg_get_string(reader);
+    type = G_TYPE_INVALID;
+
+    /* The types are looked up in the list because g_type_from_name()
+     * does not find the types not yet registered */
+    for (; name != NULL && *types != G_TYPE_INVALID; ++types) {
+        if (strcmp(g_type_name(*types), name) == 0) {
+            type = *types;
+            break;
+        }
+    }
+
+    if (type == G_TYPE_INVALID)
+        reader->failed = TRUE;
+
+    g_free(name);
+    return type;
+}
+
+static const guint8 *
+_adg_get_bytes(_AdgReader *reader, gsize size)
+{
+    const guint8 *bytes;
+
+    if (reader->failed || size > reader->size - reader->pos) {
+        reader->failed = TRUE;
+        return NULL;
+    }
+
+    bytes = reader->data + reader->pos;
+    reader->pos += size;
+    return bytes;
+}
+
+static guint32
+_adg_get_uint32(_AdgReader *reader)
+{
+    const guint8 *bytes = _adg_get_bytes(reader, sizeof(guint32));
+    guint32 value = 0;
+
+    if (bytes != NULL)
+        memcpy(&value, bytes, sizeof(value));
+
+    return value;
+}
+
+static gint64
+_adg_get_int64(_AdgReader *reader)
+{
+    const guint8 *bytes = _adg_get_bytes(reader, sizeof(gint64));
+    gint64 value = 0;
+
+    if (bytes != NULL)
+        memcpy(&value, bytes, sizeof(value));
+
+    return value;
+}
+
+static gdouble
+_adg_get_double(_AdgReader *reader)
+{
+    const guint8 *bytes = _adg_get_bytes(reader, sizeof(gdouble));
+    gdouble value = 0;
+
+    if (bytes != NULL)
+        memcpy(&value, bytes, sizeof(value));
+
+    return value;
+}
+
+static gchar *
+_adg_get_string(_AdgReader *reader)
+{
+    guint32 len;
+    const guint8 *bytes;
+
+    len = _adg_get_uint32(reader);
+    _adg_get_uint32(reader);
+
+    if (len == 0)
+        return NULL;
+
+    bytes = _adg_get_bytes(reader, len);
+    _adg_get_bytes(reader, (8 - len % 8) % 8);
+
+    return bytes != NULL ? g_strndup((const gchar *) bytes, len) : NULL;
+}
+
+static void
+_adg_get_matrix(_AdgReader *reader, cairo_matrix_t *matrix)
+{
+    matrix->xx = _adg_get_double(reader);
+    matrix->yx = _adg_get_double(reader);
+    matrix->xy = _adg_get_double(reader);
+    matrix->yy = _adg_get_double(reader);
+    matrix->x0 = _adg_get_double(reader);
+    matrix->y0 = _adg_get_double(reader);
+}
+
+/* Reads the number of following items, each taking at least
+ * @min_size bytes: checking it upfront against the remaining size
+ * rejects bogus counts before allocating or looping on them */
+static guint32
+_adg_get_count(_AdgReader *reader, gsize min_size)
+{
+    guint32 count = _adg_get_uint32(reader);
+
+    if (! reader->failed && count > (reader->size - reader->pos) / min_size)
+        reader->failed = TRUE;
+
+    return reader->failed ? 0 : count;
+}
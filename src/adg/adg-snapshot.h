@@ -0,0 +1,50 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_SNAPSHOT_H__
+#define __ADG_SNAPSHOT_H__
+
+
+G_BEGIN_DECLS
+
+#define ADG_SNAPSHOT_ERROR          (adg_snapshot_error_quark())
+
+typedef enum {
+    ADG_SNAPSHOT_ERROR_UNSUPPORTED,
+    ADG_SNAPSHOT_ERROR_INVALID,
+} AdgSnapshotError;
+
+
+GQuark          adg_snapshot_error_quark        (void);
+gboolean        adg_snapshot_save               (AdgEntity      *entity,
+                                                 const gchar    *file,
+                                                 GError        **error);
+AdgEntity *     adg_snapshot_load               (const gchar    *file,
+                                                 GError        **error);
+
+G_END_DECLS
+
+
+#endif /* __ADG_SNAPSHOT_H__ */
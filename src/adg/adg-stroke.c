@@ -76,6 +76,7 @@ static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static AdgDress         _adg_lod_dress          (AdgEntity      *entity);
 static void             _adg_unset_trail        (AdgStroke      *stroke);
 
 
@@ -97,6 +98,9 @@ adg_stroke_class_init(AdgStrokeClass *klass)
     entity_class->local_changed = _adg_local_changed;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->lod_dress = _adg_lod_dress;
+    entity_class->batchable = TRUE;
+    entity_class->lod_policy = ADG_LOD_POLICY_DOT;
 
     param = adg_param_spec_dress("line-dress",
                                  P_("Line Dress"),
@@ -342,17 +346,18 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 
     if (cairo_path != NULL) {
         cairo_transform(cr, adg_entity_get_global_matrix(entity));
-
-        cairo_save(cr);
-        cairo_transform(cr, adg_entity_get_local_matrix(entity));
-        cairo_append_path(cr, cairo_path);
-        cairo_restore(cr);
-
-        adg_entity_apply_dress(entity, data->line_dress, cr);
-        cairo_stroke(cr);
+        adg_entity_stroke_path(entity, data->line_dress, cairo_path,
+                               adg_entity_get_local_matrix(entity), cr);
     }
 }
 
+static AdgDress
+_adg_lod_dress(AdgEntity *entity)
+{
+    AdgStrokePrivate *data = adg_stroke_get_instance_private((AdgStroke *) entity);
+    return data->line_dress;
+}
+
 static void
 _adg_unset_trail(AdgStroke *stroke)
 {
@@ -0,0 +1,940 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-svg
+ * @Section_Id:svg
+ * @title: SVG writer
+ * @short_description: Structured export of drawings in the SVG format
+ *
+ * The SVG surface of cairo writes a drawing as a flat list of painting
+ * operations. The SVG writer instead walks the arranged entity tree
+ * and keeps its structure in the output document:
+ * <itemizedlist>
+ * <listitem>every entity becomes a &lt;g&gt; element, so containers
+ *           and dimensions group their children the same way they
+ *           do in the #AdgEntity tree;</listitem>
+ * <listitem>the styles are not inlined: every #AdgDress used by the
+ *           drawing becomes a CSS class, named after the dress (e.g.
+ *           "line-stroke" for #ADG_DRESS_LINE_STROKE) and defined
+ *           only once;</listitem>
+ * <listitem>geometries used more than once, such as the arrows of
+ *           the dimensions or an #AdgTrail stroked by different
+ *           entities, are written once in a &lt;symbol&gt; and then
+ *           instantiated with &lt;use&gt;.</listitem>
+ * </itemizedlist>
+ *
+ * #AdgStroke, #AdgHatch, #AdgLDim, #AdgADim, #AdgRDim, #AdgMarker and
+ * the entities implementing #AdgTextual are exported. Any other entity
+ * (e.g. tables and the title block) is silently skipped. The hatches
+ * filled by an #AdgRuledFill are rendered with an SVG &lt;pattern&gt;.
+ *
+ * The document is written incrementally while walking the tree: the
+ * CSS classes and the symbols are defined just before their first
+ * use, so only a small buffer is kept in memory.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <gio/gio.h>
+#include <math.h>
+#include <string.h>
+
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-container.h"
+#include "adg-alignment.h"
+#include "adg-marker.h"
+#include "adg-style.h"
+#include "adg-dress.h"
+#include "adg-color-style.h"
+#include "adg-dash.h"
+#include "adg-line-style.h"
+#include "adg-font-style.h"
+#include "adg-fill-style.h"
+#include "adg-ruled-fill.h"
+#include "adg-dim-style.h"
+#include "adg-textual.h"
+#include "adg-stroke.h"
+#include "adg-hatch.h"
+#include "adg-dim.h"
+#include "adg-ldim.h"
+#include "adg-adim.h"
+#include "adg-rdim.h"
+#include "adg-canvas.h"
+
+#include "adg-svg.h"
+
+
+/* The buffer is sent to the stream whenever it grows over this size */
+#define _ADG_SVG_CHUNK          4096
+#define _ADG_SVG_EPSILON        1e-9
+
+typedef struct {
+    GOutputStream  *stream;
+    GCancellable   *cancellable;
+    GError         *error;
+    GString        *buffer;
+    guint           id;
+    GHashTable     *counts;
+    GHashTable     *defs;
+    GHashTable     *classes;
+    GHashTable     *names;
+} _AdgSvg;
+
+
+static void             _adg_count_instances    (_AdgSvg        *svg,
+                                                 AdgEntity      *entity);
+static void             _adg_count_key          (_AdgSvg        *svg,
+                                                 gchar          *key);
+static gboolean         _adg_dim_parts          (AdgEntity      *entity,
+                                                 AdgTrail      **trail,
+                                                 AdgMarker     **marker1,
+                                                 AdgMarker     **marker2);
+static gchar *          _adg_stroke_key         (AdgStroke      *stroke);
+static gchar *          _adg_marker_key         (AdgMarker      *marker);
+static void             _adg_write_entity       (_AdgSvg        *svg,
+                                                 AdgEntity      *entity);
+static void             _adg_write_stroke       (_AdgSvg        *svg,
+                                                 AdgStroke      *stroke);
+static void             _adg_write_hatch        (_AdgSvg        *svg,
+                                                 AdgHatch       *hatch);
+static void             _adg_write_marker       (_AdgSvg        *svg,
+                                                 AdgMarker      *marker);
+static void             _adg_write_textual      (_AdgSvg        *svg,
+                                                 AdgTextual     *textual);
+static void             _adg_write_dim          (_AdgSvg        *svg,
+                                                 AdgDim         *dim);
+static void             _adg_write_geometry     (_AdgSvg        *svg,
+                                                 gchar          *key,
+                                                 const cairo_path_t *cairo_path,
+                                                 const cairo_matrix_t *matrix,
+                                                 const cairo_matrix_t *placement);
+static const gchar *    _adg_class              (_AdgSvg        *svg,
+                                                 AdgEntity      *entity,
+                                                 AdgDress        dress);
+static void             _adg_append_style       (_AdgSvg        *svg,
+                                                 GString        *css,
+                                                 AdgEntity      *entity,
+                                                 AdgStyle       *style);
+static void             _adg_append_color       (GString        *css,
+                                                 const gchar    *property,
+                                                 AdgEntity      *entity,
+                                                 AdgDress        dress);
+static guint            _adg_pattern            (_AdgSvg        *svg,
+                                                 AdgEntity      *entity,
+                                                 AdgRuledFill   *ruled_fill);
+static gchar *          _adg_class_name         (AdgDress        dress);
+static void             _adg_put                (_AdgSvg        *svg,
+                                                 const gchar    *format,
+                                                 ...) G_GNUC_PRINTF(2, 3);
+static void             _adg_put_matrix         (_AdgSvg        *svg,
+                                                 const gchar    *attribute,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_put_path           (_AdgSvg        *svg,
+                                                 const cairo_path_t *cairo_path,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_put_pair           (_AdgSvg        *svg,
+                                                 const cairo_path_data_t *data,
+                                                 const cairo_matrix_t *matrix);
+static void             _adg_append_double      (GString        *string,
+                                                 gdouble         value);
+static void             _adg_flush              (_AdgSvg        *svg,
+                                                 gboolean        force);
+
+
+/**
+ * adg_svg_write:
+ * @entity: the root #AdgEntity to export
+ * @stream: the #GOutputStream where to write the document
+ * @cancellable: (allow-none): optional #GCancellable object, <constant>NULL</constant> to ignore
+ * @error: (allow-none): return location for a #GError or <constant>NULL</constant>
+ *
+ * Arranges @entity and writes it, together with its children, in
+ * @stream as an SVG document. Check the section description for
+ * details on how the entities are exported. The document is written
+ * in chunks while walking the tree, so @stream is not required to
+ * be seekable and it is not closed at the end.
+ *
+ * If @entity is an #AdgCanvas, its margins are included in the
+ * viewport of the document.
+ *
+ * Any error raised by @stream (including the cancellation through
+ * @cancellable) stops the export and is reported in @error, if not
+ * <constant>NULL</constant>.
+ *
+ * Returns: <constant>TRUE</constant> on success, <constant>FALSE</constant> otherwise.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_svg_write(AdgEntity *entity, GOutputStream *stream,
+              GCancellable *cancellable, GError **error)
+{
+    _AdgSvg svg;
+    CpmlExtents extents;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), FALSE);
+    g_return_val_if_fail(G_IS_OUTPUT_STREAM(stream), FALSE);
+    g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    adg_entity_arrange(entity);
+
+    svg.stream = stream;
+    svg.cancellable = cancellable;
+    svg.error = NULL;
+    svg.buffer = g_string_sized_new(_ADG_SVG_CHUNK);
+    svg.id = 0;
+    svg.counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    svg.defs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    svg.classes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    svg.names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    /* Only the geometries used more than once become symbols */
+    _adg_count_instances(&svg, entity);
+
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    if (ADG_IS_CANVAS(entity))
+        adg_canvas_apply_margins((AdgCanvas *) entity, &extents);
+
+    _adg_put(&svg, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             "<svg xmlns=\"http://www.w3.org/2000/svg\""
+             " xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\"");
+
+    if (extents.is_defined) {
+        _adg_put(&svg, " width=\"");
+        _adg_append_double(svg.buffer, extents.size.x);
+        _adg_put(&svg, "\" height=\"");
+        _adg_append_double(svg.buffer, extents.size.y);
+        _adg_put(&svg, "\" viewBox=\"");
+        _adg_append_double(svg.buffer, extents.org.x);
+        _adg_put(&svg, " ");
+        _adg_append_double(svg.buffer, extents.org.y);
+        _adg_put(&svg, " ");
+        _adg_append_double(svg.buffer, extents.size.x);
+        _adg_put(&svg, " ");
+        _adg_append_double(svg.buffer, extents.size.y);
+        _adg_put(&svg, "\"");
+    }
+
+    _adg_put(&svg, ">\n");
+    _adg_write_entity(&svg, entity);
+    _adg_put(&svg, "</svg>\n");
+    _adg_flush(&svg, TRUE);
+
+    g_string_free(svg.buffer, TRUE);
+    g_hash_table_destroy(svg.counts);
+    g_hash_table_destroy(svg.defs);
+    g_hash_table_destroy(svg.classes);
+    g_hash_table_destroy(svg.names);
+
+    if (svg.error != NULL) {
+        g_propagate_error(error, svg.error);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+static void
+_adg_count_instances(_AdgSvg *svg, AdgEntity *entity)
+{
+    AdgTrail *trail;
+    AdgMarker *marker1, *marker2;
+
+    if (ADG_IS_CONTAINER(entity)) {
+        GSList *children, *child;
+
+        children = adg_container_children((AdgContainer *) entity);
+        for (child = children; child != NULL; child = child->next)
+            _adg_count_instances(svg, child->data);
+        g_slist_free(children);
+    } else if (ADG_IS_HATCH(entity)) {
+        /* Hatches are written in global space: nothing to share */
+    } else if (ADG_IS_STROKE(entity)) {
+        _adg_count_key(svg, _adg_stroke_key((AdgStroke *) entity));
+    } else if (ADG_IS_MARKER(entity)) {
+        _adg_count_key(svg, _adg_marker_key((AdgMarker *) entity));
+    } else if (_adg_dim_parts(entity, &trail, &marker1, &marker2)) {
+        if (marker1 != NULL)
+            _adg_count_key(svg, _adg_marker_key(marker1));
+        if (marker2 != NULL)
+            _adg_count_key(svg, _adg_marker_key(marker2));
+    }
+}
+
+static void
+_adg_count_key(_AdgSvg *svg, gchar *key)
+{
+    guint count;
+
+    if (key == NULL)
+        return;
+
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(svg->counts, key));
+    g_hash_table_replace(svg->counts, key, GUINT_TO_POINTER(count + 1));
+}
+
+static gboolean
+_adg_dim_parts(AdgEntity *entity, AdgTrail **trail,
+               AdgMarker **marker1, AdgMarker **marker2)
+{
+    if (ADG_IS_LDIM(entity))
+        _adg_ldim_get_lines((AdgLDim *) entity, trail, marker1, marker2);
+    else if (ADG_IS_ADIM(entity))
+        _adg_adim_get_lines((AdgADim *) entity, trail, marker1, marker2);
+    else if (ADG_IS_RDIM(entity))
+        _adg_rdim_get_lines((AdgRDim *) entity, trail, marker1, marker2);
+    else
+        return FALSE;
+
+    return TRUE;
+}
+
+static gchar *
+_adg_stroke_key(AdgStroke *stroke)
+{
+    AdgTrail *trail;
+    const cairo_matrix_t *local;
+
+    trail = adg_stroke_get_trail(stroke);
+    if (trail == NULL)
+        return NULL;
+
+    /* The line width does not depend on the local matrix, so the
+     * geometry can be shared only if the trail is transformed in
+     * the same way: the translation is left to <use> */
+    local = adg_entity_get_local_matrix((AdgEntity *) stroke);
+    return g_strdup_printf("%p %a %a %a %a", (gpointer) trail,
+                           local->xx, local->yx, local->xy, local->yy);
+}
+
+static gchar *
+_adg_marker_key(AdgMarker *marker)
+{
+    AdgModel *model = adg_marker_model(marker);
+
+    /* Markers are filled, so the whole transformation is left to <use> */
+    if (! ADG_IS_TRAIL(model))
+        return NULL;
+
+    return g_strdup_printf("%p", (gpointer) model);
+}
+
+static void
+_adg_write_entity(_AdgSvg *svg, AdgEntity *entity)
+{
+    if (svg->error != NULL)
+        return;
+
+    if (ADG_IS_CONTAINER(entity)) {
+        GSList *children, *child;
+
+        /* The children list is built by prepending */
+        children = adg_container_children((AdgContainer *) entity);
+        children = g_slist_reverse(children);
+        _adg_put(svg, "<g>\n");
+        for (child = children; child != NULL; child = child->next)
+            _adg_write_entity(svg, child->data);
+        _adg_put(svg, "</g>\n");
+        g_slist_free(children);
+    } else if (ADG_IS_HATCH(entity)) {
+        _adg_write_hatch(svg, (AdgHatch *) entity);
+    } else if (ADG_IS_STROKE(entity)) {
+        _adg_write_stroke(svg, (AdgStroke *) entity);
+    } else if (ADG_IS_MARKER(entity)) {
+        _adg_write_marker(svg, (AdgMarker *) entity);
+    } else if (ADG_IS_TEXTUAL(entity)) {
+        _adg_write_textual(svg, (AdgTextual *) entity);
+    } else if (ADG_IS_DIM(entity)) {
+        _adg_write_dim(svg, (AdgDim *) entity);
+    }
+
+    _adg_flush(svg, FALSE);
+}
+
+static void
+_adg_write_stroke(_AdgSvg *svg, AdgStroke *stroke)
+{
+    AdgEntity *entity;
+    AdgTrail *trail;
+    const cairo_path_t *cairo_path;
+    const cairo_matrix_t *local;
+    cairo_matrix_t linear, placement;
+    const gchar *class_name;
+
+    entity = (AdgEntity *) stroke;
+    trail = adg_stroke_get_trail(stroke);
+    cairo_path = trail != NULL ? adg_trail_get_cairo_path(trail) : NULL;
+    if (cairo_path == NULL)
+        return;
+
+    local = adg_entity_get_local_matrix(entity);
+    adg_matrix_copy(&linear, local);
+    linear.x0 = linear.y0 = 0;
+    cairo_matrix_init_translate(&placement, local->x0, local->y0);
+
+    class_name = _adg_class(svg, entity, adg_stroke_get_line_dress(stroke));
+
+    /* As in rendering, the line width is in global space */
+    _adg_put(svg, "<g class=\"%s\"", class_name);
+    _adg_put_matrix(svg, "transform", adg_entity_get_global_matrix(entity));
+    _adg_put(svg, ">\n");
+    _adg_write_geometry(svg, _adg_stroke_key(stroke),
+                        cairo_path, &linear, &placement);
+    _adg_put(svg, "</g>\n");
+}
+
+static void
+_adg_write_hatch(_AdgSvg *svg, AdgHatch *hatch)
+{
+    AdgEntity *entity;
+    AdgTrail *trail;
+    const cairo_path_t *cairo_path;
+    cairo_matrix_t map;
+    const gchar *class_name;
+
+    entity = (AdgEntity *) hatch;
+    trail = adg_stroke_get_trail((AdgStroke *) hatch);
+    cairo_path = trail != NULL ? adg_trail_get_cairo_path(trail) : NULL;
+    if (cairo_path == NULL)
+        return;
+
+    cairo_matrix_multiply(&map, adg_entity_get_local_matrix(entity),
+                          adg_entity_get_global_matrix(entity));
+    class_name = _adg_class(svg, entity, adg_hatch_get_fill_dress(hatch));
+
+    /* The fill patterns are defined in global space, so the path
+     * is fully transformed instead of using a transform attribute */
+    _adg_put(svg, "<g class=\"%s\">\n<path", class_name);
+    _adg_put_path(svg, cairo_path, &map);
+    _adg_put(svg, "/>\n</g>\n");
+}
+
+static void
+_adg_write_marker(_AdgSvg *svg, AdgMarker *marker)
+{
+    AdgEntity *entity;
+    AdgModel *model;
+    const cairo_path_t *cairo_path;
+    cairo_matrix_t map;
+
+    entity = (AdgEntity *) marker;
+    model = adg_marker_model(marker);
+    if (! ADG_IS_TRAIL(model))
+        return;
+
+    cairo_path = adg_trail_get_cairo_path((AdgTrail *) model);
+    if (cairo_path == NULL)
+        return;
+
+    cairo_matrix_multiply(&map, adg_entity_get_local_matrix(entity),
+                          adg_entity_get_global_matrix(entity));
+
+    /* The fill color is inherited from the parent, as in rendering */
+    _adg_put(svg, "<g>\n");
+    _adg_write_geometry(svg, _adg_marker_key(marker), cairo_path, NULL, &map);
+    _adg_put(svg, "</g>\n");
+}
+
+static void
+_adg_write_textual(_AdgSvg *svg, AdgTextual *textual)
+{
+    AdgEntity *entity;
+    gchar *text, *escaped;
+    cairo_matrix_t map;
+    const gchar *class_name;
+
+    entity = (AdgEntity *) textual;
+    text = adg_textual_dup_text(textual);
+    if (text == NULL || text[0] == '\0') {
+        g_free(text);
+        return;
+    }
+
+    cairo_matrix_multiply(&map, adg_entity_get_local_matrix(entity),
+                          adg_entity_get_global_matrix(entity));
+    class_name = _adg_class(svg, entity, adg_textual_get_font_dress(textual));
+    escaped = g_markup_escape_text(text, -1);
+
+    _adg_put(svg, "<g class=\"%s\"", class_name);
+    _adg_put_matrix(svg, "transform", &map);
+    _adg_put(svg, ">\n<text>%s</text>\n</g>\n", escaped);
+
+    g_free(escaped);
+    g_free(text);
+}
+
+static void
+_adg_write_dim(_AdgSvg *svg, AdgDim *dim)
+{
+    AdgEntity *entity;
+    AdgDimStyle *dim_style;
+    AdgTrail *trail;
+    AdgMarker *marker1, *marker2;
+    const cairo_path_t *cairo_path;
+    const gchar *dim_class, *line_class;
+
+    entity = (AdgEntity *) dim;
+    if (! _adg_dim_parts(entity, &trail, &marker1, &marker2) ||
+        ! adg_dim_compute_geometry(dim))
+        return;
+
+    dim_style = adg_dim_get_dim_style(dim);
+    dim_class = _adg_class(svg, entity, adg_dim_get_dim_dress(dim));
+    line_class = _adg_class(svg, entity, adg_dim_style_get_line_dress(dim_style));
+
+    _adg_put(svg, "<g class=\"%s\">\n", dim_class);
+    _adg_write_entity(svg, (AdgEntity *) adg_dim_get_quote(dim));
+
+    if (marker1 != NULL)
+        _adg_write_marker(svg, marker1);
+    if (marker2 != NULL)
+        _adg_write_marker(svg, marker2);
+
+    cairo_path = trail != NULL ? adg_trail_get_cairo_path(trail) : NULL;
+    if (cairo_path != NULL) {
+        /* The dimension lines are already in local space */
+        _adg_put(svg, "<g class=\"%s\"", line_class);
+        _adg_put_matrix(svg, "transform", adg_entity_get_global_matrix(entity));
+        _adg_put(svg, ">\n<path");
+        _adg_put_path(svg, cairo_path, NULL);
+        _adg_put(svg, "/>\n</g>\n");
+    }
+
+    _adg_put(svg, "</g>\n");
+}
+
+static void
+_adg_write_geometry(_AdgSvg *svg, gchar *key, const cairo_path_t *cairo_path,
+                    const cairo_matrix_t *matrix,
+                    const cairo_matrix_t *placement)
+{
+    cairo_matrix_t map;
+    guint count, symbol;
+
+    count = key != NULL ?
+        GPOINTER_TO_UINT(g_hash_table_lookup(svg->counts, key)) : 0;
+
+    if (count <= 1) {
+        if (matrix != NULL)
+            cairo_matrix_multiply(&map, matrix, placement);
+        else
+            adg_matrix_copy(&map, placement);
+
+        _adg_put(svg, "<path");
+        _adg_put_path(svg, cairo_path, &map);
+        _adg_put(svg, "/>\n");
+        g_free(key);
+        return;
+    }
+
+    symbol = GPOINTER_TO_UINT(g_hash_table_lookup(svg->defs, key));
+    if (symbol == 0) {
+        /* The first instance defines the symbol */
+        symbol = ++svg->id;
+        g_hash_table_insert(svg->defs, key, GUINT_TO_POINTER(symbol));
+        _adg_put(svg, "<defs>\n<symbol id=\"adg-symbol-%u\" overflow=\"visible\">\n"
+                 "<path", symbol);
+        _adg_put_path(svg, cairo_path, matrix);
+        _adg_put(svg, "/>\n</symbol>\n</defs>\n");
+    } else {
+        g_free(key);
+    }
+
+    _adg_put(svg, "<use xlink:href=\"#adg-symbol-%u\"", symbol);
+    _adg_put_matrix(svg, "transform", placement);
+    _adg_put(svg, "/>\n");
+}
+
+static const gchar *
+_adg_class(_AdgSvg *svg, AdgEntity *entity, AdgDress dress)
+{
+    gchar *base, *key, *name;
+    GString *css;
+    guint n;
+
+    base = _adg_class_name(dress);
+    css = g_string_new("");
+    _adg_append_style(svg, css, entity, adg_entity_style(entity, dress));
+
+    /* A dress can resolve to different styles in different entities:
+     * the same class name is reused only for the same declarations */
+    key = g_strconcat(base, "{", css->str, "}", NULL);
+    name = g_hash_table_lookup(svg->classes, key);
+
+    if (name != NULL) {
+        g_free(key);
+    } else {
+        n = GPOINTER_TO_UINT(g_hash_table_lookup(svg->names, base)) + 1;
+        g_hash_table_replace(svg->names, g_strdup(base), GUINT_TO_POINTER(n));
+        name = n == 1 ? g_strdup(base) : g_strdup_printf("%s-%u", base, n);
+        g_hash_table_insert(svg->classes, key, name);
+
+        _adg_put(svg, "<style type=\"text/css\"><![CDATA[ .%s { %s} ]]></style>\n",
+                 name, css->str);
+    }
+
+    g_string_free(css, TRUE);
+    g_free(base);
+
+    return name;
+}
+
+static void
+_adg_append_style(_AdgSvg *svg, GString *css,
+                  AdgEntity *entity, AdgStyle *style)
+{
+    if (ADG_IS_LINE_STYLE(style)) {
+        AdgLineStyle *line_style;
+        const AdgDash *dash;
+        const gdouble *dashes;
+        gint n, num_dashes;
+
+        line_style = (AdgLineStyle *) style;
+        _adg_append_color(css, "stroke", entity,
+                          adg_line_style_get_color_dress(line_style));
+
+        g_string_append(css, "stroke-width: ");
+        _adg_append_double(css, adg_line_style_get_width(line_style));
+
+        switch (adg_line_style_get_cap(line_style)) {
+        case CAIRO_LINE_CAP_ROUND:
+            g_string_append(css, "; stroke-linecap: round");
+            break;
+        case CAIRO_LINE_CAP_SQUARE:
+            g_string_append(css, "; stroke-linecap: square");
+            break;
+        default:
+            g_string_append(css, "; stroke-linecap: butt");
+            break;
+        }
+
+        switch (adg_line_style_get_join(line_style)) {
+        case CAIRO_LINE_JOIN_ROUND:
+            g_string_append(css, "; stroke-linejoin: round");
+            break;
+        case CAIRO_LINE_JOIN_BEVEL:
+            g_string_append(css, "; stroke-linejoin: bevel");
+            break;
+        default:
+            g_string_append(css, "; stroke-linejoin: miter");
+            break;
+        }
+
+        g_string_append(css, "; stroke-miterlimit: ");
+        _adg_append_double(css, adg_line_style_get_miter_limit(line_style));
+
+        dash = adg_line_style_get_dash(line_style);
+        num_dashes = dash != NULL ? adg_dash_get_num_dashes(dash) : 0;
+        if (num_dashes > 0) {
+            dashes = adg_dash_get_dashes(dash);
+            g_string_append(css, "; stroke-dasharray: ");
+            for (n = 0; n < num_dashes; ++n) {
+                if (n > 0)
+                    g_string_append(css, ",");
+                _adg_append_double(css, dashes[n]);
+            }
+            g_string_append(css, "; stroke-dashoffset: ");
+            _adg_append_double(css, adg_dash_get_offset(dash));
+        }
+
+        g_string_append(css, "; fill: none; ");
+    } else if (ADG_IS_FONT_STYLE(style)) {
+        AdgFontStyle *font_style;
+        const gchar *family;
+
+        font_style = (AdgFontStyle *) style;
+        _adg_append_color(css, "fill", entity,
+                          adg_font_style_get_color_dress(font_style));
+
+        family = adg_font_style_get_family(font_style);
+        if (family != NULL && strchr(family, '\'') == NULL)
+            g_string_append_printf(css, "font-family: '%s'; ", family);
+
+        g_string_append(css, "font-size: ");
+        _adg_append_double(css, adg_font_style_get_size(font_style));
+
+        switch (adg_font_style_get_slant(font_style)) {
+        case CAIRO_FONT_SLANT_ITALIC:
+            g_string_append(css, "; font-style: italic");
+            break;
+        case CAIRO_FONT_SLANT_OBLIQUE:
+            g_string_append(css, "; font-style: oblique");
+            break;
+        default:
+            g_string_append(css, "; font-style: normal");
+            break;
+        }
+
+        if (adg_font_style_get_weight(font_style) == CAIRO_FONT_WEIGHT_BOLD)
+            g_string_append(css, "; font-weight: bold; ");
+        else
+            g_string_append(css, "; font-weight: normal; ");
+    } else if (ADG_IS_DIM_STYLE(style)) {
+        /* The markers inherit the fill color from the dimension */
+        _adg_append_color(css, "fill", entity,
+                          adg_dim_style_get_color_dress((AdgDimStyle *) style));
+    } else if (ADG_IS_RULED_FILL(style)) {
+        guint pattern = _adg_pattern(svg, entity, (AdgRuledFill *) style);
+
+        if (pattern > 0)
+            g_string_append_printf(css, "fill: url(#adg-pattern-%u); ", pattern);
+        else
+            g_string_append(css, "fill: none; ");
+        g_string_append(css, "stroke: none; ");
+    }
+}
+
+static void
+_adg_append_color(GString *css, const gchar *property,
+                  AdgEntity *entity, AdgDress dress)
+{
+    AdgColorStyle *color_style;
+    gdouble alpha;
+
+    color_style = (AdgColorStyle *) adg_entity_style(entity, dress);
+    if (! ADG_IS_COLOR_STYLE(color_style))
+        return;
+
+    g_string_append_printf(css, "%s: #%02x%02x%02x; ", property,
+                           (guint) (adg_color_style_get_red(color_style) * 255 + 0.5),
+                           (guint) (adg_color_style_get_green(color_style) * 255 + 0.5),
+                           (guint) (adg_color_style_get_blue(color_style) * 255 + 0.5));
+
+    alpha = adg_color_style_get_alpha(color_style);
+    if (alpha < 1) {
+        g_string_append_printf(css, "%s-opacity: ", property);
+        _adg_append_double(css, alpha);
+        g_string_append(css, "; ");
+    }
+}
+
+static guint
+_adg_pattern(_AdgSvg *svg, AdgEntity *entity, AdgRuledFill *ruled_fill)
+{
+    const gchar *line_class;
+    gdouble spacing, angle;
+    CpmlPair step;
+    gchar *key;
+    guint pattern;
+
+    spacing = adg_ruled_fill_get_spacing(ruled_fill);
+    angle = adg_ruled_fill_get_angle(ruled_fill);
+
+    /* Same parametrization of the ruled fill: every line goes from
+     * (k step.x, 0) to (0, k step.y), k being an integer */
+    step.x = cos(angle) * spacing;
+    step.y = sin(angle) * spacing;
+    if (fabs(step.x) < _ADG_SVG_EPSILON)
+        step.x = 0;
+    if (fabs(step.y) < _ADG_SVG_EPSILON)
+        step.y = 0;
+    if (step.x == 0 && step.y == 0)
+        return 0;
+
+    line_class = _adg_class(svg, entity, adg_ruled_fill_get_line_dress(ruled_fill));
+    key = g_strdup_printf("pattern %s %a %a", line_class, step.x, step.y);
+
+    pattern = GPOINTER_TO_UINT(g_hash_table_lookup(svg->defs, key));
+    if (pattern > 0) {
+        g_free(key);
+        return pattern;
+    }
+
+    pattern = ++svg->id;
+    g_hash_table_insert(svg->defs, key, GUINT_TO_POINTER(pattern));
+
+    /* The tile is the rectangle with the vertexes on the axes:
+     * repeating it covers the whole family of lines */
+    _adg_put(svg, "<defs>\n<pattern id=\"adg-pattern-%u\""
+             " patternUnits=\"userSpaceOnUse\" width=\"", pattern);
+    _adg_append_double(svg->buffer, step.x != 0 ? fabs(step.x) : fabs(step.y));
+    _adg_put(svg, "\" height=\"");
+    _adg_append_double(svg->buffer, step.y != 0 ? fabs(step.y) : fabs(step.x));
+    _adg_put(svg, "\">\n<path class=\"%s\" d=\"", line_class);
+
+    if (step.y == 0) {
+        _adg_put(svg, "M ");
+        _adg_append_double(svg->buffer, fabs(step.x) / 2);
+        _adg_put(svg, " 0 v ");
+        _adg_append_double(svg->buffer, fabs(step.x));
+    } else if (step.x == 0) {
+        _adg_put(svg, "M 0 ");
+        _adg_append_double(svg->buffer, fabs(step.y) / 2);
+        _adg_put(svg, " h ");
+        _adg_append_double(svg->buffer, fabs(step.y));
+    } else if (step.x * step.y > 0) {
+        _adg_put(svg, "M ");
+        _adg_append_double(svg->buffer, fabs(step.x));
+        _adg_put(svg, " 0 L 0 ");
+        _adg_append_double(svg->buffer, fabs(step.y));
+    } else {
+        _adg_put(svg, "M 0 0 L ");
+        _adg_append_double(svg->buffer, fabs(step.x));
+        _adg_put(svg, " ");
+        _adg_append_double(svg->buffer, fabs(step.y));
+    }
+
+    _adg_put(svg, "\"/>\n</pattern>\n</defs>\n");
+
+    return pattern;
+}
+
+static gchar *
+_adg_class_name(AdgDress dress)
+{
+    const gchar *name;
+    gchar *class_name, *p;
+
+    name = adg_dress_get_name(dress);
+    if (name == NULL)
+        return g_strdup_printf("dress-%d", dress);
+
+    if (g_str_has_prefix(name, "ADG_DRESS_"))
+        name += strlen("ADG_DRESS_");
+
+    /* ADG_DRESS_LINE_STROKE becomes line-stroke */
+    class_name = g_ascii_strdown(name, -1);
+    for (p = class_name; *p != '\0'; ++p)
+        if (! g_ascii_isalnum(*p))
+            *p = '-';
+
+    return class_name;
+}
+
+static void
+_adg_put(_AdgSvg *svg, const gchar *format, ...)
+{
+    va_list var_args;
+
+    /* Numbers must be written by _adg_append_double(), so they
+     * do not depend on the decimal separator of the locale */
+    va_start(var_args, format);
+    g_string_append_vprintf(svg->buffer, format, var_args);
+    va_end(var_args);
+}
+
+static void
+_adg_put_matrix(_AdgSvg *svg, const gchar *attribute,
+                const cairo_matrix_t *matrix)
+{
+    if (adg_matrix_equal(matrix, adg_matrix_identity()))
+        return;
+
+    _adg_put(svg, " %s=\"matrix(", attribute);
+    _adg_append_double(svg->buffer, matrix->xx);
+    _adg_put(svg, " ");
+    _adg_append_double(svg->buffer, matrix->yx);
+    _adg_put(svg, " ");
+    _adg_append_double(svg->buffer, matrix->xy);
+    _adg_put(svg, " ");
+    _adg_append_double(svg->buffer, matrix->yy);
+    _adg_put(svg, " ");
+    _adg_append_double(svg->buffer, matrix->x0);
+    _adg_put(svg, " ");
+    _adg_append_double(svg->buffer, matrix->y0);
+    _adg_put(svg, ")\"");
+}
+
+static void
+_adg_put_path(_AdgSvg *svg, const cairo_path_t *cairo_path,
+              const cairo_matrix_t *matrix)
+{
+    const cairo_path_data_t *data;
+    gint n;
+
+    _adg_put(svg, " d=\"");
+
+    for (n = 0; n < cairo_path->num_data; n += data->header.length) {
+        data = &cairo_path->data[n];
+        switch (data->header.type) {
+        case CPML_MOVE:
+            _adg_put(svg, "M");
+            _adg_put_pair(svg, &data[1], matrix);
+            break;
+        case CPML_LINE:
+            _adg_put(svg, " L");
+            _adg_put_pair(svg, &data[1], matrix);
+            break;
+        case CPML_CURVE:
+            _adg_put(svg, " C");
+            _adg_put_pair(svg, &data[1], matrix);
+            _adg_put_pair(svg, &data[2], matrix);
+            _adg_put_pair(svg, &data[3], matrix);
+            break;
+        case CPML_CLOSE:
+            _adg_put(svg, " Z");
+            break;
+        default:
+            break;
+        }
+    }
+
+    _adg_put(svg, "\"");
+}
+
+static void
+_adg_put_pair(_AdgSvg *svg, const cairo_path_data_t *data,
+              const cairo_matrix_t *matrix)
+{
+    gdouble x, y;
+
+    x = data->point.x;
+    y = data->point.y;
+    if (matrix != NULL)
+        cairo_matrix_transform_point(matrix, &x, &y);
+
+    _adg_put(svg, " ");
+    _adg_append_double(svg->buffer, x);
+    _adg_put(svg, " ");
+    _adg_append_double(svg->buffer, y);
+}
+
+static void
+_adg_append_double(GString *string, gdouble value)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* Avoid "-0" in the output */
+    if (fabs(value) < _ADG_SVG_EPSILON)
+        value = 0;
+
+    g_ascii_formatd(buffer, sizeof(buffer), "%.8g", value);
+    g_string_append(string, buffer);
+}
+
+static void
+_adg_flush(_AdgSvg *svg, gboolean force)
+{
+    if (! force && svg->buffer->len < _ADG_SVG_CHUNK)
+        return;
+
+    /* After the first error the output is simply discarded */
+    if (svg->error == NULL)
+        g_output_stream_write_all(svg->stream, svg->buffer->str,
+                                  svg->buffer->len, NULL,
+                                  svg->cancellable, &svg->error);
+
+    g_string_truncate(svg->buffer, 0);
+}
@@ -854,10 +854,8 @@ _adg_cell_new(void)
 static void
 _adg_cell_invalidate(AdgTableCell *table_cell)
 {
-    AdgTable *table = adg_table_cell_get_table(table_cell);
-
-    if (table)
-        adg_entity_invalidate((AdgEntity *) table);
+    if (table_cell->row)
+        adg_table_row_invalidate(table_cell->row);
 }
 
 static gboolean
@@ -40,8 +40,13 @@ struct _AdgTablePrivate {
     AdgTableStyle *table_style;
     AdgStroke     *grid;
     AdgStroke     *frame;
-    GSList        *rows;
+    GQueue         rows;
+    GHashTable    *row_links;
     GHashTable    *cell_names;
+
+    /* Layout cache, valid until the extents are cleared */
+    CpmlPair       size;
+    GPtrArray     *sorted_rows;
 };
 
 G_END_DECLS
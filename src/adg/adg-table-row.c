@@ -58,11 +58,14 @@ struct _AdgTableRow {
     AdgTable      *table;
     GSList        *cells;
     gdouble        height;
+    gboolean       is_dirty;
+    CpmlPair       size;
     CpmlExtents    extents;
 };
 
 
 static AdgTableRow *    _adg_row_new        (AdgTable       *table);
+static void             _adg_invalidate_cell(AdgTableCell   *table_cell);
 
 
 GType
@@ -119,7 +122,6 @@ adg_table_row_new(AdgTable *table)
 
     table_row = _adg_row_new(table);
     adg_table_insert(table, table_row, NULL);
-    adg_entity_invalidate((AdgEntity *) table);
 
     return table_row;
 }
@@ -148,7 +150,6 @@ adg_table_row_new_before(AdgTableRow *before_row)
 
     table_row = _adg_row_new(table);
     adg_table_insert(table, table_row, before_row);
-    adg_entity_invalidate((AdgEntity *) before_row->table);
 
     return table_row;
 }
@@ -253,6 +254,31 @@ adg_table_row_foreach(AdgTableRow *table_row,
     g_slist_foreach(table_row->cells, (GFunc) callback, user_data);
 }
 
+/**
+ * adg_table_row_invalidate:
+ * @table_row: a valid #AdgTableRow
+ *
+ * Marks @table_row as dirty: the entities of its cells are
+ * invalidated and the row will be measured and arranged again in
+ * the next arrange() phase of its table. The other rows keep their
+ * cached size, so editing a cell does not relayout the whole table.
+ *
+ * Since: 1.0
+ **/
+void
+adg_table_row_invalidate(AdgTableRow *table_row)
+{
+    g_return_if_fail(table_row != NULL);
+
+    table_row->is_dirty = TRUE;
+    g_slist_foreach(table_row->cells, (GFunc) _adg_invalidate_cell, NULL);
+
+    if (table_row->table != NULL) {
+        adg_table_invalidate_grid(table_row->table);
+        adg_entity_set_extents((AdgEntity *) table_row->table, NULL);
+    }
+}
+
 /**
  * adg_table_row_get_table:
  * @table_row: a valid #AdgTableRow
@@ -277,8 +303,8 @@ adg_table_row_get_table(AdgTableRow *table_row)
  * @table_row: a valid #AdgTableRow
  * @height: the new height
  *
- * Sets a new height on @table_row. The extents will be invalidated to
- * recompute the whole layout of the table. Specifying 0 in
+ * Sets a new height on @table_row. The row will be invalidated to
+ * recompute the layout of the table. Specifying 0 in
  * @height will use the default height set in the table style.
  *
  * Since: 1.0
@@ -290,7 +316,7 @@ adg_table_row_set_height(AdgTableRow *table_row, gdouble height)
 
     table_row->height = height;
 
-    adg_entity_invalidate((AdgEntity *) table_row->table);
+    adg_table_row_invalidate(table_row);
 }
 
 /**
@@ -340,6 +366,9 @@ adg_table_row_get_extents(AdgTableRow *table_row)
  * returning it to the caller. The returned #CpmlPair is owned by
  * @table_row and should not be modified or freed.
  *
+ * The size is cached: it is computed again only if @table_row has
+ * been invalidated with adg_table_row_invalidate() in the meantime.
+ *
  * Returns: (transfer none): the minimum size required.
  *
  * Since: 1.0
@@ -358,6 +387,9 @@ adg_table_row_size_request(AdgTableRow *table_row)
 
     g_return_val_if_fail(table_row != NULL, NULL);
 
+    if (! table_row->is_dirty)
+        return &table_row->size;
+
     table_style = (AdgTableStyle *) adg_table_get_table_style(table_row->table);
     spacing = adg_table_style_get_cell_spacing(table_style);
     xpad = spacing ? spacing->x : 0;
@@ -380,7 +412,8 @@ adg_table_row_size_request(AdgTableRow *table_row)
     if (size->x > 0)
         size->x += xpad;
 
-    return size;
+    cpml_pair_copy(&table_row->size, size);
+    return &table_row->size;
 }
 
 /**
@@ -398,6 +431,9 @@ adg_table_row_size_request(AdgTableRow *table_row)
  * @layout->size.y is negative in order to have a valid size.
  * </para></note>
  *
+ * If @table_row is not dirty and its extents are not changed,
+ * the cells are not arranged again.
+ *
  * Returns: (transfer none): the extents of @table_row or <constant>NULL</constant> on errors.
  *
  * Since: 1.0
@@ -406,6 +442,7 @@ const CpmlExtents *
 adg_table_row_arrange(AdgTableRow *table_row, const CpmlExtents *layout)
 {
     CpmlExtents *extents;
+    CpmlExtents new_extents;
     CpmlExtents cell_layout;
     const CpmlExtents *cell_extents;
     AdgTableStyle *table_style;
@@ -418,14 +455,19 @@ adg_table_row_arrange(AdgTableRow *table_row, const CpmlExtents *layout)
     g_return_val_if_fail(layout != NULL, NULL);
     g_return_val_if_fail(layout->is_defined, NULL);
 
-    /* Set the new extents */
+    /* Compute the new extents */
     extents = &table_row->extents;
-    extents->org = layout->org;
-    if (layout->size.x > 0)
-        extents->size.x = layout->size.x;
-    if (layout->size.y > 0)
-        extents->size.y = layout->size.y;
-    extents->is_defined = TRUE;
+    new_extents.org = layout->org;
+    new_extents.size.x = layout->size.x > 0 ? layout->size.x : extents->size.x;
+    new_extents.size.y = layout->size.y > 0 ? layout->size.y : extents->size.y;
+    new_extents.is_defined = TRUE;
+
+    /* Nothing changed since the last arrange */
+    if (! table_row->is_dirty && cpml_extents_equal(extents, &new_extents))
+        return extents;
+
+    cpml_extents_copy(extents, &new_extents);
+    table_row->is_dirty = FALSE;
 
     table_style = (AdgTableStyle *) adg_table_get_table_style(table_row->table);
     spacing = adg_table_style_get_cell_spacing(table_style);
@@ -455,7 +497,28 @@ _adg_row_new(AdgTable *table)
     table_row->table = table;
     table_row->cells = NULL;
     table_row->height = 0;
+    table_row->is_dirty = TRUE;
+    table_row->size.x = 0;
+    table_row->size.y = 0;
     table_row->extents.is_defined = FALSE;
+    table_row->extents.org.x = 0;
+    table_row->extents.org.y = 0;
+    table_row->extents.size.x = 0;
+    table_row->extents.size.y = 0;
 
     return table_row;
 }
+
+static void
+_adg_invalidate_cell(AdgTableCell *table_cell)
+{
+    AdgEntity *entity;
+
+    entity = adg_table_cell_title(table_cell);
+    if (entity)
+        adg_entity_invalidate(adg_entity_get_parent(entity));
+
+    entity = adg_table_cell_value(table_cell);
+    if (entity)
+        adg_entity_invalidate(adg_entity_get_parent(entity));
+}
@@ -46,6 +46,7 @@ void            adg_table_row_remove            (AdgTableRow    *table_row,
 void            adg_table_row_foreach           (AdgTableRow    *table_row,
                                                  GCallback       callback,
                                                  gpointer        user_data);
+void            adg_table_row_invalidate        (AdgTableRow    *table_row);
 AdgTable *      adg_table_row_get_table         (AdgTableRow    *table_row);
 void            adg_table_row_set_height        (AdgTableRow    *table_row,
                                                  gdouble         height);
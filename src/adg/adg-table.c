@@ -99,11 +99,17 @@ static void         _adg_global_changed     (AdgEntity      *entity);
 static void         _adg_local_changed      (AdgEntity      *entity);
 static void         _adg_invalidate         (AdgEntity      *entity);
 static void         _adg_arrange            (AdgEntity      *entity);
+static void         _adg_arrange_rows       (AdgEntity      *entity);
 static void         _adg_arrange_grid       (AdgEntity      *entity);
 static void         _adg_arrange_frame      (AdgEntity      *entity,
                                              const CpmlExtents *extents);
 static void         _adg_render             (AdgEntity      *entity,
                                              cairo_t        *cr);
+static void         _adg_render_cell        (AdgTableCell   *table_cell,
+                                             cairo_t        *cr);
+static guint        _adg_first_row_below    (GPtrArray      *sorted_rows,
+                                             gdouble         y);
+static void         _adg_invalidate_layout  (AdgTable       *table);
 static void         _adg_propagate          (AdgTable       *table,
                                              const gchar    *detailed_signal,
                                              ...);
@@ -164,8 +170,12 @@ adg_table_init(AdgTable *table)
     data->table_style = NULL;
     data->grid = NULL;
     data->frame = NULL;
-    data->rows = NULL;
+    g_queue_init(&data->rows);
+    data->row_links = g_hash_table_new(NULL, NULL);
     data->cell_names = NULL;
+    data->size.x = 0;
+    data->size.y = 0;
+    data->sorted_rows = g_ptr_array_new();
     adg_entity_set_local_mix((AdgEntity *) table, ADG_MIX_DISABLED);
 }
 
@@ -182,11 +192,7 @@ _adg_dispose(GObject *object)
         data->frame = NULL;
     }
 
-    if (data->rows) {
-        adg_table_foreach_cell(table,
-                               (GCallback) adg_table_cell_dispose, NULL);
-        data->rows = NULL;
-    }
+    adg_table_foreach_cell(table, (GCallback) adg_table_cell_dispose, NULL);
 
     if (_ADG_OLD_OBJECT_CLASS->dispose)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
@@ -196,11 +202,14 @@ static void
 _adg_finalize(GObject *object)
 {
     AdgTablePrivate *data = adg_table_get_instance_private((AdgTable *) object);
+    AdgTableRow *table_row;
 
-    if (data->rows) {
-        g_slist_foreach(data->rows, (GFunc) adg_table_row_free, NULL);
-        g_slist_free(data->rows);
-    }
+    /* adg_table_row_free() also removes the row from data->rows */
+    while ((table_row = g_queue_peek_head(&data->rows)) != NULL)
+        adg_table_row_free(table_row);
+
+    g_hash_table_destroy(data->row_links);
+    g_ptr_array_free(data->sorted_rows, TRUE);
 
     if (data->cell_names)
         g_hash_table_destroy(data->cell_names);
@@ -272,6 +281,9 @@ adg_table_new(void)
  * Inserts @table_row inside the rows list of @table. If @before_row
  * is specified, @table_row is inserted before it.
  *
+ * This is a constant time operation: only the layout of the table
+ * is invalidated, the rows already arranged are not measured again.
+ *
  * Since: 1.0
  **/
 void
@@ -286,15 +298,20 @@ adg_table_insert(AdgTable *table, AdgTableRow *table_row,
     data = adg_table_get_instance_private(table);
 
     if (before_row == NULL) {
-        data->rows = g_slist_append(data->rows, table_row);
+        g_queue_push_tail(&data->rows, table_row);
+        g_hash_table_insert(data->row_links, table_row, data->rows.tail);
     } else {
-        GSList *before = g_slist_find(data->rows, before_row);
+        GList *before = g_hash_table_lookup(data->row_links, before_row);
 
         /* This MUST be present, otherwise something really bad happened */
         g_return_if_fail(before != NULL);
 
-        data->rows = g_slist_insert_before(data->rows, before, table_row);
+        g_queue_insert_before(&data->rows, before, table_row);
+        g_hash_table_insert(data->row_links, table_row, before->prev);
     }
+
+    g_ptr_array_set_size(data->sorted_rows, 0);
+    _adg_invalidate_layout(table);
 }
 
 /**
@@ -302,7 +319,8 @@ adg_table_insert(AdgTable *table, AdgTableRow *table_row,
  * @table: an #AdgTable
  * @table_row: a valid #AdgTableRow
  *
- * Removes @table_row from list of rows of @table.
+ * Removes @table_row from list of rows of @table. This is a
+ * constant time operation.
  *
  * Since: 1.0
  **/
@@ -310,12 +328,20 @@ void
 adg_table_remove(AdgTable *table, AdgTableRow *table_row)
 {
     AdgTablePrivate *data;
+    GList *link;
 
     g_return_if_fail(ADG_IS_TABLE(table));
     g_return_if_fail(table_row != NULL);
 
     data = adg_table_get_instance_private(table);
-    data->rows = g_slist_remove(data->rows, table_row);
+    link = g_hash_table_lookup(data->row_links, table_row);
+    if (link == NULL)
+        return;
+
+    g_hash_table_remove(data->row_links, table_row);
+    g_queue_delete_link(&data->rows, link);
+    g_ptr_array_set_size(data->sorted_rows, 0);
+    _adg_invalidate_layout(table);
 }
 
 /**
@@ -342,7 +368,7 @@ adg_table_foreach(AdgTable *table, GCallback callback, gpointer user_data)
     g_return_if_fail(callback != NULL);
 
     data = adg_table_get_instance_private(table);
-    g_slist_foreach(data->rows, (GFunc) callback, user_data);
+    g_queue_foreach(&data->rows, (GFunc) callback, user_data);
 }
 
 /**
@@ -598,7 +624,8 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    _adg_propagate((AdgTable *) entity, "global-changed");
+    if (! _adg_entity_lazy_matrices())
+        _adg_propagate((AdgTable *) entity, "global-changed");
 }
 
 static void
@@ -607,64 +634,101 @@ _adg_local_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->local_changed)
         _ADG_OLD_ENTITY_CLASS->local_changed(entity);
 
-    _adg_propagate((AdgTable *) entity, "local-changed");
+    if (! _adg_entity_lazy_matrices())
+        _adg_propagate((AdgTable *) entity, "local-changed");
 }
 
 static void
 _adg_invalidate(AdgEntity *entity)
 {
-    _adg_propagate((AdgTable *) entity, "invalidate");
+    AdgTable *table = (AdgTable *) entity;
+    AdgTablePrivate *data = adg_table_get_instance_private(table);
+
+    if (data->frame)
+        adg_entity_invalidate((AdgEntity *) data->frame);
+
+    if (data->grid)
+        adg_entity_invalidate((AdgEntity *) data->grid);
+
+    /* Invalidating a row invalidates also the entities of its cells */
+    adg_table_foreach(table, (GCallback) adg_table_row_invalidate, NULL);
 }
 
 static void
 _adg_arrange(AdgEntity *entity)
+{
+    AdgTablePrivate *data = adg_table_get_instance_private((AdgTable *) entity);
+    CpmlExtents extents = { 0 };
+
+    /* Resolve the table style */
+    if (data->table_style == NULL)
+        data->table_style = (AdgTableStyle *)
+            adg_entity_style(entity, data->table_dress);
+
+    /* The extents are cleared whenever a row is invalidated, added or
+     * removed: if they are still defined, the size of the table and
+     * the layout of the rows can be reused as they are */
+    if (! adg_entity_get_extents(entity)->is_defined)
+        _adg_arrange_rows(entity);
+
+    extents.size = data->size;
+
+    _adg_arrange_grid(entity);
+    _adg_arrange_frame(entity, &extents);
+
+    extents.is_defined = TRUE;
+    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+    cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
+    adg_entity_set_extents(entity, &extents);
+}
+
+static void
+_adg_arrange_rows(AdgEntity *entity)
 {
     AdgTable *table = (AdgTable *) entity;
     AdgTablePrivate *data = adg_table_get_instance_private(table);
-    CpmlExtents extents = { 0 };
     CpmlExtents row_layout;
     const CpmlExtents *row_extents;
+    CpmlExtents old_extents;
     const CpmlPair *spacing;
     const CpmlPair *size;
-    GSList *row_node;
+    GList *row_node;
     AdgTableRow *row;
 
-    /* Resolve the table style */
-    if (data->table_style == NULL)
-        data->table_style = (AdgTableStyle *)
-            adg_entity_style(entity, data->table_dress);
-
     spacing = adg_table_style_get_cell_spacing(data->table_style);
 
-    /* Compute the size of the table */
-    for (row_node = data->rows; row_node; row_node = row_node->next) {
+    /* Compute the size of the table: only the rows invalidated
+     * since the last arrange are really measured */
+    data->size.x = 0;
+    data->size.y = 0;
+    g_ptr_array_set_size(data->sorted_rows, 0);
+    for (row_node = data->rows.head; row_node; row_node = row_node->next) {
         row = row_node->data;
         size = adg_table_row_size_request(row);
 
-        if (size->x > extents.size.x)
-            extents.size.x = size->x;
-        extents.size.y += size->y;
+        if (size->x > data->size.x)
+            data->size.x = size->x;
+        data->size.y += size->y;
+        g_ptr_array_add(data->sorted_rows, row);
     }
 
     /* Arrange the layout of the table components */
     row_layout.is_defined = 1;
-    row_layout.org.x = extents.org.x;
-    row_layout.org.y = extents.org.y + spacing->y;
-    row_layout.size.x = extents.size.x;
+    row_layout.org.x = 0;
+    row_layout.org.y = spacing->y;
+    row_layout.size.x = data->size.x;
     row_layout.size.y = -1;
-    for (row_node = data->rows; row_node; row_node = row_node->next) {
+    for (row_node = data->rows.head; row_node; row_node = row_node->next) {
         row = row_node->data;
+        cpml_extents_copy(&old_extents, adg_table_row_get_extents(row));
         row_extents = adg_table_row_arrange(row, &row_layout);
         row_layout.org.y += row_extents->size.y + spacing->y;
-    }
-
-    _adg_arrange_grid(entity);
-    _adg_arrange_frame(entity, &extents);
 
-    extents.is_defined = TRUE;
-    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
-    cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
-    adg_entity_set_extents(entity, &extents);
+        /* The grid and the frame must be regenerated
+         * only if the geometry of the table changed */
+        if (! cpml_extents_equal(&old_extents, row_extents))
+            _adg_invalidate_layout(table);
+    }
 }
 
 static void
@@ -734,10 +798,97 @@ static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
     AdgTablePrivate *data = adg_table_get_instance_private((AdgTable *) entity);
+    cairo_matrix_t map;
+    CpmlExtents clip;
+    const CpmlExtents *extents;
+    AdgTableRow *row;
+    guint n;
 
     adg_style_apply((AdgStyle *) data->table_style, entity, cr);
 
-    _adg_propagate((AdgTable *) entity, "render", cr);
+    if (data->frame)
+        adg_entity_render((AdgEntity *) data->frame, cr);
+
+    if (data->grid)
+        adg_entity_render((AdgEntity *) data->grid, cr);
+
+    /* Bring the clip area in table space, where the rows are laid
+     * out: the local matrix is applied before the global one */
+    cairo_matrix_multiply(&map, adg_entity_get_local_matrix(entity),
+                          adg_entity_get_global_matrix(entity));
+    if (cairo_matrix_invert(&map) != CAIRO_STATUS_SUCCESS)
+        return;
+
+    cairo_clip_extents(cr, &clip.org.x, &clip.org.y, &clip.size.x, &clip.size.y);
+    clip.size.x -= clip.org.x;
+    clip.size.y -= clip.org.y;
+    clip.is_defined = TRUE;
+    cpml_extents_transform(&clip, &map);
+
+    /* The rows are sorted by y, so the rows before and after
+     * the clip area are never inspected */
+    for (n = _adg_first_row_below(data->sorted_rows, clip.org.y);
+         n < data->sorted_rows->len; ++n) {
+        row = g_ptr_array_index(data->sorted_rows, n);
+        extents = adg_table_row_get_extents(row);
+
+        if (extents->org.y > clip.org.y + clip.size.y)
+            break;
+
+        if (extents->org.x <= clip.org.x + clip.size.x &&
+            clip.org.x <= extents->org.x + extents->size.x)
+            adg_table_row_foreach(row, (GCallback) _adg_render_cell, cr);
+    }
+}
+
+static void
+_adg_render_cell(AdgTableCell *table_cell, cairo_t *cr)
+{
+    AdgEntity *entity;
+
+    entity = adg_table_cell_title(table_cell);
+    if (entity)
+        adg_entity_render(adg_entity_get_parent(entity), cr);
+
+    entity = adg_table_cell_value(table_cell);
+    if (entity)
+        adg_entity_render(adg_entity_get_parent(entity), cr);
+}
+
+static guint
+_adg_first_row_below(GPtrArray *sorted_rows, gdouble y)
+{
+    const CpmlExtents *extents;
+    guint lo, hi, mid;
+
+    /* Binary search of the first row ending below y */
+    lo = 0;
+    hi = sorted_rows->len;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        extents = adg_table_row_get_extents(g_ptr_array_index(sorted_rows, mid));
+        if (extents->org.y + extents->size.y < y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+static void
+_adg_invalidate_layout(AdgTable *table)
+{
+    AdgTablePrivate *data = adg_table_get_instance_private(table);
+
+    adg_table_invalidate_grid(table);
+
+    if (data->frame) {
+        g_object_unref(data->frame);
+        data->frame = NULL;
+    }
+
+    adg_entity_set_extents((AdgEntity *) table, NULL);
 }
 
 static void
@@ -93,6 +93,7 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static AdgDress         _adg_lod_dress          (AdgEntity      *entity);
 static void             _adg_set_font_dress     (AdgTextual     *textual,
                                                  AdgDress        dress);
 static AdgDress         _adg_get_font_dress     (AdgTextual     *textual);
@@ -122,6 +123,8 @@ adg_text_class_init(AdgTextClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->lod_dress = _adg_lod_dress;
+    entity_class->lod_policy = ADG_LOD_POLICY_PLACEHOLDER;
 
     g_object_class_override_property(gobject_class, PROP_FONT_DRESS, "font-dress");
     g_object_class_override_property(gobject_class, PROP_TEXT, "text");
@@ -348,6 +351,12 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     }
 }
 
+static AdgDress
+_adg_lod_dress(AdgEntity *entity)
+{
+    return _adg_get_font_dress((AdgTextual *) entity);
+}
+
 static void
 _adg_set_font_dress(AdgTextual *textual, AdgDress dress)
 {
@@ -24,16 +24,46 @@
 
 G_BEGIN_DECLS
 
+typedef struct _AdgTrailLeaf    AdgTrailLeaf;
+typedef struct _AdgTrailNode    AdgTrailNode;
 typedef struct _AdgTrailPrivate AdgTrailPrivate;
 
+/* A primitive of the indexed path, referred by offsets in its data:
+ * segment is the header of the CPML_MOVE starting the segment (needed
+ * to resolve a CPML_CLOSE), org the origin point and data the header
+ * of the primitive itself */
+struct _AdgTrailLeaf {
+    CpmlExtents         extents;
+    guint               segment;
+    guint               org;
+    guint               data;
+};
+
+/* A node of the bounding volume hierarchy: when left is -1 the node
+ * is terminal and refers to n_leaves leaves starting from first */
+struct _AdgTrailNode {
+    CpmlExtents         extents;
+    guint               first;
+    guint               n_leaves;
+    gint                left;
+    gint                right;
+};
+
 struct _AdgTrailPrivate {
     cairo_path_t        cairo_path;
     AdgTrailCallback    callback;
     gpointer            user_data;
+    cairo_path_t        buffer;
+    gboolean            buffer_has_arcs;
+    GDestroyNotify      destroy_notify;
+    gpointer            destroy_data;
     gdouble             max_angle;
 
     gboolean            in_construction;
     CpmlExtents         extents;
+    cairo_path_t        indexed;
+    GArray             *leaves;
+    GArray             *nodes;
 };
 
 G_END_DECLS
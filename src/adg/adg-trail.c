@@ -34,6 +34,11 @@
  * lines and base line of #AdgLDim: every point is subject to different
  * constrains not expressible with a single affine transformation.
  *
+ * A trail can also be built on top of an external, immutable array of
+ * #cairo_path_data_t with adg_trail_new_from_data(). No copy of the
+ * array is made, so huge imported outlines (e.g. read from a memory
+ * mapped file) can be rendered, measured and snapped in place.
+ *
  * Since: 1.0
  **/
 
@@ -75,6 +80,7 @@
 
 #include "adg-internal.h"
 #include <math.h>
+#include <stdlib.h>
 
 #include "adg-model.h"
 
@@ -87,6 +93,9 @@
 
 #define EMPTY_PATH(p)          ((p) == NULL || (p)->data == NULL || (p)->num_data <= 0)
 
+/* Max number of primitives kept by a terminal node of the index */
+#define MAX_LEAVES             4
+
 G_DEFINE_TYPE_WITH_PRIVATE(AdgTrail, adg_trail, ADG_TYPE_MODEL)
 
 enum {
@@ -94,6 +103,15 @@ enum {
     PROP_MAX_ANGLE
 };
 
+typedef struct {
+    const cairo_path_t *cairo_path;
+    AdgSnap     snap;
+    CpmlPair    pair;
+    gdouble     distance;
+    AdgSnap     result;
+    CpmlPair    dest;
+} _AdgSnapQuery;
+
 
 static void             _adg_finalize           (GObject        *object);
 static void             _adg_get_property       (GObject        *object,
@@ -106,9 +124,32 @@ static void             _adg_set_property       (GObject        *object,
                                                  GParamSpec     *pspec);
 static void             _adg_clear              (AdgModel       *model);
 static cairo_path_t *   _adg_get_cairo_path     (AdgTrail       *trail);
+static cairo_path_t *   _adg_buffer_callback    (AdgTrail       *trail,
+                                                 gpointer        user_data);
 static GArray *         _adg_arc_to_curves      (GArray         *array,
                                                  const cairo_path_data_t *src,
                                                  gdouble         max_angle);
+static void             _adg_build_index        (AdgTrail       *trail);
+static void             _adg_append_leaf        (GArray         *leaves,
+                                                 const cairo_path_t *cairo_path,
+                                                 const CpmlPrimitive *primitive);
+static gint             _adg_build_node         (AdgTrailPrivate *data,
+                                                 guint           first,
+                                                 guint           n_leaves);
+static int              _adg_compare_x          (const void     *a,
+                                                 const void     *b);
+static int              _adg_compare_y          (const void     *a,
+                                                 const void     *b);
+static gdouble          _adg_box_distance       (const CpmlExtents *extents,
+                                                 const CpmlPair *pair);
+static void             _adg_snap_node          (AdgTrailPrivate *data,
+                                                 gint            n_node,
+                                                 _AdgSnapQuery  *query);
+static void             _adg_snap_leaf          (const AdgTrailLeaf *leaf,
+                                                 _AdgSnapQuery  *query);
+static void             _adg_snap_pair          (_AdgSnapQuery  *query,
+                                                 AdgSnap         snap,
+                                                 const CpmlPair *pair);
 
 
 static void
@@ -146,16 +187,32 @@ adg_trail_init(AdgTrail *trail)
     data->cairo_path.num_data = 0;
     data->callback = NULL;
     data->user_data = NULL;
+    data->buffer.status = CAIRO_STATUS_INVALID_PATH_DATA;
+    data->buffer.data = NULL;
+    data->buffer.num_data = 0;
+    data->buffer_has_arcs = FALSE;
+    data->destroy_notify = NULL;
+    data->destroy_data = NULL;
     data->max_angle = G_PI_2;
     data->in_construction = FALSE;
     data->extents.is_defined = FALSE;
+    data->indexed.status = CAIRO_STATUS_INVALID_PATH_DATA;
+    data->indexed.data = NULL;
+    data->indexed.num_data = 0;
+    data->leaves = NULL;
+    data->nodes = NULL;
 }
 
 static void
 _adg_finalize(GObject *object)
 {
+    AdgTrailPrivate *data = adg_trail_get_instance_private((AdgTrail *) object);
+
     _adg_clear((AdgModel *) object);
 
+    if (data->destroy_notify != NULL)
+        data->destroy_notify(data->destroy_data);
+
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
 }
@@ -220,6 +277,60 @@ adg_trail_new(AdgTrailCallback callback, gpointer user_data)
     return trail;
 }
 
+/**
+ * adg_trail_new_from_data:
+ * @path_data: (array length=num_data): the path data to wrap
+ * @num_data: number of elements in @path_data
+ * @destroy_notify: (allow-none): function to call when @path_data is no longer used
+ * @user_data: the argument passed to @destroy_notify
+ *
+ * Creates a new trail model that directly uses @path_data as its
+ * cairo path, without copying it. @path_data must stay valid and
+ * unchanged for the whole life of the trail: when the trail is
+ * finalized, @destroy_notify (if not <constant>NULL</constant>) is
+ * called with @user_data as argument to release it.
+ *
+ * If @path_data does not contain #CPML_ARC primitives, also
+ * adg_trail_get_cairo_path() returns @path_data as is.
+ *
+ * Returns: (transfer full): a new trail model.
+ *
+ * Since: 1.0
+ **/
+AdgTrail *
+adg_trail_new_from_data(const cairo_path_data_t *path_data, gint num_data,
+                        GDestroyNotify destroy_notify, gpointer user_data)
+{
+    AdgTrail *trail;
+    AdgTrailPrivate *data;
+    gint i, length;
+
+    g_return_val_if_fail(path_data != NULL || num_data == 0, NULL);
+
+    trail = g_object_new(ADG_TYPE_TRAIL, NULL);
+    data = adg_trail_get_instance_private(trail);
+
+    data->callback = _adg_buffer_callback;
+    data->buffer.status = CAIRO_STATUS_SUCCESS;
+    data->buffer.data = (cairo_path_data_t *) path_data;
+    data->buffer.num_data = num_data;
+    data->destroy_notify = destroy_notify;
+    data->destroy_data = user_data;
+
+    /* Arcs must be converted by adg_trail_get_cairo_path(): look for them now */
+    for (i = 0; i < num_data; i += length) {
+        length = path_data[i].header.length;
+        if (length <= 0)
+            break;
+        if (path_data[i].header.type == CPML_ARC) {
+            data->buffer_has_arcs = TRUE;
+            break;
+        }
+    }
+
+    return trail;
+}
+
 /**
  * adg_trail_get_cairo_path:
  * @trail: an #AdgTrail
@@ -234,6 +345,9 @@ adg_trail_new(AdgTrailCallback callback, gpointer user_data)
  * request is O(1). This cache is cleared only by the
  * adg_model_clear() method.
  *
+ * Trails created by adg_trail_new_from_data() without arcs skip
+ * the conversion and return the external path data directly.
+ *
  * Returns: (transfer none): a pointer to the internal cairo path or <constant>NULL</constant> on errors.
  *
  * Since: 1.0
@@ -255,6 +369,10 @@ adg_trail_get_cairo_path(AdgTrail *trail)
     if (data->cairo_path.data != NULL)
         return &data->cairo_path;
 
+    /* External data with nothing to convert is used in place */
+    if (! EMPTY_PATH(&data->buffer) && ! data->buffer_has_arcs)
+        return &data->buffer;
+
     cairo_path = adg_trail_cairo_path(trail);
     if (EMPTY_PATH(cairo_path))
         return NULL;
@@ -533,6 +651,71 @@ adg_trail_get_max_angle(AdgTrail *trail)
     return data->max_angle;
 }
 
+/**
+ * adg_trail_snap:
+ * @trail:  an #AdgTrail
+ * @snap:   the kind of points to look for
+ * @pair:   (in):  the subject point
+ * @radius: the max distance from @pair
+ * @dest:   (out) (allow-none): where to store the snapped point
+ *
+ * Looks for the point of @trail nearest to @pair, not farther
+ * than @radius, among the kinds specified by @snap. Check #AdgSnap
+ * for details on which points are considered. When a point is found
+ * and @dest is not <constant>NULL</constant>, its coordinates are
+ * stored in @dest.
+ *
+ * The primitives of @trail are indexed by a bounding volume
+ * hierarchy built on the first call, so any further query takes
+ * logarithmic time. The index is cleared by adg_model_clear().
+ *
+ * The query is performed on the #cairo_path_t returned by
+ * adg_trail_cairo_path(), so the circular arcs are not approximated
+ * by Bézier curves.
+ *
+ * Returns: the kind of the snapped point or %ADG_SNAP_NONE if nothing has been found.
+ *
+ * Since: 1.0
+ **/
+AdgSnap
+adg_trail_snap(AdgTrail *trail, AdgSnap snap, const CpmlPair *pair,
+               gdouble radius, CpmlPair *dest)
+{
+    AdgTrailPrivate *data;
+    _AdgSnapQuery query;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), ADG_SNAP_NONE);
+    g_return_val_if_fail(pair != NULL, ADG_SNAP_NONE);
+
+    data = adg_trail_get_instance_private(trail);
+
+    if (data->nodes == NULL)
+        _adg_build_index(trail);
+
+    if (data->nodes->len == 0 || radius < 0)
+        return ADG_SNAP_NONE;
+
+    query.cairo_path = &data->indexed;
+    cpml_pair_copy(&query.pair, pair);
+    query.distance = radius * radius;
+    query.result = ADG_SNAP_NONE;
+
+    /* The special points have precedence over the nearest point */
+    query.snap = snap & ~ADG_SNAP_NEAREST;
+    if (query.snap != ADG_SNAP_NONE)
+        _adg_snap_node(data, 0, &query);
+
+    if (query.result == ADG_SNAP_NONE && (snap & ADG_SNAP_NEAREST) != 0) {
+        query.snap = ADG_SNAP_NEAREST;
+        _adg_snap_node(data, 0, &query);
+    }
+
+    if (query.result != ADG_SNAP_NONE && dest != NULL)
+        cpml_pair_copy(dest, &query.dest);
+
+    return query.result;
+}
+
 
 static void
 _adg_clear(AdgModel *model)
@@ -546,6 +729,22 @@ _adg_clear(AdgModel *model)
     data->cairo_path.num_data = 0;
     data->extents.is_defined = FALSE;
 
+    /* The leaves refer to the indexed path data, so they must
+     * be dropped together with them */
+    data->indexed.status = CAIRO_STATUS_INVALID_PATH_DATA;
+    data->indexed.data = NULL;
+    data->indexed.num_data = 0;
+
+    if (data->leaves != NULL) {
+        g_array_free(data->leaves, TRUE);
+        data->leaves = NULL;
+    }
+
+    if (data->nodes != NULL) {
+        g_array_free(data->nodes, TRUE);
+        data->nodes = NULL;
+    }
+
     if (_ADG_OLD_MODEL_CLASS->clear)
         _ADG_OLD_MODEL_CLASS->clear(model);
 }
@@ -564,6 +763,13 @@ _adg_get_cairo_path(AdgTrail *trail)
     return data->callback(trail, data->user_data);
 }
 
+static cairo_path_t *
+_adg_buffer_callback(AdgTrail *trail, gpointer user_data)
+{
+    AdgTrailPrivate *data = adg_trail_get_instance_private(trail);
+    return &data->buffer;
+}
+
 static GArray *
 _adg_arc_to_curves(GArray *array, const cairo_path_data_t *src,
                    gdouble max_angle)
@@ -580,17 +786,261 @@ _adg_arc_to_curves(GArray *array, const cairo_path_data_t *src,
     if (cpml_arc_info(&arc, NULL, NULL, &start, &end)) {
         CpmlSegment segment;
         int n_curves;
-        cairo_path_data_t *curves;
+        guint len;
 
+        /* Generate the curves directly inside the array, so no
+         * temporary buffer is needed */
         n_curves = ceil(fabs(end-start) / max_angle);
-        curves = g_new(cairo_path_data_t, n_curves * 4);
-        segment.data = curves;
+        len = array->len;
+        array = g_array_set_size(array, len + n_curves * 4);
+        segment.data = &g_array_index(array, cairo_path_data_t, len);
         cpml_arc_to_curves(&arc, &segment, n_curves);
+    }
+
+    return array;
+}
+
+static void
+_adg_build_index(AdgTrail *trail)
+{
+    AdgTrailPrivate *data = adg_trail_get_instance_private(trail);
+    cairo_path_t *cairo_path = adg_trail_cairo_path(trail);
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
 
-        array = g_array_append_vals(array, curves, n_curves * 4);
+    data->leaves = g_array_new(FALSE, FALSE, sizeof(AdgTrailLeaf));
+    data->nodes = g_array_new(FALSE, FALSE, sizeof(AdgTrailNode));
 
-        g_free(curves);
+    if (! EMPTY_PATH(cairo_path) &&
+        cpml_segment_from_cairo(&segment, cairo_path)) {
+        do {
+            cpml_primitive_from_segment(&primitive, &segment);
+            do {
+                _adg_append_leaf(data->leaves, cairo_path, &primitive);
+            } while (cpml_primitive_next(&primitive));
+        } while (cpml_segment_next(&segment));
+
+        /* The path data is owned by the trail and it does not change
+         * until the next clear, which also drops the index */
+        data->indexed = *cairo_path;
     }
 
-    return array;
+    if (data->leaves->len > 0)
+        _adg_build_node(data, 0, data->leaves->len);
+}
+
+static void
+_adg_append_leaf(GArray *leaves, const cairo_path_t *cairo_path,
+                 const CpmlPrimitive *primitive)
+{
+    AdgTrailLeaf leaf;
+    CpmlExtents extents;
+    CpmlPair pair;
+    size_t n, n_points;
+
+    n_points = cpml_primitive_get_n_points(primitive);
+    if (n_points < 2 || n_points > 4)
+        return;
+
+    leaf.extents.is_defined = 0;
+    leaf.segment = primitive->segment->data - cairo_path->data;
+    leaf.org = primitive->org - cairo_path->data;
+    leaf.data = primitive->data - cairo_path->data;
+
+    for (n = 0; n < n_points; ++n) {
+        cpml_primitive_put_point(primitive, n, &pair);
+        cpml_extents_pair_add(&leaf.extents, &pair);
+    }
+
+    /* The control points already bound lines and curves: arcs also
+     * need their quadrant points and their center, to snap on it */
+    if (cpml_primitive_type(primitive) == CPML_ARC) {
+        cpml_primitive_put_extents(primitive, &extents);
+        cpml_extents_add(&leaf.extents, &extents);
+
+        if (cpml_arc_info(primitive, &pair, NULL, NULL, NULL))
+            cpml_extents_pair_add(&leaf.extents, &pair);
+    }
+
+    g_array_append_val(leaves, leaf);
+}
+
+static gint
+_adg_build_node(AdgTrailPrivate *data, guint first, guint n_leaves)
+{
+    AdgTrailLeaf *leaves;
+    AdgTrailNode node, *p_node;
+    gint n_node, left, right;
+    guint n;
+
+    leaves = &g_array_index(data->leaves, AdgTrailLeaf, first);
+
+    node.extents.is_defined = 0;
+    for (n = 0; n < n_leaves; ++n)
+        cpml_extents_add(&node.extents, &leaves[n].extents);
+
+    node.first = first;
+    node.n_leaves = n_leaves;
+    node.left = -1;
+    node.right = -1;
+
+    n_node = data->nodes->len;
+    g_array_append_val(data->nodes, node);
+
+    if (n_leaves > MAX_LEAVES) {
+        /* Median split along the longest side */
+        qsort(leaves, n_leaves, sizeof(AdgTrailLeaf),
+              node.extents.size.x >= node.extents.size.y ?
+              _adg_compare_x : _adg_compare_y);
+
+        left = _adg_build_node(data, first, n_leaves / 2);
+        right = _adg_build_node(data, first + n_leaves / 2,
+                                n_leaves - n_leaves / 2);
+
+        /* data->nodes could have been relocated in the meantime */
+        p_node = &g_array_index(data->nodes, AdgTrailNode, n_node);
+        p_node->left = left;
+        p_node->right = right;
+    }
+
+    return n_node;
+}
+
+static int
+_adg_compare_x(const void *a, const void *b)
+{
+    const CpmlExtents *e1 = &((const AdgTrailLeaf *) a)->extents;
+    const CpmlExtents *e2 = &((const AdgTrailLeaf *) b)->extents;
+    gdouble x1 = e1->org.x + e1->size.x / 2;
+    gdouble x2 = e2->org.x + e2->size.x / 2;
+
+    return x1 < x2 ? -1 : x1 > x2 ? 1 : 0;
+}
+
+static int
+_adg_compare_y(const void *a, const void *b)
+{
+    const CpmlExtents *e1 = &((const AdgTrailLeaf *) a)->extents;
+    const CpmlExtents *e2 = &((const AdgTrailLeaf *) b)->extents;
+    gdouble y1 = e1->org.y + e1->size.y / 2;
+    gdouble y2 = e2->org.y + e2->size.y / 2;
+
+    return y1 < y2 ? -1 : y1 > y2 ? 1 : 0;
+}
+
+static gdouble
+_adg_box_distance(const CpmlExtents *extents, const CpmlPair *pair)
+{
+    gdouble dx, dy;
+
+    /* Squared distance between pair and the nearest point of extents */
+    dx = MAX(extents->org.x - pair->x, pair->x - extents->org.x - extents->size.x);
+    dy = MAX(extents->org.y - pair->y, pair->y - extents->org.y - extents->size.y);
+    dx = MAX(dx, 0);
+    dy = MAX(dy, 0);
+
+    return dx * dx + dy * dy;
+}
+
+static void
+_adg_snap_node(AdgTrailPrivate *data, gint n_node, _AdgSnapQuery *query)
+{
+    const AdgTrailNode *node;
+    const AdgTrailLeaf *leaf;
+    guint n;
+
+    node = &g_array_index(data->nodes, AdgTrailNode, n_node);
+
+    if (_adg_box_distance(&node->extents, &query->pair) > query->distance)
+        return;
+
+    if (node->left < 0) {
+        for (n = 0; n < node->n_leaves; ++n) {
+            leaf = &g_array_index(data->leaves, AdgTrailLeaf, node->first + n);
+            if (_adg_box_distance(&leaf->extents, &query->pair) <= query->distance)
+                _adg_snap_leaf(leaf, query);
+        }
+    } else {
+        const AdgTrailNode *left, *right;
+
+        /* Visit the nearest child first, to shrink the radius sooner */
+        left = &g_array_index(data->nodes, AdgTrailNode, node->left);
+        right = &g_array_index(data->nodes, AdgTrailNode, node->right);
+
+        if (_adg_box_distance(&left->extents, &query->pair) <=
+            _adg_box_distance(&right->extents, &query->pair)) {
+            _adg_snap_node(data, node->left, query);
+            _adg_snap_node(data, node->right, query);
+        } else {
+            _adg_snap_node(data, node->right, query);
+            _adg_snap_node(data, node->left, query);
+        }
+    }
+}
+
+static void
+_adg_snap_leaf(const AdgTrailLeaf *leaf, _AdgSnapQuery *query)
+{
+    cairo_path_data_t *path_data;
+    CpmlSegment segment;
+    CpmlPrimitive primitive;
+    CpmlPrimitiveType type;
+    CpmlPair pair;
+    gdouble pos;
+
+    path_data = query->cairo_path->data;
+
+    /* A CPML_CLOSE needs the segment to get its end point */
+    segment.path = (cairo_path_t *) query->cairo_path;
+    segment.data = path_data + leaf->segment;
+    segment.num_data = query->cairo_path->num_data - leaf->segment;
+
+    primitive.segment = &segment;
+    primitive.org = path_data + leaf->org;
+    primitive.data = path_data + leaf->data;
+    type = primitive.data->header.type;
+
+    if ((query->snap & ADG_SNAP_ENDPOINT) != 0) {
+        cpml_primitive_put_point(&primitive, 0, &pair);
+        _adg_snap_pair(query, ADG_SNAP_ENDPOINT, &pair);
+        cpml_primitive_put_point(&primitive, -1, &pair);
+        _adg_snap_pair(query, ADG_SNAP_ENDPOINT, &pair);
+    }
+
+    if ((query->snap & ADG_SNAP_MIDPOINT) != 0) {
+        /* put_pair_at() is not implemented for curves */
+        if (type == CPML_CURVE)
+            cpml_curve_put_pair_at_time(&primitive, 0.5, &pair);
+        else
+            cpml_primitive_put_pair_at(&primitive, 0.5, &pair);
+        _adg_snap_pair(query, ADG_SNAP_MIDPOINT, &pair);
+    }
+
+    if ((query->snap & ADG_SNAP_CENTER) != 0 && type == CPML_ARC &&
+        cpml_arc_info(&primitive, &pair, NULL, NULL, NULL))
+        _adg_snap_pair(query, ADG_SNAP_CENTER, &pair);
+
+    if ((query->snap & ADG_SNAP_NEAREST) != 0) {
+        /* Curves work with time values instead of pos values */
+        if (type == CPML_CURVE) {
+            pos = cpml_curve_get_closest_time(&primitive, &query->pair);
+            cpml_curve_put_pair_at_time(&primitive, pos, &pair);
+        } else {
+            pos = cpml_primitive_get_closest_pos(&primitive, &query->pair);
+            cpml_primitive_put_pair_at(&primitive, pos, &pair);
+        }
+        _adg_snap_pair(query, ADG_SNAP_NEAREST, &pair);
+    }
+}
+
+static void
+_adg_snap_pair(_AdgSnapQuery *query, AdgSnap snap, const CpmlPair *pair)
+{
+    gdouble distance = cpml_pair_squared_distance(pair, &query->pair);
+
+    if (distance <= query->distance) {
+        query->distance = distance;
+        query->result = snap;
+        cpml_pair_copy(&query->dest, pair);
+    }
 }
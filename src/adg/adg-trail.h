@@ -59,6 +59,10 @@ struct _AdgTrailClass {
 GType               adg_trail_get_type          (void);
 AdgTrail *          adg_trail_new               (AdgTrailCallback callback,
                                                  gpointer         user_data);
+AdgTrail *          adg_trail_new_from_data     (const cairo_path_data_t *path_data,
+                                                 gint             num_data,
+                                                 GDestroyNotify   destroy_notify,
+                                                 gpointer         user_data);
 
 const cairo_path_t *adg_trail_get_cairo_path    (AdgTrail        *trail);
 cairo_path_t *      adg_trail_cairo_path        (AdgTrail        *trail);
@@ -71,6 +75,11 @@ void                adg_trail_dump              (AdgTrail        *trail);
 void                adg_trail_set_max_angle     (AdgTrail        *trail,
                                                  gdouble          angle);
 gdouble             adg_trail_get_max_angle     (AdgTrail        *trail);
+AdgSnap             adg_trail_snap              (AdgTrail        *trail,
+                                                 AdgSnap          snap,
+                                                 const CpmlPair  *pair,
+                                                 gdouble          radius,
+                                                 CpmlPair        *dest);
 
 G_END_DECLS
 
@@ -0,0 +1,326 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <config.h>
+#include <adg-test.h>
+#include <adg.h>
+
+#ifdef G_OS_WIN32
+
+#define NULL_FILE "NUL"
+
+#else
+
+#define NULL_FILE "/dev/null"
+
+#endif
+
+
+typedef struct {
+    AdgCanvas            *canvas;
+    cairo_t              *cr;
+    cairo_surface_type_t  type;
+} _AdgBench;
+
+
+/* Builds a synthetic canvas with @n closed shapes, each of them
+ * stroked, hatched and quoted, and a table with @n rows */
+static AdgCanvas *
+_adg_bench_canvas(gint n)
+{
+    AdgCanvas *canvas;
+    AdgContainer *container;
+    AdgTable *table;
+    gint i;
+
+    canvas = adg_canvas_new();
+    container = ADG_CONTAINER(canvas);
+
+    for (i = 0; i < n; ++i) {
+        AdgPath *path = adg_path_new();
+        gdouble x = (i % 10) * 30;
+        gdouble y = (i / 10) * 30;
+
+        adg_path_move_to_explicit(path, x, y);
+        adg_path_line_to_explicit(path, x + 10, y);
+        adg_path_arc_to_explicit(path, x + 15, y + 5, x + 10, y + 10);
+        adg_path_curve_to_explicit(path, x + 8, y + 12, x + 2, y + 12, x, y + 10);
+        adg_path_close(path);
+
+        adg_container_add(container, ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+        adg_container_add(container, ADG_ENTITY(adg_hatch_new(ADG_TRAIL(path))));
+        adg_container_add(container,
+                          ADG_ENTITY(adg_ldim_new_full_explicit(x, y, x + 10, y,
+                                                                x + 5, y - 5,
+                                                                ADG_DIR_UP)));
+        g_object_unref(path);
+    }
+
+    table = adg_table_new();
+    for (i = 0; i < n; ++i) {
+        AdgTableRow *row = adg_table_row_new(table);
+        AdgTableCell *cell = adg_table_cell_new_full(row, 50, NULL, "Title", TRUE);
+        adg_table_cell_set_text_value(cell, "Value");
+    }
+    adg_container_add(container, ADG_ENTITY(table));
+
+    return canvas;
+}
+
+/* Builds @n filleted and reflected shapes with their edges: this is
+ * where most of the temporary geometry is allocated */
+static void
+_adg_bench_geometry(gpointer user_data)
+{
+    gint n = GPOINTER_TO_INT(user_data);
+    gint i;
+
+    for (i = 0; i < n; ++i) {
+        AdgPath *path = adg_path_new();
+        AdgEdges *edges;
+
+        adg_path_move_to_explicit(path, 0, 5);
+        adg_path_line_to_explicit(path, 10, 5);
+        adg_path_fillet(path, 1);
+        adg_path_line_to_explicit(path, 10, 10);
+        adg_path_fillet(path, 1);
+        adg_path_line_to_explicit(path, 20, 10);
+        adg_path_chamfer(path, 1, 1);
+        adg_path_line_to_explicit(path, 20, 0);
+        adg_path_reflect(path, NULL);
+        adg_path_close(path);
+
+        edges = adg_edges_new_with_source(ADG_TRAIL(path));
+        adg_trail_get_cairo_path(ADG_TRAIL(edges));
+
+        g_object_unref(edges);
+        g_object_unref(path);
+    }
+
+    cpml_scratch_reset();
+}
+
+/* Reports how many scratch allocations were needed by a run of
+ * _adg_bench_geometry() and how many of them reached the system
+ * allocator */
+static void
+_adg_bench_scratch(gconstpointer user_data)
+{
+    size_t n_allocs, n_mallocs, old_allocs, old_mallocs;
+
+    if (! g_test_perf()) {
+        g_test_message("Benchmarks are run only in perf mode (-m perf)");
+        return;
+    }
+
+    /* Warm up the scratch memory, as it happens in a real application */
+    _adg_bench_geometry((gpointer) user_data);
+
+    cpml_scratch_put_stats(&old_allocs, &old_mallocs);
+    _adg_bench_geometry((gpointer) user_data);
+    cpml_scratch_put_stats(&n_allocs, &n_mallocs);
+
+    g_test_minimized_result(n_mallocs - old_mallocs,
+                            "%lu temporary allocations served by %lu mallocs",
+                            (gulong) (n_allocs - old_allocs),
+                            (gulong) (n_mallocs - old_mallocs));
+}
+
+static _AdgBench *
+_adg_bench_new(AdgCanvas *canvas, cairo_surface_type_t type)
+{
+    _AdgBench *bench = g_new(_AdgBench, 1);
+
+    bench->canvas = canvas;
+    bench->cr = adg_test_cairo_context();
+    bench->type = type;
+
+    return bench;
+}
+
+static void
+_adg_bench_arrange(_AdgBench *bench)
+{
+    AdgEntity *entity = ADG_ENTITY(bench->canvas);
+
+    adg_entity_invalidate(entity);
+    adg_entity_arrange(entity);
+}
+
+static void
+_adg_bench_render_image(_AdgBench *bench)
+{
+    adg_entity_render(ADG_ENTITY(bench->canvas), bench->cr);
+}
+
+#ifdef CAIRO_HAS_RECORDING_SURFACE
+
+static void
+_adg_bench_render_recording(_AdgBench *bench)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+    cr = cairo_create(surface);
+    cairo_surface_destroy(surface);
+
+    adg_entity_render(ADG_ENTITY(bench->canvas), cr);
+    cairo_destroy(cr);
+}
+
+/* Size of the frame and height of the bands used by the asynchronous
+ * rendering of AdgGtkArea */
+#define REPLAY_WIDTH    1920
+#define REPLAY_HEIGHT   1080
+#define REPLAY_BAND     128
+
+static void
+_adg_bench_replay(_AdgBench *bench, gint band)
+{
+    cairo_rectangle_t bounds = { 0, 0, REPLAY_WIDTH, REPLAY_HEIGHT };
+    cairo_surface_t *recording, *frame;
+    cairo_t *cr;
+    gint y;
+
+    recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA,
+                                               &bounds);
+    cr = cairo_create(recording);
+    adg_entity_render(ADG_ENTITY(bench->canvas), cr);
+    cairo_destroy(cr);
+
+    frame = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                       REPLAY_WIDTH, REPLAY_HEIGHT);
+    cr = cairo_create(frame);
+    cairo_set_source_surface(cr, recording, 0, 0);
+    for (y = 0; y < REPLAY_HEIGHT; y += band) {
+        cairo_rectangle(cr, 0, y, REPLAY_WIDTH, band);
+        cairo_fill(cr);
+    }
+    cairo_destroy(cr);
+
+    cairo_surface_destroy(frame);
+    cairo_surface_destroy(recording);
+}
+
+static void
+_adg_bench_replay_single(_AdgBench *bench)
+{
+    _adg_bench_replay(bench, REPLAY_HEIGHT);
+}
+
+static void
+_adg_bench_replay_banded(_AdgBench *bench)
+{
+    _adg_bench_replay(bench, REPLAY_BAND);
+}
+
+#endif
+
+static void
+_adg_bench_export(_AdgBench *bench)
+{
+    adg_canvas_export(bench->canvas, bench->type, NULL_FILE, NULL);
+}
+
+static void
+_adg_add_benches(gint n)
+{
+    AdgCanvas *canvas;
+    gchar *testpath;
+
+    /* The canvas is shared by all the benchmarks and never destroyed */
+    canvas = _adg_bench_canvas(n);
+
+    testpath = g_strdup_printf("/adg/bench/%d/arrange", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_arrange,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_IMAGE));
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/adg/bench/%d/geometry", n);
+    adg_test_add_bench(testpath, _adg_bench_geometry, GINT_TO_POINTER(n));
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/adg/bench/%d/scratch", n);
+    g_test_add_data_func(testpath, GINT_TO_POINTER(n), _adg_bench_scratch);
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/adg/bench/%d/render/image", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_render_image,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_IMAGE));
+    g_free(testpath);
+
+#ifdef CAIRO_HAS_RECORDING_SURFACE
+    testpath = g_strdup_printf("/adg/bench/%d/render/recording", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_render_recording,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_RECORDING));
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/adg/bench/%d/replay/single", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_replay_single,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_RECORDING));
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/adg/bench/%d/replay/banded", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_replay_banded,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_RECORDING));
+    g_free(testpath);
+#endif
+
+#ifdef CAIRO_HAS_PNG_FUNCTIONS
+    testpath = g_strdup_printf("/adg/bench/%d/export/png", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_export,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_IMAGE));
+    g_free(testpath);
+#endif
+
+#ifdef CAIRO_HAS_PDF_SURFACE
+    testpath = g_strdup_printf("/adg/bench/%d/export/pdf", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_export,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_PDF));
+    g_free(testpath);
+#endif
+
+#ifdef CAIRO_HAS_PS_SURFACE
+    testpath = g_strdup_printf("/adg/bench/%d/export/ps", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_export,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_PS));
+    g_free(testpath);
+#endif
+
+#ifdef CAIRO_HAS_SVG_SURFACE
+    testpath = g_strdup_printf("/adg/bench/%d/export/svg", n);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _adg_bench_export,
+                       _adg_bench_new(canvas, CAIRO_SURFACE_TYPE_SVG));
+    g_free(testpath);
+#endif
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    _adg_add_benches(10);
+    _adg_add_benches(100);
+
+    return g_test_run();
+}
@@ -87,6 +87,42 @@ _adg_property_angle(void)
     adg_entity_destroy((AdgEntity *) arrow);
 }
 
+static void
+_adg_method_model(void)
+{
+    AdgArrow *arrow1, *arrow2, *arrow3;
+    AdgModel *model;
+
+    arrow1 = adg_arrow_new();
+    arrow2 = adg_arrow_new();
+    arrow3 = adg_arrow_new();
+    adg_arrow_set_angle(arrow3, G_PI_2);
+
+    /* Arrows with the same angle must share the same model */
+    model = adg_marker_model(ADG_MARKER(arrow1));
+    g_assert_nonnull(model);
+    g_assert_true(adg_marker_model(ADG_MARKER(arrow2)) == model);
+    g_assert_true(adg_marker_model(ADG_MARKER(arrow3)) != model);
+
+    /* The size is applied by the local matrix, not by the model */
+    adg_marker_set_size(ADG_MARKER(arrow2), 123);
+    adg_entity_invalidate(ADG_ENTITY(arrow2));
+    g_assert_true(adg_marker_model(ADG_MARKER(arrow2)) == model);
+
+    /* Changing the angle must drop the shared model */
+    adg_arrow_set_angle(arrow3, G_PI / 6);
+    g_assert_null(adg_marker_get_model(ADG_MARKER(arrow3)));
+    g_assert_true(adg_marker_model(ADG_MARKER(arrow3)) == model);
+
+    adg_arrow_set_angle(arrow1, G_PI_2);
+    g_assert_true(adg_marker_model(ADG_MARKER(arrow1)) != model);
+    g_assert_true(adg_marker_model(ADG_MARKER(arrow2)) == model);
+
+    adg_entity_destroy(ADG_ENTITY(arrow1));
+    adg_entity_destroy(ADG_ENTITY(arrow2));
+    adg_entity_destroy(ADG_ENTITY(arrow3));
+}
+
 
 int
 main(int argc, char *argv[])
@@ -99,5 +135,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/arrow/property/local-mix", _adg_property_local_mix);
     g_test_add_func("/adg/arrow/property/angle", _adg_property_angle);
 
+    g_test_add_func("/adg/arrow/method/model", _adg_method_model);
+
     return g_test_run();
 }
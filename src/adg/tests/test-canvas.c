@@ -21,6 +21,7 @@
 #include <config.h>
 #include <adg-test.h>
 #include <adg.h>
+#include <glib/gstdio.h>
 
 #ifdef G_OS_WIN32
 
@@ -489,6 +490,47 @@ _adg_property_left_margin(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_property_analytic_autoscale(void)
+{
+    AdgCanvas *canvas;
+    gboolean invalid_boolean;
+    gboolean has_analytic_autoscale;
+
+    canvas = ADG_CANVAS(adg_canvas_new());
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    g_assert_false(adg_canvas_has_analytic_autoscale(canvas));
+
+    adg_canvas_switch_analytic_autoscale(canvas, TRUE);
+    has_analytic_autoscale = adg_canvas_has_analytic_autoscale(canvas);
+    g_assert_true(has_analytic_autoscale);
+
+    adg_canvas_switch_analytic_autoscale(canvas, invalid_boolean);
+    has_analytic_autoscale = adg_canvas_has_analytic_autoscale(canvas);
+    g_assert_true(has_analytic_autoscale);
+
+    adg_canvas_switch_analytic_autoscale(canvas, FALSE);
+    has_analytic_autoscale = adg_canvas_has_analytic_autoscale(canvas);
+    g_assert_false(has_analytic_autoscale);
+
+    /* Using GObject property methods */
+    g_object_set(canvas, "analytic-autoscale", TRUE, NULL);
+    g_object_get(canvas, "analytic-autoscale", &has_analytic_autoscale, NULL);
+    g_assert_true(has_analytic_autoscale);
+
+    g_object_set(canvas, "analytic-autoscale", invalid_boolean, NULL);
+    g_object_get(canvas, "analytic-autoscale", &has_analytic_autoscale, NULL);
+    g_assert_true(has_analytic_autoscale);
+
+    g_object_set(canvas, "analytic-autoscale", FALSE, NULL);
+    g_object_get(canvas, "analytic-autoscale", &has_analytic_autoscale, NULL);
+    g_assert_false(has_analytic_autoscale);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 static void
 _adg_property_has_frame(void)
 {
@@ -656,6 +698,41 @@ _adg_property_left_padding(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_property_cache_dir(void)
+{
+    AdgCanvas *canvas;
+    const gchar *valid_dir_1, *valid_dir_2;
+    const gchar *cache_dir;
+    gchar *cache_dir_dup;
+
+    canvas = ADG_CANVAS(adg_canvas_new());
+    valid_dir_1 = "/tmp/adg-cache";
+    valid_dir_2 = "adg-cache";
+
+    /* Using the public APIs */
+    g_assert_null(adg_canvas_get_cache_dir(canvas));
+
+    adg_canvas_set_cache_dir(canvas, valid_dir_1);
+    cache_dir = adg_canvas_get_cache_dir(canvas);
+    g_assert_cmpstr(cache_dir, ==, valid_dir_1);
+
+    adg_canvas_set_cache_dir(canvas, NULL);
+    g_assert_null(adg_canvas_get_cache_dir(canvas));
+
+    /* Using GObject property methods */
+    g_object_set(canvas, "cache-dir", valid_dir_2, NULL);
+    g_object_get(canvas, "cache-dir", &cache_dir_dup, NULL);
+    g_assert_cmpstr(cache_dir_dup, ==, valid_dir_2);
+    g_free(cache_dir_dup);
+
+    g_object_set(canvas, "cache-dir", NULL, NULL);
+    g_object_get(canvas, "cache-dir", &cache_dir_dup, NULL);
+    g_assert_null(cache_dir_dup);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 static void
 _adg_method_autoscale(void)
 {
@@ -718,6 +795,68 @@ _adg_method_autoscale(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_method_autoscale_analytic(void)
+{
+    AdgCanvas *canvas;
+    AdgTitleBlock *title_block;
+    AdgPath *path;
+    AdgStroke *stroke;
+    const cairo_matrix_t *matrix;
+
+    canvas = adg_canvas_new();
+    adg_canvas_switch_analytic_autoscale(canvas, TRUE);
+
+    /* Check analytic autoscale does not crash on an empty canvas */
+    adg_canvas_set_size_explicit(canvas, 100, 100);
+    adg_canvas_autoscale(canvas);
+
+    /* The scales must be sorted for the analytic method to be used */
+    adg_canvas_set_scales(canvas, "0", "10:1", "5:1", "2:1", "1:1",
+                          "1:2", "1:5", "1:10", NULL);
+
+    title_block = adg_title_block_new();
+    adg_canvas_set_title_block(canvas, title_block);
+    g_object_unref(title_block);
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 5, 5);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+
+    adg_canvas_autoscale(canvas);
+    matrix = adg_entity_get_local_matrix(ADG_ENTITY(canvas));
+    adg_assert_isapprox(matrix->xx, 10);
+    g_assert_cmpstr(adg_title_block_get_scale(title_block), ==, "10:1");
+
+    adg_path_line_to_explicit(path, 50, 50);
+
+    adg_canvas_autoscale(canvas);
+    matrix = adg_entity_get_local_matrix(ADG_ENTITY(canvas));
+    adg_assert_isapprox(matrix->xx, 1);
+    g_assert_cmpstr(adg_title_block_get_scale(title_block), ==, "1:1");
+
+    adg_path_line_to_explicit(path, 0, 100);
+
+    adg_canvas_autoscale(canvas);
+    matrix = adg_entity_get_local_matrix(ADG_ENTITY(canvas));
+    adg_assert_isapprox(matrix->xx, 0.5);
+    g_assert_cmpstr(adg_title_block_get_scale(title_block), ==, "1:2");
+
+    /* When no scale fits, the smallest one must be left applied */
+    adg_path_line_to_explicit(path, 800, 0);
+
+    adg_canvas_autoscale(canvas);
+    matrix = adg_entity_get_local_matrix(ADG_ENTITY(canvas));
+    adg_assert_isapprox(matrix->xx, 0.1);
+    g_assert_cmpstr(adg_title_block_get_scale(title_block), ==, "1:10");
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 static void
 _adg_method_set_margins(void)
 {
@@ -874,6 +1013,101 @@ _adg_method_export(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static guint
+_adg_count_files(const gchar *dir)
+{
+    GDir *handle;
+    guint n;
+
+    handle = g_dir_open(dir, 0, NULL);
+    g_assert_nonnull(handle);
+
+    n = 0;
+    while (g_dir_read_name(handle) != NULL)
+        ++n;
+
+    g_dir_close(handle);
+    return n;
+}
+
+static void
+_adg_method_export_cache(void)
+{
+    AdgCanvas *canvas;
+    gchar *tmp_dir, *cache_dir, *file1, *file2;
+    gchar *content1, *content2;
+    const gchar *name;
+    GDir *handle;
+    gchar *path;
+
+    canvas = adg_test_canvas();
+    tmp_dir = g_dir_make_tmp("adg-XXXXXX", NULL);
+    g_assert_nonnull(tmp_dir);
+    cache_dir = g_build_filename(tmp_dir, "cache", NULL);
+    file1 = g_build_filename(tmp_dir, "file1.svg", NULL);
+    file2 = g_build_filename(tmp_dir, "file2.svg", NULL);
+
+    /* The cache directory must be created on the first export */
+    adg_canvas_set_cache_dir(canvas, cache_dir);
+    g_assert_true(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_SVG, file1, NULL));
+    g_assert_true(g_file_test(cache_dir, G_FILE_TEST_IS_DIR));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 1);
+
+    /* An unchanged drawing must be served from the cache */
+    g_assert_true(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_SVG, file2, NULL));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 1);
+    g_assert_true(g_file_get_contents(file1, &content1, NULL, NULL));
+    g_assert_true(g_file_get_contents(file2, &content2, NULL, NULL));
+    g_assert_cmpstr(content1, ==, content2);
+    g_free(content1);
+    g_free(content2);
+
+    /* A different format or a changed drawing must not */
+    g_assert_true(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_PDF, file2, NULL));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 2);
+
+    adg_canvas_set_paddings(canvas, 10, 10, 10, 10);
+    g_assert_true(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_SVG, file2, NULL));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 3);
+
+    /* Neither must the same drawing with other render switches */
+    adg_switch_extents(TRUE);
+    g_assert_true(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_SVG, file2, NULL));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 4);
+    adg_switch_extents(FALSE);
+
+    adg_switch_batching(TRUE);
+    g_assert_true(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_SVG, file2, NULL));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 5);
+    adg_switch_batching(FALSE);
+
+    g_assert_true(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_SVG, file2, NULL));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 5);
+
+    /* Unsupported surface types must still fail */
+    g_assert_false(adg_canvas_export(canvas, CAIRO_SURFACE_TYPE_XLIB, file2, NULL));
+    g_assert_cmpuint(_adg_count_files(cache_dir), ==, 5);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+
+    handle = g_dir_open(cache_dir, 0, NULL);
+    while ((name = g_dir_read_name(handle)) != NULL) {
+        path = g_build_filename(cache_dir, name, NULL);
+        g_unlink(path);
+        g_free(path);
+    }
+    g_dir_close(handle);
+    g_rmdir(cache_dir);
+    g_unlink(file1);
+    g_unlink(file2);
+    g_rmdir(tmp_dir);
+
+    g_free(file2);
+    g_free(file1);
+    g_free(cache_dir);
+    g_free(tmp_dir);
+}
+
 #if GTK3_ENABLED || GTK2_ENABLED
 
 static void
@@ -1028,19 +1262,23 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/canvas/property/right-margin", _adg_property_right_margin);
     g_test_add_func("/adg/canvas/property/bottom-margin", _adg_property_bottom_margin);
     g_test_add_func("/adg/canvas/property/left-margin", _adg_property_left_margin);
+    g_test_add_func("/adg/canvas/property/analytic-autoscale", _adg_property_analytic_autoscale);
     g_test_add_func("/adg/canvas/property/has-frame", _adg_property_has_frame);
     g_test_add_func("/adg/canvas/property/top-padding", _adg_property_top_padding);
     g_test_add_func("/adg/canvas/property/right-padding", _adg_property_right_padding);
     g_test_add_func("/adg/canvas/property/bottom-padding", _adg_property_bottom_padding);
     g_test_add_func("/adg/canvas/property/left-padding", _adg_property_left_padding);
+    g_test_add_func("/adg/canvas/property/cache-dir", _adg_property_cache_dir);
 
     g_test_add_func("/adg/canvas/method/autoscale", _adg_method_autoscale);
+    g_test_add_func("/adg/canvas/method/autoscale-analytic", _adg_method_autoscale_analytic);
     g_test_add_func("/adg/canvas/method/set-margins", _adg_method_set_margins);
     g_test_add_func("/adg/canvas/method/get-margins", _adg_method_get_margins);
     g_test_add_func("/adg/canvas/method/apply-margins", _adg_method_apply_margins);
     g_test_add_func("/adg/canvas/method/set-paddings", _adg_method_set_paddings);
     g_test_add_func("/adg/canvas/method/get-paddings", _adg_method_get_paddings);
     g_test_add_func("/adg/canvas/method/export", _adg_method_export);
+    g_test_add_func("/adg/canvas/method/export-cache", _adg_method_export_cache);
 #if GTK3_ENABLED || GTK2_ENABLED
     g_test_add_func("/adg/canvas/method/set-paper", _adg_method_set_paper);
     g_test_add_func("/adg/canvas/method/get-page-setup", _adg_method_get_page_setup);
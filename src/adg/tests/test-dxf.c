@@ -0,0 +1,230 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+
+static gchar *
+_adg_tmp_file(void)
+{
+    gchar *file;
+    gint fd;
+
+    fd = g_file_open_tmp("adg-dxf-XXXXXX.dxf", &file, NULL);
+    g_assert_cmpint(fd, !=, -1);
+    g_close(fd, NULL);
+
+    return file;
+}
+
+/* Splits the DXF content in group code/value pairs: the returned
+ * array has the code in the even items and the value in the odd ones */
+static gchar **
+_adg_parse_groups(const gchar *content)
+{
+    gchar **lines;
+    guint n, n_lines;
+    gchar *end;
+
+    lines = g_strsplit(content, "\n", -1);
+    n_lines = g_strv_length(lines);
+
+    /* The content ends with a newline, so the last line is empty */
+    g_assert_cmpuint(n_lines % 2, ==, 1);
+    g_assert_cmpstr(lines[n_lines - 1], ==, "");
+    g_free(lines[n_lines - 1]);
+    lines[n_lines - 1] = NULL;
+
+    for (n = 0; lines[n] != NULL; n += 2) {
+        g_strchug(lines[n]);
+        g_ascii_strtoll(lines[n], &end, 10);
+        g_assert_true(end != lines[n] && *end == '\0');
+    }
+
+    return lines;
+}
+
+/* Returns the index of the first group after @from with @code and @value
+ * (any value if NULL), stopping at the next entity if @entity is TRUE */
+static gint
+_adg_find_group(gchar **groups, gint from, const gchar *code,
+                const gchar *value, gboolean entity)
+{
+    gint n;
+
+    for (n = from; groups[n] != NULL; n += 2) {
+        if (entity && n > from && strcmp(groups[n], "0") == 0)
+            break;
+        if (strcmp(groups[n], code) == 0 &&
+            (value == NULL || strcmp(groups[n + 1], value) == 0))
+            return n;
+    }
+
+    return -1;
+}
+
+static guint
+_adg_count_entities(gchar **groups, const gchar *type)
+{
+    guint n;
+    gint i;
+
+    n = 0;
+    for (i = _adg_find_group(groups, 0, "0", type, FALSE); i >= 0;
+         i = _adg_find_group(groups, i + 2, "0", type, FALSE))
+        ++n;
+
+    return n;
+}
+
+static gboolean
+_adg_has_table(gchar **groups, const gchar *name)
+{
+    gint i;
+
+    for (i = _adg_find_group(groups, 0, "0", "TABLE", FALSE); i >= 0;
+         i = _adg_find_group(groups, i + 2, "0", "TABLE", FALSE))
+        if (strcmp(groups[i + 2], "2") == 0 &&
+            strcmp(groups[i + 3], name) == 0)
+            return TRUE;
+
+    return FALSE;
+}
+
+static void
+_adg_method_export(void)
+{
+    AdgContainer *container;
+    AdgPath *path, *shared;
+    AdgStroke *stroke;
+    AdgHatch *hatch;
+    AdgLDim *ldim;
+    cairo_matrix_t map;
+    gchar *file, *content, **groups;
+    GError *error;
+    gint i;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_arc_to_explicit(path, 15, 5, 10, 10);
+    adg_path_curve_to_explicit(path, 5, 15, 0, 5, 0, 10);
+    adg_path_close(path);
+
+    shared = adg_path_new();
+    adg_path_move_to_explicit(shared, 0, 0);
+    adg_path_line_to_explicit(shared, 1, 1);
+
+    container = adg_container_new();
+
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    adg_container_add(container, ADG_ENTITY(stroke));
+    hatch = adg_hatch_new(ADG_TRAIL(path));
+    adg_container_add(container, ADG_ENTITY(hatch));
+
+    stroke = adg_stroke_new(ADG_TRAIL(shared));
+    adg_container_add(container, ADG_ENTITY(stroke));
+    stroke = adg_stroke_new(ADG_TRAIL(shared));
+    cairo_matrix_init_translate(&map, 20, 0);
+    adg_entity_set_local_map(ADG_ENTITY(stroke), &map);
+    adg_container_add(container, ADG_ENTITY(stroke));
+
+    ldim = adg_ldim_new_full_explicit(0, 0, 10, 0, 5, -5, ADG_DIR_UP);
+    adg_container_add(container, ADG_ENTITY(ldim));
+
+    g_object_unref(path);
+    g_object_unref(shared);
+
+    file = _adg_tmp_file();
+    error = NULL;
+    g_assert_true(adg_dxf_export(ADG_ENTITY(container), file, &error));
+    g_assert_null(error);
+
+    g_assert_true(g_file_get_contents(file, &content, NULL, NULL));
+    groups = _adg_parse_groups(content);
+    g_free(content);
+
+    i = _adg_find_group(groups, 0, "9", "$ACADVER", FALSE);
+    g_assert_cmpint(i, >=, 0);
+    g_assert_cmpstr(groups[i + 2], ==, "1");
+    g_assert_cmpstr(groups[i + 3], ==, "AC1015");
+
+    /* The required sections and tables must be present */
+    g_assert_cmpint(_adg_find_group(groups, 0, "2", "TABLES", FALSE), >=, 0);
+    g_assert_cmpint(_adg_find_group(groups, 0, "2", "BLOCKS", FALSE), >=, 0);
+    g_assert_cmpint(_adg_find_group(groups, 0, "2", "ENTITIES", FALSE), >=, 0);
+    g_assert_cmpint(_adg_find_group(groups, 0, "2", "OBJECTS", FALSE), >=, 0);
+    g_assert_true(_adg_has_table(groups, "LTYPE"));
+    g_assert_true(_adg_has_table(groups, "LAYER"));
+    g_assert_true(_adg_has_table(groups, "STYLE"));
+    g_assert_true(_adg_has_table(groups, "DIMSTYLE"));
+    g_assert_true(_adg_has_table(groups, "BLOCK_RECORD"));
+    g_assert_cmpuint(_adg_count_entities(groups, "DICTIONARY"), ==, 2);
+    g_assert_cmpuint(_adg_count_entities(groups, "SECTION"), ==,
+                     _adg_count_entities(groups, "ENDSEC"));
+    i = g_strv_length(groups);
+    g_assert_cmpstr(groups[i - 2], ==, "0");
+    g_assert_cmpstr(groups[i - 1], ==, "EOF");
+
+    /* The hatch must be skipped */
+    g_assert_cmpuint(_adg_count_entities(groups, "LINE"), ==, 3);
+    g_assert_cmpuint(_adg_count_entities(groups, "ARC"), ==, 1);
+    g_assert_cmpuint(_adg_count_entities(groups, "SPLINE"), ==, 1);
+    g_assert_cmpuint(_adg_count_entities(groups, "DIMENSION"), ==, 1);
+
+    /* The dimension must refer to its block and to its style */
+    i = _adg_find_group(groups, 0, "0", "DIMENSION", FALSE);
+    g_assert_cmpint(_adg_find_group(groups, i, "2", "*D1", TRUE), >=, 0);
+    g_assert_cmpint(_adg_find_group(groups, i, "3", "Standard", TRUE), >=, 0);
+
+    /* The shared trail must be written once and inserted twice,
+     * beside the two layouts and the dimension block */
+    g_assert_cmpuint(_adg_count_entities(groups, "BLOCK"), ==, 4);
+    g_assert_cmpuint(_adg_count_entities(groups, "INSERT"), ==, 2);
+    i = _adg_find_group(groups, 0, "0", "INSERT", FALSE);
+    g_assert_cmpint(_adg_find_group(groups, i, "2", "ADG_TRAIL_1", TRUE), >=, 0);
+    g_strfreev(groups);
+
+    /* I/O errors must be reported */
+    g_unlink(file);
+    g_free(file);
+    file = g_build_filename(g_get_tmp_dir(), "adg-missing-dir", "out.dxf", NULL);
+    g_assert_false(adg_dxf_export(ADG_ENTITY(container), file, &error));
+    g_assert_nonnull(error);
+    g_assert_true(error->domain == G_FILE_ERROR);
+    g_clear_error(&error);
+
+    g_free(file);
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/adg/dxf/method/export", _adg_method_export);
+
+    return g_test_run();
+}
@@ -20,8 +20,10 @@
 
 #include <adg-test.h>
 #include <adg.h>
+#include <string.h>
 
 #define ADG_TYPE_DUMMY      (adg_dummy_get_type())
+#define ADG_TYPE_DUMMY_FILL (adg_dummy_fill_get_type())
 
 
 typedef GObject AdgDummy;
@@ -40,6 +42,22 @@ adg_dummy_init(AdgDummy *dummy)
 G_DEFINE_TYPE(AdgDummy, adg_dummy, ADG_TYPE_ENTITY);
 
 
+typedef AdgFillStyle AdgDummyFill;
+typedef AdgFillStyleClass AdgDummyFillClass;
+
+static void
+adg_dummy_fill_class_init(AdgDummyFillClass *klass)
+{
+}
+
+static void
+adg_dummy_fill_init(AdgDummyFill *dummy_fill)
+{
+}
+
+G_DEFINE_TYPE(AdgDummyFill, adg_dummy_fill, ADG_TYPE_FILL_STYLE);
+
+
 static void
 _adg_behavior_misc(void)
 {
@@ -94,6 +112,322 @@ _adg_behavior_style(void)
     g_object_unref(line_style);
 }
 
+static void
+_adg_behavior_resolved_style(void)
+{
+    AdgEntity *entity, *container, *grandparent, *sibling, *child;
+    AdgStyle *color_style, *fallback;
+
+    entity = ADG_ENTITY(adg_logo_new());
+    container = ADG_ENTITY(adg_container_new());
+    color_style = ADG_STYLE(adg_color_style_new());
+    fallback = adg_dress_get_fallback(ADG_DRESS_COLOR);
+    g_object_ref(fallback);
+
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == fallback);
+
+    /* Changing the parent must not return the cached style */
+    adg_entity_set_style(container, ADG_DRESS_COLOR, color_style);
+    adg_container_add(ADG_CONTAINER(container), entity);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == color_style);
+
+    /* Changing the style of an ancestor must be reflected */
+    adg_entity_set_style(container, ADG_DRESS_COLOR, NULL);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == fallback);
+    g_assert_true(adg_entity_style(container, ADG_DRESS_COLOR) == fallback);
+
+    /* Changing the fallback style must be reflected */
+    adg_dress_set_fallback(ADG_DRESS_COLOR, color_style);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == color_style);
+    g_assert_true(adg_entity_style(container, ADG_DRESS_COLOR) == color_style);
+
+    adg_dress_set_fallback(ADG_DRESS_COLOR, fallback);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == fallback);
+
+    /* Overrides on any ancestor must be reflected */
+    grandparent = ADG_ENTITY(adg_container_new());
+    adg_container_add(ADG_CONTAINER(grandparent), container);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == fallback);
+    adg_entity_set_style(grandparent, ADG_DRESS_COLOR, color_style);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == color_style);
+
+    /* Overrides outside the chain of ancestors must not */
+    sibling = ADG_ENTITY(adg_logo_new());
+    adg_container_add(ADG_CONTAINER(grandparent), sibling);
+    adg_entity_set_style(sibling, ADG_DRESS_COLOR, fallback);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_COLOR) == color_style);
+    g_assert_true(adg_entity_style(sibling, ADG_DRESS_COLOR) == fallback);
+
+    /* Entities bound to a parent that is not a container (e.g. the
+     * markers of a dimension) must be reached too */
+    child = ADG_ENTITY(adg_logo_new());
+    adg_entity_set_parent(child, entity);
+    g_assert_true(adg_entity_style(child, ADG_DRESS_COLOR) == color_style);
+    adg_entity_set_style(entity, ADG_DRESS_COLOR, fallback);
+    g_assert_true(adg_entity_style(child, ADG_DRESS_COLOR) == fallback);
+    adg_entity_set_style(entity, ADG_DRESS_COLOR, NULL);
+    g_assert_true(adg_entity_style(child, ADG_DRESS_COLOR) == color_style);
+    adg_entity_set_parent(child, NULL);
+    g_assert_true(adg_entity_style(child, ADG_DRESS_COLOR) == fallback);
+    adg_entity_destroy(child);
+
+    adg_entity_destroy(grandparent);
+    g_object_unref(color_style);
+    g_object_unref(fallback);
+}
+
+static void
+_adg_behavior_lazy_matrices(void)
+{
+    AdgEntity *entity, *container;
+    cairo_matrix_t map;
+
+    adg_switch_lazy_matrices(TRUE);
+
+    entity = ADG_ENTITY(adg_logo_new());
+    container = ADG_ENTITY(adg_container_new());
+    adg_container_add(ADG_CONTAINER(container), entity);
+    adg_entity_set_local_mix(entity, ADG_MIX_ANCESTORS);
+
+    /* The matrices must be composed on demand, without arranging */
+    cairo_matrix_init_scale(&map, 2, 3);
+    adg_entity_set_global_map(container, &map);
+    g_assert_cmpfloat(adg_entity_get_global_matrix(entity)->xx, ==, 2);
+    g_assert_cmpfloat(adg_entity_get_global_matrix(entity)->yy, ==, 3);
+
+    cairo_matrix_init_translate(&map, 4, 5);
+    adg_entity_set_local_map(container, &map);
+    g_assert_cmpfloat(adg_entity_get_local_matrix(entity)->x0, ==, 4);
+    g_assert_cmpfloat(adg_entity_get_local_matrix(entity)->y0, ==, 5);
+
+    /* A further change on an ancestor must be reflected */
+    cairo_matrix_init_scale(&map, 6, 7);
+    adg_entity_set_global_map(container, &map);
+    adg_entity_arrange(container);
+    g_assert_cmpfloat(adg_entity_get_global_matrix(entity)->xx, ==, 6);
+    g_assert_cmpfloat(adg_entity_get_global_matrix(entity)->yy, ==, 7);
+
+    /* Reparenting must be reflected too */
+    g_object_ref(entity);
+    adg_container_remove(ADG_CONTAINER(container), entity);
+    g_assert_true(adg_matrix_equal(adg_entity_get_global_matrix(entity),
+                                   adg_entity_get_global_map(entity)));
+
+    adg_entity_destroy(container);
+    g_object_unref(entity);
+
+    adg_switch_lazy_matrices(FALSE);
+}
+
+static void
+_adg_render_to_surface(AdgCanvas *canvas, cairo_surface_t *surface)
+{
+    cairo_t *cr = cairo_create(surface);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+}
+
+static void
+_adg_behavior_batching(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    AdgHatch *hatch;
+    AdgLDim *ldim;
+    AdgColorStyle *red;
+    cairo_surface_t *surface1, *surface2;
+    const cairo_path_t *cairo_path;
+    cairo_t *cr;
+    gint n, size;
+
+    canvas = adg_test_canvas();
+    red = adg_color_style_new();
+    adg_color_style_set_rgb(red, 1, 0, 0);
+
+    /* Non overlapping strokes, so merging them must not change
+     * the antialiasing of the result */
+    for (n = 0; n < 10; ++n) {
+        path = adg_path_new();
+        adg_path_move_to_explicit(path, n * 10 + 5, 5);
+        adg_path_line_to_explicit(path, n * 10 + 5, 95);
+        stroke = adg_stroke_new(ADG_TRAIL(path));
+        if (n % 3 == 0)
+            adg_stroke_set_line_dress(stroke, ADG_DRESS_LINE_HIDDEN);
+
+        /* Overriding the color must split the batched strokes */
+        if (n % 4 == 1) {
+            adg_entity_set_style(ADG_ENTITY(stroke), ADG_DRESS_COLOR_STROKE,
+                                 ADG_STYLE(red));
+            adg_entity_set_style(ADG_ENTITY(stroke), ADG_DRESS_COLOR_HIDDEN,
+                                 ADG_STYLE(red));
+        }
+
+        adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+        g_object_unref(path);
+    }
+
+    /* Dimensions and hatches stroke through the batch too, while
+     * their markers, quotes and fills must be kept in order */
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 20, 60);
+    adg_path_line_to_explicit(path, 80, 60);
+    adg_path_line_to_explicit(path, 80, 80);
+    adg_path_close(path);
+    hatch = adg_hatch_new(ADG_TRAIL(path));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(hatch));
+    g_object_unref(path);
+
+    ldim = adg_ldim_new_full_explicit(20, 30, 80, 30, 50, 20, ADG_DIR_UP);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(ldim));
+
+    g_assert_true(ADG_ENTITY_GET_CLASS(stroke)->batchable);
+    g_assert_true(ADG_ENTITY_GET_CLASS(hatch)->batchable);
+    g_assert_true(ADG_ENTITY_GET_CLASS(ldim)->batchable);
+    g_assert_false(ADG_ENTITY_GET_CLASS(canvas)->batchable);
+
+    surface1 = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    surface2 = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+
+    _adg_render_to_surface(canvas, surface1);
+
+    adg_switch_batching(TRUE);
+    _adg_render_to_surface(canvas, surface2);
+    adg_switch_batching(FALSE);
+
+    size = cairo_image_surface_get_stride(surface1) * 100;
+    g_assert_cmpint(memcmp(cairo_image_surface_get_data(surface1),
+                           cairo_image_surface_get_data(surface2),
+                           size), ==, 0);
+
+    /* Outside a rendering the stroke must be done immediately */
+    adg_switch_batching(TRUE);
+    cr = cairo_create(surface2);
+    cairo_path = adg_trail_get_cairo_path(adg_stroke_get_trail(stroke));
+    adg_entity_stroke_path(ADG_ENTITY(stroke), ADG_DRESS_LINE, cairo_path, NULL, cr);
+    g_assert_false(cairo_has_current_point(cr));
+    cairo_destroy(cr);
+    adg_switch_batching(FALSE);
+
+    cairo_surface_destroy(surface1);
+    cairo_surface_destroy(surface2);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+    g_object_unref(red);
+}
+
+static gint
+_adg_painted_pixels(cairo_surface_t *surface)
+{
+    const guint32 *row;
+    gint x, y, n;
+
+    cairo_surface_flush(surface);
+    n = 0;
+    for (y = 0; y < cairo_image_surface_get_height(surface); ++y) {
+        row = (const guint32 *) (cairo_image_surface_get_data(surface) +
+                                 y * cairo_image_surface_get_stride(surface));
+        for (x = 0; x < cairo_image_surface_get_width(surface); ++x)
+            if (row[x] != 0)
+                ++n;
+    }
+
+    return n;
+}
+
+static gint
+_adg_render_lod(AdgEntity *entity, gdouble scale, gdouble threshold)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gint n;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+    adg_set_lod_threshold(cr, threshold);
+    cairo_translate(cr, 50, 50);
+    cairo_scale(cr, scale, scale);
+    adg_entity_render(entity, cr);
+    cairo_destroy(cr);
+
+    n = _adg_painted_pixels(surface);
+    cairo_surface_destroy(surface);
+
+    return n;
+}
+
+static void
+_adg_behavior_lod(void)
+{
+    AdgPath *path;
+    AdgStroke *stroke;
+    AdgHatch *hatch;
+    AdgToyText *toy_text;
+    AdgEntityClass *klass;
+    cairo_t *cr, *other_cr;
+    gint n;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+    adg_path_line_to_explicit(path, 0, 10);
+    adg_path_close(path);
+
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    hatch = adg_hatch_new(ADG_TRAIL(path));
+    toy_text = adg_toy_text_new("Level of detail");
+    g_object_unref(path);
+
+    /* Sanity checks */
+    cr = adg_test_cairo_context();
+    adg_set_lod_threshold(NULL, 1);
+    adg_assert_isapprox(adg_get_lod_threshold(NULL), 0);
+    adg_set_lod_threshold(cr, -1);
+    adg_assert_isapprox(adg_get_lod_threshold(cr), 0);
+
+    /* The threshold is bound to the cairo context */
+    adg_set_lod_threshold(cr, 1000);
+    adg_assert_isapprox(adg_get_lod_threshold(cr), 1000);
+    other_cr = adg_test_cairo_context();
+    adg_assert_isapprox(adg_get_lod_threshold(other_cr), 0);
+    cairo_destroy(other_cr);
+    adg_set_lod_threshold(cr, 0);
+    adg_assert_isapprox(adg_get_lod_threshold(cr), 0);
+    cairo_destroy(cr);
+
+    /* Every class declares its own policy */
+    g_assert_cmpint(ADG_ENTITY_GET_CLASS(stroke)->lod_policy, ==, ADG_LOD_POLICY_DOT);
+    g_assert_cmpint(ADG_ENTITY_GET_CLASS(hatch)->lod_policy, ==, ADG_LOD_POLICY_DETAIL);
+    g_assert_cmpint(ADG_ENTITY_GET_CLASS(toy_text)->lod_policy, ==, ADG_LOD_POLICY_PLACEHOLDER);
+    klass = g_type_class_ref(ADG_TYPE_CONTAINER);
+    g_assert_cmpint(klass->lod_policy, ==, ADG_LOD_POLICY_NONE);
+    g_type_class_unref(klass);
+
+    /* Disabled level of detail */
+    g_assert_cmpint(_adg_render_lod(ADG_ENTITY(stroke), 1, 0), >, 4);
+
+    /* Markers and hatches below the threshold are skipped */
+    g_assert_cmpint(_adg_render_lod(ADG_ENTITY(hatch), 1, 1000), ==, 0);
+
+    /* A sub-pixel stroke is collapsed into a single dot */
+    n = _adg_render_lod(ADG_ENTITY(stroke), 0.01, 1000);
+    g_assert_cmpint(n, >, 0);
+    g_assert_cmpint(n, <=, 4);
+
+    /* Text is replaced by a placeholder or, if thinner
+     * than one pixel, skipped */
+    g_assert_cmpint(_adg_render_lod(ADG_ENTITY(toy_text), 1, 1000), >, 0);
+    g_assert_cmpint(_adg_render_lod(ADG_ENTITY(toy_text), 0.01, 1000), ==, 0);
+
+    /* Full detail is restored above the threshold */
+    g_assert_cmpint(_adg_render_lod(ADG_ENTITY(stroke), 1, 1), >, 4);
+
+    adg_entity_destroy(ADG_ENTITY(stroke));
+    adg_entity_destroy(ADG_ENTITY(hatch));
+    adg_entity_destroy(ADG_ENTITY(toy_text));
+}
+
 static void
 _adg_behavior_local(void)
 {
@@ -437,6 +771,151 @@ _adg_method_get_canvas(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_method_dup_hash(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    cairo_matrix_t map;
+    gchar *hash1, *hash2;
+
+    /* Sanity check */
+    g_assert_null(adg_entity_dup_hash(NULL));
+
+    canvas = adg_test_canvas();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    adg_entity_arrange(ADG_ENTITY(canvas));
+
+    hash1 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_nonnull(hash1);
+    g_assert_cmpuint(strlen(hash1), ==, 64);
+
+    /* The hash must be stable */
+    hash2 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_cmpstr(hash1, ==, hash2);
+    g_free(hash2);
+
+    /* The cache directory does not change the drawing */
+    adg_canvas_set_cache_dir(canvas, "adg-cache");
+    hash2 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_cmpstr(hash1, ==, hash2);
+    g_free(hash2);
+
+    /* Changing a model must change the hash */
+    adg_path_line_to_explicit(path, 20, 0);
+    adg_entity_arrange(ADG_ENTITY(canvas));
+    hash2 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_cmpstr(hash1, !=, hash2);
+    g_free(hash1);
+    hash1 = hash2;
+
+    /* Changing a child entity must change the hash */
+    cairo_matrix_init_translate(&map, 5, 5);
+    adg_entity_set_local_map(ADG_ENTITY(stroke), &map);
+    adg_entity_arrange(ADG_ENTITY(canvas));
+    hash2 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_cmpstr(hash1, !=, hash2);
+    g_free(hash1);
+    g_free(hash2);
+
+    g_object_unref(path);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_dup_hash_pattern(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgHatch *hatch;
+    AdgFillStyle *fill_style;
+    cairo_pattern_t *pattern;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gchar *hash1, *hash2;
+
+    canvas = adg_test_canvas();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+    adg_path_close(path);
+    hatch = adg_hatch_new(ADG_TRAIL(path));
+    fill_style = g_object_new(ADG_TYPE_DUMMY_FILL, NULL);
+    adg_entity_set_style(ADG_ENTITY(hatch), ADG_DRESS_FILL_HATCH,
+                         ADG_STYLE(fill_style));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(hatch));
+    adg_entity_arrange(ADG_ENTITY(canvas));
+
+    /* Solid patterns are hashed by color */
+    pattern = cairo_pattern_create_rgb(1, 0, 0);
+    adg_fill_style_set_pattern(fill_style, pattern);
+    cairo_pattern_destroy(pattern);
+    hash1 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_nonnull(hash1);
+
+    pattern = cairo_pattern_create_rgb(0, 0, 1);
+    adg_fill_style_set_pattern(fill_style, pattern);
+    cairo_pattern_destroy(pattern);
+    hash2 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_nonnull(hash2);
+    g_assert_cmpstr(hash1, !=, hash2);
+    g_free(hash1);
+    g_free(hash2);
+
+    /* Gradients are hashed by color stops */
+    pattern = cairo_pattern_create_linear(0, 0, 10, 0);
+    cairo_pattern_add_color_stop_rgb(pattern, 0, 1, 0, 0);
+    adg_fill_style_set_pattern(fill_style, pattern);
+    hash1 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_nonnull(hash1);
+
+    cairo_pattern_add_color_stop_rgb(pattern, 1, 0, 0, 1);
+    hash2 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_nonnull(hash2);
+    g_assert_cmpstr(hash1, !=, hash2);
+    cairo_pattern_destroy(pattern);
+    g_free(hash1);
+    g_free(hash2);
+
+    /* Image surfaces are hashed by pixels */
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 4, 4);
+    pattern = cairo_pattern_create_for_surface(surface);
+    adg_fill_style_set_pattern(fill_style, pattern);
+    hash1 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_nonnull(hash1);
+
+    cr = cairo_create(surface);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    hash2 = adg_entity_dup_hash(ADG_ENTITY(canvas));
+    g_assert_nonnull(hash2);
+    g_assert_cmpstr(hash1, !=, hash2);
+    cairo_pattern_destroy(pattern);
+    cairo_surface_destroy(surface);
+    g_free(hash1);
+    g_free(hash2);
+
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 10, 0)
+    /* Other surfaces cannot be hashed */
+    surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+    pattern = cairo_pattern_create_for_surface(surface);
+    adg_fill_style_set_pattern(fill_style, pattern);
+    g_assert_null(adg_entity_dup_hash(ADG_ENTITY(canvas)));
+    cairo_pattern_destroy(pattern);
+    cairo_surface_destroy(surface);
+#endif
+
+    g_object_unref(fill_style);
+    g_object_unref(path);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 
 int
 main(int argc, char *argv[])
@@ -448,6 +927,10 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/entity/behavior/misc", _adg_behavior_misc);
     g_test_add_func("/adg/entity/behavior/style", _adg_behavior_style);
+    g_test_add_func("/adg/entity/behavior/resolved-style", _adg_behavior_resolved_style);
+    g_test_add_func("/adg/entity/behavior/lazy-matrices", _adg_behavior_lazy_matrices);
+    g_test_add_func("/adg/entity/behavior/batching", _adg_behavior_batching);
+    g_test_add_func("/adg/entity/behavior/lod", _adg_behavior_lod);
     g_test_add_func("/adg/entity/behavior/local", _adg_behavior_local);
 
     g_test_add_func("/adg/entity/property/floating", _adg_property_floating);
@@ -458,6 +941,8 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/entity/property/extents", _adg_property_extents);
 
     g_test_add_func("/adg/entity/method/get-canvas", _adg_method_get_canvas);
+    g_test_add_func("/adg/entity/method/dup-hash", _adg_method_dup_hash);
+    g_test_add_func("/adg/entity/method/dup-hash-pattern", _adg_method_dup_hash_pattern);
 
     return g_test_run();
 }
@@ -297,6 +297,186 @@ _adg_property_render_map(void)
     gtk_widget_destroy(GTK_WIDGET(area));
 }
 
+static void
+_adg_property_snap(void)
+{
+    AdgGtkArea *area;
+    AdgSnap snap;
+
+    area = ADG_GTK_AREA(adg_gtk_area_new());
+
+    /* Sanity check */
+    g_assert_cmpint(adg_gtk_area_get_snap(NULL), ==, ADG_SNAP_NONE);
+
+    /* Using the public APIs */
+    g_assert_cmpint(adg_gtk_area_get_snap(area), ==, ADG_SNAP_NONE);
+    adg_gtk_area_set_snap(area, ADG_SNAP_ENDPOINT | ADG_SNAP_CENTER);
+    snap = adg_gtk_area_get_snap(area);
+    g_assert_cmpint(snap, ==, ADG_SNAP_ENDPOINT | ADG_SNAP_CENTER);
+
+    adg_gtk_area_set_snap(area, ADG_SNAP_NONE);
+    snap = adg_gtk_area_get_snap(area);
+    g_assert_cmpint(snap, ==, ADG_SNAP_NONE);
+
+    /* Using GObject property methods */
+    g_object_set(area, "snap", ADG_SNAP_NEAREST, NULL);
+    g_object_get(area, "snap", &snap, NULL);
+    g_assert_cmpint(snap, ==, ADG_SNAP_NEAREST);
+
+    g_object_set(area, "snap", ADG_SNAP_NONE, NULL);
+    g_object_get(area, "snap", &snap, NULL);
+    g_assert_cmpint(snap, ==, ADG_SNAP_NONE);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_property_snap_radius(void)
+{
+    AdgGtkArea *area;
+    gdouble valid_radius, invalid_radius, radius;
+
+    area = ADG_GTK_AREA(adg_gtk_area_new());
+    valid_radius = 3;
+    invalid_radius = -1;
+
+    /* Sanity check */
+    adg_assert_isapprox(adg_gtk_area_get_snap_radius(NULL), 0);
+
+    /* Using the public APIs */
+    adg_assert_isapprox(adg_gtk_area_get_snap_radius(area), 8);
+    adg_gtk_area_set_snap_radius(area, valid_radius);
+    radius = adg_gtk_area_get_snap_radius(area);
+    adg_assert_isapprox(radius, valid_radius);
+
+    adg_gtk_area_set_snap_radius(area, invalid_radius);
+    radius = adg_gtk_area_get_snap_radius(area);
+    adg_assert_isapprox(radius, valid_radius);
+
+    /* Using GObject property methods */
+    g_object_set(area, "snap-radius", 5., NULL);
+    g_object_get(area, "snap-radius", &radius, NULL);
+    adg_assert_isapprox(radius, 5);
+
+    g_object_set(area, "snap-radius", invalid_radius, NULL);
+    g_object_get(area, "snap-radius", &radius, NULL);
+    adg_assert_isapprox(radius, 5);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_property_tile_cache(void)
+{
+    AdgGtkArea *area;
+    gboolean invalid_boolean;
+    gboolean has_tile_cache;
+
+    area = (AdgGtkArea *) adg_gtk_area_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    has_tile_cache = adg_gtk_area_has_tile_cache(area);
+    g_assert_false(has_tile_cache);
+
+    adg_gtk_area_switch_tile_cache(area, invalid_boolean);
+    has_tile_cache = adg_gtk_area_has_tile_cache(area);
+    g_assert_false(has_tile_cache);
+
+    adg_gtk_area_switch_tile_cache(area, TRUE);
+    has_tile_cache = adg_gtk_area_has_tile_cache(area);
+    g_assert_true(has_tile_cache);
+
+    /* Using GObject property methods */
+    g_object_set(area, "tile-cache", invalid_boolean, NULL);
+    g_object_get(area, "tile-cache", &has_tile_cache, NULL);
+    g_assert_true(has_tile_cache);
+
+    g_object_set(area, "tile-cache", FALSE, NULL);
+    g_object_get(area, "tile-cache", &has_tile_cache, NULL);
+    g_assert_false(has_tile_cache);
+
+    g_object_set(area, "tile-cache", TRUE, NULL);
+    g_object_get(area, "tile-cache", &has_tile_cache, NULL);
+    g_assert_true(has_tile_cache);
+
+    /* Destroying the widget with the cache enabled must be safe */
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_property_async_render(void)
+{
+    AdgGtkArea *area;
+    gboolean invalid_boolean;
+    gboolean has_async_render;
+
+    area = (AdgGtkArea *) adg_gtk_area_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    has_async_render = adg_gtk_area_has_async_render(area);
+    g_assert_false(has_async_render);
+
+    adg_gtk_area_switch_async_render(area, invalid_boolean);
+    has_async_render = adg_gtk_area_has_async_render(area);
+    g_assert_false(has_async_render);
+
+    adg_gtk_area_switch_async_render(area, TRUE);
+    has_async_render = adg_gtk_area_has_async_render(area);
+    g_assert_true(has_async_render);
+
+    /* Using GObject property methods */
+    g_object_set(area, "async-render", invalid_boolean, NULL);
+    g_object_get(area, "async-render", &has_async_render, NULL);
+    g_assert_true(has_async_render);
+
+    g_object_set(area, "async-render", FALSE, NULL);
+    g_object_get(area, "async-render", &has_async_render, NULL);
+    g_assert_false(has_async_render);
+
+    g_object_set(area, "async-render", TRUE, NULL);
+    g_object_get(area, "async-render", &has_async_render, NULL);
+    g_assert_true(has_async_render);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_property_lod_threshold(void)
+{
+    AdgGtkArea *area;
+    gdouble valid_threshold, invalid_threshold, threshold;
+
+    area = ADG_GTK_AREA(adg_gtk_area_new());
+    valid_threshold = 20;
+    invalid_threshold = -1;
+
+    /* Sanity check */
+    adg_assert_isapprox(adg_gtk_area_get_lod_threshold(NULL), 0);
+
+    /* Using the public APIs */
+    adg_assert_isapprox(adg_gtk_area_get_lod_threshold(area), 0);
+    adg_gtk_area_set_lod_threshold(area, valid_threshold);
+    threshold = adg_gtk_area_get_lod_threshold(area);
+    adg_assert_isapprox(threshold, valid_threshold);
+
+    adg_gtk_area_set_lod_threshold(area, invalid_threshold);
+    threshold = adg_gtk_area_get_lod_threshold(area);
+    adg_assert_isapprox(threshold, valid_threshold);
+
+    /* Using GObject property methods */
+    g_object_set(area, "lod-threshold", 5., NULL);
+    g_object_get(area, "lod-threshold", &threshold, NULL);
+    adg_assert_isapprox(threshold, 5);
+
+    g_object_set(area, "lod-threshold", invalid_threshold, NULL);
+    g_object_get(area, "lod-threshold", &threshold, NULL);
+    adg_assert_isapprox(threshold, 5);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
 static void
 _adg_method_get_extents(void)
 {
@@ -590,6 +770,229 @@ _adg_method_motion_event(void)
     gtk_widget_destroy(GTK_WIDGET(area));
 }
 
+static void
+_adg_snapped(AdgGtkArea *area, AdgSnap snap, const CpmlPair *pair,
+             gpointer user_data)
+{
+    *((AdgSnap *) user_data) = snap;
+}
+
+static void
+_adg_method_snap(void)
+{
+    AdgGtkArea *area;
+    AdgCanvas *canvas;
+    GdkEventMotion event;
+    gboolean stop;
+    CpmlPair pair;
+    cairo_matrix_t map;
+    AdgSnap snapped;
+
+    area = _adg_gtk_area_new();
+    canvas = adg_gtk_area_get_canvas(area);
+
+    /* The test canvas is a line from (0, 0) to (1, 1) */
+    adg_entity_arrange(ADG_ENTITY(canvas));
+
+    /* Sanity check */
+    g_assert_cmpint(adg_gtk_area_snap(NULL, 0.5, 0.6, &pair), ==, ADG_SNAP_NONE);
+
+    /* Snapping is disabled by default */
+    g_assert_cmpint(adg_gtk_area_snap(area, 0.5, 0.6, &pair), ==, ADG_SNAP_NONE);
+
+    adg_gtk_area_set_snap(area, ADG_SNAP_ENDPOINT | ADG_SNAP_NEAREST);
+    g_assert_cmpint(adg_gtk_area_snap(area, 0.5, 0.6, &pair), ==, ADG_SNAP_ENDPOINT);
+    adg_assert_isapprox(pair.x, 1);
+    adg_assert_isapprox(pair.y, 1);
+
+    adg_gtk_area_set_snap_radius(area, 0.2);
+    g_assert_cmpint(adg_gtk_area_snap(area, 0.5, 0.6, &pair), ==, ADG_SNAP_NEAREST);
+    adg_assert_isapprox(pair.x, 0.55);
+    adg_assert_isapprox(pair.y, 0.55);
+    g_assert_cmpint(adg_gtk_area_snap(area, 5, 5, &pair), ==, ADG_SNAP_NONE);
+
+    adg_gtk_area_set_snap(area, ADG_SNAP_MIDPOINT);
+    g_assert_cmpint(adg_gtk_area_snap(area, 0.5, 0.6, NULL), ==, ADG_SNAP_MIDPOINT);
+
+    /* The render map must be taken into account */
+    cairo_matrix_init_scale(&map, 10, 10);
+    adg_gtk_area_set_render_map(area, &map);
+    adg_gtk_area_set_snap_radius(area, 2);
+    g_assert_cmpint(adg_gtk_area_snap(area, 5, 6, &pair), ==, ADG_SNAP_MIDPOINT);
+    adg_assert_isapprox(pair.x, 5);
+    adg_assert_isapprox(pair.y, 5);
+
+    /* Check the snapped signal is emitted on pointer motion */
+    snapped = ADG_SNAP_NEAREST;
+    g_signal_connect(area, "snapped", G_CALLBACK(_adg_snapped), &snapped);
+    event.type = GDK_MOTION_NOTIFY;
+    event.state = 0;
+    event.x = 5;
+    event.y = 6;
+    g_signal_emit_by_name(area, "motion-notify-event", &event, NULL, &stop);
+    g_assert_cmpint(snapped, ==, ADG_SNAP_MIDPOINT);
+    event.x = 50;
+    g_signal_emit_by_name(area, "motion-notify-event", &event, NULL, &stop);
+    g_assert_cmpint(snapped, ==, ADG_SNAP_NONE);
+
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+#ifdef GTK3_ENABLED
+
+static void
+_adg_draw_area(AdgGtkArea *area, cairo_surface_t *surface)
+{
+    cairo_t *cr = cairo_create(surface);
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+    GTK_WIDGET_GET_CLASS(area)->draw(GTK_WIDGET(area), cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+}
+
+static void
+_adg_assert_same_pixels(cairo_surface_t *surface1, cairo_surface_t *surface2)
+{
+    const guchar *data1, *data2;
+    gint n, size, max_diff;
+
+    data1 = cairo_image_surface_get_data(surface1);
+    data2 = cairo_image_surface_get_data(surface2);
+    size = cairo_image_surface_get_stride(surface1) *
+           cairo_image_surface_get_height(surface1);
+
+    /* Allow rounding differences on the antialiased pixels */
+    max_diff = 0;
+    for (n = 0; n < size; ++n)
+        max_diff = MAX(max_diff, ABS(data1[n] - data2[n]));
+
+    g_assert_cmpint(max_diff, <=, 2);
+}
+
+static void
+_adg_behavior_tile_cache(void)
+{
+    AdgGtkArea *area;
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    cairo_surface_t *direct, *tiled;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 10, 10);
+    adg_path_line_to_explicit(path, 500, 300);
+    adg_path_line_to_explicit(path, 100, 500);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+
+    canvas = adg_canvas_new();
+    adg_canvas_set_margins(canvas, 0, 0, 0, 0);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    area = ADG_GTK_AREA(adg_gtk_area_new_with_canvas(canvas));
+    g_object_unref(canvas);
+
+    direct = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 600, 600);
+    tiled = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 600, 600);
+
+    /* Rendering through tiles must give the same result */
+    _adg_draw_area(area, direct);
+    adg_gtk_area_switch_tile_cache(area, TRUE);
+    _adg_draw_area(area, tiled);
+    _adg_assert_same_pixels(direct, tiled);
+
+    /* Drawing from the cache */
+    _adg_draw_area(area, tiled);
+    _adg_assert_same_pixels(direct, tiled);
+
+    /* Changing the model must invalidate the affected tiles */
+    adg_path_line_to_explicit(path, 550, 550);
+    adg_model_changed(ADG_MODEL(path));
+    _adg_draw_area(area, tiled);
+
+    adg_gtk_area_switch_tile_cache(area, FALSE);
+    _adg_draw_area(area, direct);
+    _adg_assert_same_pixels(direct, tiled);
+
+    /* Explicit invalidation */
+    adg_gtk_area_switch_tile_cache(area, TRUE);
+    _adg_draw_area(area, tiled);
+    adg_gtk_area_invalidate_tiles(area, NULL);
+    _adg_draw_area(area, tiled);
+    _adg_assert_same_pixels(direct, tiled);
+
+    cairo_surface_destroy(direct);
+    cairo_surface_destroy(tiled);
+    g_object_unref(path);
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+static void
+_adg_behavior_async_render(void)
+{
+    AdgGtkArea *area;
+    GtkAllocation allocation;
+    cairo_matrix_t map;
+    cairo_surface_t *direct, *async;
+    gint minimum, natural;
+
+    area = _adg_gtk_area_new();
+    gtk_widget_get_preferred_width(GTK_WIDGET(area), &minimum, &natural);
+    gtk_widget_get_preferred_height(GTK_WIDGET(area), &minimum, &natural);
+    allocation.x = 0;
+    allocation.y = 0;
+    allocation.width = 200;
+    allocation.height = 200;
+    gtk_widget_size_allocate(GTK_WIDGET(area), &allocation);
+
+    cairo_matrix_init_scale(&map, 100, 100);
+    adg_gtk_area_set_render_map(area, &map);
+
+    direct = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 200, 200);
+    async = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 200, 200);
+    _adg_draw_area(area, direct);
+
+    /* The first draw only starts the rendering */
+    adg_gtk_area_switch_async_render(area, TRUE);
+    g_assert_false(adg_gtk_area_is_rendering(area));
+    _adg_draw_area(area, async);
+    g_assert_true(adg_gtk_area_is_rendering(area));
+
+    while (adg_gtk_area_is_rendering(area))
+        g_main_context_iteration(NULL, TRUE);
+
+    /* The frame is up to date: no new render must be started */
+    _adg_draw_area(area, async);
+    g_assert_false(adg_gtk_area_is_rendering(area));
+    _adg_assert_same_pixels(direct, async);
+
+    /* A new render map starts a new render, superseded by the next one */
+    cairo_matrix_init_scale(&map, 150, 150);
+    adg_gtk_area_set_render_map(area, &map);
+    _adg_draw_area(area, async);
+    g_assert_true(adg_gtk_area_is_rendering(area));
+
+    cairo_matrix_init_scale(&map, 180, 180);
+    adg_gtk_area_set_render_map(area, &map);
+    _adg_draw_area(area, async);
+
+    while (adg_gtk_area_is_rendering(area))
+        g_main_context_iteration(NULL, TRUE);
+
+    _adg_draw_area(area, async);
+    adg_gtk_area_switch_async_render(area, FALSE);
+    _adg_draw_area(area, direct);
+    _adg_assert_same_pixels(direct, async);
+
+    cairo_surface_destroy(direct);
+    cairo_surface_destroy(async);
+    gtk_widget_destroy(GTK_WIDGET(area));
+}
+
+#endif
+
 #ifdef GTK2_ENABLED
 
 static void
@@ -632,11 +1035,20 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg-gtk/area/type/object", ADG_GTK_TYPE_AREA);
 
     g_test_add_func("/adg-gtk/area/behavior/translation", _adg_behavior_translation);
+#ifdef GTK3_ENABLED
+    g_test_add_func("/adg-gtk/area/behavior/tile-cache", _adg_behavior_tile_cache);
+    g_test_add_func("/adg-gtk/area/behavior/async-render", _adg_behavior_async_render);
+#endif
 
     g_test_add_func("/adg-gtk/area/property/canvas", _adg_property_canvas);
     g_test_add_func("/adg-gtk/area/property/factor", _adg_property_factor);
     g_test_add_func("/adg-gtk/area/property/autozoom", _adg_property_autozoom);
     g_test_add_func("/adg-gtk/area/property/render-map", _adg_property_render_map);
+    g_test_add_func("/adg-gtk/area/property/snap", _adg_property_snap);
+    g_test_add_func("/adg-gtk/area/property/snap-radius", _adg_property_snap_radius);
+    g_test_add_func("/adg-gtk/area/property/tile-cache", _adg_property_tile_cache);
+    g_test_add_func("/adg-gtk/area/property/async-render", _adg_property_async_render);
+    g_test_add_func("/adg-gtk/area/property/lod-threshold", _adg_property_lod_threshold);
 
     g_test_add_func("/adg-gtk/area/method/get-extents", _adg_method_get_extents);
     g_test_add_func("/adg-gtk/area/method/get-zoom", _adg_method_get_zoom);
@@ -646,6 +1058,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg-gtk/area/method/canvas-changed", _adg_method_canvas_changed);
     g_test_add_func("/adg-gtk/area/method/scroll-event", _adg_method_scroll_event);
     g_test_add_func("/adg-gtk/area/method/motion-event", _adg_method_motion_event);
+    g_test_add_func("/adg-gtk/area/method/snap", _adg_method_snap);
 #ifdef GTK2_ENABLED
     g_test_add_func("/adg-gtk/area/method/size-request", _adg_method_size_request);
 #endif
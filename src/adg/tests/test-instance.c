@@ -0,0 +1,137 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+
+
+static void
+_adg_property_source(void)
+{
+    AdgInstance *instance;
+    AdgEntity *valid_source, *invalid_source, *source;
+
+    instance = adg_instance_new(NULL);
+    valid_source = ADG_ENTITY(adg_logo_new());
+    invalid_source = adg_test_invalid_pointer();
+
+    g_object_ref(valid_source);
+
+    /* Using the public APIs */
+    source = adg_instance_get_source(instance);
+    g_assert_null(source);
+
+    adg_instance_set_source(instance, valid_source);
+    source = adg_instance_get_source(instance);
+    g_assert_true(source == valid_source);
+
+    adg_instance_set_source(instance, invalid_source);
+    source = adg_instance_get_source(instance);
+    g_assert_true(source == valid_source);
+
+    adg_instance_set_source(instance, NULL);
+    source = adg_instance_get_source(instance);
+    g_assert_null(source);
+
+    /* Using GObject property methods */
+    g_object_set(instance, "source", valid_source, NULL);
+    g_object_get(instance, "source", &source, NULL);
+    g_assert_true(source == valid_source);
+    g_object_unref(source);
+
+    g_object_set(instance, "source", invalid_source, NULL);
+    g_object_get(instance, "source", &source, NULL);
+    g_assert_true(source == valid_source);
+    g_object_unref(source);
+
+    g_object_set(instance, "source", NULL, NULL);
+    g_object_get(instance, "source", &source, NULL);
+    g_assert_null(source);
+
+    adg_entity_destroy(ADG_ENTITY(instance));
+    g_object_unref(valid_source);
+}
+
+static void
+_adg_behavior_extents(void)
+{
+    AdgEntity *source;
+    AdgInstance *instance1, *instance2;
+    const CpmlExtents *source_extents, *extents;
+    cairo_matrix_t map;
+
+    source = ADG_ENTITY(adg_logo_new());
+    instance1 = adg_instance_new(source);
+    instance2 = adg_instance_new(source);
+
+    cairo_matrix_init_translate(&map, 100, 200);
+    adg_entity_set_global_map(ADG_ENTITY(instance2), &map);
+
+    adg_entity_arrange(ADG_ENTITY(instance1));
+    source_extents = adg_entity_get_extents(source);
+    g_assert_true(source_extents->is_defined);
+
+    /* An instance with an identity map has the same extents of its source */
+    extents = adg_entity_get_extents(ADG_ENTITY(instance1));
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, source_extents->org.x);
+    adg_assert_isapprox(extents->org.y, source_extents->org.y);
+    adg_assert_isapprox(extents->size.x, source_extents->size.x);
+    adg_assert_isapprox(extents->size.y, source_extents->size.y);
+
+    /* A translated instance must reuse the already arranged source */
+    adg_test_signal(source, "arrange");
+    adg_entity_arrange(ADG_ENTITY(instance2));
+    g_assert_false(adg_test_signal_check(TRUE));
+
+    extents = adg_entity_get_extents(ADG_ENTITY(instance2));
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->org.x, source_extents->org.x + 100);
+    adg_assert_isapprox(extents->org.y, source_extents->org.y + 200);
+    adg_assert_isapprox(extents->size.x, source_extents->size.x);
+    adg_assert_isapprox(extents->size.y, source_extents->size.y);
+
+    /* Invalidating the source must invalidate its instances */
+    adg_entity_invalidate(source);
+    g_assert_false(adg_entity_get_extents(ADG_ENTITY(instance1))->is_defined);
+    g_assert_false(adg_entity_get_extents(ADG_ENTITY(instance2))->is_defined);
+
+    adg_entity_destroy(ADG_ENTITY(instance1));
+    adg_entity_destroy(ADG_ENTITY(instance2));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    adg_test_add_object_checks("/adg/instance/type/object", ADG_TYPE_INSTANCE);
+    adg_test_add_entity_checks("/adg/instance/type/entity", ADG_TYPE_INSTANCE);
+
+    adg_test_add_global_space_checks("/adg/instance/behavior/global-space",
+                                     adg_instance_new(ADG_ENTITY(adg_logo_new())));
+
+    g_test_add_func("/adg/instance/behavior/extents", _adg_behavior_extents);
+
+    g_test_add_func("/adg/instance/property/source", _adg_property_source);
+
+    return g_test_run();
+}
@@ -49,6 +49,54 @@ _adg_property_named_pair(void)
     g_object_unref(model);
 }
 
+static void
+_adg_property_named_pair_slot(void)
+{
+    AdgModel *model;
+    CpmlPair valid_pair;
+    guint slot, generation;
+
+    model = ADG_MODEL(adg_path_new());
+    valid_pair.x = -1234;
+    valid_pair.y = 4321;
+
+    /* Sanity check */
+    g_assert_cmpuint(adg_model_get_named_pair_slot(NULL, "Name"), ==, 0);
+    g_assert_cmpuint(adg_model_get_named_pair_slot(model, NULL), ==, 0);
+    g_assert_null(adg_model_get_slot_pair(model, 0));
+    g_assert_null(adg_model_get_slot_pair(model, 1234));
+
+    /* Looking up an undefined named pair must not reserve a slot */
+    g_assert_cmpuint(adg_model_get_named_pair_slot(model, "Pair"), ==, 0);
+
+    adg_model_set_named_pair(model, "Pair", &valid_pair);
+    slot = adg_model_get_named_pair_slot(model, "Pair");
+    generation = adg_model_get_slot_generation(model);
+    g_assert_cmpuint(slot, >, 0);
+    g_assert_true(cpml_pair_equal(adg_model_get_slot_pair(model, slot), &valid_pair));
+    g_assert_cmpuint(adg_model_get_named_pair_slot(model, "Pair"), ==, slot);
+    g_assert_cmpuint(adg_model_get_named_pair_slot(model, "Other"), ==, 0);
+
+    valid_pair.x = 5678;
+    adg_model_set_named_pair(model, "Pair", &valid_pair);
+    g_assert_true(cpml_pair_equal(adg_model_get_slot_pair(model, slot), &valid_pair));
+
+    /* The slot of a removed named pair stays valid */
+    adg_model_set_named_pair(model, "Pair", NULL);
+    g_assert_null(adg_model_get_slot_pair(model, slot));
+    g_assert_cmpuint(adg_model_get_named_pair_slot(model, "Pair"), ==, slot);
+    g_assert_cmpuint(adg_model_get_slot_generation(model), ==, generation);
+    adg_model_set_named_pair(model, "Pair", &valid_pair);
+    g_assert_true(cpml_pair_equal(adg_model_get_slot_pair(model, slot), &valid_pair));
+
+    /* Resetting the model must change the generation */
+    adg_model_reset(model);
+    g_assert_cmpuint(adg_model_get_slot_generation(model), !=, generation);
+    g_assert_null(adg_model_get_slot_pair(model, slot));
+
+    g_object_unref(model);
+}
+
 static void
 _adg_property_dependency(void)
 {
@@ -114,6 +162,7 @@ main(int argc, char *argv[])
     adg_test_add_model_checks("/adg/model/type/model", ADG_TYPE_MODEL);
 
     g_test_add_func("/adg/model/named-pair", _adg_property_named_pair);
+    g_test_add_func("/adg/model/named-pair-slot", _adg_property_named_pair_slot);
     g_test_add_func("/adg/model/dependency", _adg_property_dependency);
 
     return g_test_run();
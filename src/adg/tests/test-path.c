@@ -22,6 +22,58 @@
 #include <adg.h>
 
 
+static void
+_adg_property_arc_tolerance(void)
+{
+    AdgPath *path;
+    gdouble valid_value, invalid_value;
+    gdouble arc_tolerance;
+    const CpmlPrimitive *primitive;
+
+    path = adg_path_new();
+    valid_value = 0.001;
+    invalid_value = -1;
+
+    /* Using the public APIs */
+    g_assert_cmpfloat(adg_path_get_arc_tolerance(path), ==, 0);
+    adg_path_set_arc_tolerance(path, valid_value);
+    arc_tolerance = adg_path_get_arc_tolerance(path);
+    adg_assert_isapprox(arc_tolerance, valid_value);
+
+    adg_path_set_arc_tolerance(path, invalid_value);
+    arc_tolerance = adg_path_get_arc_tolerance(path);
+    adg_assert_isapprox(arc_tolerance, valid_value);
+
+    /* Using GObject property methods */
+    g_object_set(path, "arc-tolerance", 0., NULL);
+    g_object_get(path, "arc-tolerance", &arc_tolerance, NULL);
+    g_assert_cmpfloat(arc_tolerance, ==, 0);
+
+    g_object_set(path, "arc-tolerance", invalid_value, NULL);
+    g_object_get(path, "arc-tolerance", &arc_tolerance, NULL);
+    g_assert_cmpfloat(arc_tolerance, ==, 0);
+
+    /* A quarter of circle is kept as a curve by default... */
+    adg_path_move_to_explicit(path, 1, 0);
+    adg_path_curve_to_explicit(path, 1, 0.5522847498, 0.5522847498, 1, 0, 1);
+    primitive = adg_path_last_primitive(path);
+    g_assert_cmpint(primitive->data[0].header.type, ==, CPML_CURVE);
+
+    /* ...and converted to an arc when within the tolerance */
+    adg_path_set_arc_tolerance(path, valid_value);
+    adg_path_curve_to_explicit(path, -0.5522847498, 1, -1, 0.5522847498, -1, 0);
+    primitive = adg_path_last_primitive(path);
+    g_assert_cmpint(primitive->data[0].header.type, ==, CPML_ARC);
+    g_assert_cmpint(primitive->data[0].header.length, ==, 3);
+    adg_assert_isapprox(primitive->data[2].point.x, -1);
+    adg_assert_isapprox(primitive->data[2].point.y, 0);
+    g_assert_true(adg_path_has_current_point(path));
+    adg_assert_isapprox(adg_path_get_current_point(path)->x, -1);
+    adg_assert_isapprox(adg_path_get_current_point(path)->y, 0);
+
+    g_object_unref(path);
+}
+
 static void
 _adg_method_get_current_point(void)
 {
@@ -998,6 +1050,101 @@ _adg_method_reflect(void)
     g_object_unref(path);
 }
 
+static void
+_adg_count(guint *counter)
+{
+    ++*counter;
+}
+
+static void
+_adg_define_update(AdgPath *path, gdouble x)
+{
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, x, 0);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "P0", 0, 0);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "P1", x, 0);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "P2", 0, 10);
+}
+
+static void
+_adg_method_update(void)
+{
+    AdgPath *path;
+    AdgModel *model;
+    AdgEntity *stroke, *ldim1, *ldim2;
+    guint n_stroke, n_ldim1, n_ldim2, n_changed;
+    cairo_path_data_t *primitive_data;
+    GSList *moved;
+
+    path = adg_path_new();
+    model = ADG_MODEL(path);
+    _adg_define_update(path, 10);
+    primitive_data = adg_path_last_primitive(path)->data;
+
+    stroke = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    ldim1 = ADG_ENTITY(adg_ldim_new_full_from_model(model, "P0", "P1", "P2", 0));
+    ldim2 = ADG_ENTITY(adg_ldim_new_full_from_model(model, "P0", "P2", "P2", 0));
+
+    n_stroke = n_ldim1 = n_ldim2 = n_changed = 0;
+    g_signal_connect_swapped(path, "changed", G_CALLBACK(_adg_count), &n_changed);
+    g_signal_connect_swapped(stroke, "invalidate", G_CALLBACK(_adg_count), &n_stroke);
+    g_signal_connect_swapped(ldim1, "invalidate", G_CALLBACK(_adg_count), &n_ldim1);
+    g_signal_connect_swapped(ldim2, "invalidate", G_CALLBACK(_adg_count), &n_ldim2);
+
+    /* Sanity checks */
+    adg_path_begin_update(NULL);
+    g_assert_null(adg_path_end_update(NULL));
+    g_assert_null(adg_path_end_update(path));
+
+    /* Nothing changed: nothing must be invalidated */
+    adg_path_begin_update(path);
+    _adg_define_update(path, 10);
+    moved = adg_path_end_update(path);
+    g_assert_null(moved);
+    g_assert_cmpuint(n_stroke, ==, 0);
+    g_assert_cmpuint(n_ldim1, ==, 0);
+    g_assert_cmpuint(n_ldim2, ==, 0);
+    g_assert_cmpuint(n_changed, ==, 0);
+
+    /* Primitives must be kept in place */
+    g_assert_true(adg_path_last_primitive(path)->data == primitive_data);
+
+    /* Moving P1 must not invalidate ldim2 */
+    adg_path_begin_update(path);
+    _adg_define_update(path, 20);
+    moved = adg_path_end_update(path);
+    g_assert_nonnull(moved);
+    g_assert_cmpstr(moved->data, ==, "P1");
+    g_assert_null(moved->next);
+    g_slist_free(moved);
+    g_assert_cmpuint(n_stroke, ==, 1);
+    g_assert_cmpuint(n_ldim1, ==, 1);
+    g_assert_cmpuint(n_ldim2, ==, 0);
+    g_assert_cmpuint(n_changed, ==, 1);
+
+    /* Named pairs not redefined must be removed */
+    adg_path_begin_update(path);
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 20, 0);
+    adg_model_set_named_pair_explicit(model, "P0", 0, 0);
+    adg_model_set_named_pair_explicit(model, "P1", 20, 0);
+    moved = adg_path_end_update(path);
+    g_assert_nonnull(moved);
+    g_assert_cmpstr(moved->data, ==, "P2");
+    g_assert_null(moved->next);
+    g_slist_free(moved);
+    g_assert_null(adg_model_get_named_pair(model, "P2"));
+    g_assert_cmpuint(n_stroke, ==, 1);
+    g_assert_cmpuint(n_ldim1, ==, 2);
+    g_assert_cmpuint(n_ldim2, ==, 1);
+    g_assert_cmpuint(n_changed, ==, 2);
+
+    adg_entity_destroy(stroke);
+    adg_entity_destroy(ldim1);
+    adg_entity_destroy(ldim2);
+    g_object_unref(path);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -1007,6 +1154,8 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/path/type/object", ADG_TYPE_PATH);
     adg_test_add_model_checks("/adg/path/type/model", ADG_TYPE_PATH);
 
+    g_test_add_func("/adg/path/property/arc-tolerance", _adg_property_arc_tolerance);
+
     g_test_add_func("/adg/path/method/get-current-point", _adg_method_get_current_point);
     g_test_add_func("/adg/path/method/has-current-point", _adg_method_has_current_point);
     g_test_add_func("/adg/path/method/last-primitive", _adg_method_last_primitive);
@@ -1025,6 +1174,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/path/method/fillet", _adg_method_fillet);
     g_test_add_func("/adg/path/method/join", _adg_method_join);
     g_test_add_func("/adg/path/method/reflect", _adg_method_reflect);
+    g_test_add_func("/adg/path/method/update", _adg_method_update);
 
     return g_test_run();
 }
@@ -0,0 +1,121 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+
+static void
+_adg_behavior_switch(void)
+{
+    AdgCanvas *canvas;
+    cairo_t *cr;
+    gchar *summary;
+
+    canvas = adg_test_canvas();
+    cr = adg_test_cairo_context();
+
+    adg_profile_reset();
+    g_assert_false(adg_profile_is_enabled());
+
+    /* Nothing must be recorded when profiling is disabled */
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    summary = adg_profile_get_summary();
+    g_assert_null(strstr(summary, "AdgStroke"));
+    g_free(summary);
+
+    adg_switch_profile(TRUE);
+    g_assert_true(adg_profile_is_enabled());
+
+    adg_entity_invalidate(ADG_ENTITY(canvas));
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    summary = adg_profile_get_summary();
+    g_assert_nonnull(strstr(summary, "AdgCanvas"));
+    g_assert_nonnull(strstr(summary, "AdgStroke"));
+    g_assert_nonnull(strstr(summary, "arrange"));
+    g_assert_nonnull(strstr(summary, "render"));
+    g_free(summary);
+
+    adg_switch_profile(FALSE);
+    g_assert_false(adg_profile_is_enabled());
+
+    /* Disabling the profiling must not clear the recorded data */
+    summary = adg_profile_get_summary();
+    g_assert_nonnull(strstr(summary, "AdgStroke"));
+    g_free(summary);
+
+    adg_profile_reset();
+    summary = adg_profile_get_summary();
+    g_assert_null(strstr(summary, "AdgStroke"));
+    g_free(summary);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_write_trace(void)
+{
+    AdgCanvas *canvas;
+    gchar *file, *content;
+    gint fd;
+
+    canvas = adg_test_canvas();
+    fd = g_file_open_tmp("adg-trace-XXXXXX.json", &file, NULL);
+    g_assert_cmpint(fd, !=, -1);
+    g_close(fd, NULL);
+
+    adg_profile_reset();
+    adg_switch_profile(TRUE);
+    adg_entity_arrange(ADG_ENTITY(canvas));
+    adg_switch_profile(FALSE);
+
+    g_assert_true(adg_profile_write_trace(file, NULL));
+    g_assert_true(g_file_get_contents(file, &content, NULL, NULL));
+    g_assert_nonnull(strstr(content, "\"traceEvents\""));
+    g_assert_nonnull(strstr(content, "\"name\":\"AdgStroke\""));
+    g_assert_nonnull(strstr(content, "\"cat\":\"arrange\""));
+    g_assert_null(strstr(content, "\"cat\":\"render\""));
+
+    /* Entities must be identified by serial number, not by address */
+    g_assert_nonnull(strstr(content, "\"args\":{\"entity\":"));
+    g_assert_null(strstr(content, "\"entity\":\""));
+    g_free(content);
+
+    g_unlink(file);
+    g_free(file);
+    adg_profile_reset();
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/adg/profile/behavior/switch", _adg_behavior_switch);
+
+    g_test_add_func("/adg/profile/method/write-trace", _adg_method_write_trace);
+
+    return g_test_run();
+}
@@ -145,6 +145,153 @@ _adg_property_spacing(void)
     g_object_unref(ruled_fill);
 }
 
+static void
+_adg_property_vector_lines(void)
+{
+    AdgRuledFill *ruled_fill;
+    gboolean invalid_boolean;
+    gboolean has_vector_lines;
+
+    ruled_fill = adg_ruled_fill_new();
+    invalid_boolean = (gboolean) 1234;
+
+    /* Using the public APIs */
+    adg_ruled_fill_switch_vector_lines(ruled_fill, FALSE);
+    has_vector_lines = adg_ruled_fill_has_vector_lines(ruled_fill);
+    g_assert_false(has_vector_lines);
+
+    adg_ruled_fill_switch_vector_lines(ruled_fill, invalid_boolean);
+    has_vector_lines = adg_ruled_fill_has_vector_lines(ruled_fill);
+    g_assert_false(has_vector_lines);
+
+    adg_ruled_fill_switch_vector_lines(ruled_fill, TRUE);
+    has_vector_lines = adg_ruled_fill_has_vector_lines(ruled_fill);
+    g_assert_true(has_vector_lines);
+
+    /* Using GObject property methods */
+    g_object_set(ruled_fill, "vector-lines", FALSE, NULL);
+    g_object_get(ruled_fill, "vector-lines", &has_vector_lines, NULL);
+    g_assert_false(has_vector_lines);
+
+    g_object_set(ruled_fill, "vector-lines", invalid_boolean, NULL);
+    g_object_get(ruled_fill, "vector-lines", &has_vector_lines, NULL);
+    g_assert_false(has_vector_lines);
+
+    g_object_set(ruled_fill, "vector-lines", TRUE, NULL);
+    g_object_get(ruled_fill, "vector-lines", &has_vector_lines, NULL);
+    g_assert_true(has_vector_lines);
+
+    g_object_unref(ruled_fill);
+}
+
+static void
+_adg_method_fill(void)
+{
+    AdgRuledFill *ruled_fill;
+    AdgFillStyle *fill_style;
+    AdgEntity *entity;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    CpmlExtents extents;
+
+    ruled_fill = adg_ruled_fill_new();
+    fill_style = (AdgFillStyle *) ruled_fill;
+    entity = (AdgEntity *) adg_logo_new();
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    extents.is_defined = 1;
+    extents.org.x = 10;
+    extents.org.y = 10;
+    extents.size.x = 80;
+    extents.size.y = 80;
+    adg_fill_style_set_extents(fill_style, &extents);
+    adg_ruled_fill_set_spacing(ruled_fill, 10);
+    adg_ruled_fill_switch_vector_lines(ruled_fill, TRUE);
+
+    /* The path must be consumed also when stroking vector lines */
+    cairo_arc(cr, 50, 50, 40, 0, G_PI * 2);
+    adg_fill_style_fill(fill_style, entity, cr);
+    g_assert_false(cairo_has_current_point(cr));
+    g_assert_null(adg_fill_style_get_pattern(fill_style));
+
+    /* Without vector lines the region is filled with a pattern */
+    adg_ruled_fill_switch_vector_lines(ruled_fill, FALSE);
+    cairo_arc(cr, 50, 50, 40, 0, G_PI * 2);
+    adg_fill_style_fill(fill_style, entity, cr);
+    g_assert_false(cairo_has_current_point(cr));
+    g_assert_nonnull(adg_fill_style_get_pattern(fill_style));
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(entity);
+    g_object_unref(ruled_fill);
+}
+
+static gint
+_adg_painted_pixels(cairo_surface_t *surface,
+                    gint x1, gint y1, gint x2, gint y2)
+{
+    const guchar *data;
+    gint stride, x, y, n;
+
+    cairo_surface_flush(surface);
+    data = cairo_image_surface_get_data(surface);
+    stride = cairo_image_surface_get_stride(surface);
+    n = 0;
+
+    /* The alpha channel of ARGB32 is the most significant byte */
+    for (y = y1; y < y2; ++y)
+        for (x = x1; x < x2; ++x)
+            if ((((const guint32 *) (data + y * stride))[x] >> 24) != 0)
+                ++n;
+
+    return n;
+}
+
+static void
+_adg_behavior_vector_lines(void)
+{
+    AdgRuledFill *ruled_fill;
+    AdgFillStyle *fill_style;
+    AdgEntity *entity;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    CpmlExtents extents;
+
+    ruled_fill = adg_ruled_fill_new();
+    fill_style = (AdgFillStyle *) ruled_fill;
+    entity = (AdgEntity *) adg_logo_new();
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    extents.is_defined = 1;
+    extents.org.x = 10;
+    extents.org.y = 10;
+    extents.size.x = 80;
+    extents.size.y = 80;
+    adg_fill_style_set_extents(fill_style, &extents);
+    adg_ruled_fill_set_spacing(ruled_fill, 4);
+    adg_ruled_fill_switch_vector_lines(ruled_fill, TRUE);
+
+    /* A square ring: the hole must be left empty by the even-odd rule,
+     * so the edges of the inner square must be swept in and out */
+    cairo_rectangle(cr, 10, 10, 80, 80);
+    cairo_rectangle(cr, 30, 30, 40, 40);
+    adg_fill_style_fill(fill_style, entity, cr);
+
+    g_assert_cmpint(_adg_painted_pixels(surface, 12, 12, 28, 88), >, 0);
+    g_assert_cmpint(_adg_painted_pixels(surface, 72, 12, 88, 88), >, 0);
+    g_assert_cmpint(_adg_painted_pixels(surface, 33, 33, 67, 67), ==, 0);
+    g_assert_cmpint(_adg_painted_pixels(surface, 0, 0, 100, 7), ==, 0);
+    g_assert_cmpint(_adg_painted_pixels(surface, 0, 93, 100, 100), ==, 0);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(entity);
+    g_object_unref(ruled_fill);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -153,9 +300,14 @@ main(int argc, char *argv[])
 
     adg_test_add_object_checks("/adg/ruled-fill/type/object", ADG_TYPE_RULED_FILL);
 
+    g_test_add_func("/adg/ruled-fill/behavior/vector-lines", _adg_behavior_vector_lines);
+
     g_test_add_func("/adg/ruled-fill/property/angle", _adg_property_angle);
     g_test_add_func("/adg/ruled-fill/property/line-dress", _adg_property_line_dress);
     g_test_add_func("/adg/ruled-fill/property/spacing", _adg_property_spacing);
+    g_test_add_func("/adg/ruled-fill/property/vector-lines", _adg_property_vector_lines);
+
+    g_test_add_func("/adg/ruled-fill/method/fill", _adg_method_fill);
 
     return g_test_run();
 }
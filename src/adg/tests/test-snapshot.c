@@ -0,0 +1,397 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#include <adg-test.h>
+#include <adg.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+
+static gchar *
+_adg_tmp_file(void)
+{
+    gchar *file;
+    gint fd;
+
+    fd = g_file_open_tmp("adg-snapshot-XXXXXX.bin", &file, NULL);
+    g_assert_cmpint(fd, !=, -1);
+    g_close(fd, NULL);
+
+    return file;
+}
+
+static void
+_adg_method_save(void)
+{
+    AdgCanvas *canvas;
+    AdgTable *table;
+    gchar *file;
+    GError *error;
+
+    canvas = adg_test_canvas();
+    file = _adg_tmp_file();
+
+    error = NULL;
+    g_assert_true(adg_snapshot_save(ADG_ENTITY(canvas), file, &error));
+    g_assert_null(error);
+
+    /* Entities that cannot be serialized must be rejected */
+    table = adg_table_new();
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(table));
+    g_assert_false(adg_snapshot_save(ADG_ENTITY(canvas), file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_UNSUPPORTED);
+    g_error_free(error);
+
+    g_unlink(file);
+    g_free(file);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_load(void)
+{
+    AdgPath *path;
+    AdgStroke *stroke;
+    AdgHatch *hatch;
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    GSList *children;
+    AdgTrail *trail, *trail2;
+    const cairo_path_t *original, *loaded;
+    const CpmlPair *pair;
+    cairo_matrix_t map;
+    gchar *file, *content;
+    gsize length;
+    GError *error;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 4, 0);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "corner", 4, 0);
+    adg_path_line_to_explicit(path, 4, 4);
+    adg_path_close(path);
+
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    adg_stroke_set_line_dress(stroke, ADG_DRESS_LINE_HIDDEN);
+    hatch = adg_hatch_new(ADG_TRAIL(path));
+    g_object_unref(path);
+
+    cairo_matrix_init_translate(&map, 5, 6);
+    adg_entity_set_local_map(ADG_ENTITY(hatch), &map);
+
+    canvas = adg_canvas_new();
+    adg_canvas_set_size_explicit(canvas, 100, 200);
+    adg_canvas_set_margins(canvas, 1, 2, 3, 4);
+    adg_canvas_switch_frame(canvas, FALSE);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(hatch));
+
+    file = _adg_tmp_file();
+    g_assert_true(adg_snapshot_save(ADG_ENTITY(canvas), file, NULL));
+
+    entity = adg_snapshot_load(file, NULL);
+    g_assert_true(ADG_IS_CANVAS(entity));
+    g_assert_cmpfloat(adg_canvas_get_size(ADG_CANVAS(entity))->y, ==, 200);
+    g_assert_cmpfloat(adg_canvas_get_left_margin(ADG_CANVAS(entity)), ==, 4);
+    g_assert_false(adg_canvas_has_frame(ADG_CANVAS(entity)));
+
+    /* The children list is built by prepending */
+    children = adg_container_children(ADG_CONTAINER(entity));
+    g_assert_cmpint(g_slist_length(children), ==, 2);
+    g_assert_true(ADG_IS_HATCH(children->data));
+    g_assert_true(ADG_IS_STROKE(children->next->data));
+    g_assert_cmpint(adg_stroke_get_line_dress(children->next->data), ==, ADG_DRESS_LINE_HIDDEN);
+    g_assert_true(adg_matrix_equal(adg_entity_get_local_map(children->data), &map));
+
+    /* The model must be shared by both entities */
+    trail = adg_stroke_get_trail(children->data);
+    trail2 = adg_stroke_get_trail(children->next->data);
+    g_assert_true(trail == trail2);
+    g_assert_true(ADG_IS_PATH(trail));
+
+    original = adg_trail_get_cairo_path(ADG_TRAIL(path));
+    loaded = adg_trail_get_cairo_path(trail);
+    g_assert_cmpint(loaded->num_data, ==, original->num_data);
+    g_assert_cmpint(memcmp(loaded->data, original->data,
+                           sizeof(cairo_path_data_t) * original->num_data), ==, 0);
+
+    pair = adg_model_get_named_pair(ADG_MODEL(trail), "corner");
+    g_assert_nonnull(pair);
+    adg_assert_isapprox(pair->x, 4);
+    adg_assert_isapprox(pair->y, 0);
+
+    g_slist_free(children);
+    adg_entity_destroy(entity);
+
+    /* Truncated files must be detected */
+    g_assert_true(g_file_get_contents(file, &content, &length, NULL));
+    g_assert_true(g_file_set_contents(file, content, length - 8, NULL));
+    g_free(content);
+
+    error = NULL;
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID);
+    g_clear_error(&error);
+
+    g_assert_true(g_file_set_contents(file, "Not a snapshot", -1, NULL));
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID);
+    g_clear_error(&error);
+
+    g_unlink(file);
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_nonnull(error);
+    g_clear_error(&error);
+
+    g_free(file);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+
+static void
+_adg_behavior_arc(void)
+{
+    AdgPath *path;
+    AdgStroke *stroke;
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    GSList *children;
+    cairo_path_t *original, *loaded;
+    gchar *file;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_arc_to_explicit(path, 1, 1, 2, 0);
+    adg_path_line_to_explicit(path, 2, -1);
+
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+
+    canvas = adg_canvas_new();
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+
+    file = _adg_tmp_file();
+    g_assert_true(adg_snapshot_save(ADG_ENTITY(canvas), file, NULL));
+    entity = adg_snapshot_load(file, NULL);
+    g_assert_true(ADG_IS_CANVAS(entity));
+
+    children = adg_container_children(ADG_CONTAINER(entity));
+    g_assert_cmpint(g_slist_length(children), ==, 1);
+
+    /* Arcs must survive the round trip, not as Bézier curves */
+    original = adg_trail_cairo_path(ADG_TRAIL(path));
+    loaded = adg_trail_cairo_path(adg_stroke_get_trail(children->data));
+    g_assert_cmpint(loaded->num_data, ==, original->num_data);
+    g_assert_cmpint(loaded->data[2].header.type, ==, CPML_ARC);
+    g_assert_cmpint(memcmp(loaded->data, original->data,
+                           sizeof(cairo_path_data_t) * original->num_data), ==, 0);
+
+    g_slist_free(children);
+    adg_entity_destroy(entity);
+    g_unlink(file);
+    g_free(file);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_behavior_content(void)
+{
+    AdgPath *path;
+    AdgStroke *stroke;
+    AdgLDim *ldim;
+    AdgToyText *toy_text;
+    AdgLineStyle *line_style;
+    AdgDimStyle *dim_style;
+    AdgArrow *arrow;
+    AdgContainer *container;
+    AdgEntity *entity;
+    AdgMarker *marker;
+    AdgStyle *style;
+    AdgPoint *point;
+    GSList *children;
+    gchar *file, *text;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "start", 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_model_set_named_pair_explicit(ADG_MODEL(path), "end", 10, 0);
+
+    /* Style overrides must be saved with the entity */
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    line_style = adg_line_style_new();
+    adg_line_style_set_width(line_style, 7);
+    adg_entity_set_style(ADG_ENTITY(stroke), ADG_DRESS_LINE_STROKE,
+                         ADG_STYLE(line_style));
+    g_object_unref(line_style);
+
+    /* Dimension points must keep the binding to the model */
+    ldim = adg_ldim_new_full_from_model(ADG_MODEL(path), "start", "end",
+                                        "end", -G_PI_2);
+    adg_dim_set_value(ADG_DIM(ldim), "<>H7");
+    dim_style = adg_dim_style_new();
+    arrow = adg_arrow_new();
+    adg_arrow_set_angle(arrow, 0.5);
+    adg_dim_style_set_marker1(dim_style, ADG_MARKER(arrow));
+    adg_entity_destroy(ADG_ENTITY(arrow));
+    adg_entity_set_style(ADG_ENTITY(ldim), ADG_DRESS_DIMENSION,
+                         ADG_STYLE(dim_style));
+    g_object_unref(dim_style);
+    g_object_unref(path);
+
+    toy_text = adg_toy_text_new("Snapshot");
+
+    container = adg_container_new();
+    adg_container_add(container, ADG_ENTITY(stroke));
+    adg_container_add(container, ADG_ENTITY(ldim));
+    adg_container_add(container, ADG_ENTITY(toy_text));
+
+    file = _adg_tmp_file();
+    g_assert_true(adg_snapshot_save(ADG_ENTITY(container), file, NULL));
+    adg_entity_destroy(ADG_ENTITY(container));
+
+    entity = adg_snapshot_load(file, NULL);
+    g_assert_true(ADG_IS_CONTAINER(entity));
+
+    children = adg_container_children(ADG_CONTAINER(entity));
+    g_assert_cmpint(g_slist_length(children), ==, 3);
+
+    g_assert_true(ADG_IS_TOY_TEXT(children->data));
+    text = adg_textual_dup_text(children->data);
+    g_assert_cmpstr(text, ==, "Snapshot");
+    g_free(text);
+
+    g_assert_true(ADG_IS_LDIM(children->next->data));
+    ldim = children->next->data;
+    adg_assert_isapprox(adg_ldim_get_direction(ldim), -G_PI_2);
+    g_assert_cmpstr(adg_dim_get_value(ADG_DIM(ldim)), ==, "<>H7");
+    point = adg_dim_get_ref2(ADG_DIM(ldim));
+    g_assert_true(ADG_IS_PATH(adg_point_get_model(point)));
+    g_assert_cmpstr(adg_point_get_name(point), ==, "end");
+
+    style = adg_entity_get_style(ADG_ENTITY(ldim), ADG_DRESS_DIMENSION);
+    g_assert_true(ADG_IS_DIM_STYLE(style));
+    marker = adg_dim_style_marker1_new(ADG_DIM_STYLE(style));
+    g_assert_true(ADG_IS_ARROW(marker));
+    adg_assert_isapprox(adg_arrow_get_angle(ADG_ARROW(marker)), 0.5);
+    adg_entity_destroy(ADG_ENTITY(marker));
+
+    /* Both the stroke and the dimension must refer to the same model */
+    g_assert_true(ADG_IS_STROKE(children->next->next->data));
+    stroke = children->next->next->data;
+    g_assert_true(adg_point_get_model(point) ==
+                  ADG_MODEL(adg_stroke_get_trail(stroke)));
+    style = adg_entity_get_style(ADG_ENTITY(stroke), ADG_DRESS_LINE_STROKE);
+    g_assert_true(ADG_IS_LINE_STYLE(style));
+    adg_assert_isapprox(adg_line_style_get_width(ADG_LINE_STYLE(style)), 7);
+
+    g_slist_free(children);
+    adg_entity_destroy(entity);
+    g_unlink(file);
+    g_free(file);
+}
+
+static void
+_adg_behavior_corrupted(void)
+{
+    AdgPath *path;
+    AdgStroke *stroke;
+    AdgContainer *container, *parent;
+    gchar *file, *content;
+    gsize length;
+    cairo_path_data_t *data;
+    GError *error;
+    gint n;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+
+    file = _adg_tmp_file();
+    g_assert_true(adg_snapshot_save(ADG_ENTITY(stroke), file, NULL));
+    adg_entity_destroy(ADG_ENTITY(stroke));
+    g_assert_true(g_file_get_contents(file, &content, &length, NULL));
+
+    /* The path data of the first model follows the 24 bytes of the
+     * file header and the 8 bytes of the model header */
+    data = (cairo_path_data_t *) (content + 32);
+    error = NULL;
+
+    data[0].header.length = 0;
+    g_assert_true(g_file_set_contents(file, content, length, NULL));
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID);
+    g_clear_error(&error);
+
+    data[0].header.length = 1000;
+    g_assert_true(g_file_set_contents(file, content, length, NULL));
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID);
+    g_clear_error(&error);
+
+    data[0].header.length = 2;
+    data[0].header.type = 42;
+    g_assert_true(g_file_set_contents(file, content, length, NULL));
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID);
+    g_clear_error(&error);
+
+    /* A curve needs 3 points */
+    data[0].header.type = CPML_CURVE;
+    g_assert_true(g_file_set_contents(file, content, length, NULL));
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID);
+    g_clear_error(&error);
+    g_free(content);
+
+    /* Excessive nesting must be rejected while loading */
+    container = adg_container_new();
+    parent = container;
+    for (n = 0; n < 100; ++n) {
+        AdgContainer *child = adg_container_new();
+        adg_container_add(parent, ADG_ENTITY(child));
+        parent = child;
+    }
+    g_assert_true(adg_snapshot_save(ADG_ENTITY(container), file, NULL));
+    adg_entity_destroy(ADG_ENTITY(container));
+    g_assert_null(adg_snapshot_load(file, &error));
+    g_assert_error(error, ADG_SNAPSHOT_ERROR, ADG_SNAPSHOT_ERROR_INVALID);
+    g_clear_error(&error);
+
+    g_unlink(file);
+    g_free(file);
+}
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/adg/snapshot/method/save", _adg_method_save);
+    g_test_add_func("/adg/snapshot/method/load", _adg_method_load);
+    g_test_add_func("/adg/snapshot/behavior/arc", _adg_behavior_arc);
+    g_test_add_func("/adg/snapshot/behavior/content", _adg_behavior_content);
+    g_test_add_func("/adg/snapshot/behavior/corrupted", _adg_behavior_corrupted);
+
+    return g_test_run();
+}
@@ -0,0 +1,135 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+#include <string.h>
+
+
+static guint
+_adg_count(const gchar *content, const gchar *needle)
+{
+    const gchar *p;
+    guint n;
+
+    n = 0;
+    for (p = strstr(content, needle); p != NULL; p = strstr(p + 1, needle))
+        ++n;
+
+    return n;
+}
+
+static void
+_adg_method_write(void)
+{
+    AdgContainer *container;
+    AdgPath *path, *shared;
+    AdgStroke *stroke;
+    AdgHatch *hatch;
+    AdgLDim *ldim;
+    cairo_matrix_t map;
+    GOutputStream *stream;
+    GMarkupParser parser = { NULL };
+    GMarkupParseContext *context;
+    const gchar *content;
+    GError *error;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_arc_to_explicit(path, 15, 5, 10, 10);
+    adg_path_close(path);
+
+    shared = adg_path_new();
+    adg_path_move_to_explicit(shared, 0, 0);
+    adg_path_line_to_explicit(shared, 1, 1);
+
+    container = adg_container_new();
+
+    stroke = adg_stroke_new(ADG_TRAIL(shared));
+    adg_container_add(container, ADG_ENTITY(stroke));
+    stroke = adg_stroke_new(ADG_TRAIL(shared));
+    cairo_matrix_init_translate(&map, 20, 0);
+    adg_entity_set_local_map(ADG_ENTITY(stroke), &map);
+    adg_container_add(container, ADG_ENTITY(stroke));
+
+    hatch = adg_hatch_new(ADG_TRAIL(path));
+    adg_container_add(container, ADG_ENTITY(hatch));
+
+    ldim = adg_ldim_new_full_explicit(0, 0, 10, 0, 5, -5, ADG_DIR_UP);
+    adg_container_add(container, ADG_ENTITY(ldim));
+
+    g_object_unref(path);
+    g_object_unref(shared);
+
+    stream = g_memory_output_stream_new_resizable();
+    error = NULL;
+    g_assert_true(adg_svg_write(ADG_ENTITY(container), stream, NULL, &error));
+    g_assert_null(error);
+    g_assert_true(g_output_stream_write_all(stream, "", 1, NULL, NULL, NULL));
+    content = g_memory_output_stream_get_data((GMemoryOutputStream *) stream);
+
+    /* The output must be well formed */
+    context = g_markup_parse_context_new(&parser, 0, NULL, NULL);
+    g_assert_true(g_markup_parse_context_parse(context, content, -1, NULL));
+    g_assert_true(g_markup_parse_context_end_parse(context, NULL));
+    g_markup_parse_context_free(context);
+
+    g_assert_true(g_str_has_prefix(content, "<?xml"));
+    g_assert_true(g_str_has_suffix(content, "</svg>\n"));
+
+    /* The shared trail must be defined once and used twice */
+    g_assert_cmpuint(_adg_count(content, "<symbol id=\"adg-symbol-1\""), ==, 1);
+    g_assert_cmpuint(_adg_count(content, "xlink:href=\"#adg-symbol-1\""), ==, 2);
+
+    /* Every dress must be defined once as a CSS class */
+    g_assert_cmpuint(_adg_count(content, ".line-stroke {"), ==, 1);
+    g_assert_cmpuint(_adg_count(content, "class=\"line-stroke\""), ==, 2);
+    g_assert_cmpuint(_adg_count(content, ".fill-hatch {"), ==, 1);
+    g_assert_cmpuint(_adg_count(content, "url(#adg-pattern-"), ==, 1);
+    g_assert_cmpuint(_adg_count(content, ".line-fill {"), ==, 1);
+    g_assert_cmpuint(_adg_count(content, ".dimension {"), ==, 1);
+    g_assert_cmpuint(_adg_count(content, ".line-dimension {"), ==, 1);
+    g_assert_cmpuint(_adg_count(content, "stroke=\""), ==, 0);
+
+    g_object_unref(stream);
+
+    /* Stream errors must be reported */
+    stream = g_memory_output_stream_new_resizable();
+    g_assert_true(g_output_stream_close(stream, NULL, NULL));
+    g_assert_false(adg_svg_write(ADG_ENTITY(container), stream, NULL, &error));
+    g_assert_nonnull(error);
+    g_assert_true(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CLOSED));
+    g_clear_error(&error);
+    g_object_unref(stream);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/adg/svg/method/write", _adg_method_write);
+
+    return g_test_run();
+}
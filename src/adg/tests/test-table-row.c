@@ -137,6 +137,72 @@ _adg_property_height(void)
     adg_entity_destroy(ADG_ENTITY(table));
 }
 
+static void
+_adg_prepend_row(AdgTableRow *row, GSList **rows)
+{
+    *rows = g_slist_prepend(*rows, row);
+}
+
+static void
+_adg_method_invalidate(void)
+{
+    AdgTable *table;
+    AdgTableRow *row, *row2;
+    AdgTableCell *cell;
+    const CpmlPair *size;
+    CpmlExtents layout;
+    GSList *rows;
+
+    /* Sanity check */
+    adg_table_row_invalidate(NULL);
+
+    table = adg_table_new();
+    row = adg_table_row_new(table);
+    adg_table_row_set_height(row, 12);
+    cell = adg_table_cell_new_with_width(row, 34);
+
+    size = adg_table_row_size_request(row);
+    adg_assert_isapprox(size->x, 34);
+    adg_assert_isapprox(size->y, 12);
+
+    layout.is_defined = 1;
+    layout.org.x = 0;
+    layout.org.y = 0;
+    layout.size.x = 100;
+    layout.size.y = -1;
+    adg_table_row_arrange(row, &layout);
+
+    /* Editing a cell must invalidate the cached size */
+    adg_table_cell_set_width(cell, 56);
+    size = adg_table_row_size_request(row);
+    adg_assert_isapprox(size->x, 56);
+    adg_assert_isapprox(size->y, 12);
+    adg_table_row_arrange(row, &layout);
+
+    adg_table_row_set_height(row, 78);
+    size = adg_table_row_size_request(row);
+    adg_assert_isapprox(size->x, 56);
+    adg_assert_isapprox(size->y, 78);
+
+    /* Check the rows order is preserved on insertion and removal */
+    row2 = adg_table_row_new_before(row);
+    rows = NULL;
+    adg_table_foreach(table, G_CALLBACK(_adg_prepend_row), &rows);
+    g_assert_cmpint(g_slist_length(rows), ==, 2);
+    g_assert_true(rows->data == row);
+    g_assert_true(rows->next->data == row2);
+    g_slist_free(rows);
+
+    adg_table_row_free(row2);
+    rows = NULL;
+    adg_table_foreach(table, G_CALLBACK(_adg_prepend_row), &rows);
+    g_assert_cmpint(g_slist_length(rows), ==, 1);
+    g_assert_true(rows->data == row);
+    g_slist_free(rows);
+
+    adg_entity_destroy(ADG_ENTITY(table));
+}
+
 
 int
 main(int argc, char *argv[])
@@ -156,6 +222,8 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/table-row/property/height", _adg_property_height);
 
+    g_test_add_func("/adg/table-row/method/invalidate", _adg_method_invalidate);
+
     result = g_test_run();
     adg_entity_destroy(ADG_ENTITY(table));
 
@@ -118,6 +118,56 @@ _adg_property_has_frame(void)
     adg_entity_destroy(ADG_ENTITY(table));
 }
 
+static void
+_adg_behavior_layout(void)
+{
+    AdgTable *table;
+    AdgEntity *entity;
+    AdgTableRow *row1, *row2;
+    AdgTableCell *cell;
+    CpmlExtents extents;
+    const CpmlExtents *row_extents;
+
+    table = adg_table_new();
+    entity = (AdgEntity *) table;
+    row1 = adg_table_row_new(table);
+    adg_table_row_set_height(row1, 10);
+    cell = adg_table_cell_new_with_width(row1, 30);
+    row2 = adg_table_row_new(table);
+    adg_table_row_set_height(row2, 20);
+    adg_table_cell_new_with_width(row2, 50);
+
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(extents.is_defined);
+
+    /* The rows are laid out from top to bottom */
+    row_extents = adg_table_row_get_extents(row1);
+    adg_assert_isapprox(row_extents->size.y, 10);
+    g_assert_cmpfloat(row_extents->org.y, <, adg_table_row_get_extents(row2)->org.y);
+
+    /* Arranging again must reuse the cached layout */
+    adg_entity_arrange(entity);
+    g_assert_true(cpml_extents_equal(adg_entity_get_extents(entity), &extents));
+
+    /* Editing a cell must invalidate the cached size */
+    adg_table_cell_set_width(cell, 80);
+    g_assert_false(adg_entity_get_extents(entity)->is_defined);
+    adg_entity_arrange(entity);
+    adg_assert_isapprox(adg_entity_get_extents(entity)->size.x,
+                        extents.size.x + 30);
+    adg_assert_isapprox(adg_entity_get_extents(entity)->size.y,
+                        extents.size.y);
+
+    /* Removing a row must shrink the table */
+    adg_table_row_free(row2);
+    adg_entity_arrange(entity);
+    adg_assert_isapprox(adg_entity_get_extents(entity)->size.y,
+                        extents.size.y - 20);
+
+    adg_entity_destroy(entity);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -131,5 +181,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/table/property/table-dress", _adg_property_table_dress);
     g_test_add_func("/adg/table/property/has-frame", _adg_property_has_frame);
 
+    g_test_add_func("/adg/table/behavior/layout", _adg_behavior_layout);
+
     return g_test_run();
 }
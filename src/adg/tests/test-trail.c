@@ -75,6 +75,78 @@ _adg_property_max_angle(void)
     g_object_unref(trail);
 }
 
+static void
+_adg_destroy_notify(gpointer user_data)
+{
+    ++*(gint *) user_data;
+}
+
+static void
+_adg_method_new_from_data(void)
+{
+    cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 4 }}
+    };
+    cairo_path_data_t arc_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 1, 0 }},
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 0, 1 }},
+        { .point = { -1, 0 }}
+    };
+    AdgTrail *trail;
+    const cairo_path_t *cairo_path;
+    const CpmlExtents *extents;
+    CpmlPair pair, dest;
+    gint n_destroyed;
+
+    n_destroyed = 0;
+    trail = adg_trail_new_from_data(data, G_N_ELEMENTS(data),
+                                    _adg_destroy_notify, &n_destroyed);
+    g_assert_nonnull(trail);
+
+    /* Without arcs, the external data must be used in place */
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    g_assert_true(cairo_path->data == data);
+    g_assert_cmpint(cairo_path->num_data, ==, G_N_ELEMENTS(data));
+    g_assert_true(adg_trail_cairo_path(trail)->data == data);
+    g_assert_cmpuint(adg_trail_n_segments(trail), ==, 1);
+
+    extents = adg_trail_get_extents(trail);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.x, 2);
+    adg_assert_isapprox(extents->size.y, 4);
+
+    pair.x = 2.1;
+    pair.y = 3.9;
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_ENDPOINT, &pair, 1, &dest), ==, ADG_SNAP_ENDPOINT);
+    adg_assert_isapprox(dest.x, 2);
+    adg_assert_isapprox(dest.y, 4);
+
+    g_object_unref(trail);
+    g_assert_cmpint(n_destroyed, ==, 1);
+
+    /* Arcs must still be converted to Bézier curves */
+    trail = adg_trail_new_from_data(arc_data, G_N_ELEMENTS(arc_data), NULL, NULL);
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    g_assert_true(cairo_path->data != arc_data);
+    g_assert_cmpint(cairo_path->data[2].header.type, ==, CPML_CURVE);
+    g_assert_true(adg_trail_cairo_path(trail)->data == arc_data);
+    g_object_unref(trail);
+
+    /* An empty buffer is valid */
+    trail = adg_trail_new_from_data(NULL, 0, NULL, NULL);
+    g_assert_null(adg_trail_get_cairo_path(trail));
+    g_object_unref(trail);
+}
+
 static void
 _adg_method_n_segments(void)
 {
@@ -162,6 +234,92 @@ _adg_method_put_segment(void)
     g_object_unref(path);
 }
 
+static void
+_adg_method_snap(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    CpmlPair pair, dest;
+    gint n;
+
+    path = adg_path_new();
+    trail = ADG_TRAIL(path);
+    pair.x = 50;
+    pair.y = 23;
+
+    /* Sanity checks */
+    g_assert_cmpint(adg_trail_snap(NULL, ADG_SNAP_NEAREST, &pair, 5, &dest), ==, ADG_SNAP_NONE);
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NEAREST, NULL, 5, &dest), ==, ADG_SNAP_NONE);
+
+    /* Check empty path */
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NEAREST, &pair, 5, &dest), ==, ADG_SNAP_NONE);
+    adg_model_clear(ADG_MODEL(path));
+
+    /* Enough horizontal lines to split the index in more levels */
+    for (n = 0; n < 20; ++n) {
+        adg_path_move_to_explicit(path, 0, n * 10);
+        adg_path_line_to_explicit(path, 100, n * 10);
+    }
+
+    /* An arc with center in (210, 0) and radius 10 */
+    adg_path_move_to_explicit(path, 200, 0);
+    adg_path_arc_to_explicit(path, 210, 10, 220, 0);
+
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NONE, &pair, 5, &dest), ==, ADG_SNAP_NONE);
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NEAREST, &pair, 5, NULL), ==, ADG_SNAP_NEAREST);
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NEAREST, &pair, 5, &dest), ==, ADG_SNAP_NEAREST);
+    adg_assert_isapprox(dest.x, 50);
+    adg_assert_isapprox(dest.y, 20);
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NEAREST, &pair, 1, &dest), ==, ADG_SNAP_NONE);
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_ENDPOINT, &pair, 5, &dest), ==, ADG_SNAP_NONE);
+
+    /* Special points have precedence over the nearest point */
+    pair.x = 1;
+    pair.y = 21;
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_ENDPOINT | ADG_SNAP_NEAREST, &pair, 5, &dest), ==, ADG_SNAP_ENDPOINT);
+    adg_assert_isapprox(dest.x, 0);
+    adg_assert_isapprox(dest.y, 20);
+
+    pair.x = 48;
+    pair.y = 31;
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_MIDPOINT | ADG_SNAP_NEAREST, &pair, 5, &dest), ==, ADG_SNAP_MIDPOINT);
+    adg_assert_isapprox(dest.x, 50);
+    adg_assert_isapprox(dest.y, 30);
+
+    /* Arcs */
+    pair.x = 211;
+    pair.y = 1;
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_ENDPOINT | ADG_SNAP_MIDPOINT | ADG_SNAP_CENTER, &pair, 3, &dest), ==, ADG_SNAP_CENTER);
+    adg_assert_isapprox(dest.x, 210);
+    adg_assert_isapprox(dest.y, 0);
+
+    pair.x = 210;
+    pair.y = 12;
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NEAREST, &pair, 5, &dest), ==, ADG_SNAP_NEAREST);
+    adg_assert_isapprox(dest.x, 210);
+    adg_assert_isapprox(dest.y, 10);
+
+    /* Check the index is rebuilt after a change */
+    adg_model_clear(ADG_MODEL(path));
+    adg_path_move_to_explicit(path, 200, 20);
+    adg_path_line_to_explicit(path, 220, 20);
+    pair.y = 18;
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_NEAREST, &pair, 5, &dest), ==, ADG_SNAP_NEAREST);
+    adg_assert_isapprox(dest.x, 210);
+    adg_assert_isapprox(dest.y, 20);
+
+    /* The closing line must end on the start of its segment */
+    adg_path_line_to_explicit(path, 220, 40);
+    adg_path_close(path);
+    pair.x = 209;
+    pair.y = 31;
+    g_assert_cmpint(adg_trail_snap(trail, ADG_SNAP_MIDPOINT, &pair, 3, &dest), ==, ADG_SNAP_MIDPOINT);
+    adg_assert_isapprox(dest.x, 210);
+    adg_assert_isapprox(dest.y, 30);
+
+    g_object_unref(path);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -173,8 +331,10 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/trail/property/max-angle", _adg_property_max_angle);
 
+    g_test_add_func("/adg/trail/method/new-from-data", _adg_method_new_from_data);
     g_test_add_func("/adg/trail/method/n-segments", _adg_method_n_segments);
     g_test_add_func("/adg/trail/method/put-segment", _adg_method_put_segment);
+    g_test_add_func("/adg/trail/method/snap", _adg_method_snap);
 
     return g_test_run();
 }
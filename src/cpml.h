@@ -28,6 +28,7 @@
 #include "cpml/cpml-primitive.h"
 #include "cpml/cpml-arc.h"
 #include "cpml/cpml-curve.h"
+#include "cpml/cpml-scratch.h"
 
 #include <glib-object.h>
 #include "cpml/cpml-gobject.h"
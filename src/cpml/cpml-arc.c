@@ -40,6 +40,13 @@
  * point the primitive is considered a circle with diameter defined by
  * the segment between the first and the intermediate point.
  *
+ * cpml_primitive_offset() on an arc always grows its radius by the
+ * offset distance, whatever the direction of the arc. Offsetting
+ * a whole segment with cpml_segment_offset() or
+ * cpml_segment_put_offsets() instead moves every point toward the
+ * normal of its tangent, so there the radius of an arc rendered
+ * with increasing angles shrinks.
+ *
  * <important>
  * <para>
  * An arc is not a native cairo primitive and should be treated specially.
@@ -60,16 +67,6 @@
  * approach as it allows to specify the number of curves to use and do
  * not need a cairo context.
  *
- * <important>
- * <title>TODO</title>
- * <itemizedlist>
- * <listitem>the <function>get_closest_pos</function> method must be
- *    implemented;</listitem>
- * <listitem>the <function>put_intersections</function> method must
- *    implement arc-arc intersections.</listitem>
- * </itemizedlist>
- * </important>
- *
  * Since: 1.0
  **/
 
@@ -102,6 +99,8 @@ static void     put_pair_at             (const CpmlPrimitive    *arc,
 static void     put_vector_at           (const CpmlPrimitive    *arc,
                                          double                  pos,
                                          CpmlVector             *vector);
+static double   get_closest_pos         (const CpmlPrimitive    *arc,
+                                         const CpmlPair         *pair);
 static size_t   put_intersections       (const CpmlPrimitive    *line,
                                          const CpmlPrimitive    *primitive,
                                          size_t                  n_dest,
@@ -124,6 +123,12 @@ static int      circle_line             (const CpmlPair         *center,
                                          const CpmlPair         *p1,
                                          const CpmlPair         *p2,
                                          CpmlPair               *dest);
+static size_t   circle_circle           (const CpmlPair         *center,
+                                         double                  r,
+                                         const CpmlPair         *center2,
+                                         double                  r2,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
 
 
 const _CpmlPrimitiveClass *
@@ -138,7 +143,7 @@ _cpml_arc_get_class(void)
             put_extents,
             put_pair_at,
             put_vector_at,
-            NULL,
+            get_closest_pos,
             put_intersections,
             offset,
             NULL
@@ -406,6 +411,38 @@ put_vector_at(const CpmlPrimitive *arc, double pos, CpmlVector *vector)
     }
 }
 
+static double
+get_closest_pos(const CpmlPrimitive *arc, const CpmlPair *pair)
+{
+    CpmlPair center, p;
+    CpmlVector vector;
+    double start, end, delta, angle, distance;
+
+    if (!cpml_arc_info(arc, &center, NULL, &start, &end) || start == end)
+        return 0;
+
+    vector.x = pair->x - center.x;
+    vector.y = pair->y - center.y;
+    delta = end - start;
+    angle = fmod(cpml_vector_angle(&vector) - start, M_PI*2);
+
+    /* Bring the angle, relative to start, on the same side of delta */
+    if (delta > 0 && angle < 0)
+        angle += M_PI*2;
+    else if (delta < 0 && angle > 0)
+        angle -= M_PI*2;
+
+    if (angle / delta <= 1)
+        return angle / delta;
+
+    /* The projection is outside the arc: return the nearest end point */
+    cpml_pair_from_cairo(&p, arc->org);
+    distance = cpml_pair_squared_distance(&p, pair);
+    cpml_pair_from_cairo(&p, &arc->data[2]);
+
+    return distance <= cpml_pair_squared_distance(&p, pair) ? 0 : 1;
+}
+
 static size_t
 put_intersections(const CpmlPrimitive *arc, const CpmlPrimitive *primitive,
                   size_t n_dest, CpmlPair *dest)
@@ -424,9 +461,13 @@ put_intersections(const CpmlPrimitive *arc, const CpmlPrimitive *primitive,
         return circle_line(&center, r, &p1, &p2, dest);
     }
 
-    case CPML_ARC:
-        /* TODO: Not Yet Implemented */
-        return 0;
+    case CPML_ARC: {
+        CpmlPair center2;
+        double r2;
+        if (!cpml_arc_info(primitive, &center2, &r2, NULL, NULL))
+            return 0;
+        return circle_circle(&center, r, &center2, r2, n_dest, dest);
+    }
     }
 
     return 0;
@@ -615,3 +656,44 @@ circle_line(const CpmlPair *center, double r,
     dest->y = (b*c - a*d) / e + center->y;
     return 2;
 }
+
+static size_t
+circle_circle(const CpmlPair *center, double r,
+              const CpmlPair *center2, double r2,
+              size_t n_dest, CpmlPair *dest)
+{
+    CpmlVector vector;
+    CpmlPair middle;
+    double d, a, h;
+
+    vector.x = center2->x - center->x;
+    vector.y = center2->y - center->y;
+    d = cpml_pair_distance(NULL, &vector);
+
+    /* Concentric, too far or one inside the other */
+    if (d == 0 || d > r + r2 || d < fabs(r - r2))
+        return 0;
+
+    /* a is the distance from center of the chord joining the two
+     * intersections, h is half the length of that chord */
+    a = (r*r - r2*r2 + d*d) / (2*d);
+    h = r*r - a*a;
+    h = h > 0 ? sqrt(h) : 0;
+
+    vector.x /= d;
+    vector.y /= d;
+    middle.x = center->x + a * vector.x;
+    middle.y = center->y + a * vector.y;
+
+    dest->x = middle.x - h * vector.y;
+    dest->y = middle.y + h * vector.x;
+    if (h == 0 || n_dest < 2) {
+        /* Only one solution found (tangent circles) or requested */
+        return 1;
+    }
+
+    ++ dest;
+    dest->x = middle.x + h * vector.y;
+    dest->y = middle.y - h * vector.x;
+    return 2;
+}
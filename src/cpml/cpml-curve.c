@@ -43,7 +43,8 @@
  * <listitem>the <function>put_vector_at</function> method must be
  *           implemented;</listitem>
  * <listitem>the <function>get_closest_pos</function> method must be
- *           implemented;</listitem>
+ *           implemented: meanwhile cpml_curve_get_closest_time() can
+ *           be used;</listitem>
  * <listitem>the <function>put_intersections</function> method must be
  *           implemented;</listitem>
  * </itemizedlist>
@@ -91,12 +92,19 @@
 #include "cpml-primitive.h"
 #include "cpml-primitive-private.h"
 #include "cpml-curve.h"
+#include <math.h>
 
 #define DEFAULT_ALGORITHM   offset_handcraft
 
+/* Number of samples used to bracket the closest point on a curve */
+#define CLOSEST_SAMPLES     16
+
 
 static void     put_extents             (const CpmlPrimitive    *curve,
                                          CpmlExtents            *extents);
+static double   distance_at_time        (const CpmlPrimitive    *curve,
+                                         double                  t,
+                                         const CpmlPair         *pair);
 static void     offset_geometrical      (CpmlPrimitive          *curve,
                                          double                  offset);
 static void     offset_handcraft        (CpmlPrimitive          *curve,
@@ -293,6 +301,131 @@ cpml_curve_put_offset_at_time(const CpmlPrimitive *curve,
     pair->y += vector.y;
 }
 
+/**
+ * cpml_curve_get_closest_time:
+ * @curve: the #CpmlPrimitive curve data
+ * @pair:  the coordinates of the subject point
+ *
+ * Given the @curve Bézier cubic, finds the "time" value (where 0 is
+ * the start and 1 is the end) of the point nearest to @pair. The
+ * result can be fed to cpml_curve_put_pair_at_time(): keep in mind
+ * it is not a pos value, as the time is not homogeneous.
+ *
+ * The curve is sampled to bracket the global minimum, that is then
+ * refined with a ternary search.
+ *
+ * Returns: the requested time value between 0 and 1.
+ *
+ * Since: 1.0
+ **/
+double
+cpml_curve_get_closest_time(const CpmlPrimitive *curve, const CpmlPair *pair)
+{
+    double t, best_t, d, best_d, lo, hi, t1, t2;
+    int n;
+
+    /* Sample the curve to bracket the global minimum... */
+    best_t = 0;
+    best_d = distance_at_time(curve, 0, pair);
+    for (n = 1; n <= CLOSEST_SAMPLES; ++n) {
+        t = (double) n / CLOSEST_SAMPLES;
+        d = distance_at_time(curve, t, pair);
+        if (d < best_d) {
+            best_d = d;
+            best_t = t;
+        }
+    }
+
+    /* ...and refine it with a ternary search around the best sample */
+    lo = best_t - 1. / CLOSEST_SAMPLES;
+    hi = best_t + 1. / CLOSEST_SAMPLES;
+    if (lo < 0)
+        lo = 0;
+    if (hi > 1)
+        hi = 1;
+
+    while (hi - lo > 1e-9) {
+        t1 = lo + (hi - lo) / 3;
+        t2 = hi - (hi - lo) / 3;
+        if (distance_at_time(curve, t1, pair) < distance_at_time(curve, t2, pair))
+            hi = t2;
+        else
+            lo = t1;
+    }
+
+    return (lo + hi) / 2;
+}
+
+/**
+ * cpml_curve_to_arc:
+ * @curve:     the #CpmlPrimitive curve data
+ * @tolerance: the maximum distance allowed between @curve and the arc
+ *
+ * Checks if @curve can be approximated by a circular arc, that is if
+ * any point of @curve is not farther than @tolerance from the arc
+ * passing through the start point, the middle point (at time 0.5)
+ * and the end point of @curve. If this is the case, @curve is
+ * rewritten in place as a %CPML_ARC primitive.
+ *
+ * An arc requires one point less than a curve: the primitive length
+ * is retained and the last point is left as embedded data (a copy of
+ * the end point), so the data following @curve does not need to be
+ * moved.
+ *
+ * Curves with coincident start and end points are never converted,
+ * as they would be interpreted as full circles.
+ *
+ * Returns: (type gboolean): 1 if @curve has been converted, 0 otherwise.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_curve_to_arc(CpmlPrimitive *curve, double tolerance)
+{
+    CpmlPair p[3], center, pair;
+    cairo_path_data_t *data;
+    double d, r, t;
+    int n;
+
+    cpml_primitive_put_point(curve, 0, &p[0]);
+    cpml_curve_put_pair_at_time(curve, 0.5, &p[1]);
+    cpml_primitive_put_point(curve, -1, &p[2]);
+
+    if (cpml_pair_equal(&p[0], &p[2]))
+        return 0;
+
+    /* Get the center of the circle passing through the 3 points */
+    d = 2 * (p[0].x * (p[1].y - p[2].y) +
+             p[1].x * (p[2].y - p[0].y) +
+             p[2].x * (p[0].y - p[1].y));
+    if (d == 0)
+        return 0;
+
+    center.x = ((p[0].x * p[0].x + p[0].y * p[0].y) * (p[1].y - p[2].y) +
+                (p[1].x * p[1].x + p[1].y * p[1].y) * (p[2].y - p[0].y) +
+                (p[2].x * p[2].x + p[2].y * p[2].y) * (p[0].y - p[1].y)) / d;
+    center.y = ((p[0].x * p[0].x + p[0].y * p[0].y) * (p[2].x - p[1].x) +
+                (p[1].x * p[1].x + p[1].y * p[1].y) * (p[0].x - p[2].x) +
+                (p[2].x * p[2].x + p[2].y * p[2].y) * (p[1].x - p[0].x)) / d;
+    r = cpml_pair_distance(&center, &p[0]);
+
+    /* Check the distance of some sample points from the arc */
+    for (n = 1; n < 16; ++n) {
+        t = (double) n / 16;
+        cpml_curve_put_pair_at_time(curve, t, &pair);
+        if (fabs(cpml_pair_distance(&center, &pair) - r) > tolerance)
+            return 0;
+    }
+
+    data = curve->data;
+    data[0].header.type = CPML_ARC;
+    cpml_pair_to_cairo(&p[1], &data[1]);
+    cpml_pair_to_cairo(&p[2], &data[2]);
+    cpml_pair_to_cairo(&p[2], &data[3]);
+
+    return 1;
+}
+
 static void
 put_extents(const CpmlPrimitive *curve, CpmlExtents *extents)
 {
@@ -311,6 +444,14 @@ put_extents(const CpmlPrimitive *curve, CpmlExtents *extents)
     cpml_extents_pair_add(extents, &p4);
 }
 
+static double
+distance_at_time(const CpmlPrimitive *curve, double t, const CpmlPair *pair)
+{
+    CpmlPair p;
+    cpml_curve_put_pair_at_time(curve, t, &p);
+    return cpml_pair_squared_distance(&p, pair);
+}
+
 static int
 geometrical(CpmlPrimitive *curve, double offset, const CpmlVector *v)
 {
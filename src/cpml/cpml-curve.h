@@ -48,6 +48,10 @@ void    cpml_curve_put_offset_at_time   (const CpmlPrimitive     *curve,
                                          double                   t,
                                          double                   offset,
                                          CpmlPair                *pair);
+double  cpml_curve_get_closest_time     (const CpmlPrimitive     *curve,
+                                         const CpmlPair          *pair);
+int     cpml_curve_to_arc               (CpmlPrimitive           *curve,
+                                         double                   tolerance);
 
 CAIRO_END_DECLS
 
@@ -0,0 +1,377 @@
+/* CPML - Cairo Path Manipulation Library
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:cpml-scratch
+ * @Section_Id:scratch
+ * @title: Scratch memory
+ * @short_description: Bump allocator for temporary data
+ *
+ * Many operations need a temporary buffer (e.g. a copy of the
+ * primitives to offset or of the segment to reverse) that is released
+ * before returning. Using malloc() and free() for these buffers puts
+ * a lot of pressure on the system allocator when the operations are
+ * repeated thousands of times, as it happens while arranging a drawing.
+ *
+ * The scratch memory is a bump allocator: cpml_scratch_alloc() simply
+ * moves a pointer forward inside a preallocated block, and a new block
+ * is allocated only when the current one is exhausted. The memory is
+ * reclaimed in two ways:
+ * <itemizedlist>
+ * <listitem>cpml_scratch_free() rewinds the pointer past the released
+ *           chunks on the top, so temporaries freed in reverse order of
+ *           allocation (as it naturally happens with nested calls) do
+ *           not accumulate;</listitem>
+ * <listitem>cpml_scratch_reset() rewinds the whole scratch memory once
+ *           no chunk is in use, merging all the blocks in a single
+ *           block big enough for the previous workload. It is expected
+ *           to be called after every high level operation (ADG does it
+ *           at the end of every arrange and export).</listitem>
+ * </itemizedlist>
+ *
+ * Every thread has its own scratch memory, so the functions using it
+ * can still be called from different threads.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "cpml-internal.h"
+#include "cpml-extents.h"
+#include "cpml-segment.h"
+#include "cpml-primitive.h"
+#include "cpml-scratch.h"
+#include <string.h>
+
+
+#define SCRATCH_BLOCK_SIZE      4096
+
+#if defined(__GNUC__)
+#define SCRATCH_THREAD_LOCAL    __thread
+#elif defined(_MSC_VER)
+#define SCRATCH_THREAD_LOCAL    __declspec(thread)
+#else
+#define SCRATCH_THREAD_LOCAL    _Thread_local
+#endif
+
+
+typedef union _ScratchBlock ScratchBlock;
+
+/* The unions enforce the strictest alignment on the headers,
+ * so the memory just after them can be used for any data type */
+typedef union {
+    struct {
+        ScratchBlock   *block;
+        size_t          offset;
+        void           *previous;
+        int             is_free;
+    }                   info;
+    long double         align_ld;
+    void               *align_p;
+} ScratchChunk;
+
+union _ScratchBlock {
+    struct {
+        ScratchBlock   *older;
+        size_t          size;
+        size_t          used;
+    }                   info;
+    ScratchChunk        align_chunk;
+};
+
+typedef struct {
+    ScratchBlock       *block;
+    void               *top;
+    size_t              n_live;
+    size_t              n_allocs;
+    size_t              n_mallocs;
+} Scratch;
+
+
+static ScratchBlock *   scratch_block_new       (ScratchBlock   *older,
+                                                 size_t          size);
+
+
+static SCRATCH_THREAD_LOCAL Scratch scratch = { NULL, NULL, 0, 0, 0 };
+
+
+/**
+ * cpml_scratch_alloc:
+ * @size: number of bytes to allocate
+ *
+ * Allocates @size bytes of temporary memory. The chunk must be
+ * released with cpml_scratch_free() as soon as it is no longer
+ * needed, ideally in reverse order of allocation.
+ *
+ * Returns: (transfer none): the allocated memory or
+ *          <constant>NULL</constant> if the system allocator fails
+ *
+ * Since: 1.0
+ **/
+void *
+cpml_scratch_alloc(size_t size)
+{
+    ScratchBlock *block;
+    ScratchChunk *chunk;
+    size_t needed;
+
+    /* Round up to a multiple of the alignment */
+    needed = (size + sizeof(ScratchChunk) - 1) / sizeof(ScratchChunk) + 1;
+    needed *= sizeof(ScratchChunk);
+
+    block = scratch.block;
+    if (block == NULL || block->info.size - block->info.used < needed) {
+        size_t block_size = block != NULL ?
+            block->info.size * 2 : SCRATCH_BLOCK_SIZE;
+
+        while (block_size < needed)
+            block_size *= 2;
+
+        block = scratch_block_new(scratch.block, block_size);
+        if (block == NULL)
+            return NULL;
+
+        scratch.block = block;
+    }
+
+    chunk = (ScratchChunk *) ((char *) (block + 1) + block->info.used);
+    chunk->info.block = block;
+    chunk->info.offset = block->info.used;
+    chunk->info.previous = scratch.top;
+    chunk->info.is_free = 0;
+    block->info.used += needed;
+
+    scratch.top = chunk + 1;
+    ++scratch.n_live;
+    ++scratch.n_allocs;
+
+    return scratch.top;
+}
+
+/**
+ * cpml_scratch_free:
+ * @ptr: (allow-none): a chunk returned by cpml_scratch_alloc()
+ *
+ * Releases a chunk of scratch memory. The memory of @ptr is available
+ * again as soon as all the chunks allocated after it have been released
+ * too, or at the latest on the next cpml_scratch_reset().
+ * If @ptr is <constant>NULL</constant> nothing is done.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_scratch_free(void *ptr)
+{
+    ScratchChunk *chunk;
+
+    if (ptr == NULL)
+        return;
+
+    chunk = (ScratchChunk *) ptr - 1;
+    chunk->info.is_free = 1;
+    --scratch.n_live;
+
+    /* Rewind the top past every released chunk */
+    while (scratch.top != NULL) {
+        chunk = (ScratchChunk *) scratch.top - 1;
+        if (! chunk->info.is_free)
+            break;
+        chunk->info.block->info.used = chunk->info.offset;
+        scratch.top = chunk->info.previous;
+    }
+}
+
+/**
+ * cpml_scratch_reset:
+ *
+ * Makes all the scratch memory available again. If more than one
+ * block has been allocated, they are merged in a single block big
+ * enough to serve the same workload without further allocations.
+ *
+ * Nothing is done if some chunk is still in use, so it is always
+ * safe to call this function.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_scratch_reset(void)
+{
+    ScratchBlock *block, *older;
+    size_t size;
+
+    block = scratch.block;
+    if (block == NULL || scratch.n_live > 0)
+        return;
+
+    scratch.top = NULL;
+
+    if (block->info.older == NULL) {
+        block->info.used = 0;
+        return;
+    }
+
+    size = 0;
+    while (block != NULL) {
+        older = block->info.older;
+        size += block->info.size;
+        free(block);
+        block = older;
+    }
+
+    scratch.block = scratch_block_new(NULL, size);
+}
+
+/**
+ * cpml_scratch_put_stats:
+ * @n_allocs: (out) (allow-none): where to store the number of chunks allocated
+ * @n_mallocs: (out) (allow-none): where to store the number of blocks allocated
+ *
+ * Gets the number of calls to cpml_scratch_alloc() and the number
+ * of requests to the system allocator performed by the scratch memory
+ * of the current thread, since the start of the program. Their
+ * difference is the number of malloc() calls avoided.
+ *
+ * Since: 1.0
+ **/
+void
+cpml_scratch_put_stats(size_t *n_allocs, size_t *n_mallocs)
+{
+    if (n_allocs != NULL)
+        *n_allocs = scratch.n_allocs;
+
+    if (n_mallocs != NULL)
+        *n_mallocs = scratch.n_mallocs;
+}
+
+/**
+ * cpml_scratch_primitive_dup:
+ * @primitive: the source #CpmlPrimitive
+ *
+ * Duplicates @primitive in scratch memory. The org and data points and
+ * the segment (if any) are copied too, so the result is independent of
+ * the source, much like cpml_primitive_deep_dup() does. Release it
+ * with cpml_scratch_free().
+ *
+ * Returns: (transfer none): the duplicate of @primitive or
+ *          <constant>NULL</constant> on errors
+ *
+ * Since: 1.0
+ **/
+CpmlPrimitive *
+cpml_scratch_primitive_dup(const CpmlPrimitive *primitive)
+{
+    CpmlPrimitive *dst;
+    size_t org_size, data_size, segment_size;
+    char *ptr;
+
+    org_size = primitive->org != NULL ? sizeof(cairo_path_data_t) : 0;
+    data_size = primitive->data != NULL ?
+        sizeof(cairo_path_data_t) * primitive->data->header.length : 0;
+    segment_size = primitive->segment != NULL &&
+        primitive->segment->data != NULL ?
+        sizeof(cairo_path_data_t) * primitive->segment->num_data : 0;
+
+    dst = cpml_scratch_alloc(sizeof(CpmlPrimitive) + sizeof(CpmlSegment) +
+                             org_size + data_size + segment_size);
+    if (dst == NULL)
+        return NULL;
+
+    ptr = (char *) (dst + 1);
+
+    if (segment_size > 0) {
+        dst->segment = memcpy(ptr, primitive->segment, sizeof(CpmlSegment));
+        ptr += sizeof(CpmlSegment);
+        dst->segment->data = memcpy(ptr, primitive->segment->data,
+                                    segment_size);
+        ptr += segment_size;
+    } else {
+        dst->segment = NULL;
+    }
+
+    if (org_size > 0) {
+        dst->org = memcpy(ptr, primitive->org, org_size);
+        ptr += org_size;
+    } else {
+        dst->org = NULL;
+    }
+
+    if (data_size > 0)
+        dst->data = memcpy(ptr, primitive->data, data_size);
+    else
+        dst->data = NULL;
+
+    return dst;
+}
+
+/**
+ * cpml_scratch_segment_dup:
+ * @segment: the source #CpmlSegment
+ *
+ * Duplicates @segment and its data in scratch memory, much like
+ * cpml_segment_deep_dup() does. The path field of the result is
+ * always set to <constant>NULL</constant>. Release it with
+ * cpml_scratch_free().
+ *
+ * Returns: (transfer none): the duplicate of @segment or
+ *          <constant>NULL</constant> on errors
+ *
+ * Since: 1.0
+ **/
+CpmlSegment *
+cpml_scratch_segment_dup(const CpmlSegment *segment)
+{
+    CpmlSegment *dst;
+    size_t data_size;
+
+    data_size = segment->data != NULL ?
+        sizeof(cairo_path_data_t) * segment->num_data : 0;
+
+    dst = cpml_scratch_alloc(sizeof(CpmlSegment) + data_size);
+    if (dst == NULL)
+        return NULL;
+
+    dst->path = NULL;
+
+    if (data_size > 0) {
+        dst->data = memcpy(dst + 1, segment->data, data_size);
+        dst->num_data = segment->num_data;
+    } else {
+        dst->data = NULL;
+        dst->num_data = 0;
+    }
+
+    return dst;
+}
+
+
+static ScratchBlock *
+scratch_block_new(ScratchBlock *older, size_t size)
+{
+    ScratchBlock *block = malloc(sizeof(ScratchBlock) + size);
+
+    if (block != NULL) {
+        block->info.older = older;
+        block->info.size = size;
+        block->info.used = 0;
+        ++scratch.n_mallocs;
+    }
+
+    return block;
+}
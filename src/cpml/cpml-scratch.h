@@ -0,0 +1,43 @@
+/* CPML - Cairo Path Manipulation Library
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__CPML_H__)
+#error "Only <cpml/cpml.h> can be included directly."
+#endif
+
+
+#ifndef __CPML_SCRATCH_H__
+#define __CPML_SCRATCH_H__
+
+
+CAIRO_BEGIN_DECLS
+
+void *          cpml_scratch_alloc          (size_t                  size);
+void            cpml_scratch_free           (void                   *ptr);
+void            cpml_scratch_reset          (void);
+void            cpml_scratch_put_stats      (size_t                 *n_allocs,
+                                             size_t                 *n_mallocs);
+CpmlPrimitive * cpml_scratch_primitive_dup  (const CpmlPrimitive    *primitive);
+CpmlSegment *   cpml_scratch_segment_dup    (const CpmlSegment      *segment);
+
+CAIRO_END_DECLS
+
+
+#endif /* __CPML_SCRATCH_H__ */
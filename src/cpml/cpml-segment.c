@@ -69,12 +69,106 @@
 #include "cpml-extents.h"
 #include "cpml-segment.h"
 #include "cpml-primitive.h"
+#include "cpml-scratch.h"
+#include "cpml-arc.h"
 #include "cpml-curve.h"
 #include <string.h>
+#include <math.h>
+
+/* Maximum distance of an intersection from the join of two adjacent
+ * primitives to be considered the join itself */
+#define JOIN_TOLERANCE  1e-9
+
+/* Joins with an angle near to 180 degrees are not extended:
+ * the miter would be too long and numerically unstable */
+#define MITER_LIMIT     1e-6
+
+/* Maximum number of intersections between two primitives,
+ * as documented by cpml_primitive_put_intersections() */
+#define MAX_INTERSECTIONS   4
+
+
+typedef struct _SweepItem SweepItem;
+typedef struct _OffsetItem OffsetItem;
+typedef struct _OffsetVertex OffsetVertex;
+
+struct _SweepItem {
+    CpmlPrimitive   primitive;
+    CpmlExtents     extents;
+    size_t          n;
+};
+
+/* Data shared among every offset distance: index contains the
+ * position of the points (origin included) inside the segment data */
+struct _OffsetItem {
+    int             type;
+    size_t          n_points;
+    size_t          index[4];
+    CpmlPair        point[4];
+    CpmlVector      normal[2];
+    int             is_degenerate;
+    int             has_center;
+    CpmlPair        center;
+    double          radius;
+    double          side;
+    double          direction;
+};
+
+/* The offset of a vertex is base + offset * miter, unless an arc is
+ * involved: the offset of prev and next are intersected instead */
+struct _OffsetVertex {
+    size_t          index;
+    CpmlPair        base;
+    CpmlVector      miter;
+    const OffsetItem *prev;
+    const OffsetItem *next;
+};
+
 
 static int              normalize               (CpmlSegment       *segment);
 static int              ensure_one_leading_move (CpmlSegment       *segment);
 static int              reshape                 (CpmlSegment       *segment);
+static int              compare_items           (const void        *a,
+                                                 const void        *b);
+static size_t           item_intersections      (const SweepItem   *item,
+                                                 const SweepItem   *item2,
+                                                 size_t             n_items,
+                                                 int                is_closed,
+                                                 CpmlPair          *dest);
+static int              has_pair                (const CpmlPair    *pair,
+                                                 size_t             n_pairs,
+                                                 const CpmlPair    *pairs);
+static int              is_near                 (const CpmlExtents *extents,
+                                                 const CpmlPair    *pair);
+static OffsetItem *     offset_prepare          (const CpmlSegment *segment,
+                                                 size_t            *n_items,
+                                                 OffsetVertex     **vertices);
+static void             offset_item             (OffsetItem        *item,
+                                                 const CpmlPrimitive *primitive,
+                                                 const cairo_path_data_t *base);
+static void             offset_miter            (OffsetVertex      *vertex,
+                                                 const OffsetItem  *items,
+                                                 size_t             n_items,
+                                                 size_t             n_vertex,
+                                                 int                is_closed);
+static void             offset_apply            (const OffsetItem  *items,
+                                                 size_t             n_items,
+                                                 const OffsetVertex *vertices,
+                                                 cairo_path_data_t *data,
+                                                 double             offset);
+static void             offset_join             (const OffsetVertex *vertex,
+                                                 double             offset,
+                                                 CpmlPair          *dest);
+static int              offset_primitive        (const OffsetItem  *item,
+                                                 double             offset,
+                                                 cairo_path_data_t *data,
+                                                 CpmlPrimitive     *primitive);
+static void             offset_arc_middle       (const OffsetItem  *item,
+                                                 double             offset,
+                                                 const CpmlPair    *start,
+                                                 const CpmlPair    *end,
+                                                 CpmlPair          *dest);
+static int              unit_normal             (CpmlVector        *vector);
 
 
 /**
@@ -391,6 +485,122 @@ cpml_segment_put_intersections(const CpmlSegment *segment,
     return total;
 }
 
+/**
+ * cpml_segment_put_self_intersections:
+ * @segment: a #CpmlSegment
+ * @n_dest:  maximum number of intersections to return
+ * @dest:    the destination vector of #CpmlPair
+ *
+ * Computes the points where @segment intersects itself and returns
+ * them in @dest. If the intersections are more than @n_dest, only
+ * the first @n_dest pairs found are stored in @dest. The joins
+ * between adjacent primitives (including the join between the last
+ * and the first primitive of a closed segment) are not reported and
+ * a crossing on a vertex, found on both the primitives sharing it,
+ * is reported only once. Differently from
+ * cpml_primitive_put_intersections(), the hypothetical intersections
+ * outside the extents of the primitives are discarded too.
+ *
+ * Calling cpml_segment_put_intersections() with @segment on both
+ * arguments checks every primitive against all the others and
+ * reports also the joins. Here instead the primitives are sorted by
+ * the left side of their extents and swept from left to right: any
+ * primitive is checked only against the active primitives, that is
+ * the primitives whose extents overlap its own.
+ *
+ * The order of the returned pairs is not specified.
+ *
+ * Returns: the number of intersections found
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_put_self_intersections(const CpmlSegment *segment,
+                                    size_t n_dest, CpmlPair *dest)
+{
+    CpmlPrimitive primitive;
+    SweepItem *items, *item, **active;
+    CpmlPair start, end, found[MAX_INTERSECTIONS];
+    size_t n_items, n, n_active, n_kept, n_found, j, k, total;
+    int is_closed;
+
+    if (n_dest == 0)
+        return 0;
+
+    /* Count the primitives */
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    n_items = 0;
+    do {
+        ++n_items;
+    } while (cpml_primitive_next(&primitive));
+
+    if (n_items < 2)
+        return 0;
+
+    items = cpml_scratch_alloc(sizeof(SweepItem) * n_items);
+    active = cpml_scratch_alloc(sizeof(SweepItem *) * n_items);
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    n = 0;
+    do {
+        item = items + n;
+        cpml_primitive_copy(&item->primitive, &primitive);
+        cpml_primitive_put_extents(&primitive, &item->extents);
+        item->n = n;
+        ++n;
+    } while (cpml_primitive_next(&primitive));
+
+    /* The last and first primitives are adjacent if they share
+     * the same point, e.g. when the segment is closed */
+    cpml_primitive_put_point(&items[0].primitive, 0, &start);
+    cpml_primitive_put_point(&items[n_items - 1].primitive, -1, &end);
+    is_closed = cpml_pair_squared_distance(&start, &end) <=
+        JOIN_TOLERANCE * JOIN_TOLERANCE;
+
+    qsort(items, n_items, sizeof(SweepItem), compare_items);
+
+    n_active = 0;
+    total = 0;
+
+    for (n = 0; n < n_items && total < n_dest; ++n) {
+        item = items + n;
+
+        /* Drop the primitives ending before the current one starts */
+        n_kept = 0;
+        for (j = 0; j < n_active; ++j) {
+            const CpmlExtents *extents = &active[j]->extents;
+            if (extents->org.x + extents->size.x >= item->extents.org.x)
+                active[n_kept++] = active[j];
+        }
+        n_active = n_kept;
+
+        for (j = 0; j < n_active && total < n_dest; ++j) {
+            const CpmlExtents *extents = &active[j]->extents;
+
+            /* Skip the primitives not overlapping on the y axis */
+            if (extents->org.y > item->extents.org.y + item->extents.size.y ||
+                item->extents.org.y > extents->org.y + extents->size.y)
+                continue;
+
+            /* The joins are discarded before filling dest, and a
+             * crossing on a vertex is found by both its primitives */
+            n_found = item_intersections(active[j], item, n_items,
+                                         is_closed, found);
+            for (k = 0; k < n_found && total < n_dest; ++k) {
+                if (! has_pair(&found[k], total, dest))
+                    dest[total++] = found[k];
+            }
+        }
+
+        active[n_active++] = item;
+    }
+
+    cpml_scratch_free(active);
+    cpml_scratch_free(items);
+
+    return total;
+}
+
 /**
  * cpml_segment_offset:
  * @segment: a #CpmlSegment
@@ -400,49 +610,77 @@ cpml_segment_put_intersections(const CpmlSegment *segment,
  * segment at the @offset distance from the original one and returns the
  * result by replacing the original @segment.
  *
- * <important>
- * <title>TODO</title>
- * <itemizedlist>
- * <listitem>Closed path are not yet managed: an elegant solution is not
- *           so obvious: use <function>cpml_close_offset</function> when
- *           will be available.</listitem>
- * <listitem>Degenerated primitives, such as lines of length 0, are not
- *           managed properly.</listitem>
- * </itemizedlist>
- * </important>
+ * This is a convenient wrapper around cpml_segment_put_offsets(): check
+ * its documentation for details on how joins, closed segments and
+ * degenerated primitives are managed.
  *
  * Since: 1.0
  **/
 void
 cpml_segment_offset(CpmlSegment *segment, double offset)
 {
-    CpmlPrimitive primitive;
-    CpmlPrimitive last_primitive;
-    CpmlPair old_end;
-    cairo_path_data_t org, *old_org;
-    int first_cycle;
+    cpml_segment_put_offsets(segment, 1, &offset, segment);
+}
 
-    cpml_primitive_from_segment(&primitive, segment);
-    first_cycle = 1;
+/**
+ * cpml_segment_put_offsets:
+ * @segment:                              a #CpmlSegment
+ * @n_offsets:                            number of offsets to compute
+ * @offsets: (array length=n_offsets):    the offset distances
+ * @dest: (array length=n_offsets) (inout): the destination segments
+ *
+ * Computes a "parallel" segment of @segment for every distance in
+ * @offsets, storing the result in the respective @dest segment. Every
+ * destination segment must have the same layout of @segment (e.g. it
+ * can be a copy got with cpml_segment_deep_dup()): its data will be
+ * overwritten. @dest can also be @segment itself when @n_offsets is 1.
+ *
+ * The offset direction of a point is the normal of the tangent vector
+ * in that point, as got by cpml_vector_normal(). Adjacent primitives
+ * are trimmed or extended so they meet where the offset of their end
+ * and start tangents intersect or, when an arc is involved, where the
+ * offset primitives themselves intersect. When the last point of @segment is
+ * coincident with the first one or @segment ends with a %CPML_CLOSE,
+ * the segment is considered closed and also its start point is
+ * joined. Degenerated primitives (e.g. lines of length 0) are skipped
+ * by the join logic and collapsed into the surrounding join.
+ *
+ * Everything not depending on the distance (normals, tangents, arc
+ * centers and join directions) is computed only once, so this is
+ * much faster than calling cpml_segment_offset() on many copies of
+ * @segment.
+ *
+ * Returns: (type gboolean): 1 on success, 0 if any @dest segment does not match @segment.
+ *
+ * Since: 1.0
+ **/
+int
+cpml_segment_put_offsets(const CpmlSegment *segment, size_t n_offsets,
+                         const double *offsets, CpmlSegment *dest)
+{
+    OffsetItem *items;
+    OffsetVertex *vertices;
+    size_t n, n_items;
 
-    do {
-        if (! first_cycle) {
-            cpml_pair_to_cairo(&old_end, &org);
-            old_org = primitive.org;
-            primitive.org = &org;
-        }
+    for (n = 0; n < n_offsets; ++n)
+        if (dest[n].num_data != segment->num_data)
+            return 0;
 
-        cpml_primitive_put_point(&primitive, -1, &old_end);
-        cpml_primitive_offset(&primitive, offset);
+    items = offset_prepare(segment, &n_items, &vertices);
+    if (items == NULL)
+        return 0;
 
-        if (! first_cycle) {
-            cpml_primitive_join(&last_primitive, &primitive);
-            primitive.org = old_org;
-        }
+    for (n = 0; n < n_offsets; ++n) {
+        if (dest[n].data != segment->data)
+            memcpy(dest[n].data, segment->data,
+                   sizeof(cairo_path_data_t) * segment->num_data);
+        offset_apply(items, n_items, vertices, dest[n].data, offsets[n]);
+    }
 
-        cpml_primitive_copy(&last_primitive, &primitive);
-        first_cycle = 0;
-    } while (cpml_primitive_next(&primitive));
+    cpml_scratch_free(vertices);
+    cpml_scratch_free(items);
+
+    return 1;
 }
 
 /**
@@ -503,7 +741,7 @@ cpml_segment_reverse(CpmlSegment *segment)
     const cairo_path_data_t *src_data;
 
     data_size = sizeof(cairo_path_data_t) * segment->num_data;
-    data = malloc(data_size);
+    data = cpml_scratch_alloc(data_size);
     src_data = segment->data;
     dst_data = data + segment->num_data;
     end_x = src_data[1].point.x;
@@ -545,12 +783,47 @@ cpml_segment_reverse(CpmlSegment *segment)
         memcpy(segment->data, data, data_size);
     }
 
-    free(data);
+    cpml_scratch_free(data);
 
     segment->data[1].point.x = end_x;
     segment->data[1].point.y = end_y;
 }
 
+/**
+ * cpml_segment_curves_to_arcs:
+ * @segment:   a #CpmlSegment
+ * @tolerance: the maximum distance allowed between a curve and its arc
+ *
+ * Scans @segment and rewrites in place as %CPML_ARC primitives all
+ * the curves close enough to a circular arc. Check cpml_curve_to_arc()
+ * for details on how the conversion is performed.
+ *
+ * Arcs can be offseted and intersected analytically, so this
+ * conversion improves both speed and precision of the subsequent
+ * operations on @segment.
+ *
+ * Returns: the number of curves converted
+ *
+ * Since: 1.0
+ **/
+size_t
+cpml_segment_curves_to_arcs(CpmlSegment *segment, double tolerance)
+{
+    CpmlPrimitive primitive;
+    size_t n;
+
+    cpml_primitive_from_segment(&primitive, segment);
+    n = 0;
+
+    do {
+        if (cpml_primitive_type(&primitive) == CPML_CURVE &&
+            cpml_curve_to_arc(&primitive, tolerance))
+            ++n;
+    } while (cpml_primitive_next(&primitive));
+
+    return n;
+}
+
 /**
  * cpml_segment_to_cairo:
  * @segment: a #CpmlSegment
@@ -711,3 +984,497 @@ reshape(CpmlSegment *segment)
     segment->num_data = num_data;
     return 1;
 }
+
+static int
+compare_items(const void *a, const void *b)
+{
+    const SweepItem *item1 = a;
+    const SweepItem *item2 = b;
+
+    if (item1->extents.org.x < item2->extents.org.x)
+        return -1;
+    if (item1->extents.org.x > item2->extents.org.x)
+        return 1;
+
+    /* Keep the order stable, regardless of the qsort implementation */
+    return item1->n < item2->n ? -1 : 1;
+}
+
+static size_t
+item_intersections(const SweepItem *item, const SweepItem *item2,
+                   size_t n_items, int is_closed, CpmlPair *dest)
+{
+    const SweepItem *first, *second;
+    CpmlPair join;
+    size_t n, n_found, n_kept;
+    int is_adjacent;
+
+    /* Sort the items by position inside the segment */
+    if (item->n < item2->n) {
+        first = item;
+        second = item2;
+    } else {
+        first = item2;
+        second = item;
+    }
+
+    n_found = cpml_primitive_put_intersections(&first->primitive,
+                                               &second->primitive,
+                                               MAX_INTERSECTIONS, dest);
+
+    /* Check if the primitives are adjacent, getting the join point */
+    is_adjacent = 1;
+    if (second->n == first->n + 1)
+        cpml_primitive_put_point(&second->primitive, 0, &join);
+    else if (is_closed && first->n == 0 && second->n == n_items - 1)
+        cpml_primitive_put_point(&first->primitive, 0, &join);
+    else
+        is_adjacent = 0;
+
+    /* Discard the join and the hypothetical intersections, that is
+     * the ones found by extending the primitives outside their bounds */
+    n_kept = 0;
+    for (n = 0; n < n_found; ++n) {
+        if (is_adjacent && has_pair(&dest[n], 1, &join))
+            continue;
+        if (is_near(&first->extents, &dest[n]) &&
+            is_near(&second->extents, &dest[n]))
+            dest[n_kept++] = dest[n];
+    }
+
+    return n_kept;
+}
+
+static int
+has_pair(const CpmlPair *pair, size_t n_pairs, const CpmlPair *pairs)
+{
+    size_t n;
+
+    for (n = 0; n < n_pairs; ++n) {
+        if (cpml_pair_squared_distance(pair, &pairs[n]) <=
+            JOIN_TOLERANCE * JOIN_TOLERANCE)
+            return 1;
+    }
+
+    return 0;
+}
+
+static int
+is_near(const CpmlExtents *extents, const CpmlPair *pair)
+{
+    /* cpml_extents_pair_is_inside() with some tolerance, so rounding
+     * errors do not discard the crossings on horizontal or vertical
+     * primitives */
+    return pair->x >= extents->org.x - JOIN_TOLERANCE &&
+           pair->y >= extents->org.y - JOIN_TOLERANCE &&
+           pair->x <= extents->org.x + extents->size.x + JOIN_TOLERANCE &&
+           pair->y <= extents->org.y + extents->size.y + JOIN_TOLERANCE;
+}
+
+static OffsetItem *
+offset_prepare(const CpmlSegment *segment, size_t *n_items,
+               OffsetVertex **vertices)
+{
+    CpmlPrimitive primitive;
+    OffsetItem *items, *last;
+    OffsetVertex *vertex;
+    size_t n;
+    int is_closed;
+
+    /* A segment with only the leading move has nothing to offset */
+    if (segment->num_data <= 2)
+        return NULL;
+
+    /* Count the primitives */
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    *n_items = 0;
+    do {
+        ++*n_items;
+    } while (cpml_primitive_next(&primitive));
+
+    items = cpml_scratch_alloc(sizeof(OffsetItem) * *n_items);
+    *vertices = cpml_scratch_alloc(sizeof(OffsetVertex) * (*n_items + 1));
+
+    cpml_primitive_from_segment(&primitive, (CpmlSegment *) segment);
+    n = 0;
+    do {
+        offset_item(items + n, &primitive, segment->data);
+        ++n;
+    } while (cpml_primitive_next(&primitive));
+
+    last = items + *n_items - 1;
+    is_closed = last->type == CPML_CLOSE ||
+        cpml_pair_squared_distance(&items[0].point[0],
+                                   &last->point[last->n_points - 1]) <=
+        JOIN_TOLERANCE * JOIN_TOLERANCE;
+
+    /* Vertex n is the start point of item n, while the last
+     * vertex is the end point of the last item */
+    for (n = 0; n <= *n_items; ++n) {
+        vertex = *vertices + n;
+        if (n < *n_items) {
+            vertex->index = items[n].index[0];
+            vertex->base = items[n].point[0];
+        } else {
+            vertex->index = last->index[last->n_points - 1];
+            vertex->base = last->point[last->n_points - 1];
+        }
+        offset_miter(vertex, items, *n_items, n, is_closed);
+    }
+
+    return items;
+}
+
+static void
+offset_item(OffsetItem *item, const CpmlPrimitive *primitive,
+            const cairo_path_data_t *base)
+{
+    const CpmlPair *start, *end;
+    double start_angle, end_angle;
+    size_t n, last;
+
+    item->type = cpml_primitive_type(primitive);
+    item->n_points = cpml_primitive_get_n_points(primitive);
+    item->has_center = 0;
+    last = item->n_points - 1;
+
+    item->index[0] = primitive->org - base;
+    for (n = 1; n < item->n_points; ++n)
+        item->index[n] = primitive->data - base + n;
+
+    /* The end point of a close is the start of the segment */
+    if (item->type == CPML_CLOSE)
+        item->index[last] = 1;
+
+    for (n = 0; n < item->n_points; ++n)
+        cpml_primitive_put_point(primitive, n, &item->point[n]);
+
+    start = &item->point[0];
+    end = &item->point[last];
+
+    item->is_degenerate = 1;
+    for (n = 1; n < item->n_points; ++n)
+        if (! cpml_pair_equal(&item->point[n], start))
+            item->is_degenerate = 0;
+
+    if (item->is_degenerate)
+        return;
+
+    if (item->type == CPML_ARC &&
+        cpml_arc_info(primitive, &item->center, &item->radius,
+                      &start_angle, &end_angle)) {
+        CpmlVector vector;
+
+        cpml_primitive_put_vector_at(primitive, 0, &item->normal[0]);
+        cpml_primitive_put_vector_at(primitive, 1, &item->normal[1]);
+
+        if (unit_normal(&item->normal[0]) && unit_normal(&item->normal[1])) {
+            /* The side tells if the radius must grow or shrink
+             * when the offset is positive */
+            vector.x = start->x - item->center.x;
+            vector.y = start->y - item->center.y;
+            item->side = vector.x * item->normal[0].x +
+                vector.y * item->normal[0].y >= 0 ? 1 : -1;
+            item->direction = end_angle > start_angle ? 1 : -1;
+            item->has_center = 1;
+            return;
+        }
+    }
+
+    /* The tangents are got from the nearest distinct control points */
+    for (n = 1; n < last && cpml_pair_equal(&item->point[n], start); ++n)
+        ;
+    item->normal[0].x = item->point[n].x - start->x;
+    item->normal[0].y = item->point[n].y - start->y;
+
+    for (n = last - 1; n > 0 && cpml_pair_equal(&item->point[n], end); --n)
+        ;
+    item->normal[1].x = end->x - item->point[n].x;
+    item->normal[1].y = end->y - item->point[n].y;
+
+    if (! unit_normal(&item->normal[0]) || ! unit_normal(&item->normal[1]))
+        item->is_degenerate = 1;
+}
+
+static void
+offset_miter(OffsetVertex *vertex, const OffsetItem *items,
+             size_t n_items, size_t n_vertex, int is_closed)
+{
+    const OffsetItem *prev, *next;
+    const CpmlVector *n1, *n2;
+    double divisor;
+    size_t n;
+
+    prev = NULL;
+    next = NULL;
+
+    /* Look for the nearest non-degenerated primitives around the
+     * vertex, wrapping around the segment ends if it is closed */
+    for (n = n_vertex; n > 0 && prev == NULL; --n)
+        if (! items[n - 1].is_degenerate)
+            prev = &items[n - 1];
+    for (n = n_vertex; n < n_items && next == NULL; ++n)
+        if (! items[n].is_degenerate)
+            next = &items[n];
+
+    if (is_closed) {
+        for (n = n_items; n > 0 && prev == NULL; --n)
+            if (! items[n - 1].is_degenerate)
+                prev = &items[n - 1];
+        for (n = 0; n < n_items && next == NULL; ++n)
+            if (! items[n].is_degenerate)
+                next = &items[n];
+    }
+
+    vertex->prev = prev;
+    vertex->next = next;
+
+    if (prev == NULL && next == NULL) {
+        vertex->miter.x = 0;
+        vertex->miter.y = 0;
+        return;
+    } else if (prev == NULL) {
+        vertex->miter = next->normal[0];
+        return;
+    } else if (next == NULL) {
+        vertex->miter = prev->normal[1];
+        return;
+    }
+
+    /* The miter is the only vector having a projection of 1 on both
+     * normals, so the offset vertex lies on both offset tangents */
+    n1 = &prev->normal[1];
+    n2 = &next->normal[0];
+    divisor = 1 + n1->x * n2->x + n1->y * n2->y;
+
+    if (divisor < MITER_LIMIT)
+        divisor = 2;
+
+    vertex->miter.x = (n1->x + n2->x) / divisor;
+    vertex->miter.y = (n1->y + n2->y) / divisor;
+}
+
+static void
+offset_apply(const OffsetItem *items, size_t n_items,
+             const OffsetVertex *vertices, cairo_path_data_t *data,
+             double offset)
+{
+    const OffsetItem *item;
+    const OffsetVertex *vertex;
+    CpmlPair pair, start, end;
+    size_t n, last;
+
+    for (n = 0; n <= n_items; ++n) {
+        vertex = vertices + n;
+        offset_join(vertex, offset, &pair);
+        cpml_pair_to_cairo(&pair, data + vertex->index);
+    }
+
+    /* Lines and closes have no interior points to update */
+    for (n = 0; n < n_items; ++n) {
+        item = items + n;
+        last = item->n_points - 1;
+        if (last < 2)
+            continue;
+
+        cpml_pair_from_cairo(&start, data + item->index[0]);
+        cpml_pair_from_cairo(&end, data + item->index[last]);
+
+        if (item->is_degenerate) {
+            cpml_pair_to_cairo(&start, data + item->index[1]);
+            if (last > 2)
+                cpml_pair_to_cairo(&start, data + item->index[2]);
+        } else if (item->type == CPML_ARC && item->has_center) {
+            offset_arc_middle(item, offset, &start, &end, &pair);
+            cpml_pair_to_cairo(&pair, data + item->index[1]);
+        } else if (item->type == CPML_ARC) {
+            pair.x = item->point[1].x + offset * item->normal[0].x;
+            pair.y = item->point[1].y + offset * item->normal[0].y;
+            cpml_pair_to_cairo(&pair, data + item->index[1]);
+        } else if (item->type == CPML_CURVE) {
+            CpmlPrimitive curve;
+            cairo_path_data_t curve_data[5];
+            CpmlPair p[4];
+            size_t j;
+
+            /* Offset a standalone copy and move its interior control
+             * points along with the ends trimmed by the joins */
+            curve_data[0].header.type = CPML_CURVE;
+            curve_data[0].header.length = 4;
+            for (j = 1; j < 4; ++j)
+                cpml_pair_to_cairo(&item->point[j], &curve_data[j]);
+            cpml_pair_to_cairo(&item->point[0], &curve_data[4]);
+
+            curve.segment = NULL;
+            curve.org = &curve_data[4];
+            curve.data = curve_data;
+            cpml_primitive_offset(&curve, offset);
+
+            cpml_pair_from_cairo(&p[0], &curve_data[4]);
+            for (j = 1; j < 4; ++j)
+                cpml_pair_from_cairo(&p[j], &curve_data[j]);
+
+            pair.x = p[1].x + start.x - p[0].x;
+            pair.y = p[1].y + start.y - p[0].y;
+            cpml_pair_to_cairo(&pair, data + item->index[1]);
+            pair.x = p[2].x + end.x - p[3].x;
+            pair.y = p[2].y + end.y - p[3].y;
+            cpml_pair_to_cairo(&pair, data + item->index[2]);
+        }
+    }
+}
+
+static void
+offset_join(const OffsetVertex *vertex, double offset, CpmlPair *dest)
+{
+    cairo_path_data_t prev_data[4], next_data[4];
+    CpmlPrimitive prev, next;
+    CpmlPair pairs[4], nearest;
+    double distance, min_distance;
+    size_t n, n_pairs;
+
+    /* The miter is exact between lines and the best guess
+     * available when a curve is involved */
+    dest->x = vertex->base.x + offset * vertex->miter.x;
+    dest->y = vertex->base.y + offset * vertex->miter.y;
+
+    if (vertex->prev == NULL || vertex->next == NULL ||
+        vertex->prev == vertex->next ||
+        (! vertex->prev->has_center && ! vertex->next->has_center) ||
+        ! offset_primitive(vertex->prev, offset, prev_data, &prev) ||
+        ! offset_primitive(vertex->next, offset, next_data, &next))
+        return;
+
+    /* Moving the ends of an arc along the miter would take them off
+     * the offset circle: the join is where the offset primitives
+     * really meet, picking the intersection nearest to the miter */
+    n_pairs = cpml_primitive_put_intersections(&prev, &next, 4, pairs);
+
+    if (n_pairs == 0) {
+        /* The offset primitives do not meet (e.g. the offset line is
+         * tangent to the circle): keep the end of the offset arc */
+        if (vertex->prev->has_center)
+            cpml_primitive_put_point(&prev, -1, dest);
+        else
+            cpml_primitive_put_point(&next, 0, dest);
+        return;
+    }
+
+    min_distance = -1;
+    for (n = 0; n < n_pairs; ++n) {
+        distance = cpml_pair_squared_distance(&pairs[n], dest);
+        if (min_distance < 0 || distance < min_distance) {
+            min_distance = distance;
+            nearest = pairs[n];
+        }
+    }
+
+    *dest = nearest;
+}
+
+/* Builds in @data the standalone offset of a line (or close) or
+ * of an arc with a known center: other primitives are not supported */
+static int
+offset_primitive(const OffsetItem *item, double offset,
+                 cairo_path_data_t *data, CpmlPrimitive *primitive)
+{
+    CpmlPair pair;
+    double radius;
+    size_t n;
+
+    if (item->is_degenerate)
+        return 0;
+
+    if (item->has_center) {
+        radius = item->radius + item->side * offset;
+        if (radius <= 0)
+            return 0;
+        data[0].header.type = CPML_ARC;
+        data[0].header.length = 3;
+        for (n = 0; n < 3; ++n) {
+            pair.x = item->point[n].x - item->center.x;
+            pair.y = item->point[n].y - item->center.y;
+            cpml_vector_set_length(&pair, radius);
+            pair.x += item->center.x;
+            pair.y += item->center.y;
+            cpml_pair_to_cairo(&pair, &data[n == 0 ? 3 : n]);
+        }
+        primitive->org = &data[3];
+    } else if (item->type == CPML_LINE || item->type == CPML_CLOSE) {
+        data[0].header.type = CPML_LINE;
+        data[0].header.length = 2;
+        for (n = 0; n < 2; ++n) {
+            pair.x = item->point[n].x + offset * item->normal[0].x;
+            pair.y = item->point[n].y + offset * item->normal[0].y;
+            cpml_pair_to_cairo(&pair, &data[n == 0 ? 2 : n]);
+        }
+        primitive->org = &data[2];
+    } else {
+        return 0;
+    }
+
+    primitive->segment = NULL;
+    primitive->data = data;
+
+    return 1;
+}
+
+/* Computes the intermediate point of an offset arc, halfway between
+ * its (possibly trimmed) @start and @end in the arc direction */
+static void
+offset_arc_middle(const OffsetItem *item, double offset,
+                  const CpmlPair *start, const CpmlPair *end,
+                  CpmlPair *dest)
+{
+    double radius, start_angle, angle;
+
+    radius = item->radius + item->side * offset;
+    if (radius <= 0) {
+        *dest = item->center;
+        return;
+    }
+
+    if (cpml_pair_equal(&item->point[0], &item->point[2])) {
+        /* A full circle: the intermediate point is the opposite
+         * of the start one, so it can simply be moved radially */
+        dest->x = item->point[1].x - item->center.x;
+        dest->y = item->point[1].y - item->center.y;
+    } else {
+        start_angle = atan2(start->y - item->center.y,
+                            start->x - item->center.x);
+        angle = atan2(end->y - item->center.y,
+                      end->x - item->center.x) - start_angle;
+
+        /* Get the sweep in the same direction of the original arc */
+        if (item->direction > 0) {
+            while (angle < 0)
+                angle += M_PI * 2;
+        } else {
+            while (angle > 0)
+                angle -= M_PI * 2;
+        }
+
+        angle = start_angle + angle / 2;
+        dest->x = cos(angle);
+        dest->y = sin(angle);
+    }
+
+    cpml_vector_set_length(dest, radius);
+    dest->x += item->center.x;
+    dest->y += item->center.y;
+}
+
+static int
+unit_normal(CpmlVector *vector)
+{
+    double length = cpml_pair_distance(NULL, vector);
+
+    if (length == 0)
+        return 0;
+
+    vector->x /= length;
+    vector->y /= length;
+    cpml_vector_normal(vector);
+
+    return 1;
+}
@@ -60,11 +60,21 @@ size_t  cpml_segment_put_intersections  (const CpmlSegment      *segment,
                                          const CpmlSegment      *segment2,
                                          size_t                  n_dest,
                                          CpmlPair               *dest);
+size_t  cpml_segment_put_self_intersections
+                                        (const CpmlSegment      *segment,
+                                         size_t                  n_dest,
+                                         CpmlPair               *dest);
 void    cpml_segment_offset             (CpmlSegment            *segment,
                                          double                  offset);
+int     cpml_segment_put_offsets        (const CpmlSegment      *segment,
+                                         size_t                  n_offsets,
+                                         const double           *offsets,
+                                         CpmlSegment            *dest);
 void    cpml_segment_transform          (CpmlSegment            *segment,
                                          const cairo_matrix_t   *matrix);
 void    cpml_segment_reverse            (CpmlSegment            *segment);
+size_t  cpml_segment_curves_to_arcs     (CpmlSegment            *segment,
+                                         double                  tolerance);
 void    cpml_segment_to_cairo           (const CpmlSegment      *segment,
                                          cairo_t                *cr);
 void    cpml_segment_dump               (const CpmlSegment      *segment);
@@ -0,0 +1,192 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <cpml.h>
+#include <math.h>
+
+
+typedef struct {
+    cairo_path_t        path;
+    cairo_path_t        scratch_path;
+    CpmlSegment         segment;
+    CpmlSegment         scratch_segment;
+    CpmlPrimitive       primitive;
+    CpmlPrimitive       scratch;
+} _CpmlBench;
+
+
+/* A horizontal line crossing all the primitives below */
+static cairo_path_data_t crossing_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { -1, 2 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 11, 2 }}
+};
+
+static cairo_path_data_t line_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 10, 5 }}
+};
+
+static cairo_path_data_t arc_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_ARC, 3 }},
+    { .point = { 5, 5 }},
+    { .point = { 10, 0 }}
+};
+
+static cairo_path_data_t curve_data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 0 }},
+    { .header = { CPML_CURVE, 4 }},
+    { .point = { 2, 8 }},
+    { .point = { 8, 8 }},
+    { .point = { 10, 0 }}
+};
+
+static CpmlSegment crossing;
+
+
+static _CpmlBench *
+_cpml_bench_new(cairo_path_data_t *data, int num_data)
+{
+    _CpmlBench *bench = g_new0(_CpmlBench, 1);
+
+    bench->path.status = CAIRO_STATUS_SUCCESS;
+    bench->path.data = data;
+    bench->path.num_data = num_data;
+    cpml_segment_from_cairo(&bench->segment, &bench->path);
+    cpml_primitive_from_segment(&bench->primitive, &bench->segment);
+
+    /* The scratch copy is modified by the benchmarks while
+     * the original data is used to restore it */
+    bench->scratch_path.status = CAIRO_STATUS_SUCCESS;
+    bench->scratch_path.data = g_memdup(data, sizeof(cairo_path_data_t) * num_data);
+    bench->scratch_path.num_data = num_data;
+    cpml_segment_from_cairo(&bench->scratch_segment, &bench->scratch_path);
+    cpml_primitive_from_segment(&bench->scratch, &bench->scratch_segment);
+
+    return bench;
+}
+
+static void
+_cpml_bench_length(_CpmlBench *bench)
+{
+    cpml_primitive_get_length(&bench->primitive);
+}
+
+static void
+_cpml_bench_extents(_CpmlBench *bench)
+{
+    CpmlExtents extents;
+
+    extents.is_defined = 0;
+    cpml_primitive_put_extents(&bench->primitive, &extents);
+}
+
+static void
+_cpml_bench_intersections(_CpmlBench *bench)
+{
+    CpmlPair pairs[4];
+
+    cpml_primitive_put_intersections_with_segment(&bench->primitive,
+                                                  &crossing, 4, pairs);
+}
+
+static void
+_cpml_bench_offset(_CpmlBench *bench)
+{
+    cpml_primitive_copy_data(&bench->scratch, &bench->primitive);
+    cpml_primitive_offset(&bench->scratch, 1);
+}
+
+static void
+_cpml_bench_transform(_CpmlBench *bench)
+{
+    cairo_matrix_t matrix;
+
+    cairo_matrix_init_rotate(&matrix, M_PI / 3);
+    cairo_matrix_translate(&matrix, 5, 5);
+
+    cpml_segment_copy_data(&bench->scratch_segment, &bench->segment);
+    cpml_segment_transform(&bench->scratch_segment, &matrix);
+}
+
+static void
+_cpml_bench_reverse(_CpmlBench *bench)
+{
+    cpml_segment_copy_data(&bench->scratch_segment, &bench->segment);
+    cpml_segment_reverse(&bench->scratch_segment);
+}
+
+static void
+_cpml_add_benches(const gchar *name, _CpmlBench *bench)
+{
+    gchar *testpath;
+
+    testpath = g_strdup_printf("/cpml/bench/%s/length", name);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _cpml_bench_length, bench);
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/cpml/bench/%s/extents", name);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _cpml_bench_extents, bench);
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/cpml/bench/%s/intersections", name);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _cpml_bench_intersections, bench);
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/cpml/bench/%s/offset", name);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _cpml_bench_offset, bench);
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/cpml/bench/%s/transform", name);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _cpml_bench_transform, bench);
+    g_free(testpath);
+
+    testpath = g_strdup_printf("/cpml/bench/%s/reverse", name);
+    adg_test_add_bench(testpath, (AdgBenchFunc) _cpml_bench_reverse, bench);
+    g_free(testpath);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    static cairo_path_t crossing_path = {
+        CAIRO_STATUS_SUCCESS,
+        crossing_data,
+        G_N_ELEMENTS(crossing_data)
+    };
+
+    adg_test_init(&argc, &argv);
+
+    cpml_segment_from_cairo(&crossing, &crossing_path);
+
+    _cpml_add_benches("line", _cpml_bench_new(line_data, G_N_ELEMENTS(line_data)));
+    _cpml_add_benches("arc", _cpml_bench_new(arc_data, G_N_ELEMENTS(arc_data)));
+    _cpml_add_benches("curve", _cpml_bench_new(curve_data, G_N_ELEMENTS(curve_data)));
+
+    return g_test_run();
+}
@@ -93,6 +93,24 @@ _cpml_sanity_offset_at_time(gint i)
     }
 }
 
+static void
+_cpml_sanity_closest_time(gint i)
+{
+    CpmlPair pair = { 0, 0 };
+
+    switch (i) {
+    case 1:
+        cpml_curve_get_closest_time(NULL, &pair);
+        break;
+    case 2:
+        cpml_curve_get_closest_time(&curve, NULL);
+        break;
+    default:
+        g_test_trap_assert_failed();
+        break;
+    }
+}
+
 static void
 _cpml_method_offset_algorithm(void)
 {
@@ -186,6 +204,65 @@ _cpml_method_offset_at_time(void)
     g_assert_cmpint((pair.y + 0.00005) * 10000, ==, 40000);
 }
 
+static void
+_cpml_method_closest_time(void)
+{
+    CpmlPair pair;
+
+    pair.x = 1; pair.y = 1;
+    adg_assert_isapprox(cpml_curve_get_closest_time(&curve, &pair), 0);
+    pair.x = 0; pair.y = 0;
+    adg_assert_isapprox(cpml_curve_get_closest_time(&curve, &pair), 0);
+    pair.x = 3; pair.y = 5;
+    adg_assert_isapprox(cpml_curve_get_closest_time(&curve, &pair), 1);
+    pair.x = 4; pair.y = 6;
+    adg_assert_isapprox(cpml_curve_get_closest_time(&curve, &pair), 1);
+    pair.x = 2; pair.y = 3;
+    adg_assert_isapprox(cpml_curve_get_closest_time(&curve, &pair), 0.5);
+}
+
+static void
+_cpml_method_to_arc(void)
+{
+    /* The usual cubic approximation of a quarter of circle */
+    cairo_path_data_t data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 1, 0 }},
+        { .header = { CPML_CURVE, 4 }},
+        { .point = { 1, 0.5522847498 }},
+        { .point = { 0.5522847498, 1 }},
+        { .point = { 0, 1 }}
+    };
+    CpmlPrimitive primitive = {
+        NULL,
+        &data[1],
+        &data[2]
+    };
+    CpmlPair center;
+    double r;
+
+    /* Collinear points cannot be converted */
+    g_assert_cmpint(cpml_curve_to_arc(&curve, 1), ==, 0);
+    g_assert_cmpint(curve_data[2].header.type, ==, CPML_CURVE);
+
+    /* Tolerance too strict */
+    g_assert_cmpint(cpml_curve_to_arc(&primitive, 1e-6), ==, 0);
+    g_assert_cmpint(data[2].header.type, ==, CPML_CURVE);
+
+    g_assert_cmpint(cpml_curve_to_arc(&primitive, 1e-3), ==, 1);
+    g_assert_cmpint(data[2].header.type, ==, CPML_ARC);
+    g_assert_cmpint(data[2].header.length, ==, 4);
+    adg_assert_isapprox(data[3].point.x, G_SQRT2 / 2);
+    adg_assert_isapprox(data[3].point.y, G_SQRT2 / 2);
+    adg_assert_isapprox(data[4].point.x, 0);
+    adg_assert_isapprox(data[4].point.y, 1);
+
+    g_assert_cmpint(cpml_arc_info(&primitive, &center, &r, NULL, NULL), ==, 1);
+    adg_assert_isapprox(center.x, 0);
+    adg_assert_isapprox(center.y, 0);
+    adg_assert_isapprox(r, 1);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -195,11 +272,14 @@ main(int argc, char *argv[])
     adg_test_add_traps("/cpml/curve/sanity/pair-at-time", _cpml_sanity_pair_at_time, 2);
     adg_test_add_traps("/cpml/curve/sanity/vector-at-time", _cpml_sanity_vector_at_time, 2);
     adg_test_add_traps("/cpml/curve/sanity/offset-at-time", _cpml_sanity_offset_at_time, 2);
+    adg_test_add_traps("/cpml/curve/sanity/closest-time", _cpml_sanity_closest_time, 2);
 
     g_test_add_func("/cpml/curve/method/offset-algorithm", _cpml_method_offset_algorithm);
     g_test_add_func("/cpml/curve/method/pair-at-time", _cpml_method_pair_at_time);
     g_test_add_func("/cpml/curve/method/vector-at-time", _cpml_method_vector_at_time);
     g_test_add_func("/cpml/curve/method/offset-at-time", _cpml_method_offset_at_time);
+    g_test_add_func("/cpml/curve/method/closest-time", _cpml_method_closest_time);
+    g_test_add_func("/cpml/curve/method/to-arc", _cpml_method_to_arc);
 
     return g_test_run();
 }
@@ -798,18 +798,18 @@ _cpml_method_get_closest_pos(void)
 
     /* Arc */
     cpml_primitive_next(&primitive);
-    /* TODO: not yet implemented
-     * pair.x = 3; pair.y = 1;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0);
-     * pair.x = 6; pair.y = 7;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
-     * pair.x = 0; pair.y = 0;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0);
-     * pair.x = 10; pair.y = 10;
-     * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
-     */
+    pair.x = 3; pair.y = 1;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0);
+    pair.x = 6; pair.y = 7;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
+    pair.x = 0; pair.y = 0;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0);
+    pair.x = 10; pair.y = 10;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
+    pair.x = 4; pair.y = 5;
+    adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 0.595);
 
-    /* Close */
+    /* Curve */
     cpml_primitive_next(&primitive);
     /* TODO: not yet implemented
      * pair.x = 6; pair.y = 7;
@@ -821,6 +821,7 @@ _cpml_method_get_closest_pos(void)
      * pair.x = 0; pair.y = 0;
      * adg_assert_isapprox(cpml_primitive_get_closest_pos(&primitive, &pair), 1);
      */
+    g_assert_cmpfloat(cpml_primitive_get_closest_pos(&primitive, &pair), ==, -1);
 
     /* Close */
     cpml_primitive_next(&primitive);
@@ -1265,8 +1266,9 @@ static void
 _cpml_method_offset(void)
 {
     CpmlSegment original, *segment;
-    CpmlPrimitive primitive, line, curve;
+    CpmlPrimitive primitive, line, curve, arc;
     CpmlPrimitive *backup;
+    cairo_path_data_t arc_data[4];
 
     /* Work on a copy to avoid modifying the original cairo path */
     cpml_segment_from_cairo(&original, (cairo_path_t *) adg_test_path());
@@ -1306,6 +1308,24 @@ _cpml_method_offset(void)
     adg_assert_isapprox(primitive.data[2].point.x, 6);
     adg_assert_isapprox(primitive.data[2].point.y, 7);
 
+    /* The radius grows also on arcs with increasing angles */
+    arc_data[0].point.x = 6;
+    arc_data[0].point.y = 7;
+    arc_data[2].point.x = 4;
+    arc_data[2].point.y = 5;
+    arc_data[3].point.x = 3;
+    arc_data[3].point.y = 1;
+    arc.segment = NULL;
+    arc.org = &arc_data[0];
+    arc.data = &arc_data[1];
+    arc.data->header.type = CPML_ARC;
+    arc.data->header.length = 3;
+    cpml_primitive_offset(&arc, 1);
+    adg_assert_isapprox((arc.org)->point.x, 5.463);
+    adg_assert_isapprox((arc.org)->point.y, 7.844);
+    adg_assert_isapprox(arc.data[2].point.x, 2.003);
+    adg_assert_isapprox(arc.data[2].point.y, 0.923);
+
     /* Curve */
     cpml_primitive_next(&primitive);
     cpml_primitive_copy(&curve, &primitive);
@@ -0,0 +1,196 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2019  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#include <adg-test.h>
+#include <cpml.h>
+#include <string.h>
+
+
+static cairo_path_data_t data[] = {
+    { .header = { CPML_MOVE, 2 }},
+    { .point = { 0, 1 }},
+    { .header = { CPML_LINE, 2 }},
+    { .point = { 2, 3 }},
+    { .header = { CPML_CURVE, 4 }},
+    { .point = { 4, 5 }},
+    { .point = { 6, 7 }},
+    { .point = { 8, 9 }}
+};
+
+static cairo_path_t path = {
+    CAIRO_STATUS_SUCCESS,
+    data,
+    G_N_ELEMENTS(data)
+};
+
+
+static void
+_cpml_behavior_rewind(void)
+{
+    gpointer chunk1, chunk2, chunk3;
+
+    g_test_message("Chunks released in reverse order must be reused");
+    chunk1 = cpml_scratch_alloc(10);
+    g_assert_nonnull(chunk1);
+    chunk2 = cpml_scratch_alloc(10);
+    g_assert_nonnull(chunk2);
+    g_assert_true(chunk1 != chunk2);
+    cpml_scratch_free(chunk2);
+    chunk3 = cpml_scratch_alloc(10);
+    g_assert_true(chunk3 == chunk2);
+
+    g_test_message("Chunks released in any order must be reused once all are released");
+    cpml_scratch_free(chunk1);
+    chunk2 = cpml_scratch_alloc(10);
+    g_assert_true(chunk2 != chunk1);
+    cpml_scratch_free(chunk3);
+    cpml_scratch_free(chunk2);
+    chunk3 = cpml_scratch_alloc(10);
+    g_assert_true(chunk3 == chunk1);
+    cpml_scratch_free(chunk3);
+
+    /* NULL must be silently ignored */
+    cpml_scratch_free(NULL);
+}
+
+static void
+_cpml_behavior_alignment(void)
+{
+    gpointer chunk1, chunk2;
+
+    chunk1 = cpml_scratch_alloc(1);
+    chunk2 = cpml_scratch_alloc(sizeof(double));
+    g_assert_cmpuint(GPOINTER_TO_SIZE(chunk1) % sizeof(double), ==, 0);
+    g_assert_cmpuint(GPOINTER_TO_SIZE(chunk2) % sizeof(double), ==, 0);
+
+    /* Writing the whole chunks must not corrupt anything */
+    memset(chunk1, 0xFF, 1);
+    memset(chunk2, 0xFF, sizeof(double));
+
+    cpml_scratch_free(chunk2);
+    cpml_scratch_free(chunk1);
+}
+
+static void
+_cpml_method_reset(void)
+{
+    gpointer chunks[100];
+    size_t n_allocs, n_mallocs, old_allocs, old_mallocs;
+    guint n;
+
+    cpml_scratch_put_stats(&old_allocs, &old_mallocs);
+
+    /* Allocate more than a single block */
+    for (n = 0; n < G_N_ELEMENTS(chunks); ++n) {
+        chunks[n] = cpml_scratch_alloc(1000);
+        g_assert_nonnull(chunks[n]);
+    }
+
+    cpml_scratch_put_stats(&n_allocs, &n_mallocs);
+    g_assert_cmpuint(n_allocs - old_allocs, ==, G_N_ELEMENTS(chunks));
+    g_assert_cmpuint(n_mallocs, >, old_mallocs);
+
+    g_test_message("Reset must be ignored while some chunk is in use");
+    cpml_scratch_reset();
+    memset(chunks[0], 0, 1000);
+    for (n = 1; n < G_N_ELEMENTS(chunks); n += 2)
+        cpml_scratch_free(chunks[n]);
+    cpml_scratch_reset();
+    for (n = 0; n < G_N_ELEMENTS(chunks); n += 2)
+        cpml_scratch_free(chunks[n]);
+
+    g_test_message("After a reset the same workload must not call the allocator");
+    cpml_scratch_reset();
+    cpml_scratch_put_stats(&old_allocs, &old_mallocs);
+    for (n = 0; n < G_N_ELEMENTS(chunks); ++n)
+        chunks[n] = cpml_scratch_alloc(1000);
+    cpml_scratch_put_stats(&n_allocs, &n_mallocs);
+    g_assert_cmpuint(n_mallocs, ==, old_mallocs);
+    for (n = G_N_ELEMENTS(chunks); n > 0; --n)
+        cpml_scratch_free(chunks[n - 1]);
+
+    /* Invalid stats pointers must be silently ignored */
+    cpml_scratch_put_stats(NULL, NULL);
+}
+
+static void
+_cpml_method_primitive_dup(void)
+{
+    CpmlSegment segment;
+    CpmlPrimitive primitive, *dup;
+
+    cpml_segment_from_cairo(&segment, &path);
+    cpml_primitive_from_segment(&primitive, &segment);
+    cpml_primitive_next(&primitive);
+
+    dup = cpml_scratch_primitive_dup(&primitive);
+    g_assert_nonnull(dup);
+    g_assert_true(dup->org != primitive.org);
+    g_assert_true(dup->data != primitive.data);
+    g_assert_true(dup->segment != primitive.segment);
+    g_assert_cmpint(dup->data->header.type, ==, CPML_CURVE);
+    g_assert_cmpfloat(dup->org->point.x, ==, 2);
+    g_assert_cmpfloat(dup->data[3].point.y, ==, 9);
+    g_assert_cmpint(dup->segment->num_data, ==, segment.num_data);
+
+    /* Modifying the duplicate must not change the source */
+    dup->data[3].point.y = 0;
+    g_assert_cmpfloat(data[7].point.y, ==, 9);
+
+    cpml_scratch_free(dup);
+}
+
+static void
+_cpml_method_segment_dup(void)
+{
+    CpmlSegment segment, *dup;
+
+    cpml_segment_from_cairo(&segment, &path);
+
+    dup = cpml_scratch_segment_dup(&segment);
+    g_assert_nonnull(dup);
+    g_assert_null(dup->path);
+    g_assert_true(dup->data != segment.data);
+    g_assert_cmpint(dup->num_data, ==, segment.num_data);
+    g_assert_cmpfloat(dup->data[1].point.y, ==, 1);
+
+    cpml_segment_reverse(dup);
+    g_assert_cmpfloat(dup->data[1].point.x, ==, 8);
+    g_assert_cmpfloat(data[1].point.x, ==, 0);
+
+    cpml_scratch_free(dup);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/cpml/scratch/behavior/rewind", _cpml_behavior_rewind);
+    g_test_add_func("/cpml/scratch/behavior/alignment", _cpml_behavior_alignment);
+
+    g_test_add_func("/cpml/scratch/method/reset", _cpml_method_reset);
+    g_test_add_func("/cpml/scratch/method/primitive-dup", _cpml_method_primitive_dup);
+    g_test_add_func("/cpml/scratch/method/segment-dup", _cpml_method_segment_dup);
+
+    return g_test_run();
+}
@@ -416,6 +416,97 @@ _cpml_method_put_intersections(void)
     g_assert_cmpuint(cpml_segment_put_intersections(&segment1, &segment2, 10, pair), ==, 0);
 }
 
+static void
+_cpml_method_put_self_intersections(void)
+{
+    cairo_path_data_t data[] = {
+        /* A bow tie: the first line crosses the third one in (1, 1) */
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 2 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 0, 2 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+    cairo_path_data_t vertex_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 2 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 4, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 4 }}
+    };
+    cairo_path_t vertex_path = {
+        CAIRO_STATUS_SUCCESS,
+        vertex_data,
+        G_N_ELEMENTS(vertex_data)
+    };
+    cairo_path_data_t arc_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 4, 0 }},
+        /* Centered in (2.25, 0) with a radius of 1.75 */
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 2.25, 1.75 }},
+        { .point = { 1.012563, -1.237437 }}
+    };
+    cairo_path_t arc_path = {
+        CAIRO_STATUS_SUCCESS,
+        arc_data,
+        G_N_ELEMENTS(arc_data)
+    };
+    CpmlSegment segment;
+    CpmlPair pair[10];
+
+    cpml_segment_from_cairo(&segment, &path);
+
+    /* The joins between adjacent primitives must not be reported */
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 10, pair), ==, 1);
+    adg_assert_isapprox(pair[0].x, 1);
+    adg_assert_isapprox(pair[0].y, 1);
+
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 0, pair), ==, 0);
+
+    /* Turn the bow tie into a square */
+    data[3].point.x = 2;
+    data[3].point.y = 0;
+    data[5].point.x = 2;
+    data[5].point.y = 2;
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 10, pair), ==, 0);
+
+    /* The second segment of the test path does not intersect itself */
+    cpml_segment_from_cairo(&segment, (cairo_path_t *) adg_test_path());
+    cpml_segment_next(&segment);
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 10, pair), ==, 0);
+
+    /* The last line crosses the vertex in (2, 2), shared by the first
+     * two lines: the crossing must be reported once */
+    cpml_segment_from_cairo(&segment, &vertex_path);
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 10, pair), ==, 1);
+    adg_assert_isapprox(pair[0].x, 2);
+    adg_assert_isapprox(pair[0].y, 2);
+
+    /* The arc crosses the line in (0.5, 0) besides joining it in (4, 0):
+     * the join must not take the only available slot */
+    cpml_segment_from_cairo(&segment, &arc_path);
+    g_assert_cmpuint(cpml_segment_put_self_intersections(&segment, 1, pair), ==, 1);
+    adg_assert_isapprox(pair[0].x, 0.5);
+    adg_assert_isapprox(pair[0].y, 0);
+}
+
 static void
 _cpml_method_offset(void)
 {
@@ -448,6 +539,127 @@ _cpml_method_offset(void)
     g_free(segment);
 }
 
+static void
+_cpml_method_put_offsets(void)
+{
+    cairo_path_data_t data[] = {
+        /* A 4x4 square with a degenerated line in (4, 4) */
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 0, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 4, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 4, 4 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 4, 4 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 0, 4 }},
+        { .header = { CPML_CLOSE, 1 }}
+    };
+    cairo_path_t path = {
+        CAIRO_STATUS_SUCCESS,
+        data,
+        G_N_ELEMENTS(data)
+    };
+    cairo_path_data_t arc_data[] = {
+        /* Half circle centered in (0, 0) with radius 2 */
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 0, 2 }},
+        { .point = { -2, 0 }}
+    };
+    cairo_path_t arc_path = {
+        CAIRO_STATUS_SUCCESS,
+        arc_data,
+        G_N_ELEMENTS(arc_data)
+    };
+    cairo_path_data_t join_data[] = {
+        { .header = { CPML_MOVE, 2 }},
+        { .point = { 4, 0 }},
+        { .header = { CPML_LINE, 2 }},
+        { .point = { 2, 0 }},
+        { .header = { CPML_ARC, 3 }},
+        { .point = { 0, 2 }},
+        { .point = { -2, 0 }}
+    };
+    cairo_path_t join_path = {
+        CAIRO_STATUS_SUCCESS,
+        join_data,
+        G_N_ELEMENTS(join_data)
+    };
+    CpmlSegment segment, *dest[2], results[2];
+    CpmlPair pair;
+    double offsets[] = { 1, -1 };
+
+    cpml_segment_from_cairo(&segment, &path);
+    dest[0] = cpml_segment_deep_dup(&segment);
+    dest[1] = cpml_segment_deep_dup(&segment);
+    results[0] = *dest[0];
+    results[1] = *dest[1];
+
+    g_assert_cmpint(cpml_segment_put_offsets(&segment, 2, offsets, results), ==, 1);
+
+    /* The square is closed, so also the start point is joined */
+    adg_assert_isapprox(results[0].data[1].point.x, 1);
+    adg_assert_isapprox(results[0].data[1].point.y, 1);
+    adg_assert_isapprox(results[0].data[3].point.x, 3);
+    adg_assert_isapprox(results[0].data[3].point.y, 1);
+    adg_assert_isapprox(results[0].data[5].point.x, 3);
+    adg_assert_isapprox(results[0].data[5].point.y, 3);
+    adg_assert_isapprox(results[0].data[7].point.x, 3);
+    adg_assert_isapprox(results[0].data[7].point.y, 3);
+    adg_assert_isapprox(results[0].data[9].point.x, 1);
+    adg_assert_isapprox(results[0].data[9].point.y, 3);
+
+    adg_assert_isapprox(results[1].data[1].point.x, -1);
+    adg_assert_isapprox(results[1].data[1].point.y, -1);
+    adg_assert_isapprox(results[1].data[3].point.x, 5);
+    adg_assert_isapprox(results[1].data[3].point.y, -1);
+    adg_assert_isapprox(results[1].data[5].point.x, 5);
+    adg_assert_isapprox(results[1].data[5].point.y, 5);
+    adg_assert_isapprox(results[1].data[7].point.x, 5);
+    adg_assert_isapprox(results[1].data[7].point.y, 5);
+    adg_assert_isapprox(results[1].data[9].point.x, -1);
+    adg_assert_isapprox(results[1].data[9].point.y, 5);
+
+    /* The original segment must be left untouched */
+    adg_assert_isapprox(data[1].point.x, 0);
+    adg_assert_isapprox(data[1].point.y, 0);
+
+    /* Segments with a different layout must be rejected */
+    results[0].num_data = 4;
+    g_assert_cmpint(cpml_segment_put_offsets(&segment, 2, offsets, results), ==, 0);
+
+    g_free(dest[0]);
+    g_free(dest[1]);
+
+    /* The arc is offseted toward the normal of its tangent */
+    cpml_segment_from_cairo(&segment, &arc_path);
+    g_assert_cmpint(cpml_segment_put_offsets(&segment, 1, offsets, &segment), ==, 1);
+    adg_assert_isapprox(arc_data[1].point.x, 1);
+    adg_assert_isapprox(arc_data[1].point.y, 0);
+    adg_assert_isapprox(arc_data[3].point.x, 0);
+    adg_assert_isapprox(arc_data[3].point.y, 1);
+    adg_assert_isapprox(arc_data[4].point.x, -1);
+    adg_assert_isapprox(arc_data[4].point.y, 0);
+
+    /* A line not tangent to the next arc must be joined where the
+     * offset line meets the offset circle, keeping every point of
+     * the arc on that circle */
+    cpml_segment_from_cairo(&segment, &join_path);
+    g_assert_cmpint(cpml_segment_put_offsets(&segment, 1, offsets + 1, &segment), ==, 1);
+    adg_assert_isapprox(join_data[1].point.x, 4);
+    adg_assert_isapprox(join_data[1].point.y, 1);
+    adg_assert_isapprox(join_data[3].point.x, 2.828);
+    adg_assert_isapprox(join_data[3].point.y, 1);
+    cpml_pair_from_cairo(&pair, &join_data[5]);
+    adg_assert_isapprox(cpml_pair_distance(&pair, NULL), 3);
+    g_assert_cmpfloat(pair.y, >, 2.9);
+    adg_assert_isapprox(join_data[6].point.x, -3);
+    adg_assert_isapprox(join_data[6].point.y, 0);
+}
+
 static void
 _cpml_method_transform(void)
 {
@@ -595,7 +807,9 @@ main(int argc, char *argv[])
     g_test_add_func("/cpml/segment/method/copy-data", _cpml_method_copy_data);
     g_test_add_func("/cpml/segment/method/get-length", _cpml_method_get_length);
     g_test_add_func("/cpml/segment/method/put-intersections", _cpml_method_put_intersections);
+    g_test_add_func("/cpml/segment/method/put-self-intersections", _cpml_method_put_self_intersections);
     g_test_add_func("/cpml/segment/method/offset", _cpml_method_offset);
+    g_test_add_func("/cpml/segment/method/put-offsets", _cpml_method_put_offsets);
     g_test_add_func("/cpml/segment/method/transform", _cpml_method_transform);
     g_test_add_func("/cpml/segment/method/reverse", _cpml_method_reverse);
     g_test_add_func("/cpml/segment/method/to-cairo", _cpml_method_to_cairo);
@@ -28,6 +28,7 @@
 #include "adg-title-block.h"
 #include "adg-canvas.h"
 #include "adg-test.h"
+#include <glib/gstdio.h>
 
 
 typedef struct {
@@ -46,6 +47,12 @@ typedef struct {
     gboolean flag;
 } _SignalData;
 
+typedef struct {
+    gchar *testpath;
+    AdgBenchFunc func;
+    gpointer user_data;
+} _BenchData;
+
 
 /* Using adg_nop() would require to pull in the whole libadg stack:
  * better to replicate that trivial function instead.
@@ -768,3 +775,146 @@ adg_test_add_traps(const gchar *testpath, AdgTrapsFunc func, gint n_fragments)
     traps_data->n_fragments = n_fragments;
     g_test_add_data_func(testpath, traps_data, (gpointer) _adg_traps);
 }
+
+/* Loads the results of a previous run, as written by _adg_bench_report(),
+ * to be used as a baseline. The file is read only once: any line that
+ * cannot be parsed is silently skipped. */
+static GHashTable *
+_adg_bench_baseline(void)
+{
+    static GHashTable *baseline = NULL;
+    const gchar *file;
+    gchar *content, **lines, **line;
+
+    if (baseline != NULL)
+        return baseline;
+
+    baseline = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+    file = g_getenv("ADG_BENCH_BASELINE");
+    if (file == NULL || ! g_file_get_contents(file, &content, NULL, NULL))
+        return baseline;
+
+    lines = g_strsplit(content, "\n", -1);
+    g_free(content);
+
+    for (line = lines; *line != NULL; ++line) {
+        gchar **fields = g_strsplit(*line, "\t", -1);
+
+        if (g_strv_length(fields) >= 3) {
+            gdouble *result = g_new(gdouble, 1);
+            *result = g_ascii_strtod(fields[2], NULL);
+            g_hash_table_insert(baseline, g_strdup(fields[0]), result);
+        }
+
+        g_strfreev(fields);
+    }
+
+    g_strfreev(lines);
+    return baseline;
+}
+
+/* Outputs a result as a tab separated line (test path, number of
+ * iterations, seconds per iteration and, if a baseline is present,
+ * the difference in percentual), either on stdout or appended to the
+ * file specified by the ADG_BENCH_OUTPUT environment variable. */
+static gboolean
+_adg_bench_report(const gchar *testpath, guint n_iterations, gdouble result)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+    const gchar *file, *env;
+    const gdouble *base;
+    gdouble delta, tolerance;
+    GString *line;
+    gboolean is_regression;
+
+    line = g_string_new(testpath);
+    g_string_append_printf(line, "\t%u\t%s", n_iterations,
+                           g_ascii_formatd(buffer, sizeof(buffer), "%.6e", result));
+
+    is_regression = FALSE;
+    base = g_hash_table_lookup(_adg_bench_baseline(), testpath);
+    if (base != NULL && *base > 0) {
+        env = g_getenv("ADG_BENCH_TOLERANCE");
+        tolerance = env != NULL ? g_ascii_strtod(env, NULL) : 10;
+        delta = (result - *base) / *base * 100;
+        is_regression = delta > tolerance;
+        g_string_append_printf(line, "\t%+.1f%%", delta);
+    }
+
+    g_string_append_c(line, '\n');
+
+    file = g_getenv("ADG_BENCH_OUTPUT");
+    if (file == NULL) {
+        g_print("%s", line->str);
+    } else {
+        FILE *fp = g_fopen(file, "a");
+        if (fp != NULL) {
+            fputs(line->str, fp);
+            fclose(fp);
+        }
+    }
+
+    g_string_free(line, TRUE);
+    return ! is_regression;
+}
+
+static void
+_adg_bench(_BenchData *bench_data)
+{
+    GTimer *timer;
+    const gchar *env;
+    gdouble min_time, elapsed, result;
+    guint n, n_iterations;
+
+    if (! g_test_perf()) {
+        g_test_message("Benchmarks are run only in perf mode (-m perf)");
+        return;
+    }
+
+    env = g_getenv("ADG_BENCH_TIME");
+    min_time = env != NULL ? g_ascii_strtod(env, NULL) : 0.5;
+
+    /* Warm up caches and lazy initializations */
+    bench_data->func(bench_data->user_data);
+
+    /* Double the number of iterations until the elapsed time
+     * is long enough to give a meaningful result */
+    timer = g_timer_new();
+    n_iterations = 1;
+    for (;;) {
+        g_timer_start(timer);
+        for (n = 0; n < n_iterations; ++n)
+            bench_data->func(bench_data->user_data);
+        elapsed = g_timer_elapsed(timer, NULL);
+
+        if (elapsed >= min_time || n_iterations >= G_MAXUINT / 2)
+            break;
+
+        n_iterations *= 2;
+    }
+    g_timer_destroy(timer);
+
+    result = elapsed / n_iterations;
+    g_test_minimized_result(result, "%s: %g seconds per iteration",
+                            bench_data->testpath, result);
+
+    if (! _adg_bench_report(bench_data->testpath, n_iterations, result)) {
+        g_test_message("%s: slower than the baseline", bench_data->testpath);
+        g_test_fail();
+    }
+}
+
+void
+adg_test_add_bench(const gchar *testpath, AdgBenchFunc func, gpointer user_data)
+{
+    _BenchData *bench_data;
+
+    g_return_if_fail(func != NULL);
+
+    bench_data = g_new(_BenchData, 1);
+    bench_data->testpath = g_strdup(testpath);
+    bench_data->func = func;
+    bench_data->user_data = user_data;
+    g_test_add_data_func(testpath, bench_data, (gpointer) _adg_bench);
+}
@@ -110,6 +110,13 @@ G_BEGIN_DECLS
  */
 typedef void (*AdgTrapsFunc)(gint i);
 
+/* The following type is used by adg_test_add_bench() to register a
+ * benchmark. The function is called repeatedly with the same user data,
+ * so it should perform one iteration of the code to be measured (and
+ * nothing more) in a way that can be repeated indefinitely.
+ */
+typedef void (*AdgBenchFunc)(gpointer user_data);
+
 
 void            adg_test_init                   (int            *p_argc,
                                                  char          **p_argv[]);
@@ -142,6 +149,9 @@ void            adg_test_add_local_space_checks (const gchar    *testpath,
 void            adg_test_add_traps              (const gchar    *testpath,
                                                  AdgTrapsFunc    func,
                                                  gint            n_fragments);
+void            adg_test_add_bench              (const gchar    *testpath,
+                                                 AdgBenchFunc    func,
+                                                 gpointer        user_data);
 
 G_END_DECLS
 